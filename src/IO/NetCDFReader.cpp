@@ -3,8 +3,28 @@
 #include "logging.h"
 #include "topology.hpp"
 
+#include <cstring>
+#include <string>
+
 using namespace biospring;
 
+// Returns the content of a fixed-length, possibly not null-terminated, name field.
+static std::string fixedLengthString(const char * field, size_t length)
+{
+    return std::string(field, strnlen(field, length));
+}
+
+// Returns the mass of a particle, replacing a null mass by 1.0.
+float NetCDFReader::checkedMass(size_t index) const
+{
+    if (std::abs(_pbuffer.masses[index]) < 1e-6)
+    {
+        logging::warning("Mass of particle %zu is 0.0. Changing it to 1.0", index);
+        return 1.0;
+    }
+    return _pbuffer.masses[index];
+}
+
 void NetCDFReader::addSpringsToSpn()
 {
     for (size_t i = 0; i < _sbuffer.number_of_springs; ++i)
@@ -18,54 +38,39 @@ void NetCDFReader::addSpringsToSpn()
 
 void NetCDFReader::addParticlesToSpn()
 {
-    char buf[5] = "";
+    _topology.reserve(_pbuffer.number_of_particles);
     for (size_t i = 0; i < _pbuffer.number_of_particles; ++i)
     {
-        topology::Particle p;
-        p.properties().set_position(
+        topology::ParticleProperties properties;
+        properties.set_position(
             Vector3f(_pbuffer.coordinates[i][0], _pbuffer.coordinates[i][1], _pbuffer.coordinates[i][2]));
-        p.properties().set_atom_id(_pbuffer.ids[i]);
-        p.properties().set_residue_id(_pbuffer.resids[i]);
-        p.properties().set_charge(_pbuffer.charges[i]);
-        p.properties().set_radius(_pbuffer.radii[i]);
-        p.properties().set_epsilon(_pbuffer.epsilons[i]);
-        p.properties().set_dynamic((_pbuffer.dynamic_states[i] == 0) ? false : true);
-        p.properties().set_mass(_pbuffer.masses[i]);
-
-        if (std::abs(p.properties().mass()) < 1e-6)
-        {
-            logging::warning("Mass of particle %d is 0.0. Changing it to 1.0", i);
-            p.properties().set_mass(1.0);
-        }
-
-        memset(buf, 0, PARTICLE_NAME_LENGTH);
-        strncpy(buf, _pbuffer.particlenames[i], PARTICLE_NAME_LENGTH);
-        p.properties().set_name(buf);
-
-        memset(buf, 0, RESIDUE_NAME_LENGTH);
-        strncpy(buf, _pbuffer.resnames[i], RESIDUE_NAME_LENGTH);
-        p.properties().set_residue_name(buf);
-
-        memset(buf, 0, CHAIN_NAME_LENGTH);
-        strncpy(buf, _pbuffer.chainnames[i], CHAIN_NAME_LENGTH);
-        p.properties().set_chain_name(buf);
+        properties.set_atom_id(_pbuffer.ids[i]);
+        properties.set_residue_id(_pbuffer.resids[i]);
+        properties.set_charge(_pbuffer.charges[i]);
+        properties.set_radius(_pbuffer.radii[i]);
+        properties.set_epsilon(_pbuffer.epsilons[i]);
+        properties.set_dynamic((_pbuffer.dynamic_states[i] == 0) ? false : true);
+        properties.set_mass(checkedMass(i));
+
+        properties.set_name(fixedLengthString(_pbuffer.particlenames[i], PARTICLE_NAME_LENGTH));
+        properties.set_residue_name(fixedLengthString(_pbuffer.resnames[i], RESIDUE_NAME_LENGTH));
+        properties.set_chain_name(fixedLengthString(_pbuffer.chainnames[i], CHAIN_NAME_LENGTH));
 
         /* we test if these arrays are NULL since they are not mandatory
          * in the Nc. */
-        // topology::IMPProperties impProperties = topology::IMPProperties::build();
         auto imp = topology::IMPProperties::build();
         if (_pbuffer.surface_accessibilities)
             imp.solvent_accessible_surface(_pbuffer.surface_accessibilities[i]);
         if (_pbuffer.hscales)
             imp.transfert_energy_by_accessible_surface(_pbuffer.hscales[i]);
-        p.properties().set_imp(imp);
+        properties.set_imp(imp);
 
         // Hydrophobicity is a ParticleProperties member in its own right, not an
         // IMP property: it feeds the pairwise hydrophobic force, not IMPALA.
         if (_pbuffer.hydrophobicities)
-            p.properties().set_hydrophobicity(_pbuffer.hydrophobicities[i]);
+            properties.set_hydrophobicity(_pbuffer.hydrophobicities[i]);
 
-        _topology.add_particle(p);
+        _topology.add_particle(properties);
     }
 }
 
@@ -87,6 +92,68 @@ void NetCDFReader::read()
     }
 }
 
+//
+// Reads the file straight into a SpringNetwork.
+//
+// This is the loading path of the simulation engine. `read()` builds a
+// `topology::Topology`, which `Topology::to_spring_network` then copies once more
+// into `spn::Particle` objects; on large networks those intermediate copies (and
+// their per-particle strings and unique-id maps) dominate both startup time and
+// peak memory. Here each particle is created from the NetCDF arrays directly into
+// the network's reserved storage, and every array is released as soon as it has
+// been consumed.
+//
+// The resulting network is the same as `read()` followed by `to_spring_network`.
+//
+void NetCDFReader::readSpringNetwork(spn::SpringNetwork & spn)
+{
+    try
+    {
+        _file = std::make_unique<netCDF::NcFile>(_filename, netCDF::NcFile::read);
+        readParticles();
+
+        const netCDF::NcDim springdim = _file->getDim("spring_number");
+        spn.clear();
+        spn.reserve(_pbuffer.number_of_particles, springdim.isNull() ? 0 : springdim.getSize());
+
+        for (size_t i = 0; i < _pbuffer.number_of_particles; ++i)
+        {
+            spn::Particle p;
+            p.setName(fixedLengthString(_pbuffer.particlenames[i], PARTICLE_NAME_LENGTH));
+            p.setResName(fixedLengthString(_pbuffer.resnames[i], RESIDUE_NAME_LENGTH));
+            // resids/particleids stay signed ints on disk (some PDB files use
+            // negative residue numbering), while the simulation-side Particle
+            // assumes a non-negative id; cast explicitly as to_spring_network does.
+            p.setResId(static_cast<unsigned>(_pbuffer.resids[i]));
+            p.setChainName(fixedLengthString(_pbuffer.chainnames[i], CHAIN_NAME_LENGTH));
+            p.setExtid(static_cast<unsigned>(_pbuffer.ids[i]));
+            p.setMass(checkedMass(i));
+            p.setCharge(_pbuffer.charges[i]);
+            p.setRadius(_pbuffer.radii[i]);
+            p.setEpsilon(_pbuffer.epsilons[i]);
+            p.setPosition(Vector3f(_pbuffer.coordinates[i][0], _pbuffer.coordinates[i][1], _pbuffer.coordinates[i][2]));
+            p.setDynamic(_pbuffer.dynamic_states[i] != 0);
+            p.setHydrophobicity(_pbuffer.hydrophobicities[i]);
+            p.setSolventAccessibilitySurface(_pbuffer.surface_accessibilities[i]);
+            p.setTransferEnergyByAccessibleSurface(_pbuffer.hscales[i]);
+            spn.addParticle(std::move(p));
+        }
+        _pbuffer.clear();
+
+        readSprings();
+        for (size_t i = 0; i < _sbuffer.number_of_springs; ++i)
+        {
+            spn.addSpring(static_cast<unsigned>(_sbuffer.springs[i][0]), static_cast<unsigned>(_sbuffer.springs[i][1]),
+                          _sbuffer.springsequilibriums[i], _sbuffer.springsstiffnesses[i]);
+        }
+        _sbuffer.clear();
+    }
+    catch (netCDF::exceptions::NcException & e)
+    {
+        logging::die("%s", e.what());
+    }
+}
+
 void NetCDFReader::readParticles()
 {
     readNumberOfParticles();
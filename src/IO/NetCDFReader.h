@@ -16,6 +16,9 @@ class NetCDFReader : public TopologyReaderBase
 
     void read();
 
+    // Reads the file straight into a SpringNetwork, without intermediate Topology.
+    void readSpringNetwork(biospring::spn::SpringNetwork & spn);
+
   protected:
     SpringBuffer _sbuffer;
     ParticleBuffer _pbuffer;
@@ -32,6 +35,8 @@ class NetCDFReader : public TopologyReaderBase
     void addParticlesToSpn();
     void addSpringsToSpn();
 
+    float checkedMass(size_t index) const;
+
     void checkNDims(const netCDF::NcVar & var, int ref);
     void checkDim(const netCDF::NcVar & var, int dimid, size_t size);
     netCDF::NcVar getNcVar(const char * varname, bool mandatory = true);
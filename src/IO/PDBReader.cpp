@@ -1,11 +1,17 @@
 
 #include "IO/PDBReader.h"
 #include "logging.h"
+#include "utils/file.hpp"
 #include "utils/string.hpp"
 
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <string_view>
+
+#ifdef OPENMP_SUPPORT
+#include <omp.h>
+#endif
 
 using namespace biospring;
 
@@ -22,10 +28,15 @@ static bool sameParticles(const topology::Particle & left, const topology::Parti
 }
 
 //
-// Parses an atom line, creates a particle with according data and adds it to spring network.
+// Parses the fixed columns of an ATOM/HETATM line.
 //
-topology::Particle PDBReader::parseAtomLine(const std::string & line)
+// Fields are read as views on the line and numbers with `std::from_chars`, so that
+// parsing allocates nothing and can run concurrently on lines of a mapped file.
+//
+bool PDBReader::parseAtomRecord(std::string_view line, AtomRecord & record)
 {
+    namespace str = biospring::utils::string;
+
     // Occupancy (cols 55-60), temperature factor (cols 61-66), element name
     // (cols 77-78) and charge (cols 79-80) are all optional trailing columns
     // of a PDB ATOM/HETATM record; a number of real-world files (including
@@ -33,156 +44,240 @@ topology::Particle PDBReader::parseAtomLine(const std::string & line)
     // models with no occupancy/B-factor at all, sometimes not even padded
     // to the nominal 8-character-wide z column) omit some or all of them.
     // Only require the line to reach into the z column (position 47) so
-    // std::stof below has at least one digit to parse, and treat each
-    // trailing field as absent/defaulted rather than dying when the line
-    // doesn't reach that far.
+    // there is at least one digit to parse, and treat each trailing field
+    // as absent/defaulted rather than failing when the line doesn't reach
+    // that far.
+    if (line.size() < 47)
+        return false;
+
+    if (!str::parse_field(line.substr(6, 5), record.atom_id) || !str::parse_field(line.substr(22, 4), record.residue_id) ||
+        !str::parse_field(line.substr(30, 8), record.x) || !str::parse_field(line.substr(38, 8), record.y) ||
+        !str::parse_field(line.substr(46, 8), record.z))
+        return false;
+
+    record.name = str::trim_view(line.substr(12, 4));
+    record.residue_name = str::trim_view(line.substr(17, 3));
+    record.chain_name = str::trim_view(line.substr(21, 1));
+
+    record.occupancy = 1.0f;
+    if (line.size() >= 60 && !str::trim_view(line.substr(54, 6)).empty() &&
+        !str::parse_field(line.substr(54, 6), record.occupancy))
+        return false;
+
+    record.temperature_factor = 0.0f;
+    if (line.size() >= 66 && !str::trim_view(line.substr(60, 6)).empty() &&
+        !str::parse_field(line.substr(60, 6), record.temperature_factor))
+        return false;
+
+    record.element_name = line.size() >= 78 ? str::trim_view(line.substr(76, 2)) : std::string_view();
+
+    record.charge = 0.0f;
+    if (line.size() > 78 && !str::trim_view(line.substr(78, 2)).empty() &&
+        !str::parse_field(line.substr(78, 2), record.charge))
+        return false;
+
+    return true;
+}
+
+//
+// Builds the properties of the particle described by an ATOM/HETATM record.
+//
+topology::ParticleProperties PDBReader::makeParticleProperties(const AtomRecord & record)
+{
+    topology::ParticleProperties properties;
+    properties.set_name(std::string(record.name));
+    properties.set_atom_id(record.atom_id);
+    properties.set_residue_name(std::string(record.residue_name));
+    properties.set_residue_id(record.residue_id);
+    properties.set_chain_name(std::string(record.chain_name));
+    properties.set_element_name(std::string(record.element_name));
+    properties.set_position(Vector3f(record.x, record.y, record.z));
+    properties.set_occupancy(record.occupancy);
+    properties.set_temperature_factor(record.temperature_factor);
+    properties.set_charge(record.charge);
+    return properties;
+}
+
+//
+// Parses an atom line, creates a particle with according data and adds it to spring network.
+//
+topology::Particle PDBReader::parseAtomLine(const std::string & line)
+{
     if (line.size() < 47)
     {
         logging::error("PDB format requires a line that is at least 47 characters long");
         logging::die("line too short: '%s'", line.c_str());
     }
-    int id = std::stoi(line.substr(6, 5));
-    std::string name = biospring::utils::string::trim(line.substr(12, 4));
-    std::string resname = biospring::utils::string::trim(line.substr(17, 3));
-    std::string chain = biospring::utils::string::trim(line.substr(21, 1));
-    int resid = std::stoi(line.substr(22, 4));
-    float x = std::stof(line.substr(30, 8));
-    float y = std::stof(line.substr(38, 8));
-    float z = std::stof(line.substr(46, 8));
-    float occupancy = line.size() >= 60 && !biospring::utils::string::trim(line.substr(54, 6)).empty()
-                           ? std::stof(line.substr(54, 6))
-                           : 1.0f;
-    float tempfactor = line.size() >= 66 && !biospring::utils::string::trim(line.substr(60, 6)).empty()
-                            ? std::stof(line.substr(60, 6))
-                            : 0.0f;
-    std::string elementname = line.size() >= 78 ? biospring::utils::string::trim(line.substr(76, 2)) : "";
-    float charge = 0.0;
-    if (line.size() > 78 and biospring::utils::string::trim(line.substr(78, 2)) != "")
-        charge = std::stof(line.substr(78, 2));
-
-    topology::ParticleProperties properties = topology::ParticleProperties::build()
-                                                  .name(name)
-                                                  .atom_id(id)
-                                                  .residue_name(resname)
-                                                  .residue_id(resid)
-                                                  .chain_name(chain)
-                                                  .element_name(elementname)
-                                                  .position(Vector3f(x, y, z))
-                                                  .occupancy(occupancy)
-                                                  .temperature_factor(tempfactor)
-                                                  .charge(charge);
-
-    return topology::Particle(properties);
+
+    AtomRecord record;
+    if (!parseAtomRecord(line, record))
+        logging::die("malformed ATOM/HETATM record: '%s'", line.c_str());
+
+    return topology::Particle(makeParticleProperties(record));
 }
 
-std::vector<std::pair<size_t, size_t>> PDBReader::parseConectLine(const std::string & line)
+//
+// Parses a CONECT line.
+//
+// The record's own serial is mandatory, the connected serials (cols 12-31) are
+// read as long as they parse.
+//
+PDBReader::ConectRecord PDBReader::parseConectRecord(std::string_view line)
 {
-    std::vector<std::pair<size_t, size_t>> pairs_indexes;
+    ConectRecord record;
 
-    // The connected serials below are each parsed defensively; the record's own
-    // serial must be too, otherwise a malformed CONECT line throws
-    // std::invalid_argument straight out of the reader.
-    size_t serial = 0;
-    try
+    if (line.size() <= 6 || !biospring::utils::string::parse_field(line.substr(6, 5), record.serials[0]))
     {
-        serial = static_cast<size_t>(std::stoi(line.substr(6, 5)));
+        record.malformed = true;
+        return record;
     }
-    catch (const std::exception &)
+    record.size = 1;
+
+    static constexpr size_t bonded_columns[] = {11, 16, 21, 26};
+    for (size_t start : bonded_columns)
+    {
+        if (start >= line.size())
+            break;
+        if (biospring::utils::string::parse_field(line.substr(start, 5), record.serials[record.size]))
+            record.size++;
+    }
+
+    return record;
+}
+
+std::vector<std::pair<size_t, size_t>> PDBReader::parseConectLine(const std::string & line)
+{
+    std::vector<std::pair<size_t, size_t>> pairs_indexes;
+
+    // A malformed serial used to throw std::invalid_argument straight out of
+    // the reader; the record is skipped instead.
+    const ConectRecord record = parseConectRecord(line);
+    if (record.malformed)
     {
         logging::warning("skipping malformed CONECT record: %s", line.c_str());
         return pairs_indexes;
     }
 
-    // Helper function to try parsing and add to vector if successful
-    auto try_add_pair = [&](size_t start_index) {
-        try {
-            size_t connected_serial = static_cast<size_t>(std::stoi(line.substr(start_index, 5)));
-            pairs_indexes.emplace_back(serial, connected_serial);
-        } catch (const std::exception&) {
-            // Catches std::invalid_argument and std::out_of_range
-            // Do nothing if parsing fails or substring is out of range
-        }
-    };
-
-    // Add each connected serial if valid
-    try_add_pair(11); // serial1
-    try_add_pair(16); // serial2
-    try_add_pair(21); // serial3
-    try_add_pair(26); // serial4
+    const size_t serial = static_cast<size_t>(record.serials[0]);
+    for (size_t i = 1; i < record.size; ++i)
+        pairs_indexes.emplace_back(serial, static_cast<size_t>(record.serials[i]));
 
     return pairs_indexes;
 }
 
+//
+// Reads a PDB file.
+//
+// The file is mapped in memory and its lines are indexed, then ATOM/HETATM and
+// CONECT records are parsed concurrently into plain records. Particles and springs
+// are finally inserted serially, in file order, into a topology reserved up front:
+// particle unique ids are minted from a global counter and the duplicate-serial and
+// dangling-CONECT diagnostics depend on that order.
+//
 void PDBReader::read()
 {
-    // Opens file for reading, dies if error occurs.
-    safeOpen();
+    // Maps the file, dies if error occurs.
+    utils::file::MappedFile file(_filename, true);
+    const std::vector<std::string_view> lines = utils::string::split_lines(file.view());
 
-    // Loop over lines.
-    std::string buffer;
-    std::getline(_instream, buffer);
-    do
+    std::vector<std::string_view> atomlines;
+    std::vector<std::string_view> conectlines;
+    for (const std::string_view & line : lines)
+    {
+        if (isAtomLine(line))
+            atomlines.push_back(line);
+        else if (isConectLine(line))
+            conectlines.push_back(line);
+    }
+
+    // Parses records.
+    std::vector<AtomRecord> atoms(atomlines.size());
+    std::vector<char> valid(atomlines.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < atomlines.size(); ++i)
+        valid[i] = parseAtomRecord(atomlines[i], atoms[i]);
+
+    std::vector<ConectRecord> conects(conectlines.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < conectlines.size(); ++i)
+        conects[i] = parseConectRecord(conectlines[i]);
+
+    // Adds particles.
+    size_t nbonds = 0;
+    for (const ConectRecord & conect : conects)
+        nbonds += conect.size > 0 ? conect.size - 1 : 0;
+    _topology.reserve(_topology.number_of_particles() + atoms.size(), _topology.number_of_springs() + nbonds);
+    _extidtoindex.reserve(atoms.size());
+
+    for (size_t i = 0; i < atoms.size(); ++i)
     {
-        if (isAtomLine(buffer))
+        // Reports the error on the first invalid record exactly as the line parser does.
+        if (!valid[i])
+            parseAtomLine(std::string(atomlines[i]));
+
+        const AtomRecord & atom = atoms[i];
+        if (!isInFilter(atom.name))
+            continue;
+
+        if (!_extidtoindex.emplace(atom.atom_id, _topology.number_of_particles()).second)
         {
-            topology::Particle p = parseAtomLine(buffer);
+            // Some real-world PDB files (e.g. biological-assembly dumps that
+            // concatenate several symmetry copies without renumbering) reuse
+            // atom serials across otherwise-distinct atoms. CONECT resolution
+            // for such a serial is inherently ambiguous, so only the first
+            // occurrence stays addressable; every atom is still added below.
+            BIOSPRING_WARN_ONCE("PDB file reuses atom serial '%d' for multiple atoms "
+                                "(e.g. unrenumbered symmetry copies in a biological "
+                                "assembly): CONECT records referring to it will only "
+                                "resolve to its first occurrence",
+                                atom.atom_id);
+        }
+        _topology.add_particle(makeParticleProperties(atom));
+    }
 
-            if (isInFilter(p.properties().name()))
-            {
-                int atom_id = p.properties().atom_id();
-                if (_extidtoindex.find(atom_id) == _extidtoindex.end())
-                {
-                    _extidtoindex[atom_id] = _topology.number_of_particles();
-                }
-                else
-                {
-                    // Some real-world PDB files (e.g. biological-assembly dumps that
-                    // concatenate several symmetry copies without renumbering) reuse
-                    // atom serials across otherwise-distinct atoms. CONECT resolution
-                    // for such a serial is inherently ambiguous, so only the first
-                    // occurrence stays addressable; every atom is still added below.
-                    BIOSPRING_WARN_ONCE("PDB file reuses atom serial '%d' for multiple atoms "
-                                        "(e.g. unrenumbered symmetry copies in a biological "
-                                        "assembly): CONECT records referring to it will only "
-                                        "resolve to its first occurrence",
-                                        atom_id);
-                }
-                _topology.add_particle(p);
-            }
+    // Adds springs.
+    // https://pdb2pqr.readthedocs.io/en/v3.5.0/_modules/pdb2pqr/pdb.html#CONECT.__init__
+    for (size_t i = 0; i < conects.size(); ++i)
+    {
+        const ConectRecord & conect = conects[i];
+        if (conect.malformed)
+        {
+            logging::warning("skipping malformed CONECT record: %s", std::string(conectlines[i]).c_str());
+            continue;
         }
-        else if (isConectLine(buffer))
+
+        for (size_t j = 1; j < conect.size; ++j)
         {
-            // https://pdb2pqr.readthedocs.io/en/v3.5.0/_modules/pdb2pqr/pdb.html#CONECT.__init__
-            auto pairs_indexes = parseConectLine(buffer);
-            for (auto & pair_indexes : pairs_indexes)
+            // _extidtoindex only holds atoms that passed the filter above.
+            // Looking a missing serial up with operator[] would default-insert
+            // 0 and silently bond the atom to particle 0 -- a wrong topology
+            // that no error reports. Real PDB files routinely CONECT to
+            // HETATMs the filter dropped, so skip the pair instead of dying.
+            const auto first = _extidtoindex.find(conect.serials[0]);
+            const auto second = _extidtoindex.find(conect.serials[j]);
+            if (first == _extidtoindex.end() || second == _extidtoindex.end())
             {
-                // _extidtoindex only holds atoms that passed the filter above.
-                // Looking a missing serial up with operator[] would default-insert
-                // 0 and silently bond the atom to particle 0 -- a wrong topology
-                // that no error reports. Real PDB files routinely CONECT to
-                // HETATMs the filter dropped, so skip the pair instead of dying.
-                const auto first = _extidtoindex.find(pair_indexes.first);
-                const auto second = _extidtoindex.find(pair_indexes.second);
-                if (first == _extidtoindex.end() || second == _extidtoindex.end())
-                {
-                    BIOSPRING_WARN_ONCE("CONECT record refers to atom serials absent from the model "
-                                        "(e.g. %zu-%zu): skipping those bonds",
-                                        pair_indexes.first, pair_indexes.second);
-                    continue;
-                }
-                // PDB CONECT records are listed symmetrically (a bond between A
-                // and B appears once from A's own record and once from B's),
-                // so the same spring is routinely seen twice.
-                try
-                {
-                    _topology.add_spring(first->second, second->second);
-                }
-                catch (const topology::SpringAlreadyExistsException &)
-                {
-                }
+                BIOSPRING_WARN_ONCE("CONECT record refers to atom serials absent from the model "
+                                    "(e.g. %d-%d): skipping those bonds",
+                                    conect.serials[0], conect.serials[j]);
+                continue;
             }
+
+            // PDB CONECT records are listed symmetrically (a bond between A
+            // and B appears once from A's own record and once from B's),
+            // so the same spring is routinely seen twice. A record may also
+            // list its own serial, which is no bond at all.
+            topology::Particle & p1 = _topology.get_particle(first->second);
+            topology::Particle & p2 = _topology.get_particle(second->second);
+            if (first->second == second->second || _topology.has_spring_between(p1, p2))
+                continue;
+            _topology.add_spring(p1, p2);
         }
-    } while (std::getline(_instream, buffer));
+    }
 }
 
 //
@@ -230,7 +325,7 @@ void PDBReader::updatePositions()
 //
 // Returns true if filter is found in the internal filter collection.
 //
-bool PDBReader::isInFilter(const std::string & filter) const
+bool PDBReader::isInFilter(std::string_view filter) const
 {
     if (_atomfilter.size() == 0)
         return true;
@@ -4,8 +4,10 @@
 #include "IO/ReaderBase.h"
 #include "topology.hpp"
 
-#include <map>
+#include <array>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #define UNDEFINEDINDEX -1
@@ -17,21 +19,56 @@ class PDBReader : public TopologyReaderBase
     PDBReader(const std::string & path) : TopologyReaderBase(path) {}
     PDBReader(const char * const path) : TopologyReaderBase(path) {}
 
+    // Fixed-column fields of an ATOM/HETATM record.
+    // String fields are views on the parsed line: a record must not outlive it.
+    struct AtomRecord
+    {
+        int atom_id = 0;
+        std::string_view name;
+        std::string_view residue_name;
+        std::string_view chain_name;
+        int residue_id = 0;
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float occupancy = 1.0f;
+        float temperature_factor = 0.0f;
+        std::string_view element_name;
+        float charge = 0.0f;
+    };
+
+    // Serials of a CONECT record: the atom serial followed by up to four bonded serials.
+    struct ConectRecord
+    {
+        std::array<int, 5> serials{};
+        size_t size = 0;
+        bool malformed = false;
+    };
+
+    // Parses an ATOM/HETATM line without allocating.
+    // Returns false if the line is too short or if a mandatory field is not a number.
+    static bool parseAtomRecord(std::string_view line, AtomRecord & record);
+
+    // Parses a CONECT line without allocating nor throwing.
+    static ConectRecord parseConectRecord(std::string_view line);
+
+    static biospring::topology::ParticleProperties makeParticleProperties(const AtomRecord & record);
+
     static biospring::topology::Particle parseAtomLine(const std::string & line);
 
     // Returns true if a line starts with ATOM or HETATM.
-    static bool isAtomLine(const std::string & line)
+    static bool isAtomLine(std::string_view line)
     {
-        std::string record(line.substr(0, 6));
+        std::string_view record(line.substr(0, 6));
         return (record == "ATOM  " or record == "HETATM");
     }
 
     static std::vector<std::pair<size_t, size_t>> parseConectLine(const std::string & line);
 
     // Returns true if a line starts with CONECT.
-    static bool isConectLine(const std::string & line)
+    static bool isConectLine(std::string_view line)
     {
-        std::string record(line.substr(0, 6));
+        std::string_view record(line.substr(0, 6));
         return (record == "CONECT");
     }
 
@@ -40,11 +77,11 @@ class PDBReader : public TopologyReaderBase
     int getIdFromExtid(size_t extid) const;
 
     void addAtomfilter(const std::string & filter) { _atomfilter.push_back(filter); }
-    bool isInFilter(const std::string & filter) const;
+    bool isInFilter(std::string_view filter) const;
     bool isInFilter(const char * const filter) const { return isInFilter(std::string(filter)); }
 
   protected:
-    std::map<int, size_t> _extidtoindex;
+    std::unordered_map<int, size_t> _extidtoindex;
     std::vector<std::string> _atomfilter;
 };
 
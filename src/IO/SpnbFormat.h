@@ -0,0 +1,101 @@
+//
+// Defines the layout of the native binary spring-network format (.spnb).
+//
+// The format exists so that a spring network can be loaded without the NetCDF
+// library nor any parsing: all values are stored little-endian, the file starts
+// with a versioned fixed-size header followed by a section table, and every
+// section starts on a 64-byte boundary. Once the file is mapped in memory, each
+// array is read without parsing (loading still copies it into the in-memory
+// structures).
+//
+//     [Header][SectionEntry x number_of_sections][pad][section][pad][section]...
+//
+// Particle names, residue names and chain names are stored once in a string table
+// and referred to by index from per-particle arrays. Unlike in the NetCDF format,
+// they are neither truncated nor padded to a fixed width.
+//
+
+#ifndef __SPNB_FORMAT_H__
+#define __SPNB_FORMAT_H__
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace biospring
+{
+namespace io
+{
+namespace spnb
+{
+
+// First bytes of every .spnb file.
+constexpr char MAGIC[8] = {'B', 'I', 'O', 'S', 'P', 'N', 'B', '\0'};
+
+// Format version. Readers refuse files with a different major version.
+constexpr uint32_t VERSION = 1;
+
+// Sections start on multiples of this many bytes (cache line size).
+constexpr size_t ALIGNMENT = 64;
+
+// Section identifiers.
+// New sections may be appended in later versions: readers ignore unknown ids.
+enum class SectionId : uint32_t
+{
+    Coordinates = 1,            // float[3 * number_of_particles]
+    Charges = 2,                // float[number_of_particles]
+    Radii = 3,                  // float[number_of_particles]
+    Epsilons = 4,               // float[number_of_particles]
+    Masses = 5,                 // float[number_of_particles]
+    Hydrophobicities = 6,       // float[number_of_particles], optional
+    TransferEnergies = 7,       // float[number_of_particles], optional (IMPALA hydrophobicity scale)
+    SurfaceAccessibilities = 8, // float[number_of_particles], optional
+    ExternalIds = 9,            // int32[number_of_particles]
+    ResidueIds = 10,            // int32[number_of_particles]
+    DynamicStates = 11,         // uint8[number_of_particles]
+    NameIndices = 12,           // uint32[number_of_particles], index in the string table
+    ResidueNameIndices = 13,    // uint32[number_of_particles], index in the string table
+    ChainNameIndices = 14,      // uint32[number_of_particles], index in the string table
+    StringOffsets = 15,         // uint32[number_of_strings + 1], offsets in StringData
+    StringData = 16,            // char[], concatenated strings (not null-terminated)
+    Springs = 17,               // int32[2 * number_of_springs], particle indices
+    SpringEquilibriums = 18,    // float[number_of_springs]
+    SpringStiffnesses = 19,     // float[number_of_springs]
+};
+
+// File header.
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t number_of_particles;
+    uint64_t number_of_springs;
+    uint32_t number_of_strings;
+    uint32_t number_of_sections;
+    uint8_t reserved[24];
+};
+
+// Section table entry. `offset` is relative to the beginning of the file.
+struct SectionEntry
+{
+    uint32_t id;
+    uint32_t element_size;
+    uint64_t offset;
+    uint64_t size; // in bytes
+};
+
+static_assert(sizeof(Header) == 64, "spnb::Header must be 64 bytes");
+static_assert(sizeof(SectionEntry) == 24, "spnb::SectionEntry must be 24 bytes");
+
+// Returns the first multiple of ALIGNMENT not lower than `offset`.
+constexpr uint64_t align(uint64_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+// The format is little-endian and mapped as is: big-endian hosts are not supported.
+constexpr bool isHostSupported() { return std::endian::native == std::endian::little; }
+
+} // namespace spnb
+} // namespace io
+} // namespace biospring
+
+#endif // __SPNB_FORMAT_H__
@@ -0,0 +1,270 @@
+#include "IO/SpnbReader.h"
+#include "Particle.h"
+#include "SpringNetwork.h"
+#include "logging.h"
+#include "topology.hpp"
+
+#include <cstring>
+#include <limits>
+#include <string>
+
+using namespace biospring;
+using io::spnb::SectionId;
+
+//
+// Maps the file and checks its header and section table.
+//
+void SpnbReader::open()
+{
+    if (not io::spnb::isHostSupported())
+        logging::die("%s: the .spnb format can only be read on little-endian hosts", _filename.c_str());
+
+    _file.open(_filename, true);
+    const std::string_view bytes = _file.view();
+
+    if (bytes.size() < sizeof(io::spnb::Header) or
+        std::memcmp(bytes.data(), io::spnb::MAGIC, sizeof(io::spnb::MAGIC)) != 0)
+        logging::die("%s: not a .spnb file", _filename.c_str());
+
+    _header = reinterpret_cast<const io::spnb::Header *>(bytes.data());
+    if (_header->version != io::spnb::VERSION)
+        logging::die("%s: unsupported .spnb version %u (expected %u)", _filename.c_str(), _header->version,
+                     io::spnb::VERSION);
+    if (_header->header_size < sizeof(io::spnb::Header) or _header->header_size % alignof(io::spnb::SectionEntry))
+        logging::die("%s: invalid .spnb header size %u", _filename.c_str(), _header->header_size);
+
+    const uint64_t tablesize = uint64_t(_header->number_of_sections) * sizeof(io::spnb::SectionEntry);
+    if (_header->header_size + tablesize > bytes.size())
+        logging::die("%s: truncated .spnb section table", _filename.c_str());
+    _sections = std::span<const io::spnb::SectionEntry>(
+        reinterpret_cast<const io::spnb::SectionEntry *>(bytes.data() + _header->header_size),
+        _header->number_of_sections);
+
+    for (const io::spnb::SectionEntry & entry : _sections)
+    {
+        if (entry.offset % io::spnb::ALIGNMENT != 0 or entry.offset > bytes.size() or
+            entry.size > bytes.size() - entry.offset)
+            logging::die("%s: .spnb section %u lies outside the file or is misaligned", _filename.c_str(), entry.id);
+    }
+
+    // Counts are multiplied by element sizes later on: bound them by what the file can hold
+    // first, so that a corrupted header cannot make these products wrap around.
+    if (_header->number_of_particles > bytes.size() / (3 * sizeof(float)) or
+        _header->number_of_springs > bytes.size() / (2 * sizeof(int32_t)))
+        logging::die("%s: .spnb header counts exceed the file size", _filename.c_str());
+    if (_header->number_of_strings == std::numeric_limits<uint32_t>::max())
+        logging::die("%s: invalid .spnb number of strings %u", _filename.c_str(), _header->number_of_strings);
+}
+
+const io::spnb::SectionEntry * SpnbReader::_findSection(SectionId id) const
+{
+    for (const io::spnb::SectionEntry & entry : _sections)
+        if (entry.id == static_cast<uint32_t>(id))
+            return &entry;
+    return nullptr;
+}
+
+template <typename T> std::span<const T> SpnbReader::_optionalSection(SectionId id, size_t size) const
+{
+    const io::spnb::SectionEntry * entry = _findSection(id);
+    if (entry == nullptr)
+        return std::span<const T>();
+    // `size` is checked against the bytes left in the file before it is multiplied.
+    if (size > (_file.view().size() - entry->offset) / sizeof(T))
+        logging::die("%s: .spnb section %u should have %zu elements, more than the file holds", _filename.c_str(),
+                     entry->id, size);
+    if (entry->element_size != sizeof(T) or entry->size != size * sizeof(T))
+        logging::die("%s: .spnb section %u has %llu bytes whereas it should have %zu", _filename.c_str(), entry->id,
+                     static_cast<unsigned long long>(entry->size), size * sizeof(T));
+    return std::span<const T>(reinterpret_cast<const T *>(_file.view().data() + entry->offset), size);
+}
+
+template <typename T> std::span<const T> SpnbReader::_section(SectionId id, size_t size) const
+{
+    if (size > 0 and _findSection(id) == nullptr)
+        logging::die("%s: .spnb section %u not found", _filename.c_str(), static_cast<uint32_t>(id));
+    return _optionalSection<T>(id, size);
+}
+
+std::string_view SpnbReader::getString(uint32_t index) const
+{
+    const auto offsets = _section<uint32_t>(SectionId::StringOffsets, size_t(_header->number_of_strings) + 1);
+    const auto data = _stringData(offsets);
+    if (index >= _header->number_of_strings or offsets[index] > offsets[index + 1] or
+        offsets[index + 1] > offsets.back())
+        logging::die("%s: .spnb string %u not found or corrupted", _filename.c_str(), index);
+    return std::string_view(data.data() + offsets[index], offsets[index + 1] - offsets[index]);
+}
+
+// The string data may only be omitted when every string is empty.
+std::span<const char> SpnbReader::_stringData(std::span<const uint32_t> offsets) const
+{
+    if (offsets.back() > 0)
+        return _section<char>(SectionId::StringData, offsets.back());
+    return _optionalSection<char>(SectionId::StringData, 0);
+}
+
+//
+// Maps every section used to build a network and validates the cross-references
+// (string indexes, spring endpoints), so that the sections are then read unchecked.
+//
+SpnbReader::Sections SpnbReader::_readSections()
+{
+    open();
+
+    Sections s;
+    s.nparticles = getNumberOfParticles();
+    s.nsprings = getNumberOfSprings();
+    if (s.nparticles == 0)
+        logging::die("No particle found in topology");
+
+    const size_t nparticles = s.nparticles;
+    const size_t nsprings = s.nsprings;
+    s.coordinates = _section<float>(SectionId::Coordinates, 3 * nparticles);
+    s.charges = _section<float>(SectionId::Charges, nparticles);
+    s.radii = _section<float>(SectionId::Radii, nparticles);
+    s.epsilons = _section<float>(SectionId::Epsilons, nparticles);
+    s.masses = _section<float>(SectionId::Masses, nparticles);
+    s.hydrophobicities = _optionalSection<float>(SectionId::Hydrophobicities, nparticles);
+    s.transferenergies = _optionalSection<float>(SectionId::TransferEnergies, nparticles);
+    s.surfaces = _optionalSection<float>(SectionId::SurfaceAccessibilities, nparticles);
+    s.extids = _section<int32_t>(SectionId::ExternalIds, nparticles);
+    s.resids = _section<int32_t>(SectionId::ResidueIds, nparticles);
+    s.dynamicstates = _section<uint8_t>(SectionId::DynamicStates, nparticles);
+    s.names = _section<uint32_t>(SectionId::NameIndices, nparticles);
+    s.resnames = _section<uint32_t>(SectionId::ResidueNameIndices, nparticles);
+    s.chainnames = _section<uint32_t>(SectionId::ChainNameIndices, nparticles);
+    s.springs = _section<int32_t>(SectionId::Springs, 2 * nsprings);
+    s.equilibriums = _section<float>(SectionId::SpringEquilibriums, nsprings);
+    s.stiffnesses = _section<float>(SectionId::SpringStiffnesses, nsprings);
+
+    s.offsets = _section<uint32_t>(SectionId::StringOffsets, size_t(_header->number_of_strings) + 1);
+    s.stringdata = _stringData(s.offsets);
+    for (size_t i = 1; i < s.offsets.size(); ++i)
+        if (s.offsets[i] < s.offsets[i - 1])
+            logging::die("%s: corrupted .spnb string table", _filename.c_str());
+    for (size_t i = 0; i < nparticles; ++i)
+        if (s.names[i] >= _header->number_of_strings or s.resnames[i] >= _header->number_of_strings or
+            s.chainnames[i] >= _header->number_of_strings)
+            logging::die("%s: .spnb particle %zu refers to an unknown name", _filename.c_str(), i);
+
+    for (size_t i = 0; i < nsprings; ++i)
+    {
+        const int32_t first = s.springs[2 * i];
+        const int32_t second = s.springs[2 * i + 1];
+        if (first < 0 or second < 0 or static_cast<size_t>(first) >= nparticles or
+            static_cast<size_t>(second) >= nparticles)
+            logging::die("%s: .spnb spring %zu refers to an unknown particle (%d, %d)", _filename.c_str(), i, first,
+                         second);
+        if (first == second)
+            logging::die("%s: .spnb spring %zu links particle %d to itself", _filename.c_str(), i, first);
+    }
+    return s;
+}
+
+float SpnbReader::_checkedMass(const Sections & s, size_t index) const
+{
+    if (std::abs(s.masses[index]) < 1e-6)
+    {
+        logging::warning("Mass of particle %zu is 0.0. Changing it to 1.0", index);
+        return 1.0;
+    }
+    return s.masses[index];
+}
+
+void SpnbReader::_close()
+{
+    _file.close();
+    _header = nullptr;
+    _sections = {};
+}
+
+//
+// Reads the file straight into a SpringNetwork.
+//
+// The resulting network is the same as `read()` followed by
+// `Topology::to_spring_network`.
+//
+void SpnbReader::readSpringNetwork(spn::SpringNetwork & spn)
+{
+    const Sections s = _readSections();
+
+    spn.clear();
+    spn.reserve(s.nparticles, s.nsprings);
+
+    for (size_t i = 0; i < s.nparticles; ++i)
+    {
+        spn::Particle p;
+        p.setName(std::string(s.name(s.names[i])));
+        p.setResName(std::string(s.name(s.resnames[i])));
+        // residue/atom ids stay signed on disk (some PDB files use negative
+        // residue numbering), while the simulation-side Particle assumes a
+        // non-negative id; cast explicitly as to_spring_network does.
+        p.setResId(static_cast<unsigned>(s.resids[i]));
+        p.setChainName(std::string(s.name(s.chainnames[i])));
+        p.setExtid(static_cast<unsigned>(s.extids[i]));
+        p.setMass(_checkedMass(s, i));
+        p.setCharge(s.charges[i]);
+        p.setRadius(s.radii[i]);
+        p.setEpsilon(s.epsilons[i]);
+        p.setPosition(Vector3f(s.coordinates[3 * i], s.coordinates[3 * i + 1], s.coordinates[3 * i + 2]));
+        p.setDynamic(s.dynamicstates[i] != 0);
+        if (not s.hydrophobicities.empty())
+            p.setHydrophobicity(s.hydrophobicities[i]);
+        if (not s.transferenergies.empty())
+            p.setTransferEnergyByAccessibleSurface(s.transferenergies[i]);
+        if (not s.surfaces.empty())
+            p.setSolventAccessibilitySurface(s.surfaces[i]);
+        spn.addParticle(std::move(p));
+    }
+
+    for (size_t i = 0; i < s.nsprings; ++i)
+    {
+        spn.addSpring(static_cast<unsigned>(s.springs[2 * i]), static_cast<unsigned>(s.springs[2 * i + 1]),
+                      s.equilibriums[i], s.stiffnesses[i]);
+    }
+
+    _close();
+}
+
+//
+// Reads the file into a Topology, straight from the mapped sections.
+//
+void SpnbReader::read()
+{
+    const Sections s = _readSections();
+
+    _topology.reserve(s.nparticles, s.nsprings);
+    for (size_t i = 0; i < s.nparticles; ++i)
+    {
+        topology::ParticleProperties properties;
+        properties.set_name(std::string(s.name(s.names[i])));
+        properties.set_residue_name(std::string(s.name(s.resnames[i])));
+        properties.set_chain_name(std::string(s.name(s.chainnames[i])));
+        properties.set_atom_id(s.extids[i]);
+        properties.set_residue_id(s.resids[i]);
+        properties.set_position(Vector3f(s.coordinates[3 * i], s.coordinates[3 * i + 1], s.coordinates[3 * i + 2]));
+        properties.set_charge(s.charges[i]);
+        properties.set_radius(s.radii[i]);
+        properties.set_epsilon(s.epsilons[i]);
+        properties.set_mass(_checkedMass(s, i));
+        properties.set_dynamic(s.dynamicstates[i] != 0);
+        if (not s.hydrophobicities.empty())
+            properties.set_hydrophobicity(s.hydrophobicities[i]);
+        auto imp = topology::IMPProperties::build();
+        if (not s.surfaces.empty())
+            imp.solvent_accessible_surface(s.surfaces[i]);
+        if (not s.transferenergies.empty())
+            imp.transfert_energy_by_accessible_surface(s.transferenergies[i]);
+        properties.set_imp(imp);
+        _topology.add_particle(properties);
+    }
+
+    for (size_t i = 0; i < s.nsprings; ++i)
+    {
+        _topology.add_spring(static_cast<size_t>(s.springs[2 * i]), static_cast<size_t>(s.springs[2 * i + 1]),
+                             s.equilibriums[i], s.stiffnesses[i]);
+    }
+
+    _close();
+}
@@ -0,0 +1,81 @@
+#ifndef __SPNBREADER_H__
+#define __SPNBREADER_H__
+
+#include "IO/ReaderBase.h"
+#include "IO/SpnbFormat.h"
+#include "utils/file.hpp"
+
+#include <span>
+#include <string_view>
+
+// Reads a spring network in the native binary format (.spnb).
+// See IO/SpnbFormat.h for the layout.
+//
+// The file is mapped in memory and validated once. Its arrays are then copied
+// into the Topology or SpringNetwork without any text parsing; the mapping
+// avoids parsing, not the O(N) construction of the in-memory structures.
+class SpnbReader : public TopologyReaderBase
+{
+  public:
+    SpnbReader() : TopologyReaderBase() {}
+    SpnbReader(const std::string & path) : TopologyReaderBase(path) {}
+    SpnbReader(const char * const path) : TopologyReaderBase(path) {}
+
+    // Reads the file into a Topology.
+    void read();
+
+    // Reads the file straight into a SpringNetwork, without intermediate Topology.
+    void readSpringNetwork(biospring::spn::SpringNetwork & spn);
+
+    // Maps and validates the file. Dies if it is not a valid .spnb file.
+    void open();
+
+    size_t getNumberOfParticles() const { return _header ? _header->number_of_particles : 0; }
+    size_t getNumberOfSprings() const { return _header ? _header->number_of_springs : 0; }
+
+    // Returns the name stored at a given index of the string table.
+    // Dies if the index is out of range or the string table is corrupted.
+    std::string_view getString(uint32_t index) const;
+
+  protected:
+    biospring::utils::file::MappedFile _file;
+    const biospring::io::spnb::Header * _header = nullptr;
+    std::span<const biospring::io::spnb::SectionEntry> _sections;
+
+    // Returns a view on a section. Returns an empty view if an optional section is absent.
+    template <typename T> std::span<const T> _section(biospring::io::spnb::SectionId id, size_t size) const;
+    template <typename T> std::span<const T> _optionalSection(biospring::io::spnb::SectionId id, size_t size) const;
+
+    const biospring::io::spnb::SectionEntry * _findSection(biospring::io::spnb::SectionId id) const;
+
+    // Views on the sections used to build a network, validated by `_readSections`.
+    struct Sections
+    {
+        size_t nparticles = 0;
+        size_t nsprings = 0;
+        std::span<const float> coordinates, charges, radii, epsilons, masses;
+        std::span<const float> hydrophobicities, transferenergies, surfaces;
+        std::span<const int32_t> extids, resids;
+        std::span<const uint8_t> dynamicstates;
+        std::span<const uint32_t> names, resnames, chainnames;
+        std::span<const int32_t> springs;
+        std::span<const float> equilibriums, stiffnesses;
+        std::span<const uint32_t> offsets;
+        std::span<const char> stringdata;
+
+        std::string_view name(uint32_t index) const
+        {
+            return std::string_view(stringdata.data() + offsets[index], offsets[index + 1] - offsets[index]);
+        }
+    };
+
+    // Maps the file and returns its validated sections. Dies if the file is corrupted.
+    Sections _readSections();
+    std::span<const char> _stringData(std::span<const uint32_t> offsets) const;
+
+    // Returns the mass of a particle, 1.0 (with a warning) if it is null.
+    float _checkedMass(const Sections & s, size_t index) const;
+    void _close();
+};
+
+#endif // __SPNBREADER_H__
@@ -0,0 +1,175 @@
+#include "IO/SpnbWriter.h"
+#include "IO/SpnbFormat.h"
+#include "SpringNetwork.h"
+#include "logging.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace biospring;
+
+namespace
+{
+
+// Interns the particle, residue and chain names of a network.
+class StringTable
+{
+  public:
+    uint32_t intern(const std::string & s)
+    {
+        auto [it, inserted] = _indices.try_emplace(s, static_cast<uint32_t>(_offsets.size() - 1));
+        if (inserted)
+        {
+            _data += s;
+            _offsets.push_back(static_cast<uint32_t>(_data.size()));
+        }
+        return it->second;
+    }
+
+    uint32_t size() const { return static_cast<uint32_t>(_offsets.size() - 1); }
+    const std::vector<uint32_t> & offsets() const { return _offsets; }
+    const std::string & data() const { return _data; }
+
+  protected:
+    std::unordered_map<std::string, uint32_t> _indices;
+    std::vector<uint32_t> _offsets{0};
+    std::string _data;
+};
+
+// A section to write: its table entry and the bytes it points to.
+struct Section
+{
+    io::spnb::SectionEntry entry;
+    const void * data;
+};
+
+template <typename T> Section makeSection(io::spnb::SectionId id, const std::vector<T> & values)
+{
+    io::spnb::SectionEntry entry{};
+    entry.id = static_cast<uint32_t>(id);
+    entry.element_size = sizeof(T);
+    entry.size = values.size() * sizeof(T);
+    return Section{entry, values.data()};
+}
+
+} // namespace
+
+void SpnbWriter::write()
+{
+    if (not io::spnb::isHostSupported())
+        logging::die("%s: the .spnb format can only be written on little-endian hosts", _filename.c_str());
+
+    const size_t nparticles = _spn->getNumberOfParticles();
+    const size_t nsprings = _spn->getNumberOfSprings();
+
+    // Gathers particle data into contiguous arrays.
+    std::vector<float> coordinates(3 * nparticles);
+    std::vector<float> charges(nparticles), radii(nparticles), epsilons(nparticles), masses(nparticles);
+    std::vector<float> hydrophobicities(nparticles), transferenergies(nparticles), surfaces(nparticles);
+    std::vector<int32_t> extids(nparticles), resids(nparticles);
+    std::vector<uint8_t> dynamicstates(nparticles);
+    std::vector<uint32_t> names(nparticles), resnames(nparticles), chainnames(nparticles);
+    StringTable strings;
+
+    for (size_t i = 0; i < nparticles; ++i)
+    {
+        const spn::Particle & p = _spn->getParticle(static_cast<unsigned>(i));
+        const Vector3f position = p.getPosition();
+        coordinates[3 * i] = position.getX();
+        coordinates[3 * i + 1] = position.getY();
+        coordinates[3 * i + 2] = position.getZ();
+        charges[i] = p.getCharge();
+        radii[i] = p.getRadius();
+        epsilons[i] = p.getEpsilon();
+        masses[i] = p.getMass();
+        hydrophobicities[i] = p.getHydrophobicity();
+        transferenergies[i] = p.getTransferEnergyByAccessibleSurface();
+        surfaces[i] = p.getSolventAccessibilitySurface();
+        // ids mirror topology::ParticleProperties::atom_id()/residue_id(), which stay signed.
+        extids[i] = static_cast<int32_t>(p.getExtid());
+        resids[i] = static_cast<int32_t>(p.getResId());
+        dynamicstates[i] = p.isDynamic() ? 1 : 0;
+        names[i] = strings.intern(p.getName());
+        resnames[i] = strings.intern(p.getResName());
+        chainnames[i] = strings.intern(p.getChainName());
+    }
+
+    // Gathers spring data.
+    std::vector<int32_t> springs(2 * nsprings);
+    std::vector<float> equilibriums(nsprings), stiffnesses(nsprings);
+    for (size_t i = 0; i < nsprings; ++i)
+    {
+        const spn::Spring & s = _spn->getSpring(static_cast<unsigned>(i));
+        springs[2 * i] = s.getParticle1().getId();
+        springs[2 * i + 1] = s.getParticle2().getId();
+        equilibriums[i] = s.getEquilibrium();
+        stiffnesses[i] = s.getStiffness();
+    }
+
+    std::vector<char> stringdata(strings.data().begin(), strings.data().end());
+
+    using io::spnb::SectionId;
+    std::vector<Section> sections = {
+        makeSection(SectionId::Coordinates, coordinates),
+        makeSection(SectionId::Charges, charges),
+        makeSection(SectionId::Radii, radii),
+        makeSection(SectionId::Epsilons, epsilons),
+        makeSection(SectionId::Masses, masses),
+        makeSection(SectionId::Hydrophobicities, hydrophobicities),
+        makeSection(SectionId::TransferEnergies, transferenergies),
+        makeSection(SectionId::SurfaceAccessibilities, surfaces),
+        makeSection(SectionId::ExternalIds, extids),
+        makeSection(SectionId::ResidueIds, resids),
+        makeSection(SectionId::DynamicStates, dynamicstates),
+        makeSection(SectionId::NameIndices, names),
+        makeSection(SectionId::ResidueNameIndices, resnames),
+        makeSection(SectionId::ChainNameIndices, chainnames),
+        makeSection(SectionId::StringOffsets, strings.offsets()),
+        makeSection(SectionId::StringData, stringdata),
+        makeSection(SectionId::Springs, springs),
+        makeSection(SectionId::SpringEquilibriums, equilibriums),
+        makeSection(SectionId::SpringStiffnesses, stiffnesses),
+    };
+
+    // Lays the sections out.
+    uint64_t offset = sizeof(io::spnb::Header) + sections.size() * sizeof(io::spnb::SectionEntry);
+    for (Section & section : sections)
+    {
+        offset = io::spnb::align(offset);
+        section.entry.offset = offset;
+        offset += section.entry.size;
+    }
+
+    io::spnb::Header header{};
+    std::memcpy(header.magic, io::spnb::MAGIC, sizeof(header.magic));
+    header.version = io::spnb::VERSION;
+    header.header_size = sizeof(io::spnb::Header);
+    header.number_of_particles = nparticles;
+    header.number_of_springs = nsprings;
+    header.number_of_strings = strings.size();
+    header.number_of_sections = static_cast<uint32_t>(sections.size());
+
+    // Writes the file.
+    _ostream.open(_filename, std::ios::binary);
+    if (not _ostream)
+        logging::die("can't open file: '%s'", _filename.c_str());
+
+    _ostream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const Section & section : sections)
+        _ostream.write(reinterpret_cast<const char *>(&section.entry), sizeof(section.entry));
+
+    const char padding[io::spnb::ALIGNMENT] = {};
+    uint64_t position = sizeof(io::spnb::Header) + sections.size() * sizeof(io::spnb::SectionEntry);
+    for (const Section & section : sections)
+    {
+        _ostream.write(padding, static_cast<std::streamsize>(section.entry.offset - position));
+        _ostream.write(static_cast<const char *>(section.data), static_cast<std::streamsize>(section.entry.size));
+        position = section.entry.offset + section.entry.size;
+    }
+
+    _ostream.close();
+    if (_ostream.fail())
+        logging::die("%s: error while writing file", _filename.c_str());
+}
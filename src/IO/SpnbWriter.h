@@ -0,0 +1,16 @@
+#ifndef __SPNBWRITER_H__
+#define __SPNBWRITER_H__
+
+#include "WriterBase.h"
+
+// Writes a spring network in the native binary format (.spnb).
+// See IO/SpnbFormat.h for the layout.
+class SpnbWriter : public TopologyWriterBase
+{
+  public:
+    using TopologyWriterBase::TopologyWriterBase;
+
+    void write() override;
+};
+
+#endif // __SPNBWRITER_H__
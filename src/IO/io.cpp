@@ -7,6 +7,8 @@
 #include "IO/PQRReader.h"
 #include "IO/PQRWriter.h"
 #include "IO/ReaderBase.h"
+#include "IO/SpnbReader.h"
+#include "IO/SpnbWriter.h"
 #include "logging.h"
 #include "utils.hpp"
 
@@ -42,6 +44,8 @@ topology::Topology readTopology(const std::string & path)
         reader = std::make_unique<PQRReader>();
     else if (extension == "nc")
         reader = std::make_unique<NetCDFReader>();
+    else if (extension == "spnb")
+        reader = std::make_unique<SpnbReader>();
     else
         logging::die("Unrecognized topology format '%s'", extension.c_str());
 
@@ -58,6 +62,24 @@ topology::Topology readTopology(const std::string & path)
     return reader->getTopology();
 }
 
+//
+// Reads a spring network file straight into a SpringNetwork.
+//
+// Format is guessed based on file name extension (nc or spnb).
+//
+void readSpringNetwork(const std::string & path, spn::SpringNetwork & spn)
+{
+    std::string extension = biospring::utils::path::getExtension(path);
+
+    if (extension == "nc")
+        NetCDFReader(path).readSpringNetwork(spn);
+    else if (extension == "spnb")
+        SpnbReader(path).readSpringNetwork(spn);
+    else
+        logging::die("%s: unrecognized spring network format '%s' (expected nc or spnb)", path.c_str(),
+                     extension.c_str());
+}
+
 void writeTopology(const std::string & path, const topology::Topology & topology, bool writePdbConect)
 {
     spn::SpringNetwork spn;
@@ -85,7 +107,7 @@ static void _writeTopology(const std::string & path, const spn::SpringNetwork *
         const spn::SpringNetwork * spn;
         std::string format;
 
-        const std::unordered_set<std::string> allowedFormats{"pdb", "pqr", "cdl", "nc"};
+        const std::unordered_set<std::string> allowedFormats{"pdb", "pqr", "cdl", "nc", "spnb"};
 
         bool writePdbConect;
 
@@ -117,6 +139,8 @@ static void _writeTopology(const std::string & path, const spn::SpringNetwork *
                 writePQR();
             else if (format == "nc")
                 writeNC();
+            else if (format == "spnb")
+                writeSPNB();
             else if (format == "cdl")
                 writeCDL();
         }
@@ -141,6 +165,12 @@ static void _writeTopology(const std::string & path, const spn::SpringNetwork *
             NetCDFWriter(path, spn).writeBinary();
         }
 
+        void writeSPNB() const
+        {
+            logging::status("Writing spring network to spnb file %s.", path.c_str());
+            SpnbWriter(path, spn).write();
+        }
+
         void writeCDL() const
         {
             logging::status("Writing spring network to ASCII cdl file %s.", path.c_str());
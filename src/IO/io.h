@@ -13,6 +13,7 @@ namespace biospring
 namespace io
 {
 topology::Topology readTopology(const std::string & path);
+void readSpringNetwork(const std::string & path, spn::SpringNetwork & spn);
 
 void writeTopology(const std::string & path, const topology::Topology & topology, bool writePdbConect = false);
 void writeTopology(const vector<string> & outputfiles, const topology::Topology & topology, bool writePdbConect = false);
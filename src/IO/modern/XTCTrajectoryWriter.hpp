@@ -16,10 +16,18 @@ class XTCTrajectoryWriter : public TrajectoryWriterBase
   protected:
     // Cannot use modern C++ here, like std::unique_ptr, because the xdrfile library
     // prevents it by design.
-    XDRFILE * _xdr;
+    XDRFILE * _xdr = nullptr;
 
   public:
-    using TrajectoryWriterBase::TrajectoryWriterBase;
+    XTCTrajectoryWriter(const std::string & path, const spn::SpringNetwork & topology, size_t write_frequency = 1)
+        : TrajectoryWriterBase(path, topology, write_frequency)
+    {
+        // The base constructor opened a text stream on the path; XTC frames go
+        // through xdrfile instead.
+        _ostream.close();
+        safe_open();
+    }
+
     void safe_open();
     virtual void write_step();
 
@@ -15,19 +15,36 @@ biospring::spn::Particle & InsertionVector::getParticle(unsigned i)
     return _p2;
 }
 
-void InsertionVector::computeVector()
+const biospring::spn::Particle & InsertionVector::getParticle(unsigned i) const
+{
+    if (i > 1)
+        throw std::out_of_range("i should be 0 or 1");
+    if (i == 0)
+        return _p1;
+    return _p2;
+}
+
+void InsertionVector::update() const
+{
+    _computeVector();
+    _computeAngle();
+    _computeRollAngle();
+    _stale = false;
+}
+
+void InsertionVector::_computeVector() const
 {
     _vector = _p2.getPosition() - _p1.getPosition();
 }
 
-void InsertionVector::computeAngle()
+void InsertionVector::_computeAngle() const
 {
     _angle = std::acos(-_vector.getZ() / _vector.norm());
     _angle *= 180.0 / M_PI;
     _angle -= 90.0;
 }
 
-void InsertionVector::computeRollAngle()
+void InsertionVector::_computeRollAngle() const
 {
     // FOR NOW ROLL ANGLE ONLY CORRECT FOR PLANE MEMBRANE
     // if (!_sp->getForceField()->isMeshMembraneVerticesArrayEmpty())
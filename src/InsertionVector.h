@@ -12,12 +12,17 @@ class SpringNetwork;
 } // namespace spn
 } // namespace biospring
 
+// Insertion vector: the vector between two particles, its angle to the membrane plane, the roll
+// angle of the system around it and the insertion depth (z of the centroid).
+//
+// These are computed on first use after each step (see invalidate), so that steps with no
+// consumer (CSV writer, logs, restraints, MDDriver) do not pay for them.
 class InsertionVector
 {
   public:
     InsertionVector(const biospring::spn::SpringNetwork & sp, biospring::spn::Particle & p1,
                     biospring::spn::Particle & p2)
-        : _sp(sp), _p1(p1), _p2(p2), _vector(Vector3f(0.0, 0.0, 0.0)), _angle(0.0)
+        : _sp(sp), _p1(p1), _p2(p2), _vector(Vector3f(0.0, 0.0, 0.0)), _angle(0.0), _rollAngle(0.0), _stale(true)
     {
     }
 
@@ -25,22 +30,46 @@ class InsertionVector
     biospring::spn::Particle & getParticle(unsigned i); // Non const usefull to modify the particles!
 
 
-    Vector3f getVector() const { return _vector; }
-    float getAngle() const { return _angle; }
-    float getRollAngle() const { return _rollAngle; }
+    Vector3f getVector() const
+    {
+        _update();
+        return _vector;
+    }
+    float getAngle() const
+    {
+        _update();
+        return _angle;
+    }
+    float getRollAngle() const
+    {
+        _update();
+        return _rollAngle;
+    }
     float getInsertionDepth() const;
 
-    void computeVector();
-    void computeAngle();
-    void computeRollAngle();
+    // Marks the vector and the angles as out of date, after the particles moved.
+    void invalidate() { _stale = true; }
+
+    // Computes the vector and the angles now.
+    void update() const;
 
   protected:
     const biospring::spn::SpringNetwork & _sp;
     biospring::spn::Particle & _p1;
     biospring::spn::Particle & _p2;
-    Vector3f _vector;
-    float _angle;
-    float _rollAngle;
+    mutable Vector3f _vector;
+    mutable float _angle;
+    mutable float _rollAngle;
+    mutable bool _stale;
+
+    void _update() const
+    {
+        if (_stale)
+            update();
+    }
+    void _computeVector() const;
+    void _computeAngle() const;
+    void _computeRollAngle() const;
 };
 
 #endif // __INSERTION_VECTOR_H__
@@ -3,31 +3,60 @@
 
 #include "Particle.h"
 #include "Vector3f.h"
-#include "measure.hpp"
+#include "selection/Expression.h"
 
+#include <string>
 #include <vector>
 
+// A named set of particles, compiled from a selection expression (see selection::Expression)
+// to the sorted indexes of the selected particles.
+//
+// Dynamic selections (coordinates, `within`) are evaluated again with update().
 class Selection
 {
   public:
-    Selection(const std::string & name) : _name(name) {}
+    Selection(const std::string & name, const biospring::selection::Expression & expression,
+              std::vector<biospring::spn::Particle> & particles, const biospring::selection::Labels & labels)
+        : _name(name), _expression(expression), _particles(&particles)
+    {
+        update(labels);
+    }
 
     std::string getName() const { return _name; }
+    const biospring::selection::Expression & getExpression() const { return _expression; }
+    bool isDynamic() const { return _expression.isDynamic(); }
+
+    const std::vector<size_t> & getIndexes() const { return _indexes; }
+    size_t size() const { return _indexes.size(); }
+    bool empty() const { return _indexes.empty(); }
 
-    Vector3f getBarycentre() const { return biospring::measure::centroid(_particles); }
+    void update(const biospring::selection::Labels & labels) { _indexes = _expression.evaluate(*_particles, labels); }
 
-    void addParticle(biospring::spn::Particle * p) { _particles.push_back(p); }
+    Vector3f getBarycentre() const
+    {
+        Vector3f sum;
+        for (const size_t i : _indexes)
+            sum += (*_particles)[i].getPosition();
+        return _indexes.empty() ? sum : sum / float(_indexes.size());
+    }
 
+    // Spreads a force over the particles, static particles excepted.
     void addForce(const Vector3f & force)
     {
-        Vector3f force_ = force / float(_particles.size());
-        for (auto p : _particles)
-            p->addForce(force_);
+        Vector3f force_ = force / float(_indexes.size());
+        for (const size_t i : _indexes)
+        {
+            biospring::spn::Particle & p = (*_particles)[i];
+            if (p.isDynamic())
+                p.addForce(force_);
+        }
     }
 
   protected:
     std::string _name;
-    std::vector<biospring::spn::Particle *> _particles;
+    biospring::selection::Expression _expression;
+    std::vector<biospring::spn::Particle> * _particles;
+    std::vector<size_t> _indexes;
 };
 
 #endif // __SELECTION_H__
@@ -0,0 +1,111 @@
+// Force kernels of the simulation step: springs and each per-particle term.
+//
+// Argument: number of particles.
+
+#include <benchmark/benchmark.h>
+
+#include "SpringNetwork.h"
+#include "synthetic.hpp"
+
+#include <functional>
+#include <string>
+
+using namespace biospring;
+
+namespace
+{
+
+constexpr double SPRING_CUTOFF = 6.0;
+
+void sizes(benchmark::internal::Benchmark * benchmark)
+{
+    benchmark->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+}
+
+// Measures computeParticleForces with the terms enabled by `enable` only.
+void particle_forces(benchmark::State & state, const std::function<void(configuration::Configuration &)> & enable)
+{
+    configuration::Configuration config = benchmarks::make_configuration();
+    enable(config);
+
+    spn::SpringNetwork spn;
+    benchmarks::make_spring_network(spn, static_cast<size_t>(state.range(0)), config);
+
+    for (auto _ : state)
+        spn.computeParticleForces();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+static void BM_SpringForces(benchmark::State & state)
+{
+    configuration::Configuration config = benchmarks::make_configuration();
+    config.spring.enable = true;
+
+    spn::SpringNetwork spn;
+    benchmarks::make_spring_network(spn, static_cast<size_t>(state.range(0)), config, SPRING_CUTOFF);
+
+    for (auto _ : state)
+        spn.computeSpringForces();
+    state.counters["springs"] = spn.getNumberOfSprings();
+    state.SetItemsProcessed(state.iterations() * spn.getNumberOfSprings());
+}
+BENCHMARK(BM_SpringForces)->Apply(sizes);
+
+static void BM_ParticleForcesSteric(benchmark::State & state)
+{
+    particle_forces(state, [](configuration::Configuration & config) {
+        config.steric.enable = true;
+        config.steric.cutoff = 8.0;
+    });
+}
+BENCHMARK(BM_ParticleForcesSteric)->Apply(sizes);
+
+static void BM_ParticleForcesElectrostatic(benchmark::State & state)
+{
+    particle_forces(state, [](configuration::Configuration & config) {
+        config.electrostatic.enable = true;
+        config.electrostatic.cutoff = 16.0;
+    });
+}
+BENCHMARK(BM_ParticleForcesElectrostatic)->Apply(sizes);
+
+static void BM_ParticleForcesHydrophobic(benchmark::State & state)
+{
+    particle_forces(state, [](configuration::Configuration & config) {
+        config.hydrophobicity.enable = true;
+        config.hydrophobicity.cutoff = 15.0;
+    });
+}
+BENCHMARK(BM_ParticleForcesHydrophobic)->Apply(sizes);
+
+static void BM_ParticleForcesIMPALA(benchmark::State & state)
+{
+    particle_forces(state, [](configuration::Configuration & config) { config.imp.enable = true; });
+}
+BENCHMARK(BM_ParticleForcesIMPALA)->Apply(sizes);
+
+// The electrostatic field cannot be enabled without Coulomb interactions: the
+// density grid term samples a grid the same way, on its own.
+static void BM_ParticleForcesDensityGrid(benchmark::State & state)
+{
+    const std::string path = benchmarks::temporary_path("forces-" + std::to_string(state.range(0)) + ".dx");
+    benchmarks::write_dx(path, static_cast<size_t>(state.range(0)), 65);
+    particle_forces(state, [&](configuration::Configuration & config) {
+        config.densitygrid.enable = true;
+        config.densitygrid.path = path;
+    });
+}
+BENCHMARK(BM_ParticleForcesDensityGrid)->Apply(sizes);
+
+static void BM_ParticleForcesViscosity(benchmark::State & state)
+{
+    particle_forces(state, [](configuration::Configuration & config) {
+        config.viscosity.enable = true;
+        config.viscosity.value = 1.0;
+    });
+}
+BENCHMARK(BM_ParticleForcesViscosity)->Apply(sizes);
+
+BENCHMARK_MAIN();
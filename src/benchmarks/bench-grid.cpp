@@ -0,0 +1,53 @@
+// Potential grids: sampling at particle positions and gradient computation.
+
+#include <benchmark/benchmark.h>
+
+#include "IO/OpenDXReader.h"
+#include "grid/PotentialGrid.hpp"
+#include "synthetic.hpp"
+
+#include <string>
+
+using namespace biospring;
+
+namespace
+{
+
+constexpr size_t NUMBER_OF_PARTICLES = 100000;
+
+grid::PotentialGrid make_grid(size_t shape)
+{
+    const std::string path = benchmarks::temporary_path("grid-" + std::to_string(shape) + ".dx");
+    benchmarks::write_dx(path, NUMBER_OF_PARTICLES, shape);
+    return opendx::readGrid(path);
+}
+
+} // namespace
+
+// Argument: number of points of the grid along each axis.
+static void BM_PotentialGridSample(benchmark::State & state)
+{
+    const grid::PotentialGrid grid = make_grid(static_cast<size_t>(state.range(0)));
+    const auto positions = benchmarks::positions(NUMBER_OF_PARTICLES);
+    for (auto _ : state)
+    {
+        Vector3f sum;
+        for (const Vector3f & position : positions)
+            sum += grid.get(position.getX(), position.getY(), position.getZ()).vector;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * NUMBER_OF_PARTICLES);
+}
+BENCHMARK(BM_PotentialGridSample)->Arg(33)->Arg(65)->Arg(129)->Unit(benchmark::kMicrosecond);
+
+// Argument: number of points of the grid along each axis.
+static void BM_PotentialGridGradient(benchmark::State & state)
+{
+    grid::PotentialGrid grid = make_grid(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+        grid.compute_gradient();
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0) * state.range(0));
+}
+BENCHMARK(BM_PotentialGridGradient)->Arg(33)->Arg(65)->Arg(129)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
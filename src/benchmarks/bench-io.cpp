@@ -0,0 +1,65 @@
+// Input/output: OpenDX parsing and trajectory writers.
+
+#include <benchmark/benchmark.h>
+
+#include "IO/OpenDXReader.h"
+#include "IO/modern/PDBTrajectoryWriter.hpp"
+#include "IO/modern/XTCTrajectoryWriter.hpp"
+#include "SpringNetwork.h"
+#include "synthetic.hpp"
+
+#include <string>
+
+using namespace biospring;
+
+// Argument: number of points of the grid along each axis.
+static void BM_OpenDXRead(benchmark::State & state)
+{
+    const size_t shape = static_cast<size_t>(state.range(0));
+    const std::string path = benchmarks::temporary_path("io-" + std::to_string(shape) + ".dx");
+    benchmarks::write_dx(path, 100000, shape);
+
+    for (auto _ : state)
+    {
+        OpenDXReader reader(path);
+        reader.read();
+        benchmark::DoNotOptimize(reader.getGrid());
+    }
+    state.SetItemsProcessed(state.iterations() * shape * shape * shape);
+}
+BENCHMARK(BM_OpenDXRead)->Arg(33)->Arg(65)->Arg(97)->Unit(benchmark::kMillisecond);
+
+namespace
+{
+
+// Writes one frame per iteration.
+template <typename Writer> void trajectory_write(benchmark::State & state, const std::string & extension)
+{
+    spn::SpringNetwork spn;
+    benchmarks::make_spring_network(spn, static_cast<size_t>(state.range(0)), benchmarks::make_configuration());
+
+    const std::string path = benchmarks::temporary_path("trajectory-" + std::to_string(state.range(0)) + extension);
+    Writer writer(path, spn);
+    for (auto _ : state)
+        writer.write_step();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+// Argument: number of particles.
+// PDB files cannot number more than 99999 atoms.
+static void BM_PDBTrajectoryWrite(benchmark::State & state)
+{
+    trajectory_write<io::modern::PDBTrajectoryWriter>(state, ".pdb");
+}
+BENCHMARK(BM_PDBTrajectoryWrite)->RangeMultiplier(10)->Range(1000, 10000)->Unit(benchmark::kMillisecond);
+
+// Argument: number of particles.
+static void BM_XTCTrajectoryWrite(benchmark::State & state)
+{
+    trajectory_write<io::modern::XTCTrajectoryWriter>(state, ".xtc");
+}
+BENCHMARK(BM_XTCTrajectoryWrite)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,84 @@
+// Cell-list neighbor search: construction, update and queries.
+//
+// Arguments: number of particles, density (in 1e-3 beads per Å³) and, for
+// updates, the skin (in 1/10 Å).
+
+#include <benchmark/benchmark.h>
+
+#include "nsearch.hpp"
+#include "synthetic.hpp"
+
+#include <vector>
+
+using namespace biospring;
+
+namespace
+{
+
+using Searcher = nsearch::NeighborSearch<std::vector<Vector3f>>;
+
+constexpr float CUTOFF = 8.0f;
+
+double density(const benchmark::State & state) { return static_cast<double>(state.range(1)) * 1e-3; }
+
+void densities(benchmark::internal::Benchmark * benchmark)
+{
+    for (int64_t n : {1000, 10000, 100000, 1000000})
+        for (int64_t density : {5, 10, 100})
+            benchmark->Args({n, density});
+}
+
+void densities_and_skins(benchmark::internal::Benchmark * benchmark)
+{
+    for (int64_t n : {1000, 10000, 100000, 1000000})
+        for (int64_t density : {10, 100})
+            for (int64_t skin : {0, 10, 20})
+                benchmark->Args({n, density, skin});
+}
+
+} // namespace
+
+static void BM_NeighborSearchBuild(benchmark::State & state)
+{
+    const auto positions = benchmarks::positions(static_cast<size_t>(state.range(0)), density(state));
+    for (auto _ : state)
+    {
+        Searcher searcher(positions, CUTOFF);
+        benchmark::DoNotOptimize(searcher);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NeighborSearchBuild)->Apply(densities)->Unit(benchmark::kMicrosecond);
+
+// Without a skin, every update rebuilds the cell list. With a skin, particles
+// have not moved here, so this measures the cost of the drift check that lets
+// an update be skipped.
+static void BM_NeighborSearchUpdate(benchmark::State & state)
+{
+    const auto positions = benchmarks::positions(static_cast<size_t>(state.range(0)), density(state));
+    Searcher searcher(positions, CUTOFF, static_cast<float>(state.range(2)) * 0.1f);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(searcher.update());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NeighborSearchUpdate)->Apply(densities_and_skins)->Unit(benchmark::kMicrosecond);
+
+// Visits the neighbors of every particle, as the nonbonded force loops do.
+static void BM_NeighborSearchQuery(benchmark::State & state)
+{
+    const auto positions = benchmarks::positions(static_cast<size_t>(state.range(0)), density(state));
+    const Searcher searcher(positions, CUTOFF);
+    size_t pairs = 0;
+    for (auto _ : state)
+    {
+        pairs = 0;
+        for (const Vector3f & position : positions)
+            searcher.for_each_neighbor(position, [&](size_t) { ++pairs; });
+        benchmark::DoNotOptimize(pairs);
+    }
+    state.counters["neighbors"] = static_cast<double>(pairs) / static_cast<double>(positions.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NeighborSearchQuery)->Apply(densities)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,32 @@
+// Topology construction: springs from a distance cutoff.
+//
+// Arguments: number of particles and cutoff (in Å).
+
+#include <benchmark/benchmark.h>
+
+#include "synthetic.hpp"
+#include "topology.hpp"
+
+using namespace biospring;
+
+static void BM_AddSpringsFromCutoff(benchmark::State & state)
+{
+    const topology::Topology source = benchmarks::make_topology(static_cast<size_t>(state.range(0)));
+    size_t springs = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        topology::Topology top = source;
+        state.ResumeTiming();
+
+        top.add_springs_from_cutoff(static_cast<double>(state.range(1)));
+        springs = top.number_of_springs();
+    }
+    state.counters["springs"] = static_cast<double>(springs);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddSpringsFromCutoff)
+    ->ArgsProduct({{1000, 10000, 100000, 1000000}, {6, 12}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,148 @@
+// Synthetic systems for the benchmarks.
+//
+// Systems are the lattice globules of topology::generator, with the lattice
+// spacing chosen to match the requested density, so that the number of
+// neighbors within a cutoff does not depend on the size of the system. The
+// default density (0.01 bead/Å³) is the one of a coarse-grained protein; 0.1 is
+// close to an all-atom model.
+//
+// Everything is generated in-process from a fixed seed: the benchmarks need no
+// input file and are reproducible from one run to the next.
+
+#ifndef __BENCHMARKS_SYNTHETIC_HPP__
+#define __BENCHMARKS_SYNTHETIC_HPP__
+
+#include "SpringNetwork.h"
+#include "Vector3f.h"
+#include "configuration/Configuration.hpp"
+#include "topology.hpp"
+#include "topology/Generator.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace benchmarks
+{
+
+constexpr double DEFAULT_DENSITY = 0.01; // beads per Å³
+constexpr unsigned DEFAULT_SEED = 20240229;
+
+// Returns the edge length of a cube holding `n` particles at the given density.
+inline float box_size(size_t n, double density = DEFAULT_DENSITY)
+{
+    return static_cast<float>(std::cbrt(static_cast<double>(n) / density));
+}
+
+// Returns a lattice globule of `n` particles at the given density (see
+// topology::generator::lattice_protein), with springs between the particles closer
+// than `spring_cutoff`, or none if it is not positive. Every particle also gets an
+// accessible surface, and hydrophobic ones a favourable IMPALA transfer energy.
+inline topology::Topology make_topology(size_t n, double spring_cutoff = 0.0, double density = DEFAULT_DENSITY,
+                                        unsigned seed = DEFAULT_SEED)
+{
+    topology::generator::Parameters parameters;
+    parameters.number_of_particles = n;
+    parameters.spacing = std::cbrt(1.0 / density);
+    parameters.seed = seed;
+    if (spring_cutoff > 0.0)
+        parameters.spring_cutoff = spring_cutoff;
+
+    topology::Topology top = topology::generator::lattice_protein(parameters);
+    if (spring_cutoff <= 0.0)
+        top.springs().clear();
+
+    for (size_t i = 0; i < top.number_of_particles(); ++i)
+    {
+        topology::ParticleProperties & properties = top.get_particle(i).properties();
+        topology::IMPProperties imp;
+        imp.set_solvent_accessible_surface(50.0f);
+        imp.set_transfert_energy_by_accessible_surface(properties.is_hydrophobic() ? -0.02f : 0.01f);
+        properties.set_imp(imp);
+    }
+    return top;
+}
+
+// Returns the positions of the particles of a globule of `n` particles at the given density.
+inline std::vector<Vector3f> positions(size_t n, double density = DEFAULT_DENSITY, unsigned seed = DEFAULT_SEED)
+{
+    const topology::Topology top = make_topology(n, 0.0, density, seed);
+    std::vector<Vector3f> result;
+    result.reserve(top.number_of_particles());
+    for (size_t i = 0; i < top.number_of_particles(); ++i)
+        result.push_back(top.get_particle(i).properties().position());
+    return result;
+}
+
+// Returns a configuration with every force term disabled. Benchmarks enable the
+// terms they measure.
+inline configuration::Configuration make_configuration()
+{
+    configuration::Configuration config = configuration::defaultConfiguration();
+    config.sim.nbsteps = 1;
+    config.sim.timestep = 0.01;
+    config.spring.enable = false;
+    config.steric.enable = false;
+    config.electrostatic.enable = false;
+    config.hydrophobicity.enable = false;
+    config.viscosity.enable = false;
+    config.pdbtraj.enable = false;
+    config.xtctraj.enable = false;
+    config.csvsample.enable = false;
+    return config;
+}
+
+// Fills `spn` with `n` particles and, if `spring_cutoff` is positive, with springs
+// between all particles closer than `spring_cutoff`, then sets it up.
+inline void make_spring_network(spn::SpringNetwork & spn, size_t n, const configuration::Configuration & config,
+                                double spring_cutoff = 0.0, double density = DEFAULT_DENSITY)
+{
+    make_topology(n, spring_cutoff, density).to_spring_network(spn);
+    spn.setup(config);
+}
+
+// Writes an OpenDX potential of `shape` points spanning the box of `n` particles
+// at the given density, with a smooth, non-constant potential.
+inline void write_dx(const std::string & path, size_t n, size_t shape, double density = DEFAULT_DENSITY)
+{
+    const double size = box_size(n, density);
+    const double spacing = size / static_cast<double>(shape - 1);
+
+    std::ofstream os(path);
+    os << "object 1 class gridpositions counts " << shape << ' ' << shape << ' ' << shape << '\n';
+    os << "origin 0 0 0\n";
+    os << "delta " << spacing << " 0 0\n";
+    os << "delta 0 " << spacing << " 0\n";
+    os << "delta 0 0 " << spacing << '\n';
+    os << "object 2 class gridconnections counts " << shape << ' ' << shape << ' ' << shape << '\n';
+    os << "object 3 class array type \"double\" rank 0 items " << shape * shape * shape << " data follows\n";
+
+    size_t column = 0;
+    for (size_t i = 0; i < shape; ++i)
+        for (size_t j = 0; j < shape; ++j)
+            for (size_t k = 0; k < shape; ++k)
+            {
+                os << std::sin(0.1 * i) * std::cos(0.1 * j) + 0.01 * k;
+                os << (++column % 3 == 0 ? '\n' : ' ');
+            }
+    if (column % 3 != 0)
+        os << '\n';
+}
+
+// Returns the path of a scratch file in the temporary directory.
+inline std::string temporary_path(const std::string & name)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "biospring-benchmarks";
+    std::filesystem::create_directories(directory);
+    return (directory / name).string();
+}
+
+} // namespace benchmarks
+} // namespace biospring
+
+#endif // __BENCHMARKS_SYNTHETIC_HPP__
@@ -0,0 +1,429 @@
+
+#include "biospring-bench-cli.h"
+
+#ifdef OPENMP_SUPPORT
+#include "omp.h"
+#endif
+
+#include "IO/io.h"
+#include "SpringNetwork.h"
+#include "configuration/Configuration.hpp"
+#include "configuration/SafeConfigurationReader.hpp"
+#include "logging.h"
+#include "topology.hpp"
+#include "topology/Generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace biospringbench
+{
+
+const argparse::description_t PROGRAM_DESCRIPTION = {
+    "biospring-bench measures the throughput of the simulation engine on synthetic systems.",
+    "",
+    "Systems (--system) are elastic networks of any size, generated in-process from a seed:",
+    "  lattice  : one compact globular protein",
+    "  membrane : a bilayer slab of head and tail beads",
+    "  assembly : a multi-chain assembly of globular proteins",
+    "",
+    "Each run simulates --steps steps with a given number of OpenMP threads (-t/--threads).",
+    "Strong scaling runs the same system with every thread count; weak scaling runs",
+    "--particles particles per thread. Results are written as CSV to --report.",
+    "",
+    "Without -c/--msp, a canonical configuration is used (springs, steric, electrostatic,",
+    "hydrophobic and viscosity terms). --write saves the system and this configuration",
+    "as <prefix>.spnb and <prefix>.msp so that it can be run with biospring.",
+};
+
+namespace
+{
+
+struct RunResult
+{
+    std::string scaling;
+    unsigned threads;
+    size_t particles;
+    size_t springs;
+    unsigned steps;
+    double seconds;
+    uintmax_t bytes; // written by trajectory writers
+};
+
+// Configuration used when no .msp file is given. Parameters are those of the
+// example/001_GKinase tutorial, with all nonbonded terms enabled.
+configuration::Configuration canonicalConfiguration()
+{
+    configuration::Configuration config = configuration::defaultConfiguration();
+    config.sim.timestep = 2.5;
+    config.sim.neighborskin = 2.0;
+
+    config.spring.enable = true;
+    config.spring.scale = 10.0;
+
+    config.steric.enable = true;
+    config.steric.mode = "linear";
+    config.steric.cutoff = 8.0;
+
+    config.electrostatic.enable = true;
+    config.electrostatic.cutoff = 16.0;
+    config.electrostatic.dielectric = 40.0;
+
+    config.hydrophobicity.enable = true;
+    config.hydrophobicity.cutoff = 8.0;
+
+    config.viscosity.enable = true;
+    config.viscosity.value = 0.1;
+
+    config.pdbtraj.enable = false;
+    config.csvsample.enable = false;
+    config.xtctraj.enable = false;
+    config.xtctraj.path = "trajectory.xtc";
+    config.xtctraj.frequency = 100;
+    return config;
+}
+
+// Writes the settings that biospring-bench configures, in .msp format.
+void writeConfiguration(const std::string & path, const configuration::Configuration & config)
+{
+    std::ofstream os(path);
+    if (!os)
+        logging::die("Cannot open %s", path.c_str());
+
+    os << "# Generated by " << PROGRAM_VERSION << "\n\n";
+    config.sim.print(os);
+    os << "\n";
+    config.spring.print(os);
+    os << "\n";
+    config.steric.print(os);
+    os << "\n";
+    config.electrostatic.print(os);
+    os << "\n";
+    config.hydrophobicity.print(os);
+    os << "\n";
+    config.viscosity.print(os);
+    os << "\n";
+    config.xtctraj.print(os);
+}
+
+// Returns the trajectory files the configuration writes.
+std::vector<std::string> trajectoryPaths(const configuration::Configuration & config)
+{
+    std::vector<std::string> paths;
+    for (const auto * setting : {&config.pdbtraj, &config.xtctraj, &config.csvsample})
+        if (setting->enable)
+            paths.push_back(setting->path);
+    return paths;
+}
+
+RunResult run(const std::string & scaling, const topology::Topology & top, configuration::Configuration config,
+              unsigned threads, unsigned steps)
+{
+    config.sim.nbsteps = static_cast<int>(steps);
+    config.sim.samplerate = static_cast<int>(steps); // logs once per run
+
+#ifdef OPENMP_SUPPORT
+    omp_set_num_threads(static_cast<int>(threads));
+#endif
+
+    RunResult result{scaling, threads, top.number_of_particles(), top.number_of_springs(), steps, 0.0, 0};
+
+    // Trajectory files are flushed when the writers are destroyed with the network.
+    {
+        spn::SpringNetwork spn;
+        top.to_spring_network(spn);
+        spn.setup(config);
+
+        logging::status("Running %s scaling: %zu particles, %u thread(s), %u steps", scaling.c_str(),
+                        top.number_of_particles(), threads, steps);
+        // timeit::Timer counts milliseconds: too coarse for the ns/day of short runs.
+        const auto start = std::chrono::steady_clock::now();
+        spn.run();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    for (const std::string & path : trajectoryPaths(config))
+        if (std::filesystem::exists(path))
+            result.bytes += std::filesystem::file_size(path);
+
+    return result;
+}
+
+// Writes the results, one line per run. Speedup and efficiency are relative to the
+// first run of the same scaling mode (the lowest thread count).
+void writeReport(const std::string & path, const std::string & system, double timestep,
+                 const std::vector<RunResult> & results)
+{
+    std::ofstream os(path);
+    if (!os)
+        logging::die("Cannot open %s", path.c_str());
+
+    os << "scaling,system,threads,particles,springs,steps,seconds,steps_per_second,ns_per_day,speedup,efficiency,"
+          "bytes_per_step\n";
+
+    logging::status("Benchmark results (%s):", path.c_str());
+    logging::info("    %-8s %8s %10s %12s %12s %10s %10s %14s", "scaling", "threads", "particles", "steps/s",
+                  "ns/day", "speedup", "efficiency", "bytes/step");
+
+    std::map<std::string, const RunResult *> references;
+    for (const RunResult & result : results)
+    {
+        const RunResult & reference = *references.emplace(result.scaling, &result).first->second;
+
+        const double steps_per_second = result.steps / result.seconds;
+        const double ns_per_day = steps_per_second * timestep * 1e-6 * 86400.0;
+        const double ratio = reference.seconds / result.seconds;
+        const double threads_ratio = static_cast<double>(result.threads) / reference.threads;
+
+        // Strong scaling: same work, so the time ratio is the speedup.
+        // Weak scaling: work grows with threads, so the time ratio is the efficiency.
+        const bool strong = result.scaling == "strong";
+        const double speedup = strong ? ratio : ratio * threads_ratio;
+        const double efficiency = strong ? ratio / threads_ratio : ratio;
+        const double bytes_per_step = static_cast<double>(result.bytes) / result.steps;
+
+        os << result.scaling << ',' << system << ',' << result.threads << ',' << result.particles << ','
+           << result.springs << ',' << result.steps << ',' << result.seconds << ',' << steps_per_second << ','
+           << ns_per_day << ',' << speedup << ',' << efficiency << ',' << bytes_per_step << '\n';
+
+        logging::info("    %-8s %8u %10zu %12.2f %12.4f %10.2f %10.2f %14.1f", result.scaling.c_str(),
+                      result.threads, result.particles, steps_per_second, ns_per_day, speedup, efficiency,
+                      bytes_per_step);
+    }
+}
+
+} // namespace
+
+int main(int argc, char ** argv)
+{
+    CommandLineArguments args(std::string(argv[0]), PROGRAM_DESCRIPTION, PROGRAM_VERSION);
+    args.parseCommandLine(argc, argv);
+    args.printArgumentValues();
+
+    configuration::Configuration config = canonicalConfiguration();
+    if (!args.pathConfig.empty())
+    {
+        logging::status("Reading MSP file %s.", args.pathConfig.c_str());
+        auto reader = configuration::SafeConfigurationReader(configuration::defaultConfiguration());
+        reader.setFileName(args.pathConfig);
+        reader.read();
+        config = reader.getConfiguration();
+    }
+    if (args.trajectoryFrequency > 0)
+    {
+        config.xtctraj.enable = true;
+        config.xtctraj.frequency = args.trajectoryFrequency;
+    }
+
+    topology::generator::Parameters parameters;
+    parameters.seed = args.seed;
+    topology::generator::SystemKind kind;
+    try
+    {
+        kind = topology::generator::system_kind(args.system);
+    }
+    catch (const std::invalid_argument & e)
+    {
+        logging::die("%s", e.what());
+    }
+
+    // Generated systems are reused between runs with the same number of particles.
+    std::map<size_t, topology::Topology> systems;
+    const auto system = [&](size_t n) -> const topology::Topology & {
+        auto it = systems.find(n);
+        if (it == systems.end())
+        {
+            logging::status("Generating %s system with %zu particles (seed %u).", args.system.c_str(), n, args.seed);
+            parameters.number_of_particles = n;
+            it = systems.emplace(n, topology::generator::make_system(kind, parameters)).first;
+            logging::info("    %zu springs", it->second.number_of_springs());
+        }
+        return it->second;
+    };
+
+    if (!args.pathWrite.empty())
+    {
+        const std::string spnb = args.pathWrite + ".spnb";
+        const std::string msp = args.pathWrite + ".msp";
+        logging::status("Writing %s and %s.", spnb.c_str(), msp.c_str());
+        io::writeTopology(spnb, system(args.particles));
+        writeConfiguration(msp, config);
+    }
+
+    std::vector<RunResult> results;
+    if (args.steps > 0)
+    {
+        if (args.strongScaling())
+            for (unsigned threads : args.threads)
+                results.push_back(run("strong", system(args.particles), config, threads, args.steps));
+        if (args.weakScaling())
+            for (unsigned threads : args.threads)
+                results.push_back(
+                    run("weak", system(static_cast<size_t>(args.particles) * threads), config, threads, args.steps));
+
+        writeReport(args.pathReport, args.system, config.sim.timestep, results);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+CommandLineArguments::CommandLineArguments(const std::string & name, const argparse::description_t & description,
+                                           const std::string & version)
+    : CommandLineArgumentsBase(name, description, version), system("lattice"), particles(10000), seed(1),
+      pathConfig(""), steps(1000), threads(), scaling("strong"), trajectoryFrequency(0), pathReport("bench.csv"),
+      pathWrite("")
+{
+    argparse::Argument system = argparse::Argument()
+                                    .name_long("--system")
+                                    .description("kind of system: lattice, membrane or assembly")
+                                    .argument_type(argparse::ArgumentType::STRING)
+                                    .default_value("lattice");
+
+    argparse::Argument particles = argparse::Argument()
+                                       .name_short("-n")
+                                       .name_long("--particles")
+                                       .description("number of particles (per thread for weak scaling)")
+                                       .argument_type(argparse::ArgumentType::INTEGER)
+                                       .default_value("10000");
+
+    argparse::Argument seed = argparse::Argument()
+                                  .name_long("--seed")
+                                  .description("seed of the system generator")
+                                  .argument_type(argparse::ArgumentType::INTEGER)
+                                  .default_value("1");
+
+    argparse::Argument config = argparse::Argument()
+                                    .name_short("-c")
+                                    .name_long("--msp")
+                                    .description("simulation configuration, .msp format (default: canonical)")
+                                    .metavar("MSP")
+                                    .argument_type(argparse::ArgumentType::PATH_INPUT);
+
+    argparse::Argument steps = argparse::Argument()
+                                   .name_long("--steps")
+                                   .description("number of steps per run (0 only generates the system)")
+                                   .argument_type(argparse::ArgumentType::INTEGER)
+                                   .default_value("1000");
+
+    argparse::Argument threads = argparse::Argument()
+                                     .name_short("-t")
+                                     .name_long("--threads")
+                                     .description("OpenMP thread counts (default: 1, 2, 4... up to the maximum)")
+                                     .number_of_arguments("+")
+                                     .argument_type(argparse::ArgumentType::INTEGER);
+
+    argparse::Argument scaling = argparse::Argument()
+                                     .name_long("--scaling")
+                                     .description("scaling report: strong, weak or both")
+                                     .argument_type(argparse::ArgumentType::STRING)
+                                     .default_value("strong");
+
+    argparse::Argument trajectory = argparse::Argument()
+                                        .name_long("--trajectory-frequency")
+                                        .description("writes an XTC trajectory every N steps (0: configuration default)")
+                                        .argument_type(argparse::ArgumentType::INTEGER)
+                                        .default_value("0");
+
+    argparse::Argument report = argparse::Argument()
+                                    .name_short("-o")
+                                    .name_long("--report")
+                                    .description("output CSV report")
+                                    .metavar("CSV")
+                                    .argument_type(argparse::ArgumentType::PATH_OUTPUT)
+                                    .default_value("bench.csv");
+
+    argparse::Argument write = argparse::Argument()
+                                   .name_long("--write")
+                                   .description("writes the system and configuration as <PREFIX>.spnb and <PREFIX>.msp")
+                                   .metavar("PREFIX")
+                                   .argument_type(argparse::ArgumentType::STRING);
+
+    _parser.add_argument(system);
+    _parser.add_argument(particles);
+    _parser.add_argument(seed);
+    _parser.add_argument(config);
+    _parser.add_argument(steps);
+    _parser.add_argument(threads);
+    _parser.add_argument(scaling);
+    _parser.add_argument(trajectory);
+    _parser.add_argument(report);
+    _parser.add_argument(write);
+}
+
+void CommandLineArguments::parseCommandLine(int argc, const char * const argv[])
+{
+    _parser.parse_arguments(argc, argv);
+    system = _parser.get_option_value<std::string>("--system");
+    particles = _parser.get_option_value<unsigned>("--particles");
+    seed = _parser.get_option_value<unsigned>("--seed");
+    steps = _parser.get_option_value<unsigned>("--steps");
+    scaling = _parser.get_option_value<std::string>("--scaling");
+    trajectoryFrequency = _parser.get_option_value<unsigned>("--trajectory-frequency");
+    pathReport = _parser.get_option_value<std::string>("--report");
+    if (_parser.get_option("--msp").is_set())
+        pathConfig = _parser.get_option_value<std::string>("--msp");
+    if (_parser.get_option("--write").is_set())
+        pathWrite = _parser.get_option_value<std::string>("--write");
+
+    if (particles == 0)
+        logging::die("The number of particles should be positive.");
+    if (scaling != "strong" && scaling != "weak" && scaling != "both")
+        logging::die("Scaling option should be strong, weak or both.");
+
+#ifdef OPENMP_SUPPORT
+    const unsigned max_threads = static_cast<unsigned>(omp_get_max_threads());
+#else
+    const unsigned max_threads = 1;
+#endif
+
+    if (_parser.get_option("--threads").is_set())
+        for (int n : _parser.get_option_values<int>("--threads"))
+            threads.push_back(static_cast<unsigned>(std::max(n, 0)));
+    else
+    {
+        for (unsigned n = 1; n < max_threads; n *= 2)
+            threads.push_back(n);
+        threads.push_back(max_threads);
+    }
+
+    for (unsigned n : threads)
+    {
+        if (n == 0)
+            logging::die("Thread counts should be positive.");
+#ifndef OPENMP_SUPPORT
+        if (n > 1)
+            logging::die("Thread count %u requires OpenMP support. Reconfigure with OPENMP_SUPPORT=ON.", n);
+#endif
+    }
+}
+
+void CommandLineArguments::printArgumentValues() const
+{
+    logging::status("Running biospring-bench with arguments:");
+    logging::info("    system: %s", system.c_str());
+    logging::info("    particles: %u%s", particles, scaling == "strong" ? "" : " (per thread for weak scaling)");
+    logging::info("    seed: %u", seed);
+    logging::info("    configuration: %s", pathConfig.empty() ? "canonical" : pathConfig.c_str());
+    logging::info("    steps: %u", steps);
+    std::string counts;
+    for (unsigned n : threads)
+        counts += (counts.empty() ? "" : ", ") + std::to_string(n);
+    logging::info("    threads: %s", counts.c_str());
+    logging::info("    scaling: %s", scaling.c_str());
+    if (trajectoryFrequency > 0)
+        logging::info("    trajectory frequency: %u", trajectoryFrequency);
+    logging::info("    report: %s", pathReport.c_str());
+    if (!pathWrite.empty())
+        logging::info("    write: %s.spnb, %s.msp", pathWrite.c_str(), pathWrite.c_str());
+}
+
+} // namespace biospringbench
+} // namespace biospring
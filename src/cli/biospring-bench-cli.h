@@ -0,0 +1,54 @@
+
+#include "argparse.hpp"
+#include "version.h"
+
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+
+namespace biospringbench
+{
+
+const std::string PROGRAM_VERSION = "biospring-bench " + biospring::VERSION_STRING;
+
+//
+// Handles command-line parsing as well as argument storage for program biospring-bench.
+//
+class CommandLineArguments : public argparse::CommandLineArgumentsBase
+{
+  public:
+    // System generation.
+    std::string system;
+    unsigned particles;
+    unsigned seed;
+
+    // Runs.
+    std::string pathConfig; // optional: canonical configuration when empty
+    unsigned steps;
+    std::vector<unsigned> threads;
+    std::string scaling;
+    unsigned trajectoryFrequency;
+
+    // Outputs.
+    std::string pathReport;
+    std::string pathWrite;
+
+    // Constructor (inherited from argparse::CommandLineArgumentsBase).
+    CommandLineArguments(const std::string & name, const argparse::description_t & description,
+                         const std::string & version = "");
+
+    // Implements abstract methods from parent class.
+    void printArgumentValues() const;
+    void parseCommandLine(int argc, const char * const argv[]);
+
+    bool strongScaling() const { return scaling == "strong" || scaling == "both"; }
+    bool weakScaling() const { return scaling == "weak" || scaling == "both"; }
+};
+
+int main(int argc, char ** argv);
+
+} // namespace biospringbench
+
+} // namespace biospring
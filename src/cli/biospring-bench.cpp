@@ -0,0 +1,4 @@
+
+#include "biospring-bench-cli.h"
+
+int main(int argc, char ** argv) { return biospring::biospringbench::main(argc, argv); }
@@ -16,13 +16,15 @@
 #include "SpringNetworkOpenCL.h"
 #endif
 
+#include "Ensemble.h"
 #include "SpringNetwork.h"
 
-#include "IO/NetCDFReader.h"
 #include "IO/PDBReader.h"
+#include "IO/io.h"
 #include "logging.h"
 
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -32,6 +34,8 @@
 #include "configuration/SafeConfigurationReader.hpp"
 
 #include "measure.hpp"
+#include "timeit.hpp"
+#include "utils.hpp"
 
 namespace biospring
 {
@@ -71,17 +75,100 @@ const argparse::description_t PROGRAM_DESCRIPTION = {
     "biospring runs the spring-network simulation engine.",
     "",
     "Required inputs:",
-    "  -s/--nc  : binary NetCDF spring-network file (.nc)",
+    "  -s/--nc  : spring-network file, binary NetCDF (.nc) or native binary (.spnb)",
     "  -c/--msp : simulation configuration file (.msp)",
+    "",
+    "Ensembles:",
+    "  --replicas N runs N independent replicas of the system in one process. The system and the",
+    "  DX grids are read once and shared. --vary sets a parameter per replica, e.g.",
+    "  --vary probe.x=0,5,10 probe.y=2 ; output files get the replica number (traj.1.xtc).",
 };
 
+namespace
+{
+
+configuration::Configuration readConfiguration(const CommandLineArguments & args)
+{
+    logging::status("Reading MSP file %s.", args.pathConfig.c_str());
+    auto configReader = configuration::SafeConfigurationReader(configuration::defaultConfiguration());
+    configReader.setFileName(args.pathConfig);
+    configReader.read();
+
+    logging::status("Using configuration parameters:");
+    auto config = configReader.getConfiguration();
+    config.print();
+    return config;
+}
+
+// Runs the replicas of an ensemble (--replicas).
+int runReplicas(const CommandLineArguments & args)
+{
+#if defined(MDDRIVER_SUPPORT) || defined(FREESASA_SUPPORT)
+    logging::warning("Interactors are not available with --replicas: replicas run without MDDriver and FreeSASA.");
+#endif
+    const configuration::Configuration config = readConfiguration(args);
+
+    logging::status("Reading spring network file %s.", args.pathTopology.c_str());
+    spn::Ensemble ensemble(io::readTopology(args.pathTopology), config, args.replicas);
+
+    for (const std::string & variation : args.variations)
+    {
+        const size_t equal = variation.find('=');
+        if (equal == std::string::npos)
+            logging::die("--vary: expected <parameter>=<values>, got '%s'.", variation.c_str());
+        try
+        {
+            ensemble.vary(variation.substr(0, equal), utils::string::split(variation.substr(equal + 1), ","));
+        }
+        catch (const std::invalid_argument & e)
+        {
+            logging::die("--vary: %s.", e.what());
+        }
+    }
+
+    logging::status("Setting up %zu replicas...", ensemble.size());
+    try
+    {
+        ensemble.setup();
+    }
+    catch (const std::runtime_error & e)
+    {
+        logging::die("%s.", e.what());
+    }
+
+    logging::status("Running %zu replicas...", ensemble.size());
+    timeit::Timer timer;
+    ensemble.run();
+    timer.stop();
+    logging::info("%zu replicas ran in %.3f s (peak memory: %.1f MB).", ensemble.size(), timer.elapsed_seconds(),
+                  utils::memory::peakResidentSetSize() / (1024.0 * 1024.0));
+
+    logging::stop_async();
+    return 0;
+}
+
+} // namespace
+
 int main(int argc, char ** argv)
 {
     // Command-line parsing.
     CommandLineArguments args(std::string(argv[0]), PROGRAM_DESCRIPTION, PROGRAM_VERSION);
     args.parseCommandLine(argc, argv);
+
+    // From now on, messages are written by a background thread so that the simulation
+    // never waits for the terminal.
+    logging::Level level;
+    logging::level_from_string(args.logLevel, level);
+    logging::set_level(level);
+    if (!args.pathLogJson.empty())
+        logging::set_json_sink(args.pathLogJson);
+    logging::start_async();
+
     args.printArgumentValues();
 
+    if (args.replicas > 1)
+        return runReplicas(args);
+
     // SpringNetwork initialization: type of SpringNetwork depends on whether
     // OpenCL support is active or not.
     biospring::spn::SpringNetwork * spn = nullptr;
@@ -114,6 +201,7 @@ int main(int argc, char ** argv)
     iFreeSASA.setAlg(args.freesasaParam.sasa_alg);
     iFreeSASA.set_lr_n(args.freesasaParam.sasa_lr_n);
     iFreeSASA.set_sr_n(args.freesasaParam.sasa_sr_n);
+    iFreeSASA.setThreshold(args.freesasaParam.sasa_threshold);
     iFreeSASA.setProbeRad(args.freesasaParam.sasa_probe_radius);
     iFreeSASA.setRadiiClassifier(args.freesasaParam.sasa_classifier);
     iFreeSASA.setNthreads(args.freesasaParam.sasa_n_threads);
@@ -122,23 +210,16 @@ int main(int argc, char ** argv)
 #endif
 
     // Reads configuration file.
-    logging::status("Reading MSP file %s.", args.pathConfig.c_str());
-    auto configReader =
-        biospring::configuration::SafeConfigurationReader(biospring::configuration::defaultConfiguration());
-    configReader.setFileName(args.pathConfig);
-    configReader.read();
-
-    logging::status("Using configuration parameters:");
-    auto config = configReader.getConfiguration();
-    config.print();
-
-    // Reads topology file.
-    logging::status("Reading Nc file %s.", args.pathTopology.c_str());
-    NetCDFReader netcdfreader;
-    netcdfreader.setFileName(args.pathTopology);
-    netcdfreader.read();
+    auto config = readConfiguration(args);
 
-    netcdfreader.getTopology().to_spring_network(*spn);
+    // Reads topology file straight into the spring network.
+    logging::status("Reading spring network file %s.", args.pathTopology.c_str());
+    biospring::timeit::Timer loadtimer;
+    biospring::io::readSpringNetwork(args.pathTopology, *spn);
+    loadtimer.stop();
+    logging::info("Loaded %u particles and %zu springs in %.3f s (peak memory: %.1f MB).",
+                  spn->getNumberOfParticles(), spn->getSprings().size(), loadtimer.elapsed_seconds(),
+                  biospring::utils::memory::peakResidentSetSize() / (1024.0 * 1024.0));
 
     spn->setup(config);
 
@@ -161,6 +242,7 @@ int main(int argc, char ** argv)
     spn->run();
 
     delete spn;
+    logging::stop_async();
     return 0;
 }
 
@@ -171,7 +253,7 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
     argparse::Argument topology = argparse::Argument()
                                       .name_short("-s")
                                       .name_long("--nc")
-                                      .description("input topology, binary NetCDF .nc format")
+                                      .description("input topology, binary NetCDF .nc or native binary .spnb format")
                                       .metavar("NC")
                                       .argument_type(argparse::ArgumentType::PATH_INPUT)
                                       .required(true);
@@ -184,8 +266,37 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
                                     .argument_type(argparse::ArgumentType::PATH_INPUT)
                                     .required(true);
 
+    argparse::Argument logLevel = argparse::Argument()
+                                      .name_long("--log-level")
+                                      .description("minimal level of messages: debug, info, status, warning or error")
+                                      .argument_type(argparse::ArgumentType::STRING)
+                                      .default_value("debug");
+
+    argparse::Argument logJson = argparse::Argument()
+                                     .name_long("--log-json")
+                                     .description("also writes messages to a JSON lines file")
+                                     .metavar("JSON")
+                                     .argument_type(argparse::ArgumentType::PATH_OUTPUT);
+
+    argparse::Argument replicas = argparse::Argument()
+                                      .name_long("--replicas")
+                                      .description("number of independent replicas run in this process")
+                                      .argument_type(argparse::ArgumentType::INTEGER)
+                                      .default_value("1");
+
+    argparse::Argument vary = argparse::Argument()
+                                  .name_long("--vary")
+                                  .description("per-replica parameter values, <param>=<v0>,<v1>,...")
+                                  .metavar("PARAM=VALUES")
+                                  .number_of_arguments("+")
+                                  .argument_type(argparse::ArgumentType::STRING);
+
     _parser.add_argument(topology);
     _parser.add_argument(config);
+    _parser.add_argument(replicas);
+    _parser.add_argument(vary);
+    _parser.add_argument(logLevel);
+    _parser.add_argument(logJson);
 
     // == MDDriver-specific options ==
 
@@ -236,7 +347,8 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
         .name_long("--sasa-alg")
         .argument_type(argparse::ArgumentType::STRING)
         .default_value("lr")
-        .description("Choose between Lee-Richards (lr) or Shrake-Rupley (sr) algorithm.");
+        .description("Choose between Lee-Richards (lr), Shrake-Rupley (sr) or the native incremental Shrake-Rupley "
+                     "(native) algorithm.");
 
     argparse::Argument sasa_lr_n = argparse::Argument()
         .name_long("--sasa-lr-n")
@@ -250,6 +362,13 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
         .default_value("100")
         .description("Number of test points in S&R.");
 
+    argparse::Argument sasa_threshold = argparse::Argument()
+        .name_long("--sasa-threshold")
+        .argument_type(argparse::ArgumentType::REAL)
+        .default_value("0.1")
+        .description("Displacement (in Ångström) above which the native algorithm recomputes a particle and its "
+                     "neighbors.");
+
     argparse::Argument sasa_probe_radius = argparse::Argument()
         .name_long("--sasa-probe-radius")
         .argument_type(argparse::ArgumentType::REAL)
@@ -273,6 +392,7 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
     _parser.add_argument(sasa_alg);
     _parser.add_argument(sasa_lr_n);
     _parser.add_argument(sasa_sr_n);
+    _parser.add_argument(sasa_threshold);
     _parser.add_argument(sasa_probe_radius);
     _parser.add_argument(sasa_classifier);
     _parser.add_argument(sasa_n_threads);
@@ -296,6 +416,21 @@ void CommandLineArguments::parseCommandLine(int argc, const char * const argv[])
     _parser.parse_arguments(argc, argv);
     pathTopology = _parser.get_option_value<std::string>("--nc");
     pathConfig = _parser.get_option_value<std::string>("--msp");
+    logLevel = _parser.get_option_value<std::string>("--log-level");
+    replicas = _parser.get_option_value<unsigned>("--replicas");
+    if (_parser.get_option("--vary").is_set())
+        variations = _parser.get_option_values<std::string>("--vary");
+
+    if (replicas == 0)
+        logging::die("The number of replicas should be positive.");
+    if (!variations.empty() && replicas == 1)
+        logging::die("--vary requires --replicas.");
+    if (_parser.get_option("--log-json").is_set())
+        pathLogJson = _parser.get_option_value<std::string>("--log-json");
+
+    logging::Level level;
+    if (!logging::level_from_string(logLevel, level))
+        logging::die("Log level should be debug, info, status, warning or error.");
 
 #ifdef MDDRIVER_SUPPORT
     mddriverParam.wait = _parser.get_option("--wait").is_set();
@@ -315,12 +450,15 @@ void CommandLineArguments::parseCommandLine(int argc, const char * const argv[])
     freesasaParam.sasa_alg = _parser.get_option_value<std::string>("--sasa-alg");
     freesasaParam.sasa_lr_n = _parser.get_option_value<unsigned>("--sasa-lr-n");
     freesasaParam.sasa_sr_n = _parser.get_option_value<unsigned>("--sasa-sr-n");
+    freesasaParam.sasa_threshold = _parser.get_option_value<float>("--sasa-threshold");
     freesasaParam.sasa_probe_radius = _parser.get_option_value<double>("--sasa-probe-radius");
     freesasaParam.sasa_classifier = _parser.get_option_value<std::string>("--sasa-classifier");
     freesasaParam.sasa_n_threads = _parser.get_option_value<unsigned>("--sasa-n-threads");
 
-    if (freesasaParam.sasa_alg !="lr" && freesasaParam.sasa_alg !="sr")
-        logging::die("FreeSASA algorithm option should be lr or sr.");
+    if (freesasaParam.sasa_alg !="lr" && freesasaParam.sasa_alg !="sr" && freesasaParam.sasa_alg !="native")
+        logging::die("FreeSASA algorithm option should be lr, sr or native.");
+    if (freesasaParam.sasa_threshold < 0.0)
+        logging::die("SASA threshold should not be a negative number.");
     if (freesasaParam.sasa_probe_radius < 0.0)
         logging::die("Probe radius should not be a negative number.");
 #endif // FREESASA_SUPPORT
@@ -335,6 +473,13 @@ void CommandLineArguments::printArgumentValues() const
     logging::status("Running biospring with arguments:");
     logging::info("    topology: %s", pathTopology.c_str());
     logging::info("    configuration: %s", pathConfig.c_str());
+    if (replicas > 1)
+        logging::info("    replicas: %u", replicas);
+    for (const std::string & variation : variations)
+        logging::info("    vary: %s", variation.c_str());
+    logging::info("    log level: %s", logLevel.c_str());
+    if (!pathLogJson.empty())
+        logging::info("    JSON log: %s", pathLogJson.c_str());
 
 #ifdef MDDRIVER_SUPPORT
     logging::info("    MDDriver parameters:");
@@ -361,6 +506,11 @@ void CommandLineArguments::printArgumentValues() const
         logging::info("      n-slices: %d", freesasaParam.sasa_lr_n);
     else if (freesasaParam.sasa_alg =="sr")
         logging::info("      n-points: %d", freesasaParam.sasa_sr_n);
+    else if (freesasaParam.sasa_alg =="native")
+    {
+        logging::info("      n-points: %d", freesasaParam.sasa_sr_n);
+        logging::info("      threshold (Å): %f", freesasaParam.sasa_threshold);
+    }
     logging::info("      probe_radius (Å): %f", freesasaParam.sasa_probe_radius);
     logging::info("      classifier: %s", freesasaParam.sasa_classifier.c_str());
     logging::info("      n_threads: %d", freesasaParam.sasa_n_threads);
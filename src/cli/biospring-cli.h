@@ -4,6 +4,7 @@
 
 #include <string>
 #include <set>
+#include <vector>
 
 namespace biospring
 {
@@ -28,9 +29,10 @@ struct FreeSASAParameters
 {
     bool sasa_dynamic = false;
     unsigned sasa_sleep = 1000; // in microseconds
-    std::string sasa_alg = "lr"; // Default Lee-Richards algorithm.
+    std::string sasa_alg = "lr"; // Default Lee-Richards algorithm (lr, sr or native).
     unsigned sasa_lr_n = 20;
     unsigned sasa_sr_n = 100;
+    float sasa_threshold = 0.1;
     double sasa_probe_radius = 1.4;
     std::string sasa_classifier = "default";
     unsigned sasa_n_threads = 2;
@@ -52,6 +54,14 @@ class CommandLineArguments : public argparse::CommandLineArgumentsBase
     MDDriverParameters mddriverParam;
     FreeSASAParameters freesasaParam;
 
+    // Ensembles: number of replicas and parameters that differ between them (<param>=<v0>,<v1>,...).
+    unsigned replicas = 1;
+    std::vector<std::string> variations;
+
+    // Logging.
+    std::string logLevel = "debug";
+    std::string pathLogJson = "";
+
     // Constructor (inherited from argparse::CommandLineArgumentsBase).
     CommandLineArguments(const std::string & name, const argparse::description_t & description, const std::string & version = "");
 
@@ -0,0 +1,180 @@
+
+#include "biospring-sweep-cli.h"
+
+#ifdef OPENMP_SUPPORT
+#include "omp.h"
+#endif
+
+#include "IO/io.h"
+#include "Sweep.h"
+#include "configuration/Configuration.hpp"
+#include "configuration/SafeConfigurationReader.hpp"
+#include "logging.h"
+#include "timeit.hpp"
+#include "utils/string.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace biospringsweep
+{
+
+const argparse::description_t PROGRAM_DESCRIPTION = {
+    "biospring-sweep runs a simulation for each combination of configuration parameters.",
+    "",
+    "Parameters are given as <group>.<name>=<v0>,<v1>,... and override the values of the",
+    "-c/--msp file (which must set simulation.nbsteps):",
+    "  --grid : runs every combination of the values (cartesian product)",
+    "  --list : run i takes the i-th value of every parameter",
+    "",
+    "Runs are spread over the OpenMP threads, one thread per run. The spring network and the DX",
+    "grids are read once. Final energies are written to -o/--table, one line per run, and the",
+    "CSV samples of all the runs to --samples. Output files get the run number (traj.3.xtc).",
+    "With --resume, the runs already in the table are skipped.",
+    "",
+    "Example:",
+    "  biospring-sweep -s model.nc -c param.msp --grid impala.scale=0.5,1,2 coulomb.dielectric=20,80",
+};
+
+int main(int argc, char ** argv)
+{
+    CommandLineArguments args(std::string(argv[0]), PROGRAM_DESCRIPTION, PROGRAM_VERSION);
+    args.parseCommandLine(argc, argv);
+    args.printArgumentValues();
+
+    logging::status("Reading MSP file %s.", args.pathConfig.c_str());
+    auto reader = configuration::SafeConfigurationReader(configuration::defaultConfiguration());
+    reader.setFileName(args.pathConfig);
+    reader.read();
+
+    logging::status("Reading spring network file %s.", args.pathTopology.c_str());
+    const auto mode = args.list.empty() ? spn::Sweep::Mode::Grid : spn::Sweep::Mode::List;
+    spn::Sweep sweep(io::readTopology(args.pathTopology), reader.getConfiguration(), mode);
+
+    try
+    {
+        for (const std::string & parameter : mode == spn::Sweep::Mode::Grid ? args.grid : args.list)
+        {
+            const size_t equal = parameter.find('=');
+            if (equal == std::string::npos)
+                throw std::invalid_argument("expected <parameter>=<values>, got '" + parameter + "'");
+            sweep.add(parameter.substr(0, equal), utils::string::split(parameter.substr(equal + 1), ","));
+        }
+
+#ifdef OPENMP_SUPPORT
+        logging::status("Running %zu simulations on %d threads...", sweep.size(), omp_get_max_threads());
+#else
+        logging::status("Running %zu simulations...", sweep.size());
+#endif
+        timeit::Timer timer;
+        const size_t runs = sweep.run(args.pathTable, args.pathSamples, args.resume);
+        timer.stop();
+        logging::status("%zu simulations ran in %.3f s. Final energies written to %s.", runs, timer.elapsed_seconds(),
+                        args.pathTable.c_str());
+    }
+    catch (const std::exception & e)
+    {
+        logging::die("%s", e.what());
+    }
+
+    return EXIT_SUCCESS;
+}
+
+CommandLineArguments::CommandLineArguments(const std::string & name, const argparse::description_t & description,
+                                           const std::string & version)
+    : CommandLineArgumentsBase(name, description, version), pathTopology(""), pathConfig(""), grid(), list(),
+      pathTable("sweep.tsv"), pathSamples(""), resume(false)
+{
+    argparse::Argument topology = argparse::Argument()
+                                      .name_short("-s")
+                                      .name_long("--nc")
+                                      .description("input topology, binary NetCDF .nc or native binary .spnb format")
+                                      .metavar("NC")
+                                      .argument_type(argparse::ArgumentType::PATH_INPUT)
+                                      .required(true);
+
+    argparse::Argument config = argparse::Argument()
+                                    .name_short("-c")
+                                    .name_long("--msp")
+                                    .description("base simulation configuration, .msp format")
+                                    .metavar("MSP")
+                                    .argument_type(argparse::ArgumentType::PATH_INPUT)
+                                    .required(true);
+
+    argparse::Argument grid = argparse::Argument()
+                                  .name_long("--grid")
+                                  .description("parameters whose combinations are run, <param>=<v0>,<v1>,...")
+                                  .metavar("PARAM=VALUES")
+                                  .number_of_arguments("+")
+                                  .argument_type(argparse::ArgumentType::STRING);
+
+    argparse::Argument list = argparse::Argument()
+                                  .name_long("--list")
+                                  .description("parameters whose i-th values are run together, <param>=<v0>,<v1>,...")
+                                  .metavar("PARAM=VALUES")
+                                  .number_of_arguments("+")
+                                  .argument_type(argparse::ArgumentType::STRING);
+
+    argparse::Argument table = argparse::Argument()
+                                   .name_short("-o")
+                                   .name_long("--table")
+                                   .description("output table of final energies (tab-separated)")
+                                   .metavar("TSV")
+                                   .argument_type(argparse::ArgumentType::PATH_OUTPUT)
+                                   .default_value("sweep.tsv");
+
+    argparse::Argument samples = argparse::Argument()
+                                     .name_long("--samples")
+                                     .description("output table of the CSV samples of all the runs")
+                                     .metavar("TSV")
+                                     .argument_type(argparse::ArgumentType::PATH_OUTPUT);
+
+    argparse::Argument resume =
+        argparse::StoreTrueArgument("", "--resume", "skips the runs already in the table of final energies");
+
+    _parser.add_argument(topology);
+    _parser.add_argument(config);
+    _parser.add_argument(grid);
+    _parser.add_argument(list);
+    _parser.add_argument(table);
+    _parser.add_argument(samples);
+    _parser.add_argument(resume);
+}
+
+void CommandLineArguments::parseCommandLine(int argc, const char * const argv[])
+{
+    _parser.parse_arguments(argc, argv);
+    pathTopology = _parser.get_option_value<std::string>("--nc");
+    pathConfig = _parser.get_option_value<std::string>("--msp");
+    pathTable = _parser.get_option_value<std::string>("--table");
+    if (_parser.get_option("--grid").is_set())
+        grid = _parser.get_option_values<std::string>("--grid");
+    if (_parser.get_option("--list").is_set())
+        list = _parser.get_option_values<std::string>("--list");
+    if (_parser.get_option("--samples").is_set())
+        pathSamples = _parser.get_option_value<std::string>("--samples");
+    resume = _parser.get_option("--resume").is_set();
+
+    if (!grid.empty() && !list.empty())
+        logging::die("Options --grid and --list are mutually exclusive.");
+}
+
+void CommandLineArguments::printArgumentValues() const
+{
+    logging::status("Running biospring-sweep with arguments:");
+    logging::info("    topology: %s", pathTopology.c_str());
+    logging::info("    configuration: %s", pathConfig.c_str());
+    for (const std::string & parameter : grid)
+        logging::info("    grid: %s", parameter.c_str());
+    for (const std::string & parameter : list)
+        logging::info("    list: %s", parameter.c_str());
+    logging::info("    table: %s%s", pathTable.c_str(), resume ? " (resumed)" : "");
+    if (!pathSamples.empty())
+        logging::info("    samples: %s", pathSamples.c_str());
+}
+
+} // namespace biospringsweep
+} // namespace biospring
@@ -0,0 +1,48 @@
+
+#include "argparse.hpp"
+#include "version.h"
+
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+
+namespace biospringsweep
+{
+
+const std::string PROGRAM_VERSION = "biospring-sweep " + biospring::VERSION_STRING;
+
+//
+// Handles command-line parsing as well as argument storage for program biospring-sweep.
+//
+class CommandLineArguments : public argparse::CommandLineArgumentsBase
+{
+  public:
+    // Inputs.
+    std::string pathTopology;
+    std::string pathConfig;
+
+    // Swept parameters, <param>=<v0>,<v1>,...
+    std::vector<std::string> grid;
+    std::vector<std::string> list;
+
+    // Outputs.
+    std::string pathTable;
+    std::string pathSamples;
+    bool resume;
+
+    // Constructor (inherited from argparse::CommandLineArgumentsBase).
+    CommandLineArguments(const std::string & name, const argparse::description_t & description,
+                         const std::string & version = "");
+
+    // Implements abstract methods from parent class.
+    void printArgumentValues() const;
+    void parseCommandLine(int argc, const char * const argv[]);
+};
+
+int main(int argc, char ** argv);
+
+} // namespace biospringsweep
+
+} // namespace biospring
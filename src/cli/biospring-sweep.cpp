@@ -0,0 +1,4 @@
+
+#include "biospring-sweep-cli.h"
+
+int main(int argc, char ** argv) { return biospring::biospringsweep::main(argc, argv); }
@@ -15,15 +15,17 @@ const argparse::description_t PROGRAM_DESCRIPTION = {
     "editspn edits or creates spring networks from an existing topology.",
     "",
     "Input topology formats are selected from the -s/--topology filename extension:",
-    "  .nc  : binary NetCDF spring-network file",
-    "  .pdb : Protein Data Bank file",
-    "  .pqr : PQR file",
+    "  .nc   : binary NetCDF spring-network file",
+    "  .spnb : native binary spring-network file (memory-mappable)",
+    "  .pdb  : Protein Data Bank file",
+    "  .pqr  : PQR file",
     "",
     "Output formats are selected from the -o/--output filename extension:",
-    "  .nc  : binary NetCDF spring-network file",
-    "  .cdl : text NetCDF/CDL spring-network file",
-    "  .pdb : Protein Data Bank file",
-    "  .pqr : PQR file",
+    "  .nc   : binary NetCDF spring-network file",
+    "  .spnb : native binary spring-network file (memory-mappable)",
+    "  .cdl  : text NetCDF/CDL spring-network file",
+    "  .pdb  : Protein Data Bank file",
+    "  .pqr  : PQR file",
 };
 
 int main(int argc, char ** argv)
@@ -221,7 +223,7 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
     argparse::Argument output = argparse::Argument()
                                     .name_short("-o")
                                     .name_long("--output")
-                                    .description("output file name(s); format is selected by extension: .nc, .cdl, .pdb or .pqr")
+                                    .description("output file name(s); format is selected by extension: .nc, .spnb, .cdl, .pdb or .pqr")
                                     .metavar("OUTPUT_FILE")
                                     .number_of_arguments("+")
                                     .argument_type(argparse::ArgumentType::PATH_OUTPUT)
@@ -13,15 +13,17 @@ const biospring::argparse::description_t PROGRAM_DESCRIPTION = {
     "mergespn merges two or more spring-network topologies.",
     "",
     "Input topology formats are selected from the -s/--topology filename extension:",
-    "  .nc  : binary NetCDF spring-network file",
-    "  .pdb : Protein Data Bank file",
-    "  .pqr : PQR file",
+    "  .nc   : binary NetCDF spring-network file",
+    "  .spnb : native binary spring-network file (memory-mappable)",
+    "  .pdb  : Protein Data Bank file",
+    "  .pqr  : PQR file",
     "",
     "Output formats are selected from the -o/--output filename extension:",
-    "  .nc  : binary NetCDF spring-network file",
-    "  .cdl : text NetCDF/CDL spring-network file",
-    "  .pdb : Protein Data Bank file",
-    "  .pqr : PQR file",
+    "  .nc   : binary NetCDF spring-network file",
+    "  .spnb : native binary spring-network file (memory-mappable)",
+    "  .cdl  : text NetCDF/CDL spring-network file",
+    "  .pdb  : Protein Data Bank file",
+    "  .pqr  : PQR file",
     "",
     "Use -cutoff/--cutoff to create springs between merged structures.",
 };
@@ -67,7 +69,7 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
     argparse::Argument topology = argparse::Argument()
                                       .name_short("-s")
                                       .name_long("--topology")
-                                      .description("input topology file(s); format is selected by extension: .nc, .pdb or .pqr")
+                                      .description("input topology file(s); format is selected by extension: .nc, .spnb, .pdb or .pqr")
                                       .metavar("INPUT_FILE")
                                       .number_of_arguments("+")
                                       .argument_type(argparse::ArgumentType::PATH_INPUT)
@@ -76,7 +78,7 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
     argparse::Argument output = argparse::Argument()
                                     .name_short("-o")
                                     .name_long("--output")
-                                    .description("output file name(s); format is selected by extension: .nc, .cdl, .pdb or .pqr")
+                                    .description("output file name(s); format is selected by extension: .nc, .spnb, .cdl, .pdb or .pqr")
                                     .metavar("OUTPUT_FILE")
                                     .number_of_arguments("+")
                                     .argument_type(argparse::ArgumentType::PATH_OUTPUT)
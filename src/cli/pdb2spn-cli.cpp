@@ -15,15 +15,17 @@ const biospring::argparse::description_t PROGRAM_DESCRIPTION = {
     "pdb2spn creates a spring network from a topology file.",
     "",
     "Input topology formats are selected from the -s/--topology filename extension:",
-    "  .nc  : binary NetCDF spring-network file",
-    "  .pdb : Protein Data Bank file",
-    "  .pqr : PQR file",
+    "  .nc   : binary NetCDF spring-network file",
+    "  .spnb : native binary spring-network file (memory-mappable)",
+    "  .pdb  : Protein Data Bank file",
+    "  .pqr  : PQR file",
     "",
     "Output formats are selected from the -o/--output filename extension:",
-    "  .nc  : binary NetCDF spring-network file",
-    "  .cdl : text NetCDF/CDL spring-network file",
-    "  .pdb : Protein Data Bank file",
-    "  .pqr : PQR file",
+    "  .nc   : binary NetCDF spring-network file",
+    "  .spnb : native binary spring-network file (memory-mappable)",
+    "  .cdl  : text NetCDF/CDL spring-network file",
+    "  .pdb  : Protein Data Bank file",
+    "  .pqr  : PQR file",
     "",
     "When the output is a PDB file, -pdbconect/--pdbconect adds CONECT",
     "records at the end of the PDB to visualize the springs of the network.",
@@ -104,7 +106,7 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
     argparse::Argument topology = argparse::Argument()
                                       .name_short("-s")
                                       .name_long("--topology")
-                                      .description("input topology file; format is selected by extension: .nc, .pdb or .pqr")
+                                      .description("input topology file; format is selected by extension: .nc, .spnb, .pdb or .pqr")
                                       .metavar("INPUT_FILE")
                                       .argument_type(argparse::ArgumentType::PATH_INPUT)
                                       .required(true);
@@ -112,7 +114,7 @@ CommandLineArguments::CommandLineArguments(const std::string & name, const argpa
     argparse::Argument output = argparse::Argument()
                                     .name_short("-o")
                                     .name_long("--output")
-                                    .description("output file name(s); format is selected by extension: .nc, .cdl, .pdb or .pqr")
+                                    .description("output file name(s); format is selected by extension: .nc, .spnb, .cdl, .pdb or .pqr")
                                     .metavar("OUTPUT_FILE")
                                     .number_of_arguments("+")
                                     .argument_type(argparse::ArgumentType::PATH_OUTPUT)
@@ -33,12 +33,20 @@ class Configuration
     GridSetting densitygrid;
     ProbeSetting probe;
     RigidBodySetting rigidbody;
+    ProfilingSetting profiling; // per-stage timings, written every `frequency` steps
+    ColvarsSetting colvars;     // collective variables and biases, see cv::Colvars
+    SelectionSetting selection; // named selections
+    ConstraintSetting constraint;
+    DecompositionSetting decomposition; // per-group energies, see spn::EnergyDecomposition
+    ActiveRegionSetting activeregion;   // only particles around a center move, see spn::ActiveRegion
 
     Configuration()
         : sim("simulation"), steric("steric"), spring("spring"), hydrophobicity("hydrophobicity"),
           electrostatic("coulomb"), imp("impala"), ivector("insertionvector"), viscosity("viscosity"),
           pdbtraj("pdbtrajectory"), xtctraj("xtctrajectory"), csvsample("csvsampling"), potentialgrid("potentialgrid"),
-          densitygrid("densitygrid"), probe("probe"), rigidbody("rigidbody")
+          densitygrid("densitygrid"), probe("probe"), rigidbody("rigidbody"), profiling("profiling"),
+          colvars("colvars"), selection("selection"), constraint("constraint"),
+          decomposition("decomposition"), activeregion("activeregion")
     {
         _register(sim);
         _register(steric);
@@ -55,42 +63,66 @@ class Configuration
         _register(densitygrid);
         _register(probe);
         _register(rigidbody);
+        _register(profiling);
+        _register(colvars);
+        _register(constraint);
+        _register(decomposition);
+        _register(activeregion);
     }
 
     void print(std::ostream & os = std::cout) const
     {
-        sim.print();
+        sim.print(os);
         os << "\n";
-        steric.print();
+        steric.print(os);
         os << "\n";
-        spring.print();
+        spring.print(os);
         os << "\n";
-        hydrophobicity.print();
+        hydrophobicity.print(os);
         os << "\n";
-        electrostatic.print();
+        electrostatic.print(os);
         os << "\n";
-        imp.print();
+        imp.print(os);
         os << "\n";
-        ivector.print();
+        ivector.print(os);
         os << "\n";
-        viscosity.print();
+        viscosity.print(os);
         os << "\n";
-        pdbtraj.print();
+        pdbtraj.print(os);
         os << "\n";
-        xtctraj.print();
+        xtctraj.print(os);
         os << "\n";
-        csvsample.print();
+        csvsample.print(os);
         os << "\n";
-        potentialgrid.print();
+        potentialgrid.print(os);
         os << "\n";
-        densitygrid.print();
+        densitygrid.print(os);
         os << "\n";
-        probe.print();
+        probe.print(os);
         os << "\n";
-        rigidbody.print();
+        rigidbody.print(os);
+        os << "\n";
+        profiling.print(os);
+        os << "\n";
+        colvars.print(os);
+        os << "\n";
+        selection.print(os);
+        os << "\n";
+        constraint.print(os);
+        os << "\n";
+        decomposition.print(os);
+        os << "\n";
+        activeregion.print(os);
     }
 
-    bool exists(const std::string & name) { return _allSettingNames.count(name); }
+    // Selection names are free: any valid name exists in the selection group.
+    bool exists(const std::string & name)
+    {
+        const std::string prefix = selection.name + ".";
+        if (name.compare(0, prefix.size(), prefix) == 0)
+            return SelectionSetting::isValidName(name.substr(prefix.size()));
+        return _allSettingNames.count(name);
+    }
 
     // Sets a parameter from its full name.
     void setFromString(const std::string & param, const std::string & value)
@@ -136,6 +168,18 @@ class Configuration
             probe.setFromString(name, value);
         else if (group == rigidbody.name)
             rigidbody.setFromString(name, value);
+        else if (group == profiling.name)
+            profiling.setFromString(name, value);
+        else if (group == colvars.name)
+            colvars.setFromString(name, value);
+        else if (group == selection.name)
+            selection.setFromString(name, value);
+        else if (group == constraint.name)
+            constraint.setFromString(name, value);
+        else if (group == decomposition.name)
+            decomposition.setFromString(name, value);
+        else if (group == activeregion.name)
+            activeregion.setFromString(name, value);
     }
 
   protected:
@@ -200,11 +244,42 @@ inline Configuration defaultConfiguration()
     config.rigidbody.montecarlo_translation_norm = 0.1;
     config.rigidbody.montecarlo_rotation_norm = 0.1;
     config.rigidbody.montecarlo_temperature = 298.1;
+    config.rigidbody.enablehydrophobicrestraint = false;
+    config.rigidbody.hydrophobicrestraint_scale = 10.0;
+    config.rigidbody.splitchains = false;
+    config.rigidbody.receptor = "";
+    config.rigidbody.receptorgrid_spacing = 1.0;
 
 
     config.imp.enable = false;
     config.imp.scale = 1.0;
 
+    config.profiling.enable = false;
+    config.profiling.path = "profile.csv";
+    config.profiling.frequency = 1000;
+    config.profiling.hardware = false;
+
+    config.colvars.enable = false;
+    config.colvars.path = "colvars.dat";
+    config.colvars.frequency = 100;
+    config.colvars.input = "";
+
+    config.constraint.enable = false;
+    config.constraint.src = "";
+    config.constraint.dest = "";
+    config.constraint.scale = 1.0;
+
+    config.decomposition.enable = false;
+    config.decomposition.path = "decomposition.csv";
+    config.decomposition.frequency = 100;
+    config.decomposition.groups = "residues";
+
+    config.activeregion.enable = false;
+    config.activeregion.center = "";
+    config.activeregion.radius = 20.0;
+    config.activeregion.buffer = 2.0;
+    config.activeregion.frequency = 10;
+
     return config;
 }
 
@@ -1,7 +1,9 @@
 #ifndef __SETTING_H__
 #define __SETTING_H__
 
+#include <algorithm>
 #include <array>
+#include <cctype>
 #include <iostream>
 #include <set>
 #include <sstream>
@@ -189,6 +191,200 @@ class TrajectorySetting : public SettingBase
     }
 };
 
+class ProfilingSetting : public TrajectorySetting
+{
+  public:
+    bool hardware;
+
+    ProfilingSetting(const std::string & name) : TrajectorySetting(name), hardware(false)
+    {
+        _parameterNames = {"enable", "path", "frequency", "hardware"};
+    }
+
+    void setFromString(const std::string & param, const std::string & s) override
+    {
+        if (param == "hardware")
+            _parse_bool(hardware, s, param);
+        else
+            TrajectorySetting::setFromString(param, s);
+    }
+
+    void print(std::ostream & os = std::cout) const override
+    {
+        TrajectorySetting::print(os);
+        _mspFormatter.print("hardware", hardware, os);
+    }
+};
+
+class ColvarsSetting : public TrajectorySetting
+{
+  public:
+    std::string input; // collective variables and biases definitions, see cv::Colvars
+
+    ColvarsSetting(const std::string & name) : TrajectorySetting(name), input()
+    {
+        _parameterNames = {"enable", "path", "frequency", "input"};
+    }
+
+    void setFromString(const std::string & param, const std::string & s) override
+    {
+        if (param == "input")
+            input = s;
+        else
+            TrajectorySetting::setFromString(param, s);
+    }
+
+    void print(std::ostream & os = std::cout) const override
+    {
+        TrajectorySetting::print(os);
+        _mspFormatter.print("input", input, os);
+    }
+};
+
+// Energy decomposition: mean energies of groups of particles, see spn::EnergyDecomposition.
+class DecompositionSetting : public TrajectorySetting
+{
+  public:
+    std::string groups; // "residues", "selections", or selection names separated by commas
+
+    DecompositionSetting(const std::string & name) : TrajectorySetting(name), groups()
+    {
+        _parameterNames = {"enable", "path", "frequency", "groups"};
+    }
+
+    void setFromString(const std::string & param, const std::string & s) override
+    {
+        if (param == "groups")
+            groups = s;
+        else
+            TrajectorySetting::setFromString(param, s);
+    }
+
+    void print(std::ostream & os = std::cout) const override
+    {
+        TrajectorySetting::print(os);
+        _mspFormatter.print("groups", groups, os);
+    }
+};
+
+// Named selections: each parameter `selection.<name> = <expression>` defines one, see
+// selection::Expression. Names are free, so that there is no fixed parameter list.
+class SelectionSetting : public SettingBase
+{
+  public:
+    std::vector<std::pair<std::string, std::string>> definitions; // in definition order
+
+    SelectionSetting(const std::string & name) : SettingBase(name), definitions() {}
+
+    // Valid selection names: letters, digits and '_', not starting with a digit.
+    static bool isValidName(const std::string & s)
+    {
+        if (s.empty() or std::isdigit(static_cast<unsigned char>(s[0])))
+            return false;
+        return std::all_of(s.begin(), s.end(),
+                           [](char c) { return std::isalnum(static_cast<unsigned char>(c)) or c == '_'; });
+    }
+
+    void setFromString(const std::string & param, const std::string & s) override
+    {
+        if (not isValidName(param))
+            logging::die("%s: invalid selection name '%s'", name.c_str(), param.c_str());
+        for (auto & [key, value] : definitions)
+        {
+            if (key == param)
+            {
+                value = s;
+                return;
+            }
+        }
+        definitions.emplace_back(param, s);
+    }
+
+    void print(std::ostream & os = std::cout) const override
+    {
+        for (const auto & [key, value] : definitions)
+            _mspFormatter.print(key, value, os);
+    }
+};
+
+class ConstraintSetting : public SettingBase
+{
+  public:
+    bool enable;
+    std::string src;  // selection names
+    std::string dest;
+    double scale;     // force module, in Da.Å.fs-2
+
+    ConstraintSetting(const std::string & name) : SettingBase(name), enable(false), src(), dest(), scale(1.0)
+    {
+        _parameterNames = {"enable", "src", "dest", "scale"};
+    }
+
+    void setFromString(const std::string & param, const std::string & s) override
+    {
+        if (param == "enable")
+            _parse_bool(enable, s, param);
+        else if (param == "src")
+            src = s;
+        else if (param == "dest")
+            dest = s;
+        else if (param == "scale")
+            utils::string::from_string<decltype(scale)>(scale, s);
+        else
+            logging::die("%s: unknown parameter '%s'", name.c_str(), param.c_str());
+    }
+
+    void print(std::ostream & os = std::cout) const override
+    {
+        _mspFormatter.print("enable", enable, os);
+        _mspFormatter.print("src", src, os);
+        _mspFormatter.print("dest", dest, os);
+        _mspFormatter.print("scale", scale, os);
+    }
+};
+
+// Active region: only the particles around `center` move, see spn::ActiveRegion.
+class ActiveRegionSetting : public SettingBase
+{
+  public:
+    bool enable;
+    std::string center; // selection name, or "probe"
+    double radius;      // Å
+    double buffer;      // Å
+    size_t frequency;   // steps between two updates of the region
+
+    ActiveRegionSetting(const std::string & name)
+        : SettingBase(name), enable(false), center(), radius(20.0), buffer(2.0), frequency(10)
+    {
+        _parameterNames = {"enable", "center", "radius", "buffer", "frequency"};
+    }
+
+    void setFromString(const std::string & param, const std::string & s) override
+    {
+        if (param == "enable")
+            _parse_bool(enable, s, param);
+        else if (param == "center")
+            center = s;
+        else if (param == "radius")
+            utils::string::from_string<decltype(radius)>(radius, s);
+        else if (param == "buffer")
+            utils::string::from_string<decltype(buffer)>(buffer, s);
+        else if (param == "frequency")
+            utils::string::from_string<decltype(frequency)>(frequency, s);
+        else
+            logging::die("%s: unknown parameter '%s'", name.c_str(), param.c_str());
+    }
+
+    void print(std::ostream & os = std::cout) const override
+    {
+        _mspFormatter.print("enable", enable, os);
+        _mspFormatter.print("center", center, os);
+        _mspFormatter.print("radius", radius, os);
+        _mspFormatter.print("buffer", buffer, os);
+        _mspFormatter.print("frequency", frequency, os);
+    }
+};
+
 class GridSetting : public SettingBase
 {
   public:
@@ -497,15 +693,24 @@ class RigidBodySetting : public SettingBase
     double montecarlo_translation_norm;  // random translation to apply each step in Å
     double montecarlo_rotation_norm;     // random rotation to apply each step in °
     double montecarlo_temperature;
+    bool enablehydrophobicrestraint;
+    double hydrophobicrestraint_scale;
+    bool splitchains;                    // one rigid body per chain
+    std::string receptor;                // chains represented by potential grids, comma-separated
+    double receptorgrid_spacing;         // in Å
 
     RigidBodySetting(const std::string & name) : SettingBase(name), 
         enable(false), enablesampling(false), enablemontecarlo(false),
         montecarlo_translation_norm(0.1), montecarlo_rotation_norm(0.1),
-        montecarlo_temperature(298.1)
+        montecarlo_temperature(298.1), enablehydrophobicrestraint(false),
+        hydrophobicrestraint_scale(10.0), splitchains(false), receptor(""),
+        receptorgrid_spacing(1.0)
     {
         _parameterNames = {"enable", "enablesampling", "enablemontecarlo",
             "montecarlo_translation_norm", "montecarlo_rotation_norm",
-            "montecarlo_temperature"};
+            "montecarlo_temperature", "enablehydrophobicrestraint",
+            "hydrophobicrestraint_scale", "splitchains", "receptor",
+            "receptorgrid_spacing"};
     }
 
     void setFromString(const std::string & param, const std::string & s) override
@@ -522,6 +727,16 @@ class RigidBodySetting : public SettingBase
             utils::string::from_string<decltype(montecarlo_rotation_norm)>(montecarlo_rotation_norm, s);
         else if (param == "montecarlo_temperature")
             utils::string::from_string<decltype(montecarlo_temperature)>(montecarlo_temperature, s);
+        else if (param == "enablehydrophobicrestraint")
+            _parse_bool(enablehydrophobicrestraint, s, param);
+        else if (param == "hydrophobicrestraint_scale")
+            utils::string::from_string<decltype(hydrophobicrestraint_scale)>(hydrophobicrestraint_scale, s);
+        else if (param == "splitchains")
+            _parse_bool(splitchains, s, param);
+        else if (param == "receptor")
+            receptor = s;
+        else if (param == "receptorgrid_spacing")
+            utils::string::from_string<decltype(receptorgrid_spacing)>(receptorgrid_spacing, s);
         else
             logging::die("%s: unknown parameter '%s'", name.c_str(), param.c_str());
     }
@@ -534,6 +749,11 @@ class RigidBodySetting : public SettingBase
         _mspFormatter.print("montecarlo_translation_norm", montecarlo_translation_norm, os);
         _mspFormatter.print("montecarlo_rotation_norm", montecarlo_rotation_norm, os);
         _mspFormatter.print("montecarlo_temperature", montecarlo_temperature, os);
+        _mspFormatter.print("enablehydrophobicrestraint", enablehydrophobicrestraint, os);
+        _mspFormatter.print("hydrophobicrestraint_scale", hydrophobicrestraint_scale, os);
+        _mspFormatter.print("splitchains", splitchains, os);
+        _mspFormatter.print("receptor", receptor, os);
+        _mspFormatter.print("receptorgrid_spacing", receptorgrid_spacing, os);
     }
 };
 
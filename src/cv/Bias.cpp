@@ -0,0 +1,166 @@
+#include "Bias.h"
+
+#include "forcefield/constants.hpp"
+#include "logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace biospring
+{
+namespace cv
+{
+
+// Boltzmann constant in kJ/mol/K.
+static const double BOLTZMANN_KJ_PER_MOL =
+    forcefield::BOLTZMANJPERK * forcefield::AVOGADRO_NUMBER / forcefield::KJOULE_TO_JOULE;
+
+static std::string bias_error(const Bias & bias, const std::string & message)
+{
+    return bias.getType() + " on '" + bias.getVariable().getName() + "': " + message;
+}
+
+// ======================================================================================
+//
+// Umbrella.
+//
+// ======================================================================================
+
+Umbrella::Umbrella(const CollectiveVariable & variable, double center, double k)
+    : Bias(variable), _center(center), _k(k)
+{
+    if (k < 0.0)
+        throw std::invalid_argument(bias_error(*this, "force constant must be >= 0"));
+}
+
+double Umbrella::evaluate(double s, double & derivative) const
+{
+    const double delta = s - _center;
+    derivative = _k * delta;
+    return 0.5 * _k * delta * delta;
+}
+
+// ======================================================================================
+//
+// HarmonicWall.
+//
+// ======================================================================================
+
+HarmonicWall::HarmonicWall(const CollectiveVariable & variable, double lower, double upper, double k)
+    : Bias(variable), _lower(lower), _upper(upper), _k(k)
+{
+    if (k < 0.0)
+        throw std::invalid_argument(bias_error(*this, "force constant must be >= 0"));
+    if (lower > upper)
+        throw std::invalid_argument(bias_error(*this, "lower wall above upper wall"));
+}
+
+double HarmonicWall::evaluate(double s, double & derivative) const
+{
+    double delta = 0.0;
+    if (s < _lower)
+        delta = s - _lower;
+    else if (s > _upper)
+        delta = s - _upper;
+    derivative = _k * delta;
+    return 0.5 * _k * delta * delta;
+}
+
+// ======================================================================================
+//
+// Metadynamics.
+//
+// ======================================================================================
+
+Metadynamics::Metadynamics(const CollectiveVariable & variable, const Parameters & parameters)
+    : Bias(variable), _parameters(parameters), _spacing(0.0), _hills(0)
+{
+    if (parameters.height < 0.0)
+        throw std::invalid_argument(bias_error(*this, "height must be >= 0"));
+    if (parameters.sigma <= 0.0)
+        throw std::invalid_argument(bias_error(*this, "sigma must be > 0"));
+    if (parameters.pace == 0)
+        throw std::invalid_argument(bias_error(*this, "pace must be > 0"));
+    if (parameters.biasfactor <= 1.0)
+        throw std::invalid_argument(bias_error(*this, "biasfactor must be > 1"));
+    if (parameters.temperature <= 0.0)
+        throw std::invalid_argument(bias_error(*this, "temperature must be > 0"));
+    if (parameters.min >= parameters.max)
+        throw std::invalid_argument(bias_error(*this, "min must be below max"));
+    if (parameters.bins == 0)
+        throw std::invalid_argument(bias_error(*this, "bins must be > 0"));
+
+    _spacing = (parameters.max - parameters.min) / static_cast<double>(parameters.bins);
+    _bias.assign(parameters.bins + 1, 0.0);
+    _derivative.assign(parameters.bins + 1, 0.0);
+}
+
+double Metadynamics::evaluate(double s, double & derivative) const
+{
+    derivative = 0.0;
+    if (s < _parameters.min or s > _parameters.max)
+        return 0.0;
+
+    const size_t i = std::min(static_cast<size_t>((s - _parameters.min) / _spacing), _parameters.bins - 1);
+    const double t = (s - getGridPoint(i)) / _spacing;
+    derivative = (1.0 - t) * _derivative[i] + t * _derivative[i + 1];
+    return (1.0 - t) * _bias[i] + t * _bias[i + 1];
+}
+
+void Metadynamics::update(double s, size_t step)
+{
+    if (step % _parameters.pace == 0)
+        deposit(s);
+}
+
+void Metadynamics::deposit(double s)
+{
+    double derivative;
+    const double deltaT = _parameters.temperature * (_parameters.biasfactor - 1.0);
+    const double height = _parameters.height * std::exp(-evaluate(s, derivative) / (BOLTZMANN_KJ_PER_MOL * deltaT));
+    const double variance = _parameters.sigma * _parameters.sigma;
+
+    for (size_t i = 0; i < _bias.size(); ++i)
+    {
+        const double delta = getGridPoint(i) - s;
+        const double gaussian = height * std::exp(-0.5 * delta * delta / variance);
+        _bias[i] += gaussian;
+        _derivative[i] -= gaussian * delta / variance;
+    }
+    ++_hills;
+}
+
+std::vector<double> Metadynamics::getFreeEnergy() const
+{
+    const double factor = -_parameters.biasfactor / (_parameters.biasfactor - 1.0);
+    std::vector<double> free_energy(_bias.size());
+    std::transform(_bias.begin(), _bias.end(), free_energy.begin(), [factor](double v) { return factor * v; });
+    const double minimum = *std::min_element(free_energy.begin(), free_energy.end());
+    for (double & f : free_energy)
+        f -= minimum;
+    return free_energy;
+}
+
+void Metadynamics::finish()
+{
+    if (not _parameters.path.empty())
+        write(_parameters.path);
+}
+
+void Metadynamics::write(const std::string & path) const
+{
+    std::ofstream os(path, std::ios::trunc);
+    if (not os)
+        throw std::runtime_error("cannot open metadynamics output file '" + path + "'");
+
+    const std::vector<double> free_energy = getFreeEnergy();
+    os << "# " << _variable.getName() << " bias free_energy (kJ/mol), " << _hills << " hills\n";
+    for (size_t i = 0; i < _bias.size(); ++i)
+        os << getGridPoint(i) << " " << _bias[i] << " " << free_energy[i] << "\n";
+    logging::info("Metadynamics profile of '%s' written to '%s'.", _variable.getName().c_str(), path.c_str());
+}
+
+} // namespace cv
+} // namespace biospring
@@ -0,0 +1,120 @@
+#ifndef __BIAS_H__
+#define __BIAS_H__
+
+#include "CollectiveVariable.h"
+
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace cv
+{
+
+// A biasing potential acting on one collective variable. Energies are in kJ/mol.
+class Bias
+{
+  public:
+    explicit Bias(const CollectiveVariable & variable) : _variable(variable) {}
+    virtual ~Bias() = default;
+
+    virtual std::string getType() const = 0;
+    const CollectiveVariable & getVariable() const { return _variable; }
+
+    // Returns the bias energy at `s` and sets `derivative` to dE/ds.
+    virtual double evaluate(double s, double & derivative) const = 0;
+
+    // Called once per step, after the forces have been applied, for history-dependent biases.
+    virtual void update(double /* s */, size_t /* step */) {}
+
+    // Called at the end of the run.
+    virtual void finish() {}
+
+  protected:
+    const CollectiveVariable & _variable;
+};
+
+// Harmonic restraint 1/2 k (s - center)², e.g. one window of an umbrella sampling.
+class Umbrella : public Bias
+{
+  public:
+    Umbrella(const CollectiveVariable & variable, double center, double k);
+    std::string getType() const override { return "umbrella"; }
+    double evaluate(double s, double & derivative) const override;
+
+  protected:
+    double _center;
+    double _k;
+};
+
+// Flat-bottom harmonic restraint: zero between `lower` and `upper`, 1/2 k d² beyond,
+// d being the distance to the crossed wall.
+class HarmonicWall : public Bias
+{
+  public:
+    HarmonicWall(const CollectiveVariable & variable, double lower, double upper, double k);
+    std::string getType() const override { return "wall"; }
+    double evaluate(double s, double & derivative) const override;
+
+  protected:
+    double _lower;
+    double _upper;
+    double _k;
+};
+
+// Well-tempered metadynamics on a one-dimensional grid.
+//
+// Every `pace` steps a gaussian of width `sigma` is added to the bias, with a height scaled
+// by exp(-V(s) / (kB ΔT)), ΔT = T (γ - 1), γ being the bias factor. The bias and its
+// derivative are kept on `bins` intervals between `min` and `max`, and interpolated linearly;
+// outside of [min, max] the bias is zero.
+//
+// The free energy profile is -γ / (γ - 1) V(s). It is written to `path` at the end of the run,
+// if a path was given.
+class Metadynamics : public Bias
+{
+  public:
+    struct Parameters
+    {
+        double height = 1.0;        // initial gaussian height, in kJ/mol
+        double sigma = 0.1;         // gaussian width, in CV units
+        size_t pace = 500;          // deposition period, in steps
+        double biasfactor = 10.0;   // γ
+        double temperature = 300.0; // in K
+        double min = 0.0;
+        double max = 1.0;
+        size_t bins = 100;
+        std::string path;
+    };
+
+    Metadynamics(const CollectiveVariable & variable, const Parameters & parameters);
+    std::string getType() const override { return "metadynamics"; }
+    double evaluate(double s, double & derivative) const override;
+    void update(double s, size_t step) override;
+    void finish() override;
+
+    // Adds a gaussian centred on `s`, tempered by the current bias.
+    void deposit(double s);
+
+    const Parameters & getParameters() const { return _parameters; }
+    size_t getNumberOfHills() const { return _hills; }
+    double getGridPoint(size_t i) const { return _parameters.min + static_cast<double>(i) * _spacing; }
+    const std::vector<double> & getBias() const { return _bias; }
+
+    // Free energy at each grid point, shifted so that its minimum is zero.
+    std::vector<double> getFreeEnergy() const;
+
+    void write(const std::string & path) const;
+
+  protected:
+    Parameters _parameters;
+    double _spacing;
+    size_t _hills;
+    std::vector<double> _bias;       // V at each grid point
+    std::vector<double> _derivative; // dV/ds at each grid point
+};
+
+} // namespace cv
+} // namespace biospring
+
+#endif // __BIAS_H__
@@ -0,0 +1,228 @@
+#include "CollectiveVariable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace biospring
+{
+namespace cv
+{
+
+static std::array<double, 3> position(const spn::Particle & p)
+{
+    const Vector3f & r = p.getPosition();
+    return {r.getX(), r.getY(), r.getZ()};
+}
+
+static std::vector<size_t> sorted_group(const std::string & name, std::vector<size_t> group)
+{
+    std::sort(group.begin(), group.end());
+    group.erase(std::unique(group.begin(), group.end()), group.end());
+    if (group.empty())
+        throw std::invalid_argument("collective variable '" + name + "': empty group");
+    return group;
+}
+
+// ======================================================================================
+//
+// Distance.
+//
+// ======================================================================================
+
+Distance::Distance(const std::string & name, size_t i, size_t j) : CollectiveVariable(name, {i, j})
+{
+    if (i == j)
+        throw std::invalid_argument("collective variable '" + name + "': distance between a particle and itself");
+}
+
+void Distance::compute(const std::vector<spn::Particle> & particles)
+{
+    const std::array<double, 3> ri = position(particles[_particles[0]]);
+    const std::array<double, 3> rj = position(particles[_particles[1]]);
+    const std::array<double, 3> rij = {rj[0] - ri[0], rj[1] - ri[1], rj[2] - ri[2]};
+
+    _value = std::sqrt(rij[0] * rij[0] + rij[1] * rij[1] + rij[2] * rij[2]);
+    const double inverse = _value > 0.0 ? 1.0 / _value : 0.0;
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        _gradient[0][axis] = -rij[axis] * inverse;
+        _gradient[1][axis] = rij[axis] * inverse;
+    }
+}
+
+// ======================================================================================
+//
+// Angle.
+//
+// ======================================================================================
+
+Angle::Angle(const std::string & name, size_t i, size_t j, size_t k) : CollectiveVariable(name, {i, j, k})
+{
+    if (i == j or j == k or i == k)
+        throw std::invalid_argument("collective variable '" + name + "': angle between non distinct particles");
+}
+
+void Angle::compute(const std::vector<spn::Particle> & particles)
+{
+    constexpr double degrees = 180.0 / M_PI;
+
+    const std::array<double, 3> ri = position(particles[_particles[0]]);
+    const std::array<double, 3> rj = position(particles[_particles[1]]);
+    const std::array<double, 3> rk = position(particles[_particles[2]]);
+    const std::array<double, 3> a = {ri[0] - rj[0], ri[1] - rj[1], ri[2] - rj[2]};
+    const std::array<double, 3> b = {rk[0] - rj[0], rk[1] - rj[1], rk[2] - rj[2]};
+
+    const double na = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    const double nb = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+    double cosine = na > 0.0 and nb > 0.0 ? (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / (na * nb) : 1.0;
+    cosine = std::clamp(cosine, -1.0, 1.0);
+    _value = std::acos(cosine) * degrees;
+
+    // The gradient is undefined for flat angles: no force is applied there.
+    const double sine = std::sqrt(1.0 - cosine * cosine);
+    if (sine < 1e-8)
+    {
+        std::fill(_gradient.begin(), _gradient.end(), std::array<double, 3>{0.0, 0.0, 0.0});
+        return;
+    }
+
+    const double factor = -degrees / sine;
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        _gradient[0][axis] = factor * (b[axis] / (na * nb) - cosine * a[axis] / (na * na));
+        _gradient[2][axis] = factor * (a[axis] / (na * nb) - cosine * b[axis] / (nb * nb));
+        _gradient[1][axis] = -_gradient[0][axis] - _gradient[2][axis];
+    }
+}
+
+// ======================================================================================
+//
+// CentroidDistance.
+//
+// ======================================================================================
+
+CentroidDistance::CentroidDistance(const std::string & name, const std::vector<size_t> & group1,
+                                   const std::vector<size_t> & group2)
+    : CollectiveVariable(name, {})
+{
+    const std::vector<size_t> first = sorted_group(name, group1);
+    const std::vector<size_t> second = sorted_group(name, group2);
+    std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(_particles));
+
+    _gradient.resize(_particles.size());
+    _weights1.assign(_particles.size(), 0.0);
+    _weights2.assign(_particles.size(), 0.0);
+    for (size_t n = 0; n < _particles.size(); ++n)
+    {
+        if (std::binary_search(first.begin(), first.end(), _particles[n]))
+            _weights1[n] = 1.0 / static_cast<double>(first.size());
+        if (std::binary_search(second.begin(), second.end(), _particles[n]))
+            _weights2[n] = 1.0 / static_cast<double>(second.size());
+    }
+}
+
+void CentroidDistance::compute(const std::vector<spn::Particle> & particles)
+{
+    double x = 0.0, y = 0.0, z = 0.0;
+
+    const long size = static_cast<long>(_particles.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for reduction(+ : x, y, z) schedule(static)
+#endif
+    for (long n = 0; n < size; ++n)
+    {
+        const std::array<double, 3> r = position(particles[_particles[n]]);
+        const double w = _weights2[n] - _weights1[n];
+        x += w * r[0];
+        y += w * r[1];
+        z += w * r[2];
+    }
+
+    // (x, y, z) is the vector from the first centroid to the second.
+    _value = std::sqrt(x * x + y * y + z * z);
+    const double inverse = _value > 0.0 ? 1.0 / _value : 0.0;
+    const std::array<double, 3> u = {x * inverse, y * inverse, z * inverse};
+    for (size_t n = 0; n < _particles.size(); ++n)
+    {
+        const double w = _weights2[n] - _weights1[n];
+        _gradient[n] = {w * u[0], w * u[1], w * u[2]};
+    }
+}
+
+// ======================================================================================
+//
+// Depth.
+//
+// ======================================================================================
+
+Depth::Depth(const std::string & name, const std::vector<size_t> & group)
+    : CollectiveVariable(name, sorted_group(name, group))
+{
+    const double w = 1.0 / static_cast<double>(_particles.size());
+    std::fill(_gradient.begin(), _gradient.end(), std::array<double, 3>{0.0, 0.0, w});
+}
+
+void Depth::compute(const std::vector<spn::Particle> & particles)
+{
+    double z = 0.0;
+
+    const long size = static_cast<long>(_particles.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for reduction(+ : z) schedule(static)
+#endif
+    for (long n = 0; n < size; ++n)
+        z += particles[_particles[n]].getPosition().getZ();
+
+    _value = z / static_cast<double>(size);
+}
+
+// ======================================================================================
+//
+// RMSD.
+//
+// ======================================================================================
+
+RMSD::RMSD(const std::string & name, const std::vector<size_t> & group, const std::vector<spn::Particle> & reference)
+    : CollectiveVariable(name, sorted_group(name, group))
+{
+    if (_particles.back() >= reference.size())
+        throw std::invalid_argument("collective variable '" + name + "': no reference position for particle " +
+                                    std::to_string(_particles.back()));
+    _reference.reserve(_particles.size());
+    for (const size_t index : _particles)
+        _reference.push_back(position(reference[index]));
+}
+
+void RMSD::compute(const std::vector<spn::Particle> & particles)
+{
+    double sum = 0.0;
+
+    const long size = static_cast<long>(_particles.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for reduction(+ : sum) schedule(static)
+#endif
+    for (long n = 0; n < size; ++n)
+    {
+        const std::array<double, 3> r = position(particles[_particles[n]]);
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            const double delta = r[axis] - _reference[n][axis];
+            sum += delta * delta;
+        }
+    }
+
+    _value = std::sqrt(sum / static_cast<double>(size));
+
+    // d(rmsd)/dr = (r - r0) / (N rmsd), undefined at the reference itself.
+    const double factor = _value > 0.0 ? 1.0 / (static_cast<double>(size) * _value) : 0.0;
+    for (long n = 0; n < size; ++n)
+    {
+        const std::array<double, 3> r = position(particles[_particles[n]]);
+        for (size_t axis = 0; axis < 3; ++axis)
+            _gradient[n][axis] = factor * (r[axis] - _reference[n][axis]);
+    }
+}
+
+} // namespace cv
+} // namespace biospring
@@ -0,0 +1,101 @@
+#ifndef __COLLECTIVE_VARIABLE_H__
+#define __COLLECTIVE_VARIABLE_H__
+
+#include "Particle.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace cv
+{
+
+// A collective variable: a function of the particle positions, computed with its gradient.
+//
+// The gradient has one entry per particle of getParticles() (each particle appears once), so
+// that a bias force can be scattered to the particles without conflicts.
+class CollectiveVariable
+{
+  public:
+    CollectiveVariable(const std::string & name, std::vector<size_t> particles)
+        : _name(name), _particles(std::move(particles)), _value(0.0), _gradient(_particles.size())
+    {
+    }
+    virtual ~CollectiveVariable() = default;
+
+    const std::string & getName() const { return _name; }
+    virtual std::string getType() const = 0;
+
+    // Computes the value and the gradient from the current positions.
+    virtual void compute(const std::vector<spn::Particle> & particles) = 0;
+
+    double getValue() const { return _value; }
+    const std::vector<size_t> & getParticles() const { return _particles; }
+    const std::vector<std::array<double, 3>> & getGradient() const { return _gradient; }
+
+  protected:
+    std::string _name;
+    std::vector<size_t> _particles;
+    double _value;
+    std::vector<std::array<double, 3>> _gradient;
+};
+
+// Distance between two particles (Å).
+class Distance : public CollectiveVariable
+{
+  public:
+    Distance(const std::string & name, size_t i, size_t j);
+    std::string getType() const override { return "distance"; }
+    void compute(const std::vector<spn::Particle> & particles) override;
+};
+
+// Angle i-j-k, at particle j (degrees).
+class Angle : public CollectiveVariable
+{
+  public:
+    Angle(const std::string & name, size_t i, size_t j, size_t k);
+    std::string getType() const override { return "angle"; }
+    void compute(const std::vector<spn::Particle> & particles) override;
+};
+
+// Distance between the centroids of two groups of particles (Å). The groups may overlap.
+class CentroidDistance : public CollectiveVariable
+{
+  public:
+    CentroidDistance(const std::string & name, const std::vector<size_t> & group1, const std::vector<size_t> & group2);
+    std::string getType() const override { return "centroiddistance"; }
+    void compute(const std::vector<spn::Particle> & particles) override;
+
+  protected:
+    // Weight of each particle in the centroid of each group (0 if not in the group).
+    std::vector<double> _weights1, _weights2;
+};
+
+// Insertion depth of a group: z of its centroid (Å), the membrane centre being at z = 0.
+class Depth : public CollectiveVariable
+{
+  public:
+    Depth(const std::string & name, const std::vector<size_t> & group);
+    std::string getType() const override { return "depth"; }
+    void compute(const std::vector<spn::Particle> & particles) override;
+};
+
+// RMSD of a group to reference positions, without superposition (Å).
+class RMSD : public CollectiveVariable
+{
+  public:
+    // `reference` holds the reference particles, indexed as the simulated ones.
+    RMSD(const std::string & name, const std::vector<size_t> & group, const std::vector<spn::Particle> & reference);
+    std::string getType() const override { return "rmsd"; }
+    void compute(const std::vector<spn::Particle> & particles) override;
+
+  protected:
+    std::vector<std::array<double, 3>> _reference;
+};
+
+} // namespace cv
+} // namespace biospring
+
+#endif // __COLLECTIVE_VARIABLE_H__
@@ -0,0 +1,344 @@
+#include "Colvars.h"
+
+#include "forcefield/constants.hpp"
+#include "utils/string.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace biospring
+{
+namespace cv
+{
+
+// ======================================================================================
+//
+// Definition file parsing.
+//
+// ======================================================================================
+
+template <typename T> static T parse_number(const std::string & s)
+{
+    std::istringstream iss(s);
+    T value;
+    if ((iss >> value).fail() or not iss.eof())
+        throw std::invalid_argument("invalid number '" + s + "'");
+    return value;
+}
+
+static size_t parse_index(const std::string & s, size_t size)
+{
+    if (s.empty() or s.front() == '-')
+        throw std::invalid_argument("invalid particle index '" + s + "'");
+    const size_t index = parse_number<size_t>(s);
+    if (index >= size)
+        throw std::invalid_argument("particle index " + s + " out of range (" + std::to_string(size) + " particles)");
+    return index;
+}
+
+// Parses "0-49,60" into {0, ..., 49, 60}, or "@name" into the particles of a selection.
+static std::vector<size_t> parse_group(const std::string & s, size_t size, const Colvars::Selections & selections)
+{
+    if (s.size() > 1 and s[0] == '@')
+    {
+        const std::vector<size_t> * selection = selections ? selections(s.substr(1)) : nullptr;
+        if (selection == nullptr)
+            throw std::invalid_argument("unknown selection '" + s.substr(1) + "'");
+        return *selection;
+    }
+
+    std::vector<size_t> group;
+    for (const std::string & token : utils::string::split(s, ","))
+    {
+        const std::vector<std::string> range = utils::string::split(token, "-");
+        if (range.size() == 1)
+            group.push_back(parse_index(range[0], size));
+        else if (range.size() == 2)
+        {
+            const size_t first = parse_index(range[0], size);
+            const size_t last = parse_index(range[1], size);
+            if (first > last)
+                throw std::invalid_argument("invalid range '" + token + "'");
+            for (size_t i = first; i <= last; ++i)
+                group.push_back(i);
+        }
+        else
+            throw std::invalid_argument("invalid range '" + token + "'");
+    }
+    return group;
+}
+
+// Parses "key=value" tokens, checking that each key is known.
+static std::map<std::string, std::string> parse_options(const std::vector<std::string> & tokens, size_t first,
+                                                        const std::vector<std::string> & known)
+{
+    std::map<std::string, std::string> options;
+    for (size_t i = first; i < tokens.size(); ++i)
+    {
+        const size_t equal = tokens[i].find('=');
+        if (equal == std::string::npos)
+            throw std::invalid_argument("expected key=value, got '" + tokens[i] + "'");
+        const std::string key = tokens[i].substr(0, equal);
+        if (std::find(known.begin(), known.end(), key) == known.end())
+            throw std::invalid_argument("unknown option '" + key + "'");
+        options[key] = tokens[i].substr(equal + 1);
+    }
+    return options;
+}
+
+template <typename T>
+static T option(const std::map<std::string, std::string> & options, const std::string & key, const T & fallback)
+{
+    const auto it = options.find(key);
+    return it == options.end() ? fallback : parse_number<T>(it->second);
+}
+
+static double required_option(const std::map<std::string, std::string> & options, const std::string & key)
+{
+    const auto it = options.find(key);
+    if (it == options.end())
+        throw std::invalid_argument("missing option '" + key + "'");
+    return parse_number<double>(it->second);
+}
+
+static void expect_arguments(const std::vector<std::string> & tokens, size_t count, const std::string & usage)
+{
+    if (tokens.size() != count)
+        throw std::invalid_argument("usage: " + usage);
+}
+
+static std::unique_ptr<CollectiveVariable> parse_variable(const std::vector<std::string> & tokens,
+                                                          const std::vector<spn::Particle> & reference,
+                                                          const Colvars::Selections & selections)
+{
+    if (tokens.size() < 3)
+        throw std::invalid_argument("usage: cv <name> <type> <arguments>");
+    const std::string & name = tokens[1];
+    const std::string & type = tokens[2];
+    const size_t size = reference.size();
+
+    if (type == "distance")
+    {
+        expect_arguments(tokens, 5, "cv <name> distance <i> <j>");
+        return std::make_unique<Distance>(name, parse_index(tokens[3], size), parse_index(tokens[4], size));
+    }
+    if (type == "angle")
+    {
+        expect_arguments(tokens, 6, "cv <name> angle <i> <j> <k>");
+        return std::make_unique<Angle>(name, parse_index(tokens[3], size), parse_index(tokens[4], size),
+                                       parse_index(tokens[5], size));
+    }
+    if (type == "centroiddistance")
+    {
+        expect_arguments(tokens, 5, "cv <name> centroiddistance <group> <group>");
+        return std::make_unique<CentroidDistance>(name, parse_group(tokens[3], size, selections),
+                                                  parse_group(tokens[4], size, selections));
+    }
+    if (type == "depth")
+    {
+        expect_arguments(tokens, 4, "cv <name> depth <group>");
+        return std::make_unique<Depth>(name, parse_group(tokens[3], size, selections));
+    }
+    if (type == "rmsd")
+    {
+        expect_arguments(tokens, 4, "cv <name> rmsd <group>");
+        return std::make_unique<RMSD>(name, parse_group(tokens[3], size, selections), reference);
+    }
+    throw std::invalid_argument("unknown collective variable type '" + type + "'");
+}
+
+static std::unique_ptr<Bias> parse_bias(const std::vector<std::string> & tokens, const Colvars & colvars,
+                                        const Colvars::OutputPath & outputPath)
+{
+    if (tokens.size() < 3)
+        throw std::invalid_argument("usage: bias <type> <cv> <options>");
+    const std::string & type = tokens[1];
+    const CollectiveVariable & variable = colvars.getVariable(tokens[2]);
+
+    if (type == "umbrella")
+    {
+        const auto options = parse_options(tokens, 3, {"center", "k"});
+        return std::make_unique<Umbrella>(variable, required_option(options, "center"), required_option(options, "k"));
+    }
+    if (type == "wall")
+    {
+        const auto options = parse_options(tokens, 3, {"lower", "upper", "k"});
+        return std::make_unique<HarmonicWall>(variable,
+                                              option(options, "lower", std::numeric_limits<double>::lowest()),
+                                              option(options, "upper", std::numeric_limits<double>::max()),
+                                              required_option(options, "k"));
+    }
+    if (type == "metadynamics")
+    {
+        const auto options = parse_options(
+            tokens, 3, {"height", "sigma", "pace", "biasfactor", "temperature", "min", "max", "bins", "path"});
+        Metadynamics::Parameters parameters;
+        parameters.height = option(options, "height", parameters.height);
+        parameters.sigma = option(options, "sigma", parameters.sigma);
+        parameters.pace = option(options, "pace", parameters.pace);
+        parameters.biasfactor = option(options, "biasfactor", parameters.biasfactor);
+        parameters.temperature = option(options, "temperature", parameters.temperature);
+        parameters.min = required_option(options, "min");
+        parameters.max = required_option(options, "max");
+        parameters.bins = option(options, "bins", parameters.bins);
+        if (options.count("path"))
+            parameters.path = outputPath ? outputPath(options.at("path")) : options.at("path");
+        return std::make_unique<Metadynamics>(variable, parameters);
+    }
+    throw std::invalid_argument("unknown bias type '" + type + "'");
+}
+
+void Colvars::read(const std::string & path, const std::vector<spn::Particle> & reference,
+                   const Selections & selections, const OutputPath & outputPath)
+{
+    std::ifstream is(path);
+    if (not is)
+        throw std::runtime_error("cannot open collective variables file '" + path + "'");
+    read(is, reference, selections, outputPath);
+}
+
+void Colvars::read(std::istream & is, const std::vector<spn::Particle> & reference, const Selections & selections,
+                   const OutputPath & outputPath)
+{
+    std::string line;
+    size_t number = 0;
+    while (std::getline(is, line))
+    {
+        ++number;
+        const std::vector<std::string> tokens = utils::string::split(line.substr(0, line.find('#')));
+        if (tokens.empty())
+            continue;
+
+        try
+        {
+            if (tokens[0] == "cv")
+                addVariable(parse_variable(tokens, reference, selections));
+            else if (tokens[0] == "bias")
+                addBias(parse_bias(tokens, *this, outputPath));
+            else
+                throw std::invalid_argument("unknown keyword '" + tokens[0] + "'");
+        }
+        catch (const std::invalid_argument & e)
+        {
+            throw std::runtime_error("collective variables: line " + std::to_string(number) + ": " + e.what());
+        }
+    }
+}
+
+// ======================================================================================
+//
+// Engine.
+//
+// ======================================================================================
+
+CollectiveVariable & Colvars::addVariable(std::unique_ptr<CollectiveVariable> variable)
+{
+    for (const auto & other : _variables)
+        if (other->getName() == variable->getName())
+            throw std::invalid_argument("duplicate collective variable '" + variable->getName() + "'");
+    _variables.push_back(std::move(variable));
+    _derivatives.push_back(0.0);
+    return *_variables.back();
+}
+
+Bias & Colvars::addBias(std::unique_ptr<Bias> bias)
+{
+    const auto it = std::find_if(_variables.begin(), _variables.end(),
+                                 [&](const auto & variable) { return variable.get() == &bias->getVariable(); });
+    if (it == _variables.end())
+        throw std::invalid_argument("bias on an unknown collective variable");
+    _biasVariables.push_back(static_cast<size_t>(it - _variables.begin()));
+    _biases.push_back(std::move(bias));
+    return *_biases.back();
+}
+
+const CollectiveVariable & Colvars::getVariable(const std::string & name) const
+{
+    for (const auto & variable : _variables)
+        if (variable->getName() == name)
+            return *variable;
+    throw std::invalid_argument("unknown collective variable '" + name + "'");
+}
+
+void Colvars::openTrace(const std::string & path, size_t frequency)
+{
+    _trace.open(path, std::ios::trunc);
+    if (not _trace)
+        throw std::runtime_error("cannot open collective variables trace '" + path + "'");
+    _traceFrequency = frequency;
+
+    _trace << "# step";
+    for (const auto & variable : _variables)
+        _trace << " " << variable->getName();
+    _trace << " bias\n";
+}
+
+double Colvars::apply(std::vector<spn::Particle> & particles, size_t step)
+{
+    for (const auto & variable : _variables)
+        variable->compute(particles);
+
+    double energy = 0.0;
+    std::fill(_derivatives.begin(), _derivatives.end(), 0.0);
+    for (size_t b = 0; b < _biases.size(); ++b)
+    {
+        double derivative;
+        energy += _biases[b]->evaluate(_biases[b]->getVariable().getValue(), derivative);
+        _derivatives[_biasVariables[b]] += derivative;
+    }
+
+    for (size_t v = 0; v < _variables.size(); ++v)
+        if (_derivatives[v] != 0.0)
+            _scatter(*_variables[v], _derivatives[v], particles);
+
+    if (_trace.is_open() and _traceFrequency > 0 and step % _traceFrequency == 0)
+    {
+        _trace << step;
+        for (const auto & variable : _variables)
+            _trace << " " << variable->getValue();
+        _trace << " " << energy << "\n";
+    }
+
+    // History-dependent biases are updated once the forces of this step are applied.
+    for (const auto & bias : _biases)
+        bias->update(bias->getVariable().getValue(), step);
+
+    return energy;
+}
+
+// Adds -dE/ds ∇s to the particles of a variable. A particle appears once per variable, so that
+// the particles can be updated in parallel.
+void Colvars::_scatter(const CollectiveVariable & variable, double derivative,
+                       std::vector<spn::Particle> & particles) const
+{
+    const std::vector<size_t> & indexes = variable.getParticles();
+    const std::vector<std::array<double, 3>> & gradient = variable.getGradient();
+    const double scale = -derivative * forcefield::GLOBAL_SPRING_FORCE_CONVERT;
+
+    const long size = static_cast<long>(indexes.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(static)
+#endif
+    for (long n = 0; n < size; ++n)
+    {
+        // Static particles are never integrated nor reset: a force would pile up on them.
+        spn::Particle & p = particles[indexes[n]];
+        if (p.isDynamic())
+            p.addForce(Vector3f(static_cast<float>(scale * gradient[n][0]), static_cast<float>(scale * gradient[n][1]),
+                                static_cast<float>(scale * gradient[n][2])));
+    }
+}
+
+void Colvars::finish()
+{
+    for (const auto & bias : _biases)
+        bias->finish();
+    if (_trace.is_open())
+        _trace.flush();
+}
+
+} // namespace cv
+} // namespace biospring
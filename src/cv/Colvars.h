@@ -0,0 +1,90 @@
+#ifndef __COLVARS_H__
+#define __COLVARS_H__
+
+#include "Bias.h"
+#include "CollectiveVariable.h"
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace cv
+{
+
+// Collective variables and the biases acting on them (colvars.input).
+//
+// Each step, the variables are computed, the derivatives of the biases are summed per variable,
+// and the bias forces -dE/ds ∇s are added to the dynamic particles of each variable.
+//
+// Definitions are read from a text file, one per line ('#' starts a comment). Particles are
+// given by their index, groups as comma-separated indexes or ranges (e.g. "0-49,60"), or as
+// "@name" for the particles of a named selection, evaluated once:
+//
+//     cv <name> distance <i> <j>
+//     cv <name> angle <i> <j> <k>
+//     cv <name> centroiddistance <group> <group>
+//     cv <name> depth <group>
+//     cv <name> rmsd <group>
+//     bias umbrella <cv> center=<s> k=<kJ/mol/unit²>
+//     bias wall <cv> lower=<s> upper=<s> k=<kJ/mol/unit²>
+//     bias metadynamics <cv> height= sigma= pace= biasfactor= temperature= min= max= bins= [path=]
+class Colvars
+{
+  public:
+    // Returns the particles of a named selection, or nullptr if there is none.
+    // Throws std::invalid_argument if the selection cannot be used as a group.
+    using Selections = std::function<const std::vector<size_t> *(const std::string &)>;
+
+    // Returns the path an output file named in the definitions (metadynamics `path=`) is
+    // written to, e.g. with the replica number inserted.
+    using OutputPath = std::function<std::string(const std::string &)>;
+
+    // Reads definitions. `reference` holds the particles the indexes refer to, and the
+    // reference positions of the RMSD variables.
+    // Throws std::runtime_error on a syntax error, with the line number.
+    void read(const std::string & path, const std::vector<spn::Particle> & reference,
+              const Selections & selections = nullptr, const OutputPath & outputPath = nullptr);
+    void read(std::istream & is, const std::vector<spn::Particle> & reference, const Selections & selections = nullptr,
+              const OutputPath & outputPath = nullptr);
+
+    // Throws std::invalid_argument if a variable with the same name exists.
+    CollectiveVariable & addVariable(std::unique_ptr<CollectiveVariable> variable);
+    Bias & addBias(std::unique_ptr<Bias> bias);
+
+    // Throws std::invalid_argument if there is no such variable.
+    const CollectiveVariable & getVariable(const std::string & name) const;
+
+    const std::vector<std::unique_ptr<CollectiveVariable>> & getVariables() const { return _variables; }
+    const std::vector<std::unique_ptr<Bias>> & getBiases() const { return _biases; }
+    bool empty() const { return _variables.empty(); }
+
+    // Writes the step, the variables and the bias energy every `frequency` steps to `path`.
+    void openTrace(const std::string & path, size_t frequency);
+
+    // Computes the variables, adds the bias forces to the particles and returns the bias
+    // energy (kJ/mol).
+    double apply(std::vector<spn::Particle> & particles, size_t step);
+
+    // Ends the run: writes the metadynamics profiles.
+    void finish();
+
+  protected:
+    std::vector<std::unique_ptr<CollectiveVariable>> _variables;
+    std::vector<std::unique_ptr<Bias>> _biases;
+    std::vector<size_t> _biasVariables; // index of the variable of each bias
+    std::vector<double> _derivatives;   // dE/ds of each variable
+    std::ofstream _trace;
+    size_t _traceFrequency = 0;
+
+    void _scatter(const CollectiveVariable & variable, double derivative, std::vector<spn::Particle> & particles) const;
+};
+
+} // namespace cv
+} // namespace biospring
+
+#endif // __COLVARS_H__
@@ -20,6 +20,8 @@ class PotentialGrid : public DenseGrid<PotentialCell>
   public:
     static const double GRADIENT_SCALE;
 
+    using DenseGrid<PotentialCell>::DenseGrid;
+
     // Computes the gradient of each cell of the grid.
     void compute_gradient();
 };
@@ -1,7 +1,19 @@
 #include "interactor/Interactor.h"
 #include "SpringNetwork.h"
 
-Interactor::Interactor() : _springnetwork(nullptr), _nbpositions(0), _sleepDuration(1000), _isRunning(false) {}
+#include <algorithm>
+
+#ifdef OPENMP_SUPPORT
+#include <omp.h>
+#endif
+
+using biospring::utils::concurrency::SpscQueue;
+
+Interactor::Interactor()
+    : _springnetwork(nullptr), _nbpositions(0), _sleepDuration(1000), _stateFields(STATE_POSITIONS),
+      _externalForceQueue(std::make_unique<SpscQueue<ExternalForce>>()), _isRunning(false)
+{
+}
 
 Interactor::~Interactor()
 {
@@ -16,17 +28,163 @@ void Interactor::initializeSystemState()
     // MDDriver's IIMD_send_coords(const int *N, ...), a fixed external C ABI.
     if (_springnetwork != nullptr)
         _setNbPositions(static_cast<int>(_springnetwork->getNumberOfParticles()));
+
+    const size_t n = static_cast<size_t>(_nbpositions);
+    const bool properties = _stateFields & STATE_PARTICLE_PROPERTIES;
+    _state.for_each([&](SystemState & state) {
+        state.positions.assign(3 * n, 0.0f);
+        state.forces.assign(properties ? 3 * n : 0, 0.0f);
+        state.solventAccessibilities.assign(properties ? n : 0, 0.0f);
+        state.transferEnergies.assign(properties ? n : 0, 0.0f);
+    });
+
+    // Room for a few complete force frames (forces plus the CLEAR and END markers).
+    _externalForceQueue = std::make_unique<SpscQueue<ExternalForce>>(4 * (n + 2));
+    _externalForceFrame.clear();
+    if (_springnetwork != nullptr)
+        for (uint32_t index : _externalForceParticles)
+            _springnetwork->removeExternalForce(index, this);
+    _externalForceParticles.clear();
+
+    // The interactor thread always finds a complete state, even before the first step.
+    _publishSystemState();
+    acquireSystemState();
 }
 
 void Interactor::initializeDataManager() {}
 
 void Interactor::syncSystemStateData()
 {
-    if (_springnetwork != nullptr)
+    _publishSystemState();
+    _applyExternalForces();
+}
+
+void Interactor::_publishSystemState()
+{
+    if (_springnetwork == nullptr)
+        return;
+
+    SystemState & state = _state.back();
+
+    // The state buffers are sized once by initializeSystemState.
+    const size_t n = std::min(static_cast<size_t>(_springnetwork->getNumberOfParticles()), state.positions.size() / 3);
+    const bool properties = (_stateFields & STATE_PARTICLE_PROPERTIES) && state.transferEnergies.size() >= n;
+
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < n; ++i)
+    {
+        const biospring::spn::Particle & p = _springnetwork->getParticle(i);
+        const Vector3f & position = p.getPosition();
+        state.positions[3 * i] = position.getX();
+        state.positions[3 * i + 1] = position.getY();
+        state.positions[3 * i + 2] = position.getZ();
+
+        if (properties)
+        {
+            const Vector3f force = p.getPreviousForce();
+            state.forces[3 * i] = force.getX();
+            state.forces[3 * i + 1] = force.getY();
+            state.forces[3 * i + 2] = force.getZ();
+            state.solventAccessibilities[i] = p.getSolventAccessibilitySurface();
+            state.transferEnergies[i] = p.getTransferEnergyByAccessibleSurface();
+        }
+    }
+
+    const unsigned fields = _stateFields | _requestedStateFields.load(std::memory_order_relaxed);
+    state.step = static_cast<unsigned>(_springnetwork->getNbIterations());
+    state.fields = fields;
+    state.stericEnergy = _springnetwork->getStericEnergy();
+    state.electrostaticEnergy = _springnetwork->getElectrostaticEnergy();
+    state.springEnergy = _springnetwork->getSpringEnergy();
+    state.impEnergy = _springnetwork->getIMPEnergy();
+
+    // The centroid and the insertion vector are computed on demand, here on the main thread
+    // so that the interactor thread never does, and only once a client asked for them.
+    if (fields & STATE_CENTROID)
+        state.centroidZ = static_cast<float>(_springnetwork->getCentroid()[2]);
+    if ((fields & STATE_INSERTION_VECTOR) && _springnetwork->isInsertionVectorEnabled())
+    {
+        const InsertionVector & iv = _springnetwork->getInsertionVector();
+        state.insertionAngle = iv.getAngle();
+        state.insertionRollAngle = iv.getRollAngle();
+        state.insertionDepth = iv.getInsertionDepth();
+        state.insertionParticles[0] = iv.getParticle(0).getId();
+        state.insertionParticles[1] = iv.getParticle(1).getId();
+    }
+
+    _state.publish();
+}
+
+SystemState & Interactor::acquireSystemState()
+{
+    _state.acquire();
+    return _state.front();
+}
+
+bool Interactor::pushClearExternalForces() { return _externalForceQueue->push(ExternalForce()); }
+
+bool Interactor::pushExternalForce(uint32_t index, const float force[3])
+{
+    ExternalForce f;
+    f.index = index;
+    f.force[0] = force[0];
+    f.force[1] = force[1];
+    f.force[2] = force[2];
+    return _externalForceQueue->push(f);
+}
+
+bool Interactor::pushEndExternalForces()
+{
+    ExternalForce f;
+    f.index = ExternalForce::END;
+    return _externalForceQueue->push(f);
+}
+
+void Interactor::_applyExternalForces()
+{
+    // Frames are kept in the queue until there is a spring network to apply them to.
+    if (_springnetwork == nullptr)
+        return;
+
+    ExternalForce f;
+    while (_externalForceQueue->pop(f))
+    {
+        if (f.index == ExternalForce::END)
+        {
+            _applyExternalForceFrame(_externalForceFrame);
+            _externalForceFrame.clear();
+            continue;
+        }
+
+        // A new frame drops the incomplete one, if any (e.g. the queue was full).
+        if (f.index == ExternalForce::CLEAR)
+            _externalForceFrame.clear();
+        _externalForceFrame.push_back(f);
+    }
+}
+
+void Interactor::_applyExternalForceFrame(const std::vector<ExternalForce> & frame)
+{
+    const unsigned nparticles = _springnetwork->getNumberOfParticles();
+    for (const ExternalForce & f : frame)
     {
-        const unsigned nbparticles = _springnetwork->getNumberOfParticles();
-        for (unsigned j = 0; j < nbparticles; ++j)
-            syncParticleStateData(j);
+        if (f.index == ExternalForce::CLEAR)
+        {
+            for (uint32_t index : _externalForceParticles)
+                _springnetwork->removeExternalForce(index, this);
+            _externalForceParticles.clear();
+        }
+        else if (f.index < nparticles)
+        {
+            // The last force sent for a particle wins.
+            _springnetwork->setExternalForce(f.index, Vector3f(f.force[0], f.force[1], f.force[2]),
+                                             biospring::spn::SpringNetwork::NO_EXPIRY, this);
+            _externalForceParticles.insert(f.index);
+        }
+        else
+            BIOSPRING_WARN_ONCE("Interactor: external force on unknown particle %u ignored", f.index);
     }
 }
 
@@ -8,8 +8,11 @@
 #include <thread>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include "logging.h"
+#include "utils/concurrency.hpp"
+#include <cstdint>
 #include <memory>
 
 
@@ -21,9 +24,62 @@ class SpringNetwork;
 } // namespace spn
 } // namespace biospring
 
+// State of the system published by the main thread for interactor threads.
+//
+// Per-particle arrays are stored as structures of arrays, in particle order, so
+// that they can be sent as is. Optional arrays are empty unless the interactor
+// requested them (see `Interactor::STATE_PARTICLE_PROPERTIES`).
+struct SystemState
+{
+    unsigned step = 0;                           // iteration at which the state was published
+    unsigned fields = 0;                         // fields published (see `Interactor::StateFields`)
+    std::vector<float> positions;                // x, y, z for each particle
+    std::vector<float> forces;                   // x, y, z force of the previous step for each particle (optional)
+    std::vector<float> solventAccessibilities;   // optional
+    std::vector<float> transferEnergies;         // optional
+    float stericEnergy = 0.0f;
+    float electrostaticEnergy = 0.0f;
+    float springEnergy = 0.0f;
+    float impEnergy = 0.0f;
+    float centroidZ = 0.0f;                      // z of the centroid of the system (optional)
+
+    // Insertion vector (see InsertionVector), when enabled (optional).
+    float insertionAngle = 0.0f;
+    float insertionRollAngle = 0.0f;
+    float insertionDepth = 0.0f;
+    int insertionParticles[2] = {-1, -1};        // ids of the two particles defining it
+};
+
+// External force pushed by an interactor thread.
+//
+// Forces are sent as frames: a frame starts with a `CLEAR` marker, which removes
+// the forces of the previous frame, followed by the new forces and an `END`
+// marker. Only complete frames are applied: a frame is held back until its `END`
+// is received, and dropped if a new `CLEAR` arrives first. The forces are handed
+// to `SpringNetwork::setExternalForce` and applied at every step until the next
+// frame. A `CLEAR` only removes the forces still owned by the interactor:
+// a force set since by another source on the same particle is kept.
+struct ExternalForce
+{
+    static constexpr uint32_t CLEAR = UINT32_MAX;
+    static constexpr uint32_t END = UINT32_MAX - 1;
+
+    uint32_t index = CLEAR;
+    float force[3] = {0.0f, 0.0f, 0.0f};
+};
+
 class Interactor
 {
   public:
+    // Fields of the `SystemState` published at each step.
+    enum StateFields : unsigned
+    {
+        STATE_POSITIONS = 1,
+        STATE_PARTICLE_PROPERTIES = 2, // forces, solvent accessibilities and transfer energies
+        STATE_CENTROID = 4,            // z of the centroid
+        STATE_INSERTION_VECTOR = 8,    // insertion vector, when enabled
+    };
+
     Interactor();
 
     virtual ~Interactor();
@@ -38,8 +94,31 @@ class Interactor
 	virtual bool continueInteractionThread() = 0;
     virtual void stopInteractionThread() = 0;
 
+    // Called by the main thread at each step: publishes the system state for the
+    // interactor thread and applies the external forces it pushed.
     virtual void syncSystemStateData();
 
+    // Interactor thread side.
+    // Fetches the latest state published by the main thread and returns it. The
+    // returned state stays valid and unchanged until the next call.
+    SystemState & acquireSystemState();
+
+    // Returns the state returned by the last call to `acquireSystemState`.
+    SystemState & getSystemState() { return _state.front(); }
+
+    // Interactor thread side.
+    // Adds fields to the published state from the next step on, e.g. when a client first
+    // asks for them. The centroid and the insertion vector are only computed if requested.
+    void requestStateFields(unsigned fields) { _requestedStateFields.fetch_or(fields, std::memory_order_relaxed); }
+
+    // Interactor thread side.
+    // Starts a new frame of external forces, adds a force to the current frame, or
+    // ends the current frame, which is then applied at the next step.
+    // Returns false if the queue is full, in which case the entry is dropped.
+    bool pushClearExternalForces();
+    bool pushExternalForce(uint32_t index, const float force[3]);
+    bool pushEndExternalForces();
+
     template <typename T>
     static T* getInteractorInstance(const std::vector<Interactor*>& interactors)
     {
@@ -60,6 +139,32 @@ class Interactor
 
     unsigned int _sleepDuration;
 
+    // Fields published in `_state` (see `StateFields`): always, and on request.
+    unsigned _stateFields;
+    std::atomic<unsigned> _requestedStateFields{0};
+
+    // State exchanged with the interactor thread: written by the main thread,
+    // read by the interactor thread.
+    biospring::utils::concurrency::TripleBuffer<SystemState> _state;
+
+    // External forces sent by the interactor thread to the main thread.
+    std::unique_ptr<biospring::utils::concurrency::SpscQueue<ExternalForce>> _externalForceQueue;
+
+    // Frame being received from the queue, applied once complete. Only used by the main thread.
+    std::vector<ExternalForce> _externalForceFrame;
+
+    // Particles forced by the current frame. Only used by the main thread.
+    std::unordered_set<uint32_t> _externalForceParticles;
+
+    // Copies the system into the back buffer of `_state` and publishes it.
+    void _publishSystemState();
+
+    // Drains `_externalForceQueue` and applies its complete frames to the spring network.
+    void _applyExternalForces();
+
+    // Applies a complete frame to the external forces of the spring network.
+    void _applyExternalForceFrame(const std::vector<ExternalForce> & frame);
+
     template <typename T>
     struct DataArray
     {
@@ -179,12 +284,13 @@ class Interactor
     };
 
 
+    // Sizes the state buffers and the external force queue, and publishes the
+    // initial state. Must be called by the main thread before the interactor
+    // thread starts.
     virtual void initializeSystemState();
 
     virtual void initializeDataManager();
 
-    virtual void syncParticleStateData(unsigned index) = 0;
-
     std::thread _thread;
     std::mutex mutex;
     std::atomic_bool _isRunning;
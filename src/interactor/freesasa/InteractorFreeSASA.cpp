@@ -1,4 +1,5 @@
 #ifdef FREESASA_SUPPORT
+#include <algorithm>
 #include <iostream>
 #include <stdlib.h>
 #include <string.h>
@@ -15,13 +16,14 @@ namespace biospring
 namespace interactor
 {
 
-InteractorFreeSASA::InteractorFreeSASA() : _sasaValid(false)
+InteractorFreeSASA::InteractorFreeSASA() : _total(0.0)
 {
 	// https://freesasa.github.io/doxygen/group__core.html
 	_freeSASA_alg = "lr";
 	_proberadius = 1.4;
 	_lr_n = 20;
 	_sr_n = 100;
+	_threshold = 0.1f;
 	_radiiclassifier = "default_classifier";
 	_nthreads = 1;
 	_isDynamic = false;
@@ -37,17 +39,17 @@ void InteractorFreeSASA::startInteractionThread()
 
 void InteractorFreeSASA::initializeSystemState()
 {
-	Interactor::initializeSystemState(); // Set _nbpositions int defined in Interactor.
+	Interactor::initializeSystemState(); // Set _nbpositions int defined in Interactor and publishes positions.
 
 	// Sized here, on the main thread, before Interactor::startInteractionThread()
-	// spawns the worker: the buffer never has to grow while the worker writes it.
-	// _sasaValid is cleared on every start, not just at construction, because
+	// spawns the worker: the buffers never have to grow while the worker writes them.
+	// Results are dropped on every start, not just at construction, because
 	// startInteractionThread() waits for the previous thread and may be entered
 	// again with a different _nbpositions.
 	radii_array.resize(_nbpositions);
     coords_array.resize(_nbpositions * 3);
-	_sasa.assign(static_cast<size_t>(_nbpositions), 0.0);
-	_sasaValid.store(false, std::memory_order_release);
+	_results.acquire(); // drops a result left by a previous run
+	_results.for_each([&](Result & result) { result.sasa.assign(static_cast<size_t>(_nbpositions), 0.0); });
 
 	initializeDataManager();
 }
@@ -163,6 +165,13 @@ void InteractorFreeSASA::setupFreesasaInteractions()
 		}
 	}
 	// setRadii(radii_array);
+
+	if (getAlg() == "native")
+		_engine = std::make_unique<biospring::sasa::ShrakeRupley>(radii_array, getProbeRad(), get_sr_n(), getThreshold(),
+		                                                          getNthreads());
+	else
+		_engine.reset();
+
 	_isRunning.store(true, std::memory_order_release);
 }
 
@@ -170,16 +179,27 @@ void InteractorFreeSASA::processFreesasaInteractions()
 {
     // double coords_array[_nbpositions * 3];
 
-	for (int i = 0; i < _nbpositions; ++i)
+	// Positions published by the main thread.
+	const std::vector<float> & positions = acquireSystemState().positions;
+
+	// The native engine only recomputes the particles whose neighborhood changed.
+	if (_engine)
 	{
-		biospring::spn::Particle & p = getSpringNetwork()->getParticle(i);
+		_engine->compute(positions);
+
+		Result & published = _results.back();
+		std::copy(_engine->areas().begin(), _engine->areas().end(), published.sasa.begin());
+		published.total = _engine->total();
+		_results.publish();
 
-		Vector3f c = p.getPosition();
-		coords_array[i * 3] = c.getX();       // Store the X coordinate
-		coords_array[i * 3 + 1] = c.getY();   // Store the Y coordinate
-		coords_array[i * 3 + 2] = c.getZ();   // Store the Z coordinate
+		if (!isDynamic())
+			stopInteractionThread();
+		return;
 	}
 
+	for (size_t i = 0; i < positions.size() && i < coords_array.size(); ++i)
+		coords_array[i] = positions[i];
+
     freesasa_result * result = nullptr;
     freesasa_parameters * param = getParams();
     // param.alg = FREESASA_SHRAKE_RUPLEY;
@@ -191,7 +211,7 @@ void InteractorFreeSASA::processFreesasaInteractions()
 
 	// freesasa_calc_coord returns NULL on allocation failure or invalid input.
 	// Reading result->sasa in that case dereferences a null pointer, so keep
-	// every use of `result` inside this branch and leave _sasa untouched: the
+	// every use of `result` inside this branch and publish nothing: the
 	// previous areas, if any, stay valid and a later pass can still succeed.
 	if (result == NULL)
 	{
@@ -199,17 +219,18 @@ void InteractorFreeSASA::processFreesasaInteractions()
 		return;
 	}
 
+	Result & published = _results.back();
 	for (int i = 0; i < _nbpositions; ++i)
 	{
-		_sasa[static_cast<size_t>(i)] = result->sasa[i];
+		published.sasa[static_cast<size_t>(i)] = result->sasa[i];
 	}
 
-	// logging::info("New total sasa : %f", _total);
-	_total = result->total;
+	// logging::info("New total sasa : %f", result->total);
+	published.total = result->total;
     freesasa_result_free(result);
 
-	// Publishes _sasa to the main thread, which reads it in syncParticleStateData.
-	_sasaValid.store(true, std::memory_order_release);
+	// Publishes the areas to the main thread, which applies them in syncSystemStateData.
+	_results.publish();
 
 	if (!isDynamic())
 		stopInteractionThread();
@@ -220,33 +241,25 @@ void InteractorFreeSASA::syncSystemStateData()
 	Interactor::syncSystemStateData();
 	if(_springnetwork!=NULL)
 	{
+		// The main thread's first idleRun -> syncSystemStateData can run before
+		// the worker has computed anything. Nothing is published then, and the
+		// surfaces are left untouched rather than set to 0, which would silently
+		// zero the IMPALA energy and force (surface is a multiplicative factor
+		// there) for the first frames.
+		if (_results.acquire())
+		{
+			const Result & result = _results.front();
+			const size_t n = std::min(result.sasa.size(), static_cast<size_t>(_springnetwork->getNumberOfParticles()));
+			for (size_t i = 0; i < n; ++i)
+				_springnetwork->getParticle(i).setSolventAccessibilitySurface(result.sasa[i]);
+			_total = result.total;
+		}
 		_springnetwork->setSASATotal(_total);
 		_springnetwork->isFreeSASADynamic(_isDynamic);
 	}
 
 }
 
-// Update the `_solventaccessibilitysurface` of the given particle
-// based on FreeSASA-related computations.
-void InteractorFreeSASA::syncParticleStateData(unsigned index)
-{
-	// The areas are computed by the worker thread, but the main thread's first
-	// idleRun -> syncSystemStateData -> syncParticleStateData can run before that
-	// first computation completes -- _isRunning is already true by then, and
-	// nothing else gates this path. Do nothing until the areas exist rather than
-	// publish a surface of 0, which would silently zero the IMPALA energy and
-	// force (surface is a multiplicative factor there) for the first frames. A
-	// later idleRun applies the real areas once the worker has produced them.
-	if (!_sasaValid.load(std::memory_order_acquire))
-	{
-		BIOSPRING_WARN_ONCE("FreeSASA: solvent accessible surfaces are not computed yet, "
-		                    "skipping the update for this frame");
-		return;
-	}
-
-	getSpringNetwork()->getParticle(index).setSolventAccessibilitySurface(_sasa[index]);
-}
-
 } // namespace interactor
 } // namespace biospring
 
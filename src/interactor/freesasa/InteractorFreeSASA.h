@@ -6,11 +6,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "freesasa.h"
-#include <atomic>
 #include <string>
 #include <vector>
 
 #include "interactor/Interactor.h"
+#include "sasa.hpp"
+
+#include <memory>
 
 namespace biospring
 {
@@ -42,6 +44,10 @@ class InteractorFreeSASA : public Interactor
         inline void set_sr_n(unsigned sr_n) {_sr_n = sr_n;};
         inline unsigned get_sr_n() const { return _sr_n;};
 
+        // Displacement (in Å) above which a particle is recomputed by the native algorithm.
+        inline void setThreshold(float threshold) {_threshold = threshold;};
+        inline float getThreshold() const { return _threshold;};
+
         inline void setProbeRad(float probe_radius) {_proberadius = probe_radius;};
         inline float getProbeRad() const { return _proberadius;};
 
@@ -60,6 +66,7 @@ class InteractorFreeSASA : public Interactor
         // inline void setRadii(double* radii) {_radii = radii;};
         // inline double* getRadii() const { return _radii;};
 
+        // Total area of the last result applied to the system.
         inline float getSASA_total() { return _total;};
 
         virtual void startInteractionThread() override;
@@ -74,12 +81,17 @@ class InteractorFreeSASA : public Interactor
 
     protected : 
 
-        std::vector<double> _sasa;
+        // Areas computed by the worker thread.
+        struct Result
+        {
+            std::vector<double> sasa;
+            double total = 0.0;
+        };
 
-        // Whether _sasa holds areas computed by the worker thread. _isRunning
-        // is set by startInteractionThread() before the worker has produced
-        // anything, so it cannot be used to decide that _sasa is readable.
-        std::atomic<bool> _sasaValid;
+        // Results published by the worker thread to the main thread. Nothing is
+        // published before the first computation completes, which is what keeps
+        // the main thread from applying areas that do not exist yet.
+        biospring::utils::concurrency::TripleBuffer<Result> _results;
 
         bool _isDynamic;
         unsigned _step;
@@ -87,6 +99,7 @@ class InteractorFreeSASA : public Interactor
         unsigned _lr_n;
         unsigned _sr_n;
         double _proberadius;
+        float _threshold;
         std::string _radiiclassifier;
         int _nthreads;
         freesasa_parameters *_params;
@@ -95,7 +108,10 @@ class InteractorFreeSASA : public Interactor
         std::vector<double> radii_array;
         std::vector<double> coords_array;
 
-        double _total;
+        // Native incremental Shrake-Rupley engine, used by the "native" algorithm.
+        std::unique_ptr<biospring::sasa::ShrakeRupley> _engine;
+
+        double _total; // only used by the main thread
 
         virtual void setupInteraction() override { setupFreesasaInteractions(); }
         virtual void processInteractions() override { processFreesasaInteractions(); }
@@ -105,8 +121,6 @@ class InteractorFreeSASA : public Interactor
 
         virtual void initializeSystemState() override;
 
-        virtual void syncParticleStateData(unsigned index) override;
-
 
 };
 
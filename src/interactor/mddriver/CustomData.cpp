@@ -6,6 +6,7 @@
 
 #include "CustomData.h"
 #include "SpringNetwork.h"
+#include "logging.h"
 
 #include "rigidbody/RigidBodiesManager.h"
 
@@ -14,16 +15,13 @@ namespace biospring
 namespace interactor
 {
 
+// Messages about data the client polls at every frame: at most 5 per second.
+static logging::RateLimiter clientRequests(5, std::chrono::seconds(1));
+
 void CustomData::initializeDataManager(InteractorMDDriver * imdl)
 {
-    // Sasa sent to client
-	imdl->floatManager.add("sasa", imdl->getNbPositions());
-
-	// IMS particle forces sent to client
-	imdl->floatManager.add("imsf", imdl->getNbPositions() * 3);
-
-	// transfer energy sent to client
-	imdl->floatManager.add("trimp", imdl->getNbPositions());
+    // Sasa, IMS particle forces and transfer energies sent to client are read
+    // from the published SystemState.
 
 	// Recieved ids of new defined rigid particle (for rigidbody)
 	imdl->floatManager.add("rigidparticlesids", imdl->getNbPositions());
@@ -114,7 +112,7 @@ void CustomData::processCustomFloatData(InteractorMDDriver * imdl) {
         else if (customFloatDataName && std::strcmp(customFloatDataName, "sasa") == 0)
         {
     #ifdef FREESASA_SUPPORT
-            float* sasa = imdl->floatManager.get("sasa").getData();
+            float* sasa = imdl->getSystemState().solventAccessibilities.data();
             int nbPositions = imdl->getNbPositions();
             sendCustomDataToClient("sasa", &(nbPositions), sasa);
     #endif
@@ -122,7 +120,7 @@ void CustomData::processCustomFloatData(InteractorMDDriver * imdl) {
         // Check if client ask for ims particles forces
         else if (customFloatDataName && std::strcmp(customFloatDataName, "imsf") == 0)
         {
-            float* imsf = imdl->floatManager.get("imsf").getData();
+            float* imsf = imdl->getSystemState().forces.data();
             int nbPositions = imdl->getNbPositions() * 3;
             sendCustomDataToClient("imsf", &(nbPositions), imsf);
         }
@@ -131,13 +129,13 @@ void CustomData::processCustomFloatData(InteractorMDDriver * imdl) {
         {
             if (imdl->getSpringNetwork()->isIMPEnabled())
             {
-                float* trimp = imdl->floatManager.get("trimp").getData();
+                float* trimp = imdl->getSystemState().transferEnergies.data();
                 int nbPositions = imdl->getNbPositions();
                 sendCustomDataToClient("trimp", &(nbPositions), trimp);
             }
             else
             {
-                logging::info("Client asked for the transfer energies but the IMPALA option is not enabled.");
+                BIOSPRING_LOG_CATEGORY(clientRequests, info, "Client asked for the transfer energies but the IMPALA option is not enabled.");
             }
             
         }
@@ -157,17 +155,19 @@ void CustomData::processCustomFloatData(InteractorMDDriver * imdl) {
                     imdl->getSpringNetwork()->getForceField()->setIMPScale(customFloat[0]);
                 }
 
-                // impala[0] <-- !!! IMPALA energy is updated in syncParticleStateData (bellow)
-                // Before this energy set to 0 in the main SpringNetwork running loop
+                // IMPALA energy is read from the published state, not from the
+                // SpringNetwork, which resets it in the main running loop
                 // (avoid sending 0 value sometimes because here we're not in the main thread)
-                impala[1] = imdl->getSpringNetwork()->getCentroid()[2]; // get z of centroid for insertionDepth
+                imdl->requestStateFields(Interactor::STATE_CENTROID);
+                impala[0] = imdl->getSystemState().impEnergy; //!< IMPALA energy, KJoule/mol
+                impala[1] = imdl->getSystemState().centroidZ; // z of the centroid for the insertion depth
                 impala[2] = imdl->getSpringNetwork()->getForceField()->getIMPScale();
 
                 sendCustomDataToClient("impala", &(sizeInfo), impala);
             }
             else
             {
-                logging::info("Client asked for IMPALA informations but the option is not enabled.");
+                BIOSPRING_LOG_CATEGORY(clientRequests, info, "Client asked for IMPALA informations but the option is not enabled.");
             }
         }
         // Check if client ask for rigidbody informations
@@ -198,7 +198,7 @@ void CustomData::processCustomFloatData(InteractorMDDriver * imdl) {
             }
             else
             {
-                logging::info("Client asked for RigidBody informations but the option is not enabled.");
+                BIOSPRING_LOG_CATEGORY(clientRequests, info, "Client asked for RigidBody informations but the option is not enabled.");
             }
         }
         else if (customFloatDataName && std::strcmp(customFloatDataName, "insvec") == 0)
@@ -208,15 +208,17 @@ void CustomData::processCustomFloatData(InteractorMDDriver * imdl) {
                 float* insvec = imdl->floatManager.get("insvec").getData();
                 int sizeInfo = imdl->floatManager.get("insvec").getSize();
 
-                const InsertionVector iv = imdl->getSpringNetwork()->getInsertionVector();
-                insvec[0] = iv.getAngle();
-                insvec[1] = iv.getRollAngle();
+                // The insertion vector is computed by the main thread, and read from the published state.
+                imdl->requestStateFields(Interactor::STATE_INSERTION_VECTOR);
+                const SystemState & state = imdl->getSystemState();
+                insvec[0] = state.insertionAngle;
+                insvec[1] = state.insertionRollAngle;
 
                 sendCustomDataToClient("insvec", &(sizeInfo), insvec);
             }
             else
             {
-                logging::info("Client asked for Insertion Vector informations but the option is not enabled.");
+                BIOSPRING_LOG_CATEGORY(clientRequests, info, "Client asked for Insertion Vector informations but the option is not enabled.");
             }
         }
         // This part regroups simulation informations to send to the client:
@@ -302,18 +304,22 @@ void CustomData::processCustomFloatData(InteractorMDDriver * imdl) {
     // Send data directly without waiting to recieve the ping from client
     // Send angle and insertion depth + nb inter when writing frame to csv
     // to synchronize information sent to client
-    if (imdl->getSpringNetwork()->isCSVTrajectoryWriterEnabled() &&
-        imdl->getSpringNetwork()->isInsertionVectorEnabled() &&
-        !(imdl->getSpringNetwork()->isImpalaSamplingEnabled()) &&
-        imdl->getSpringNetwork()->getNbIterations() % imdl->getSpringNetwork()->getCSVTrajectoryWriterFreq() == 0)
+    // (all read from the published state, so that they belong to the same step)
+    const SystemState & state = imdl->getSystemState();
+    const bool sendcsvinfo = imdl->getSpringNetwork()->isCSVTrajectoryWriterEnabled() &&
+                             imdl->getSpringNetwork()->isInsertionVectorEnabled() &&
+                             !(imdl->getSpringNetwork()->isImpalaSamplingEnabled());
+    if (sendcsvinfo)
+        imdl->requestStateFields(Interactor::STATE_INSERTION_VECTOR);
+    if (sendcsvinfo && (state.fields & Interactor::STATE_INSERTION_VECTOR) &&
+        state.step % static_cast<unsigned>(imdl->getSpringNetwork()->getCSVTrajectoryWriterFreq()) == 0)
     {
         float* csvinfo = imdl->floatManager.get("csvinfo").getData();
         int sizeInfo = imdl->floatManager.get("csvinfo").getSize();
 
-        csvinfo[0] = imdl->getSpringNetwork()->getNbIterations();
-        const InsertionVector iv = imdl->getSpringNetwork()->getInsertionVector();
-        csvinfo[1] =  iv.getAngle();
-        csvinfo[2] =  iv.getInsertionDepth();
+        csvinfo[0] = state.step;
+        csvinfo[1] = state.insertionAngle;
+        csvinfo[2] = state.insertionDepth;
 
         sendCustomDataToClient("csvinfo", &(sizeInfo), csvinfo);
     }
@@ -361,15 +367,15 @@ void CustomData::processCustomIntData(InteractorMDDriver* imdl) {
             int* insvec = imdl->intManager.get("insvec").getData();
             int sizeInfo = imdl->intManager.get("insvec").getSize();
 
-            InsertionVector iv = imdl->getSpringNetwork()->getInsertionVector();
-            insvec[0] = iv.getParticle(0).getId();
-            insvec[1] = iv.getParticle(1).getId();
+            imdl->requestStateFields(Interactor::STATE_INSERTION_VECTOR);
+            insvec[0] = imdl->getSystemState().insertionParticles[0];
+            insvec[1] = imdl->getSystemState().insertionParticles[1];
 
             sendCustomDataToClient("insvec", &(sizeInfo), insvec);
         }
         else
         {
-            logging::info("Client asked for Insertion Vector informations but the option is not enabled.");
+            BIOSPRING_LOG_CATEGORY(clientRequests, info, "Client asked for Insertion Vector informations but the option is not enabled.");
         }
     }
     // If client ask for Potential grid
@@ -408,7 +414,7 @@ void CustomData::processCustomIntData(InteractorMDDriver* imdl) {
 
 template <typename T>
 void CustomData::sendCustomDataToClient(const char *sendName, int *sendSize, T *sendData) {
-    logging::info("Send %s to client.", sendName);
+    BIOSPRING_LOG_CATEGORY(clientRequests, info, "Send %s to client.", sendName);
 
     if constexpr (std::is_same_v<T, float>) {
         IIMD_send_custom_float(sendName, sendSize, sendData);
@@ -427,33 +433,6 @@ int CustomData::getCustomDataFromClient(char *getName, int *getSize, T **getData
     }
 }
 
-
-void CustomData::syncParticleStateData(InteractorMDDriver* imdl, unsigned index)
-{
-    biospring::spn::Particle particle = imdl->getSpringNetwork()->getParticle(index);
-    // Update sasa array for the given particle
-	float sasa = particle.getSolventAccessibilitySurface();
-	float* sasaArray = imdl->floatManager.get("sasa").getData();
-	memcpy(&(sasaArray[index]), &sasa, sizeof(float));
-
-	// Update particle force array for the given particle
-	float particleForce[3];
-    particle.getPreviousForce().to_array(particleForce);
-	float* imsf = imdl->floatManager.get("imsf").getData();
-	memcpy(&(imsf[index * 3]), particleForce, sizeof(float) * 3);
-
-	// Update transfert energies array for the given particle
-	float tre = particle.getTransferEnergyByAccessibleSurface();
-	float* trimpArray = imdl->floatManager.get("trimp").getData();
-	memcpy(&(trimpArray[index]), &tre, sizeof(float));
-
-    // !!! Check processCustomFloatData to see other impala data being updated
-    float* impala = imdl->floatManager.get("impala").getData();
-    impala[0] = imdl->getSpringNetwork()->getIMPEnergy(); //!< IMPALA energy, KJoule/mol
-}
-
-
-
 } // namespace interactor
 } // namespace biospring
 
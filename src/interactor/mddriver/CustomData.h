@@ -20,7 +20,6 @@ class CustomData : public InteractorMDDriver
         static void processCustomFloatData(InteractorMDDriver* imdl);
         static void processCustomIntData(InteractorMDDriver* imdl);
         static void initializeDataManager(InteractorMDDriver* imdl);
-        static void syncParticleStateData(InteractorMDDriver* imdl, unsigned index);
     
     protected:
         template <typename T>
@@ -36,6 +36,8 @@ InteractorMDDriver::InteractorMDDriver()
 	_IMDenergies.Edihe  = 0.0;
 	_IMDenergies.Eimpr  = 0.0;
 	_sleepDuration = 1000;  // For example, set sleep duration to 1000 microseconds for InteractorMDDriver.
+	_nbforces = 0;
+	_stateFields = STATE_POSITIONS | STATE_PARTICLE_PROPERTIES;
 
 	auto initializeGrid = [](IMDGrid& grid)
 	{
@@ -94,7 +96,7 @@ void InteractorMDDriver::startInteractionThread()
  */
 void InteractorMDDriver::initializeSystemState()
 {
-	Interactor::initializeSystemState(); // Set _nbpositions int defined in Interactor.
+	Interactor::initializeSystemState(); // Set _nbpositions int defined in Interactor and sizes the shared state.
 
 	initializeDataManager();
 
@@ -110,12 +112,9 @@ void InteractorMDDriver::initializeDataManager()
 {
 	// floatManager and intManager : data you can store here with defined size
 	// refFloatManager and refIntManager : pointers to data you recieve from client
+	// Positions sent to the client are read from the published SystemState, and
+	// received forces are pushed to the external force queue.
 
-	// Position sent to client
-	floatManager.add("positions", getNbPositions() * 3);
-
-	// Store recieved forces here with fixed maximum size
-	floatManager.add("forces", getNbPositions() * 3);
 	// Particle ids of recieved forces from client with varying size
 	refIntManager.add("particleforceids");
 	// Recieved forces of particles from client with varying size
@@ -210,13 +209,16 @@ int InteractorMDDriver::processIMDInteractions(InteractorMDDriver * imdl) {
     int ret = 0;
     std::lock_guard<std::mutex> lock(imdl->mutex);
 
+    // Latest state published by the main thread.
+    SystemState & state = imdl->acquireSystemState();
+
     // Send positions
     handleIMDWorkflow(imdl);
-    float* positions = imdl->floatManager.get("positions").getData();
-    IIMD_send_coords(&(imdl->_nbpositions), positions);
+    IIMD_send_coords(&(imdl->_nbpositions), state.positions.data());
 
     // Send energies
     handleIMDWorkflow(imdl);
+    imdl->updateEnergies(state);
     IIMD_send_energies(&(imdl->_IMDenergies));
 
     // Get forces
@@ -271,53 +273,43 @@ void InteractorMDDriver::handleIMDEvents(InteractorMDDriver * imdl)
     }
 }
 
+// Sends the forces received from the client to the main thread, as a new frame
+// that replaces the previous one.
 void InteractorMDDriver::updateForces(InteractorMDDriver * imdl, int nbforces, int* particleforceids, float* particleforces)
 {
-    float* forces = imdl->floatManager.get("forces").getData();
-    imdl->floatManager.get("forces").clearData();
+    // Nothing applied before and nothing new: the frame would not change anything.
+    if (nbforces <= 0 && imdl->_nbforces <= 0)
+        return;
+
+    bool queued = imdl->pushClearExternalForces();
 
     float scale = imdl->_IMDforcescale;
-    for(int i = 0; i < nbforces; ++i) {
-        int index = particleforceids[i] * 3;
-        forces[index]   = particleforces[i*3] * scale;
-        forces[index+1] = particleforces[i*3+1] * scale;
-        forces[index+2] = particleforces[i*3+2] * scale;
+    for(int i = 0; i < nbforces && queued; ++i) {
+        if (particleforceids[i] < 0)
+            continue;
+        float force[3] = {particleforces[i*3] * scale, particleforces[i*3+1] * scale, particleforces[i*3+2] * scale};
+        queued = imdl->pushExternalForce(static_cast<uint32_t>(particleforceids[i]), force);
     }
-}
+    if (queued)
+        queued = imdl->pushEndExternalForces();
+    if (!queued)
+        BIOSPRING_WARN_ONCE("MDDriver: external force queue is full, dropping forces sent by the client");
 
-void InteractorMDDriver::syncSystemStateData()
-{
-	Interactor::syncSystemStateData();
-	if(_springnetwork!=NULL)
-	{
-		_IMDenergies.tstep  = _springnetwork->getNbIterations(); //!< integer timestep index
-		_IMDenergies.T = 0.0;          											//!< Temperature in degrees Kelvin
-		_IMDenergies.Etot = _IMDenergies.Eelec+_IMDenergies.Evdw+_IMDenergies.Ebond;  //!< Total energy, in Kcal/mol
-		_IMDenergies.Epot = 0.0;       //!< Potential energy, in Kcal/mol
-		_IMDenergies.Evdw = _springnetwork->getStericEnergy();       //!< Van der Waals energy, in Kcal/mol
-		_IMDenergies.Eelec = _springnetwork->getElectrostaticEnergy();      //!< Electrostatic energy, in Kcal/mol
-		_IMDenergies.Ebond = _springnetwork->getSpringEnergy();      //!< Bond energy, Kcal/mol
-		_IMDenergies.Eangle = 0.0;     //!< Angle energy, Kcal/mol
-		_IMDenergies.Edihe = 0.0;      //!< Dihedral energy, Kcal/mol
-		_IMDenergies.Eimpr = 0.0;      //!< Improper energy, Kcal/mol
-	}
+    imdl->_nbforces = nbforces;
 }
 
-// Update the `_positions` array in the base Interactor class and the force 
-// of the given particle based on MDDriver-related computations.
-void InteractorMDDriver::syncParticleStateData(unsigned index)
+void InteractorMDDriver::updateEnergies(const SystemState & state)
 {
-	biospring::spn::Particle particle = _springnetwork->getParticle(index);
-	float position[3];
-	_springnetwork->getParticlePosition(index, position);
-	// Update the `positions` array for the given particle.
-	float* positions = floatManager.get("positions").getData();
-	memcpy(&(positions[index * 3]), position, sizeof(float) * 3);
-	// Update the force for the given particle.
-	float* forces = floatManager.get("forces").getData();
-	_springnetwork->setForce(index, &(forces[index * 3]));
-
-	CustomData::syncParticleStateData(this, index);
+	_IMDenergies.tstep  = state.step; //!< integer timestep index
+	_IMDenergies.T = 0.0;          											//!< Temperature in degrees Kelvin
+	_IMDenergies.Etot = _IMDenergies.Eelec+_IMDenergies.Evdw+_IMDenergies.Ebond;  //!< Total energy, in Kcal/mol
+	_IMDenergies.Epot = 0.0;       //!< Potential energy, in Kcal/mol
+	_IMDenergies.Evdw = state.stericEnergy;       //!< Van der Waals energy, in Kcal/mol
+	_IMDenergies.Eelec = state.electrostaticEnergy;      //!< Electrostatic energy, in Kcal/mol
+	_IMDenergies.Ebond = state.springEnergy;      //!< Bond energy, Kcal/mol
+	_IMDenergies.Eangle = 0.0;     //!< Angle energy, Kcal/mol
+	_IMDenergies.Edihe = 0.0;      //!< Dihedral energy, Kcal/mol
+	_IMDenergies.Eimpr = 0.0;      //!< Improper energy, Kcal/mol
 }
 
 } // namespace interactor
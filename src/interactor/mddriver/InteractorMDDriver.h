@@ -40,8 +40,6 @@ class InteractorMDDriver : public Interactor
 		virtual bool continueInteractionThread() override { return _isRunning.load(std::memory_order_acquire); }
 		virtual void stopInteractionThread() override { _isRunning.store(false, std::memory_order_release); }
 
-		virtual void syncSystemStateData() override;
-
 		// Managers for float/int data assigned in the server side (BioSpring)
 		DataArrayManager<float> floatManager;
 		DataArrayManager<int> intManager;
@@ -88,7 +86,8 @@ class InteractorMDDriver : public Interactor
 
 		virtual void initializeDataManager() override;
 
-		virtual void syncParticleStateData(unsigned index) override;
+		// Fills _IMDenergies from a published state.
+		void updateEnergies(const SystemState & state);
 
 		
 	};
@@ -1,87 +1,550 @@
 
-
 #include "logging.h"
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <stdarg.h>
 #include <stdio.h>
+#include <thread>
 #include <vector>
 
 #define STRLEN 1024
 
-using std::cerr;
-using std::cout;
-using std::endl;
+namespace biospring
+{
+namespace logging
+{
 
-void biospring::logging::debug(const char * fmt, ...)
+namespace
 {
-    va_list ap;
-    char msg[STRLEN];
 
-    va_start(ap, fmt);
-    vsnprintf(msg, STRLEN, fmt, ap);
-    va_end(ap);
+struct Record
+{
+    Level level;
+    uint64_t sequence; // global order of the messages
+    int64_t time;      // ns since epoch
+    unsigned thread;
+    char message[STRLEN];
+};
+
+// Ring buffer of the messages of one thread.
+// Single producer (the thread that logs), single consumer (the background thread).
+class Ring
+{
+  public:
+    static constexpr size_t CAPACITY = 128;
+
+    const unsigned thread;
+
+    explicit Ring(unsigned thread) : thread(thread) {}
+
+    // Returns the slot to fill, or nullptr if the ring is full.
+    Record * reserve()
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == CAPACITY)
+            return nullptr;
+        return &_records[head % CAPACITY];
+    }
+
+    // Publishes the slot returned by reserve().
+    void commit() { _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Moves the published records to `records`.
+    void drain(std::vector<Record> & records)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t head = _head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail)
+            records.push_back(_records[tail % CAPACITY]);
+        _tail.store(tail, std::memory_order_release);
+    }
+
+    // Set by the producer while it decides whether to log asynchronously and fills a slot.
+    // Sequentially consistent, as is `State::async`: stop_async either sees the producer
+    // busy and waits for it, or the producer sees asynchronous mode stopped.
+    std::atomic<bool> busy{false};
+
+    // Set when the thread owning the ring exits. The ring is then freed once drained.
+    std::atomic<bool> released{false};
+
+  private:
+    std::array<Record, CAPACITY> _records;
+    alignas(64) std::atomic<size_t> _head{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+};
+
+// Owns the ring of the current thread, and releases it when the thread exits.
+struct RingHandle
+{
+    std::shared_ptr<Ring> ring;
+
+    ~RingHandle()
+    {
+        if (ring)
+            ring->released.store(true, std::memory_order_release);
+    }
+};
+
+struct State
+{
+    std::atomic<int> level{static_cast<int>(Level::Debug)};
+    std::atomic<bool> async{false};
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<unsigned> threads{0};
+
+    // Sinks. Writes are serialized so that lines never interleave.
+    std::mutex output_mutex;
+    std::ofstream json;
+
+    // Asynchronous mode.
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::thread drainer;
+    std::mutex drainer_mutex;
+    std::condition_variable wake;    // wakes the background thread up
+    std::condition_variable flushed; // signals flush requests completion
+    bool stop = false;
+    uint64_t flush_requests = 0;
+    uint64_t flush_completed = 0;
+    uint64_t dropped_reported = 0;
+};
+
+State & state()
+{
+    static State s;
+    return s;
+}
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
 
-    cerr << DEBUG_COLOR << DEBUG_PREFIX << msg << RESET_COLOR << endl;
+unsigned thread_number()
+{
+    thread_local const unsigned number = state().threads.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+Ring & thread_ring()
+{
+    thread_local RingHandle handle;
+    if (!handle.ring)
+    {
+        handle.ring = std::make_shared<Ring>(thread_number());
+        std::lock_guard<std::mutex> lock(state().rings_mutex);
+        state().rings.push_back(handle.ring);
+    }
+    return *handle.ring;
+}
+
+const std::string & color(Level level)
+{
+    switch (level)
+    {
+    case Level::Debug:
+        return DEBUG_COLOR;
+    case Level::Info:
+        return INFO_COLOR;
+    case Level::Status:
+        return STATUS_COLOR;
+    case Level::Warning:
+        return WARNING_COLOR;
+    case Level::Error:
+        break;
+    }
+    return ERROR_COLOR;
+}
+
+const std::string & prefix(Level level)
+{
+    switch (level)
+    {
+    case Level::Debug:
+        return DEBUG_PREFIX;
+    case Level::Info:
+        return INFO_PREFIX;
+    case Level::Status:
+        return STATUS_PREFIX;
+    case Level::Warning:
+        return WARNING_PREFIX;
+    case Level::Error:
+        break;
+    }
+    return ERROR_PREFIX;
+}
+
+void write_json_string(std::ostream & os, const char * s)
+{
+    os << '"';
+    for (; *s; ++s)
+    {
+        const unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\')
+            os << '\\' << *s;
+        else if (c == '\n')
+            os << "\\n";
+        else if (c == '\t')
+            os << "\\t";
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            os << escaped;
+        }
+        else
+            os << *s;
+    }
+    os << '"';
+}
+
+// Writes records to the sinks. The caller holds the output mutex.
+void write(const Record * records, size_t n)
+{
+    State & s = state();
+    std::string lines;
+    for (size_t i = 0; i < n; ++i)
+        lines += color(records[i].level) + prefix(records[i].level) + records[i].message + RESET_COLOR + '\n';
+    std::cerr << lines << std::flush;
+
+    if (s.json.is_open())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const Record & r = records[i];
+            char time[32];
+            snprintf(time, sizeof(time), "%.6f", r.time * 1e-9);
+            s.json << "{\"time\":" << time << ",\"level\":\"" << level_name(r.level) << "\",\"thread\":" << r.thread
+                   << ",\"message\":";
+            write_json_string(s.json, r.message);
+            s.json << "}\n";
+        }
+        s.json.flush();
+    }
+}
+
+void fill(Record & record, Level level, const char * fmt, va_list ap)
+{
+    record.level = level;
+    record.sequence = state().sequence.fetch_add(1, std::memory_order_relaxed);
+    record.time = now();
+    record.thread = thread_number();
+    vsnprintf(record.message, STRLEN, fmt, ap);
+}
+
+void write_now(Level level, const char * fmt, va_list ap)
+{
+    Record record;
+    fill(record, level, fmt, ap);
+    std::lock_guard<std::mutex> lock(state().output_mutex);
+    write(&record, 1);
 }
 
-void biospring::logging::die(const char * fmt, ...)
+// Writes the messages of all ring buffers, in the order they were logged, and frees the
+// rings of the threads that exited. Returns the number of messages written.
+size_t drain()
+{
+    State & s = state();
+    std::vector<Record> records;
+    {
+        std::lock_guard<std::mutex> lock(s.rings_mutex);
+        for (auto it = s.rings.begin(); it != s.rings.end();)
+        {
+            // A released ring gets no more messages: once drained, it can be freed.
+            const bool released = (*it)->released.load(std::memory_order_acquire);
+            (*it)->drain(records);
+            if (released)
+                it = s.rings.erase(it);
+            else
+                ++it;
+        }
+    }
+    std::sort(records.begin(), records.end(),
+              [](const Record & a, const Record & b) { return a.sequence < b.sequence; });
+
+    const uint64_t dropped = s.dropped.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(s.output_mutex);
+    write(records.data(), records.size());
+    if (dropped != s.dropped_reported)
+    {
+        Record record{Level::Warning, 0, now(), 0, {}};
+        snprintf(record.message, STRLEN, "%llu log messages dropped: logging faster than they can be written",
+                 static_cast<unsigned long long>(dropped - s.dropped_reported));
+        s.dropped_reported = dropped;
+        write(&record, 1);
+    }
+    return records.size();
+}
+
+void drainer_loop()
+{
+    State & s = state();
+    std::unique_lock<std::mutex> lock(s.drainer_mutex);
+    while (true)
+    {
+        const uint64_t requests = s.flush_requests;
+        const bool stopping = s.stop;
+        lock.unlock();
+        const size_t n = drain();
+        lock.lock();
+
+        s.flush_completed = requests;
+        s.flushed.notify_all();
+        if (stopping && n == 0)
+            break;
+        if (n == 0)
+            s.wake.wait_for(lock, std::chrono::milliseconds(10),
+                            [&] { return s.stop || s.flush_requests != s.flush_completed; });
+    }
+}
+
+void log(Level level, const char * fmt, va_list ap)
+{
+    if (!is_enabled(level))
+        return;
+
+    State & s = state();
+    if (!s.async.load(std::memory_order_acquire))
+    {
+        write_now(level, fmt, ap);
+        return;
+    }
+
+    Ring & ring = thread_ring();
+    ring.busy.store(true);
+    if (!s.async.load())
+    {
+        // stop_async started after the first check: its last drain may already be done.
+        ring.busy.store(false, std::memory_order_release);
+        write_now(level, fmt, ap);
+        return;
+    }
+
+    Record * record = ring.reserve();
+    if (record == nullptr)
+        s.dropped.fetch_add(1, std::memory_order_relaxed);
+    else
+    {
+        fill(*record, level, fmt, ap);
+        ring.commit();
+    }
+    ring.busy.store(false, std::memory_order_release);
+}
+
+} // namespace
+
+// ======================================================================================
+//
+// Configuration
+//
+// ======================================================================================
+
+void set_level(Level level) { state().level.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+Level level() { return static_cast<Level>(state().level.load(std::memory_order_relaxed)); }
+
+bool is_enabled(Level level)
+{
+    return level == Level::Error || static_cast<int>(level) >= state().level.load(std::memory_order_relaxed);
+}
+
+bool level_from_string(const std::string & name, Level & level)
+{
+    for (Level candidate : {Level::Debug, Level::Info, Level::Status, Level::Warning, Level::Error})
+    {
+        if (name == level_name(candidate))
+        {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char * level_name(Level level)
+{
+    switch (level)
+    {
+    case Level::Debug:
+        return "debug";
+    case Level::Info:
+        return "info";
+    case Level::Status:
+        return "status";
+    case Level::Warning:
+        return "warning";
+    case Level::Error:
+        break;
+    }
+    return "error";
+}
+
+void set_json_sink(const std::string & path)
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(state().output_mutex);
+        if (state().json.is_open())
+            state().json.close();
+        if (path.empty())
+            return;
+        state().json.open(path);
+        if (state().json)
+            return;
+    }
+    die("Cannot open log file '%s'.", path.c_str());
+}
+
+void start_async()
+{
+    State & s = state();
+    std::lock_guard<std::mutex> lock(s.drainer_mutex);
+    if (s.drainer.joinable())
+        return;
+
+    s.stop = false;
+    s.drainer = std::thread(drainer_loop);
+    s.async.store(true, std::memory_order_release);
+
+    // Pending messages are written when the program exits without calling stop_async.
+    static bool registered = false;
+    if (!registered)
+    {
+        std::atexit(stop_async);
+        registered = true;
+    }
+}
+
+void stop_async()
+{
+    State & s = state();
+    {
+        std::lock_guard<std::mutex> lock(s.drainer_mutex);
+        if (!s.drainer.joinable() || s.drainer.get_id() == std::this_thread::get_id())
+            return;
+        s.async.store(false);
+        s.stop = true;
+    }
+    s.wake.notify_all();
+    s.drainer.join();
+
+    // Threads that saw asynchronous mode still on may be filling a slot: they are waited for,
+    // so that the last drain gets their messages. Later messages are written synchronously.
+    {
+        std::lock_guard<std::mutex> lock(s.rings_mutex);
+        for (const auto & ring : s.rings)
+            while (ring->busy.load())
+                std::this_thread::yield();
+    }
+    drain();
+}
+
+bool is_async() { return state().async.load(std::memory_order_acquire); }
+
+void flush()
+{
+    State & s = state();
+    std::unique_lock<std::mutex> lock(s.drainer_mutex);
+    if (!s.drainer.joinable() || s.stop)
+        return;
+    const uint64_t request = ++s.flush_requests;
+    s.wake.notify_all();
+    s.flushed.wait(lock, [&] { return s.flush_completed >= request || s.stop; });
+}
+
+uint64_t dropped_messages() { return state().dropped.load(std::memory_order_relaxed); }
+
+// ======================================================================================
+//
+// RateLimiter
+//
+// ======================================================================================
+
+bool RateLimiter::allow()
+{
+    if (_period > 0)
+    {
+        const int64_t time = now();
+        int64_t start = _window_start.load(std::memory_order_relaxed);
+        if (time - start >= _period && _window_start.compare_exchange_strong(start, time, std::memory_order_relaxed))
+            _count.store(0, std::memory_order_relaxed);
+    }
+
+    if (_count.load(std::memory_order_relaxed) < _burst &&
+        _count.fetch_add(1, std::memory_order_relaxed) < _burst)
+        return true;
+
+    _suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// ======================================================================================
+//
+// Logging functions
+//
+// ======================================================================================
+
+void debug(const char * fmt, ...)
 {
     va_list ap;
-    char msg[STRLEN];
+    va_start(ap, fmt);
+    log(Level::Debug, fmt, ap);
+    va_end(ap);
+}
+
+void die(const char * fmt, ...)
+{
+    // Pending messages come first, the error is the last line.
+    stop_async();
 
+    va_list ap;
     va_start(ap, fmt);
-    vsnprintf(msg, STRLEN, fmt, ap);
+    write_now(Level::Error, fmt, ap);
     va_end(ap);
 
-    cerr << ERROR_COLOR << ERROR_PREFIX << msg << RESET_COLOR << endl;
     exit(EXIT_FAILURE);
 }
 
-void biospring::logging::status(const char * fmt, ...)
+void status(const char * fmt, ...)
 {
     va_list ap;
-    char msg[STRLEN];
-
     va_start(ap, fmt);
-    vsnprintf(msg, STRLEN, fmt, ap);
+    log(Level::Status, fmt, ap);
     va_end(ap);
-
-    cerr << STATUS_COLOR << STATUS_PREFIX << msg << RESET_COLOR << endl;
 }
 
-void biospring::logging::warning(const char * fmt, ...)
+void warning(const char * fmt, ...)
 {
     va_list ap;
-    char msg[STRLEN];
-
     va_start(ap, fmt);
-    vsnprintf(msg, STRLEN, fmt, ap);
+    log(Level::Warning, fmt, ap);
     va_end(ap);
-
-    cerr << WARNING_COLOR << WARNING_PREFIX << msg << RESET_COLOR << endl;
 }
 
-void biospring::logging::info(const char * fmt, ...)
+void info(const char * fmt, ...)
 {
     va_list ap;
-    char msg[STRLEN];
-
     va_start(ap, fmt);
-    vsnprintf(msg, STRLEN, fmt, ap);
+    log(Level::Info, fmt, ap);
     va_end(ap);
-
-    cerr << INFO_COLOR << INFO_PREFIX << msg << RESET_COLOR << endl;
 }
 
-void biospring::logging::error(const char * fmt, ...)
+void error(const char * fmt, ...)
 {
     va_list ap;
-    char msg[STRLEN];
-
     va_start(ap, fmt);
-    vsnprintf(msg, STRLEN, fmt, ap);
+    log(Level::Error, fmt, ap);
     va_end(ap);
-
-    cerr << ERROR_COLOR << ERROR_PREFIX << msg << RESET_COLOR << endl;
 }
+
+} // namespace logging
+} // namespace biospring
@@ -2,6 +2,8 @@
 #define __BIOSPRING_LOGGING_H__
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 
@@ -33,19 +35,113 @@ void info(const char * fmt, ...);
 void status(const char * fmt, ...);
 void warning(const char * fmt, ...);
 
+// Messages are written whole, one line at a time, so that messages from several threads never
+// interleave. By default they are written to std::cerr by the calling thread.
+//
+// In asynchronous mode (start_async), each thread formats its messages into its own lock-free
+// ring buffer, and a background thread writes them. Logging then never waits for the
+// terminal: when a ring buffer is full, messages are dropped and their number is reported.
+// Errors (die) are always written synchronously, after the pending messages.
+//
+// The background thread writes the messages it collects at once in the order they were
+// logged. Messages from different threads collected at different times are not reordered:
+// a message may come after a message logged later by another thread. The messages of one
+// thread always keep their order.
+
+enum class Level
+{
+    Debug,
+    Info,
+    Status,
+    Warning,
+    Error,
+};
+
+// Messages below `level` are discarded before being formatted. Errors are never discarded.
+void set_level(Level level);
+Level level();
+bool is_enabled(Level level);
+
+// Returns the level named `name` (debug, info, status, warning or error).
+// Returns false if the name is unknown.
+bool level_from_string(const std::string & name, Level & level);
+const char * level_name(Level level);
+
+// Also writes each message to `path` as a JSON object per line, with its time (seconds since
+// epoch), level, thread and text. An empty path closes the JSON sink.
+void set_json_sink(const std::string & path);
+
+void start_async();
+void stop_async(); // writes the pending messages, then stops the background thread
+bool is_async();
+
+// Waits until the messages logged so far by any thread are written. No-op in synchronous mode.
+void flush();
+
+// Number of messages dropped because a ring buffer was full.
+uint64_t dropped_messages();
+
+// Allows at most `burst` messages per `period`; a null period allows `burst` messages in total.
+// Lock-free: meant to be a static object shared by the call sites of a category of messages.
+class RateLimiter
+{
+  public:
+    RateLimiter(unsigned burst, std::chrono::milliseconds period = std::chrono::milliseconds::zero())
+        : _burst(burst), _period(std::chrono::duration_cast<std::chrono::nanoseconds>(period).count())
+    {
+    }
+
+    // Returns true if a message may be logged now.
+    bool allow();
+
+    // Returns the number of messages refused since the last call, and resets it.
+    uint64_t take_suppressed() { return _suppressed.exchange(0, std::memory_order_relaxed); }
+
+  private:
+    const unsigned _burst;
+    const int64_t _period; // in ns
+    std::atomic<int64_t> _window_start{0};
+    std::atomic<unsigned> _count{0};
+    std::atomic<uint64_t> _suppressed{0};
+};
+
 } // namespace logging
 
+// Emits a message through logging::`fn` (info, warning, ...) at most `burst` times per `period_ms`
+// milliseconds for this call site, e.g. for a message sent on every frame received from a client.
+// The number of messages left out is logged with the next one that gets through.
+#define BIOSPRING_LOG_RATE_LIMITED(fn, burst, period_ms, ...)                                                          \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static biospring::logging::RateLimiter _biospring_limiter((burst), std::chrono::milliseconds(period_ms));      \
+        BIOSPRING_LOG_CATEGORY(_biospring_limiter, fn, __VA_ARGS__);                                                   \
+    } while (false)
+
+// Same as BIOSPRING_LOG_RATE_LIMITED, with a RateLimiter shared by several call sites.
+#define BIOSPRING_LOG_CATEGORY(limiter, fn, ...)                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if ((limiter).allow())                                                                                         \
+        {                                                                                                              \
+            const uint64_t _biospring_suppressed = (limiter).take_suppressed();                                        \
+            if (_biospring_suppressed > 0)                                                                             \
+                biospring::logging::fn("(%llu similar messages suppressed)",                                           \
+                                       static_cast<unsigned long long>(_biospring_suppressed));                       \
+            biospring::logging::fn(__VA_ARGS__);                                                                       \
+        }                                                                                                              \
+    } while (false)
+
 // Emits a warning the first time this call site is reached, then stays quiet.
 // For degraded-but-recoverable paths inside the simulation loop, where an
 // unconditional warning() would print once per particle per step and drown the
-// output it is meant to draw attention to. The flag is function-local, so each
+// output it is meant to draw attention to. The limiter is function-local, so each
 // call site throttles independently, and atomic because several of these sites
 // straddle an interactor's worker thread and the main thread.
 #define BIOSPRING_WARN_ONCE(...)                                                                                       \
     do                                                                                                                 \
     {                                                                                                                  \
-        static std::atomic<bool> _biospring_warned{false};                                                             \
-        if (!_biospring_warned.exchange(true, std::memory_order_relaxed))                                              \
+        static biospring::logging::RateLimiter _biospring_warned(1);                                                   \
+        if (_biospring_warned.allow())                                                                                 \
             biospring::logging::warning(__VA_ARGS__);                                                                  \
     } while (false)
 
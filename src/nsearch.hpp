@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
 #include <optional>
 #include <unordered_map>
 #include <utility>
@@ -193,6 +194,11 @@ template <concepts::LocatableContainer ContainerType> class NeighborSearch : pub
     // populated and consulted when `_skin > 0`.
     std::vector<std::array<double, 3>> _referencePositions;
 
+    // Cell of each particle of the system, `untracked` if it is not in the
+    // cell list. Used by `relocate`.
+    static constexpr size_t untracked = std::numeric_limits<size_t>::max();
+    std::vector<size_t> _cell_of;
+
   public:
     // Initializes the neighbor search object with the particles.
 
@@ -248,11 +254,42 @@ template <concepts::LocatableContainer ContainerType> class NeighborSearch : pub
     // skin was requested, the rebuild is skipped until a tracked particle has
     // drifted far enough since the last rebuild that a neighbor could
     // otherwise be missed (see `_exceeds_skin`).
-    void update()
+    // Returns true if the cell list was rebuilt.
+    bool update()
     {
         if (!_exceeds_skin())
-            return;
+            return false;
         _build_grid();
+        return true;
+    }
+
+    // Moves the given particles to the cells of their current positions
+    // without rebuilding the grid, so that the cost is proportional to the
+    // number of particles given rather than to the system size. The other
+    // particles must not have moved since the last rebuild. Particles that
+    // left the grid box stay in its border cells, which keeps queries exact.
+    // Indexes the cell list does not track are ignored.
+    template <typename Indexes> void relocate(const Indexes & indexes)
+    {
+        for (const auto index : indexes)
+        {
+            const size_t i = static_cast<size_t>(index);
+            if (i >= _cell_of.size() || _cell_of[i] == untracked)
+                continue;
+
+            const auto & position = concepts::locatable::get_position(_system->at(i));
+            const size_t cell_id = _compute_cell(position);
+            if (_skin > 0.0f)
+                _referencePositions[i] = position;
+            if (cell_id == _cell_of[i])
+                continue;
+
+            std::vector<size_t> & previous = _cells[_cell_of[i]];
+            *std::find(previous.begin(), previous.end(), i) = previous.back();
+            previous.pop_back();
+            _cells[cell_id].push_back(i);
+            _cell_of[i] = cell_id;
+        }
     }
 
     // Excludes one particle index from the grid. The grid is rebuilt
@@ -278,10 +315,11 @@ template <concepts::LocatableContainer ContainerType> class NeighborSearch : pub
     {
         const float radius = _search_radius();
 
-        // Calculate grid cell coordinates for the given position, considering negative coordinates
-        size_t cell_y = static_cast<size_t>((position[1] - _box.min_y()) / radius);
-        size_t cell_z = static_cast<size_t>((position[2] - _box.min_z()) / radius);
-        size_t cell_x = static_cast<size_t>((position[0] - _box.min_x()) / radius);
+        // Calculate grid cell coordinates for the given position, considering negative coordinates.
+        // Positions below the box (particles that moved since the grid was built) go to the first cell.
+        size_t cell_y = static_cast<size_t>(std::max(0.0, (position[1] - _box.min_y()) / radius));
+        size_t cell_z = static_cast<size_t>(std::max(0.0, (position[2] - _box.min_z()) / radius));
+        size_t cell_x = static_cast<size_t>(std::max(0.0, (position[0] - _box.min_x()) / radius));
 
         // Ensure that the cell coordinates are within bounds
         cell_x = std::min(cell_x, _ncells_x - 1);
@@ -355,6 +393,7 @@ template <concepts::LocatableContainer ContainerType> class NeighborSearch : pub
 
         if (_skin > 0.0f)
             _referencePositions.assign(_system->size(), std::array<double, 3>{});
+        _cell_of.assign(_system->size(), untracked);
 
         const auto add_particle_to_cell = [&](size_t i) {
             if (_excluded_index && i == *_excluded_index)
@@ -367,6 +406,7 @@ template <concepts::LocatableContainer ContainerType> class NeighborSearch : pub
 
             // Adds the particle to the appropriate cell.
             _cells[cell_id].push_back(i);
+            _cell_of[i] = cell_id;
 
             if (_skin > 0.0f)
                 _referencePositions[i] = position;
@@ -0,0 +1,233 @@
+#include "perfcounters.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef OPENMP_SUPPORT
+#include <omp.h>
+#endif
+
+namespace biospring
+{
+namespace perf
+{
+
+const char * event_name(size_t event)
+{
+    static const char * names[NUMBER_OF_EVENTS] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+    return event < NUMBER_OF_EVENTS ? names[event] : "unknown";
+}
+
+Counts difference(const Counts & a, const Counts & b)
+{
+    Counts result{};
+    for (size_t i = 0; i < NUMBER_OF_EVENTS; ++i)
+        result[i] = a[i] > b[i] ? a[i] - b[i] : 0;
+    return result;
+}
+
+bool requested_by_environment()
+{
+    const char * value = std::getenv("BIOSPRING_PERF_COUNTERS");
+    return value != nullptr && *value != '\0' && std::strcmp(value, "0") != 0;
+}
+
+#ifdef __linux__
+
+namespace
+{
+
+// perf_event_open has no glibc wrapper.
+int perf_event_open(perf_event_attr * attr, pid_t pid, int cpu, int group, unsigned long flags)
+{
+    return static_cast<int>(syscall(SYS_perf_event_open, attr, pid, cpu, group, flags));
+}
+
+perf_event_attr event_attributes(size_t event)
+{
+    // PERF_COUNT_HW_CACHE_MISSES is the generic last-level cache miss event.
+    static const uint64_t configs[NUMBER_OF_EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                       PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[event];
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return attr;
+}
+
+} // namespace
+
+// Opens the counters of the calling thread. The first thread decides which events
+// are available (`slots`); the other threads must open the same ones.
+bool HardwareCounters::_open_group(Group & group, std::array<int, NUMBER_OF_EVENTS> & slots,
+                                   std::string & error) const
+{
+    const bool first = slots[CYCLES] < 0 && slots[INSTRUCTIONS] < 0 && slots[LLC_MISSES] < 0 &&
+                       slots[BRANCH_MISSES] < 0;
+    for (size_t event = 0; event < NUMBER_OF_EVENTS; ++event)
+    {
+        if (!first && slots[event] < 0)
+            continue;
+
+        perf_event_attr attr = event_attributes(event);
+        const int leader = group.descriptors.empty() ? -1 : group.descriptors.front();
+        attr.disabled = leader < 0 ? 1 : 0;
+        const int fd = perf_event_open(&attr, 0, -1, leader, 0);
+        if (fd < 0)
+        {
+            if (first && (errno == ENOENT || errno == EOPNOTSUPP || errno == EINVAL))
+                continue; // event not supported by this CPU
+            error = std::string("perf_event_open failed for ") + event_name(event) + ": " + std::strerror(errno);
+            if (errno == EACCES || errno == EPERM)
+                error += " (see /proc/sys/kernel/perf_event_paranoid)";
+            _close_group(group);
+            return false;
+        }
+        if (first)
+            slots[event] = static_cast<int>(group.descriptors.size());
+        group.descriptors.push_back(fd);
+    }
+
+    if (group.descriptors.empty())
+    {
+        error = "no hardware event is supported";
+        return false;
+    }
+
+    const int leader = group.descriptors.front();
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void HardwareCounters::_close_group(Group & group)
+{
+    for (int fd : group.descriptors)
+        ::close(fd);
+    group.descriptors.clear();
+}
+
+bool HardwareCounters::open()
+{
+    close();
+
+    std::array<int, NUMBER_OF_EVENTS> slots{-1, -1, -1, -1};
+    std::string error;
+
+    // The calling thread opens its counters first so that it decides which events
+    // are available. It is thread 0 of the OpenMP team.
+    std::vector<Group> groups(1);
+    bool success = _open_group(groups[0], slots, error);
+
+#ifdef OPENMP_SUPPORT
+    if (success)
+    {
+        groups.resize(static_cast<size_t>(omp_get_max_threads()));
+#pragma omp parallel
+        {
+            const int thread = omp_get_thread_num();
+            if (thread > 0)
+            {
+                std::string thread_error;
+                std::array<int, NUMBER_OF_EVENTS> thread_slots = slots;
+                if (!_open_group(groups[thread], thread_slots, thread_error))
+                {
+#pragma omp critical
+                    {
+                        success = false;
+                        error = thread_error;
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    if (!success)
+    {
+        for (Group & group : groups)
+            _close_group(group);
+        _error = error;
+        return false;
+    }
+
+    _groups = std::move(groups);
+    _slots = slots;
+    _error.clear();
+    return true;
+}
+
+void HardwareCounters::close()
+{
+    for (Group & group : _groups)
+        _close_group(group);
+    _groups.clear();
+    _slots.fill(-1);
+}
+
+Counts HardwareCounters::read() const
+{
+    struct
+    {
+        uint64_t number;
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[NUMBER_OF_EVENTS];
+    } buffer;
+
+    Counts counts{};
+    for (const Group & group : _groups)
+    {
+        if (group.descriptors.empty())
+            continue;
+        if (::read(group.descriptors.front(), &buffer, sizeof(buffer)) <= 0)
+            continue;
+
+        // The kernel multiplexes the counters when there are more events than hardware
+        // counters; the counts are then extrapolated over the enabled time.
+        const double scale = buffer.time_running > 0 && buffer.time_running < buffer.time_enabled
+                                 ? static_cast<double>(buffer.time_enabled) / buffer.time_running
+                                 : 1.0;
+        for (size_t event = 0; event < NUMBER_OF_EVENTS; ++event)
+            if (_slots[event] >= 0 && static_cast<uint64_t>(_slots[event]) < buffer.number)
+                counts[event] += static_cast<uint64_t>(buffer.values[_slots[event]] * scale);
+    }
+    return counts;
+}
+
+#else // __linux__
+
+bool HardwareCounters::_open_group(Group &, std::array<int, NUMBER_OF_EVENTS> &, std::string &) const { return false; }
+
+void HardwareCounters::_close_group(Group & group) { group.descriptors.clear(); }
+
+bool HardwareCounters::open()
+{
+    _error = "hardware counters require Linux perf_event_open";
+    return false;
+}
+
+void HardwareCounters::close()
+{
+    _groups.clear();
+    _slots.fill(-1);
+}
+
+Counts HardwareCounters::read() const { return Counts{}; }
+
+#endif // __linux__
+
+} // namespace perf
+} // namespace biospring
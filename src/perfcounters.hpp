@@ -0,0 +1,101 @@
+// Hardware performance counters.
+//
+// Reads CPU cycles, retired instructions, last-level cache misses and branch
+// misses through the Linux perf_event_open system call, without any library.
+// The counters only count user-space events, which the default
+// perf_event_paranoid setting (2) allows for unprivileged users.
+//
+// With OpenMP, each thread of the team opens its own counters and read()
+// returns the sum over the team, so that the counts of a parallel loop are
+// complete. The team is the one of the parallel regions that follow open(): the
+// counters should be reopened if the number of threads changes.
+//
+// Example:
+//
+//     perf::HardwareCounters counters;
+//     if (counters.open())
+//     {
+//         const perf::Counts start = counters.read();
+//         computeForces();
+//         const perf::Counts counts = perf::difference(counters.read(), start);
+//     }
+//
+
+#ifndef __PERFCOUNTERS_HPP__
+#define __PERFCOUNTERS_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace perf
+{
+
+enum Event : size_t
+{
+    CYCLES,
+    INSTRUCTIONS,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    NUMBER_OF_EVENTS
+};
+
+using Counts = std::array<uint64_t, NUMBER_OF_EVENTS>;
+
+// Short event name, e.g. "llc_misses".
+const char * event_name(size_t event);
+
+// Returns a - b, element-wise, saturating at 0.
+Counts difference(const Counts & a, const Counts & b);
+
+// Returns true if the BIOSPRING_PERF_COUNTERS environment variable is set to a
+// value other than "0".
+bool requested_by_environment();
+
+class HardwareCounters
+{
+  public:
+    HardwareCounters() = default;
+    ~HardwareCounters() { close(); }
+
+    HardwareCounters(const HardwareCounters &) = delete;
+    HardwareCounters & operator=(const HardwareCounters &) = delete;
+
+    // Opens the counters. Returns false if the system does not provide them,
+    // in which case error() tells why. Events that the CPU does not support
+    // are left out and read as 0 (see available()).
+    bool open();
+    void close();
+
+    bool is_open() const { return !_groups.empty(); }
+    bool available(size_t event) const { return _slots[event] >= 0; }
+    const std::string & error() const { return _error; }
+
+    // Returns the counts accumulated since open(), summed over the threads.
+    // Counts are scaled when the kernel had to multiplex the counters.
+    // Returns zeros if the counters are not open.
+    Counts read() const;
+
+  protected:
+    // Counters of one thread: a group led by the first available event.
+    struct Group
+    {
+        std::vector<int> descriptors;
+    };
+
+    std::vector<Group> _groups;
+    std::array<int, NUMBER_OF_EVENTS> _slots{-1, -1, -1, -1}; // position of each event in a group
+    std::string _error;
+
+    bool _open_group(Group & group, std::array<int, NUMBER_OF_EVENTS> & slots, std::string & error) const;
+    static void _close_group(Group & group);
+};
+
+} // namespace perf
+} // namespace biospring
+
+#endif // __PERFCOUNTERS_HPP__
@@ -7,6 +7,10 @@
 #include "ReduceRule.h"
 #include "logging.h"
 
+#ifdef OPENMP_SUPPORT
+#include <omp.h>
+#endif
+
 namespace biospring
 {
 namespace reduce
@@ -30,6 +34,121 @@ void Reducer::initialize_rules(const std::string & path)
     _rules_initialized = true;
 }
 
+void Reducer::reduce(void)
+{
+    if (!_forcefield_initialized)
+        throw std::runtime_error("Reducer:: Forcefield not initialized!");
+
+    if (!_rules_initialized)
+        throw std::runtime_error("Reducer:: Rules not initialized!");
+
+    logging::status("Reducing model using group and forcefield");
+
+    const ParticleContainer & particles = _source_topology.particles().data();
+    if (particles.empty())
+        return;
+
+    // Interns rule atom names, then looks up each particle name once.
+    AtomNameTable names;
+    const auto rules = _compile_rules(names);
+
+    std::vector<uint32_t> name_ids(particles.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < particles.size(); ++i)
+        name_ids[i] = names.id(particles[i].properties().name());
+
+    const ReductionInput input{particles, name_ids};
+    const std::vector<ResidueRange> residues = _partition_by_residue(particles);
+
+    // One output slot per residue: grains and warning messages.
+    std::vector<std::vector<topology::ParticleProperties>> grains(residues.size());
+    std::vector<std::vector<std::string>> messages(residues.size());
+
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (size_t r = 0; r < residues.size(); ++r)
+    {
+        const std::string & resname = particles[residues[r].begin].properties().residue_name();
+        const auto residue_rules = rules.find(resname);
+
+        // Skips the residue if found no rule for it.
+        if (residue_rules == rules.end())
+        {
+            messages[r].push_back(
+                utils::string::format("Residue '%s' not found in reduce rules. Skipping it.", resname.c_str()));
+            continue;
+        }
+
+        ResidueReducer residue_builder(input, residues[r], residue_rules->second, messages[r]);
+        residue_builder.set_ignore_duplicate_particles(_ignore_duplicate_particles);
+        residue_builder.set_ignore_missing_particles(_ignore_missing_particles);
+        residue_builder.build(grains[r]);
+    }
+
+    // Prints messages and creates grains serially, in residue order (particle
+    // unique ids are not thread-safe).
+    size_t number_of_grains = 0;
+    for (const auto & residue_grains : grains)
+        number_of_grains += residue_grains.size();
+    _target_topology.reserve(_target_topology.number_of_particles() + number_of_grains);
+
+    for (size_t r = 0; r < residues.size(); ++r)
+    {
+        for (const std::string & message : messages[r])
+            logging::warning("%s", message.c_str());
+        for (const topology::ParticleProperties & grain : grains[r])
+            _target_topology.add_particle(grain);
+    }
+}
+
+std::unordered_map<std::string, std::vector<CompiledRule>> Reducer::_compile_rules(AtomNameTable & names) const
+{
+    std::unordered_map<std::string, std::vector<CompiledRule>> compiled;
+
+    for (const ReduceRule & rule : _rules)
+    {
+        CompiledRule target;
+        target.rule = &rule;
+        for (const std::string & name : rule.getAtomNames())
+        {
+            const uint32_t id = names.intern(name);
+            target.atoms.emplace_back(name, id);
+            target.atom_ids.push_back(id);
+        }
+        std::sort(target.atom_ids.begin(), target.atom_ids.end());
+
+        if (_forcefield.hasProperty(rule.name()))
+            target.properties = _forcefield.getPropertiesFromName(rule.name());
+
+        compiled[rule.residue_name()].push_back(std::move(target));
+    }
+
+    return compiled;
+}
+
+std::vector<ResidueRange> Reducer::_partition_by_residue(const ParticleContainer & particles)
+{
+    std::vector<ResidueRange> residues;
+    size_t begin = 0;
+
+    for (size_t i = 1; i <= particles.size(); ++i)
+    {
+        const bool same_residue = i < particles.size() and
+                                  particles[i].properties().residue_id() == particles[begin].properties().residue_id() and
+                                  particles[i].properties().chain_name() == particles[begin].properties().chain_name();
+        if (not same_residue)
+        {
+            residues.push_back({begin, i});
+            begin = i;
+        }
+    }
+
+    return residues;
+}
+
 // =====================================================================================
 //
 //                              LEGACY CODE
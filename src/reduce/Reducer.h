@@ -7,7 +7,14 @@
 #ifndef __REDUCER_H__
 #define __REDUCER_H__
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Particle.h"
@@ -18,6 +25,7 @@
 #include "logging.h"
 #include "measure.hpp"
 #include "topology.hpp"
+#include "utils.hpp"
 
 namespace biospring
 {
@@ -42,24 +50,85 @@ struct ReductionParameters
     ReductionParameters() : pathGroup(""), pathForceField(""), ignoreMissing(false), ignoreDuplicate(false) {}
 };
 
-// Used to build a specific grain from a set of particles and a rule.
+// Interns atom names to dense integer ids.
+//
+// Rules are compiled against this table once, and each input particle's name is
+// looked up once, so that grains are then built by comparing integers instead of
+// strings.
+class AtomNameTable
+{
+  protected:
+    std::unordered_map<std::string, uint32_t> _ids;
+
+  public:
+    // Id of names that were never interned.
+    static constexpr uint32_t UNKNOWN = std::numeric_limits<uint32_t>::max();
+
+    // Returns the id of a name, interning it if needed.
+    uint32_t intern(const std::string & name)
+    {
+        return _ids.try_emplace(name, static_cast<uint32_t>(_ids.size())).first->second;
+    }
+
+    // Returns the id of a name, or `UNKNOWN` if it was never interned.
+    uint32_t id(const std::string & name) const
+    {
+        const auto it = _ids.find(name);
+        return it == _ids.end() ? UNKNOWN : it->second;
+    }
+
+    size_t size() const { return _ids.size(); }
+};
+
+// A reduce rule whose atom names have been replaced by interned ids, together
+// with its force field properties, looked up once.
+struct CompiledRule
+{
+    const ReduceRule * rule = nullptr;
+    std::vector<uint32_t> atom_ids;                      // sorted
+    std::vector<std::pair<std::string, uint32_t>> atoms; // rule atom names and ids, in rule order
+    std::optional<spn::ParticleProperty> properties;     // empty if the grain is not in the force field
+
+    bool contains(uint32_t id) const { return std::binary_search(atom_ids.begin(), atom_ids.end(), id); }
+};
+
+// Range of consecutive input particles that share the same chain and residue id.
+struct ResidueRange
+{
+    size_t begin;
+    size_t end;
+};
+
+// Input shared by the builders: the all-atom particles and the interned id of each
+// particle's name.
+struct ReductionInput
+{
+    const ParticleContainer & particles;
+    const std::vector<uint32_t> & name_ids;
+};
+
+// Used to build a specific grain from a residue and a rule.
+//
+// Warnings are not printed but appended to a message list, so that residues can
+// be processed concurrently while messages are still printed in residue order.
 class GrainBuilder
 {
   protected:
-    using Grain = topology::Particle;
+    using Grain = topology::ParticleProperties;
 
-    const ParticleContainer & _input_particles;
-    const ReduceRule & _rule;
-    const forcefield::ForceField & _forcefield;
+    const ReductionInput & _input;
+    const ResidueRange _residue;
+    const CompiledRule & _rule;
+    std::vector<std::string> & _messages;
     bool _ignore_duplicate_particles;
     bool _ignore_missing_particles;
     Grain _grain; // output grain
     bool _grain_built;
 
   public:
-    GrainBuilder(const ParticleContainer & input_particles, const ReduceRule & rule,
-                 const forcefield::ForceField & forcefield)
-        : _input_particles(input_particles), _rule(rule), _forcefield(forcefield), _ignore_duplicate_particles(false),
+    GrainBuilder(const ReductionInput & input, ResidueRange residue, const CompiledRule & rule,
+                 std::vector<std::string> & messages)
+        : _input(input), _residue(residue), _rule(rule), _messages(messages), _ignore_duplicate_particles(false),
           _ignore_missing_particles(false), _grain(), _grain_built(false)
     {
     }
@@ -87,12 +156,12 @@ class GrainBuilder
     // Returns a grain built from the input particles and the rule.
     bool build(void)
     {
-        ParticleContainer grain_particles;
+        std::vector<size_t> grain_particles;
 
-        // Adds particles from `_input_particles` that are defined in `_rule`.
-        for (const topology::Particle & p : _input_particles)
-            if (_rule.hasAtomNamed(p.properties().name()))
-                grain_particles.push_back(p);
+        // Adds particles from the residue that are defined in `_rule`.
+        for (size_t i = _residue.begin; i < _residue.end; ++i)
+            if (_rule.contains(_input.name_ids[i]))
+                grain_particles.push_back(i);
 
         // Sanity checks: grain is not empty, has enough particles, and has not too many particles.
         bool success = _check_not_enough_particles(grain_particles) && _check_too_many_particles(grain_particles);
@@ -107,99 +176,117 @@ class GrainBuilder
     }
 
   protected:
-    std::string _grain_name() const { return _rule.name(); }
-    std::string _residue_name() const { return _rule.residue_name(); }
-    int _residue_id() const { return _input_particles[0].properties().residue_id(); }
+    const topology::ParticleProperties & _first() const { return _input.particles[_residue.begin].properties(); }
+
+    const std::string & _grain_name() const { return _rule.rule->name(); }
+    const std::string & _residue_name() const { return _rule.rule->residue_name(); }
+    int _residue_id() const { return _first().residue_id(); }
 
-    // Returns true if a grain contains a particle with a given name.
-    static bool contains_particle(const ParticleContainer & particles, const std::string & name)
+    template <typename... Args> void _warning(const char * fmt, Args... args) const
     {
-        for (const auto & p : particles)
-            if (p.properties().name() == name)
+        _messages.push_back(utils::string::format(fmt, args...));
+    }
+
+    // Returns true if a grain contains a particle with a given name id.
+    bool _contains_particle(const std::vector<size_t> & particles, uint32_t name_id) const
+    {
+        for (size_t i : particles)
+            if (_input.name_ids[i] == name_id)
                 return true;
         return false;
     }
 
     // Creates a grain from a set of particles.
-    Grain _create_grain(const ParticleContainer & grain_particles) const
+    Grain _create_grain(const std::vector<size_t> & grain_particles) const
     {
+        // Same arithmetic as `measure::centroid`.
+        std::array<double, 3> centroid{0.0, 0.0, 0.0};
+        for (size_t i : grain_particles)
+        {
+            const Vector3f & position = _input.particles[i].properties().position();
+            centroid[0] += position.getX();
+            centroid[1] += position.getY();
+            centroid[2] += position.getZ();
+        }
+        const double f = 1.0 / grain_particles.size();
+        centroid[0] *= f;
+        centroid[1] *= f;
+        centroid[2] *= f;
+
         Grain grain;
-        grain.properties().set_name(_grain_name());
-        grain.properties().set_residue_name(_residue_name());
-        grain.properties().set_residue_id(_residue_id());
-        grain.properties().set_chain_name(_input_particles[0].properties().chain_name());
-        grain.properties().set_position(measure::centroid(grain_particles));
+        grain.set_name(_grain_name());
+        grain.set_residue_name(_residue_name());
+        grain.set_residue_id(_residue_id());
+        grain.set_chain_name(_first().chain_name());
+        grain.set_position(centroid);
 
         // Set properties from forcefield.
-        if (_forcefield.hasProperty(_grain_name()))
+        if (_rule.properties)
         {
-            const spn::ParticleProperty & pp = _forcefield.getPropertiesFromName(_grain_name());
-            grain.properties().set_charge(pp.getCharge());
-            grain.properties().set_radius(pp.getRadius());
-            grain.properties().set_mass(pp.getMass());
-            grain.properties().set_epsilon(pp.getEpsilon());
-
-            grain.properties().set_hydrophobicity(pp.getHydrophobicity());
-            // grain.properties().set_imp(topology::IMPProperties::build().transfert_energy_by_accessible_surface(pp.getTransferEnergyByAccessibleSurface()));
+            const spn::ParticleProperty & pp = *_rule.properties;
+            grain.set_charge(pp.getCharge());
+            grain.set_radius(pp.getRadius());
+            grain.set_mass(pp.getMass());
+            grain.set_epsilon(pp.getEpsilon());
+
+            grain.set_hydrophobicity(pp.getHydrophobicity());
             topology::IMPProperties impProperties = topology::IMPProperties::build();
             impProperties.set_solvent_accessible_surface(pp.getSolventAccessibilitySurface());
             impProperties.set_transfert_energy_by_accessible_surface(pp.getTransferEnergyByAccessibleSurface());
-            grain.properties().set_imp(impProperties);
-            // grain.properties().imp().set_transfert_energy_by_accessible_surface(
-            //     pp.getTransferEnergyByAccessibleSurface());
+            grain.set_imp(impProperties);
         }
         else
         {
-            logging::warning("No Forcefield found for '%s'!", _grain_name().c_str());
+            _warning("No Forcefield found for '%s'!", _grain_name().c_str());
         }
 
         return grain;
     }
 
     // Checks if a grain is empty.
-    // If so, displays a warning message.
+    // If so, records a warning message.
     // Returns the success status, which is true if grain is not empty, false otherwise.
-    bool _check_not_empty(const ParticleContainer & grain) const
+    bool _check_not_empty(const std::vector<size_t> & grain) const
     {
         bool success = true;
         if (grain.empty())
         {
-            logging::warning("Residue %s:%d: No particle found to create grain %s...skipping it",
-                             _residue_name().c_str(), _residue_id(), _grain_name().c_str());
+            _warning("Residue %s:%d: No particle found to create grain %s...skipping it", _residue_name().c_str(),
+                     _residue_id(), _grain_name().c_str());
             success = false;
         }
         return success;
     }
 
     // Checks if a grain has not enough particles.
-    // If so, displays a warning message.
+    // If so, records a warning message.
     // Returns the success status, which is true if grain has enough particles, or
     // false if grain has not enough particles and `_ignore_missing_particles` is false.
-    bool _check_not_enough_particles(const ParticleContainer & grain) const
+    bool _check_not_enough_particles(const std::vector<size_t> & grain) const
     {
         if (!_check_not_empty(grain))
             return false;
 
         bool success = true;
-        if (grain.size() < _rule.number_of_atoms())
+        if (grain.size() < _rule.atom_ids.size())
         {
             // Grain has missing particles.
-            // Finds which one are missing to display warning message.
-            for (const std::string & name : _rule.getAtomNames())
+            // Finds which one are missing to record warning message.
+            for (const auto & [name, id] : _rule.atoms)
             {
-                if (!contains_particle(grain, name))
+                if (!_contains_particle(grain, id))
                 {
                     if (_ignore_missing_particles)
                     {
-                        logging::warning("Residue %s:%d: Particle '%s' required for grain '%s' not found in "
-                                         "topology...still adding grain to model",
-                                         _residue_name().c_str(), _residue_id(), name.c_str(), _grain_name().c_str());
+                        _warning("Residue %s:%d: Particle '%s' required for grain '%s' not found in "
+                                 "topology...still adding grain to model",
+                                 _residue_name().c_str(), _residue_id(), name.c_str(), _grain_name().c_str());
                     }
                     else
                     {
-                        logging::warning("Residue %s:%d: Particle '%s' required for grain '%s' not found in "
-                                         "topology...skipping this grain",
-                                         _residue_name().c_str(), _residue_id(), name.c_str(), _grain_name().c_str());
+                        _warning("Residue %s:%d: Particle '%s' required for grain '%s' not found in "
+                                 "topology...skipping this grain",
+                                 _residue_name().c_str(), _residue_id(), name.c_str(), _grain_name().c_str());
                         success = false;
                     }
                 }
@@ -210,23 +297,23 @@ class GrainBuilder
     }
 
     // Checks if a grain has too many particles.
-    // If so, displays a warning message.
+    // If so, records a warning message.
     // Returns the success status, which is true if grain has not too many particles, or
     // false if grain has too many particles and `_ignore_duplicate_particles` is false.
-    bool _check_too_many_particles(const ParticleContainer & grain) const
+    bool _check_too_many_particles(const std::vector<size_t> & grain) const
     {
         bool success = true;
-        if (grain.size() > _rule.number_of_atoms())
+        if (grain.size() > _rule.atom_ids.size())
         {
             if (_ignore_duplicate_particles)
             {
-                logging::warning("Residue %s:%d: Duplicate particles in grain %s...still adding grain to model",
-                                 _residue_name().c_str(), _residue_id(), _grain_name().c_str());
+                _warning("Residue %s:%d: Duplicate particles in grain %s...still adding grain to model",
+                         _residue_name().c_str(), _residue_id(), _grain_name().c_str());
             }
             else
             {
-                logging::warning("Residue %s:%d: Duplicate particles in grain %s...skipping this grain",
-                                 _residue_name().c_str(), _residue_id(), _grain_name().c_str());
+                _warning("Residue %s:%d: Duplicate particles in grain %s...skipping this grain",
+                         _residue_name().c_str(), _residue_id(), _grain_name().c_str());
                 success = false;
             }
         }
@@ -237,16 +324,17 @@ class GrainBuilder
 class ResidueReducer
 {
   protected:
-    const ParticleContainer & _particles;
-    const ReduceRuleContainer & _rules;
-    const forcefield::ForceField & _forcefield;
+    const ReductionInput & _input;
+    const ResidueRange _residue;
+    const std::vector<CompiledRule> & _rules;
+    std::vector<std::string> & _messages;
     bool _ignore_missing_particles;
     bool _ignore_duplicate_particles;
 
   public:
-    ResidueReducer(const ParticleContainer & particles, const ReduceRuleContainer & rules,
-                   const forcefield::ForceField & forcefield)
-        : _particles(particles), _rules(rules), _forcefield(forcefield), _ignore_missing_particles(false),
+    ResidueReducer(const ReductionInput & input, ResidueRange residue, const std::vector<CompiledRule> & rules,
+                   std::vector<std::string> & messages)
+        : _input(input), _residue(residue), _rules(rules), _messages(messages), _ignore_missing_particles(false),
           _ignore_duplicate_particles(false)
     {
     }
@@ -264,17 +352,15 @@ class ResidueReducer
     // Main methods.
     // =============================================================================
 
-    // Returns a vector of grains representing the residue.
-    std::vector<topology::Particle> build(void) const
+    // Appends the grains representing the residue to `grains`.
+    void build(std::vector<topology::ParticleProperties> & grains) const
     {
-        // Displays warnings if some particles are present in the residue but not in the rule.
+        // Records warnings if some particles are present in the residue but not in the rule.
         _check_unknown_particles();
 
-        std::vector<topology::Particle> grains;
-
-        for (const auto & rule : _rules)
+        for (const CompiledRule & rule : _rules)
         {
-            GrainBuilder grain_builder(_particles, rule, _forcefield);
+            GrainBuilder grain_builder(_input, _residue, rule, _messages);
             grain_builder.set_ignore_duplicate_particles(_ignore_duplicate_particles);
             grain_builder.set_ignore_missing_particles(_ignore_missing_particles);
 
@@ -282,26 +368,29 @@ class ResidueReducer
             if (success)
                 grains.push_back(grain_builder.grain());
         }
-
-        return grains;
     }
 
   protected:
-    // Displays a warning message if some particles are present in the residue but not in the rule.
+    // Records a warning message if some particles are present in the residue but not in the rule.
     void _check_unknown_particles() const
     {
-        for (const topology::Particle & p : _particles)
-            if (!_particle_belongs_to_a_grain(p))
-                logging::warning("Particle '%s' of residue '%s':'%d' not found in any grain", p.properties().name().c_str(),
-                                                                                              p.properties().residue_name().c_str(),
-                                                                                              p.properties().residue_id());
+        for (size_t i = _residue.begin; i < _residue.end; ++i)
+        {
+            if (!_particle_belongs_to_a_grain(_input.name_ids[i]))
+            {
+                const topology::ParticleProperties & p = _input.particles[i].properties();
+                _messages.push_back(utils::string::format("Particle '%s' of residue '%s':'%d' not found in any grain",
+                                                          p.name().c_str(), p.residue_name().c_str(),
+                                                          p.residue_id()));
+            }
+        }
     }
 
     // Returns true if a particle belongs to a grain, i.e. if particle's names is found in at least one rule.
-    bool _particle_belongs_to_a_grain(const topology::Particle & p) const
+    bool _particle_belongs_to_a_grain(uint32_t name_id) const
     {
-        for (const ReduceRule & rule : _rules)
-            if (rule.hasAtomNamed(p.properties().name()))
+        for (const CompiledRule & rule : _rules)
+            if (rule.contains(name_id))
                 return true;
 
         return false;
@@ -311,8 +400,6 @@ class ResidueReducer
 class Reducer
 {
   protected:
-    using ParticleGroups = std::vector<ParticleContainer>;
-
     const topology::Topology & _source_topology;
 
     forcefield::ForceField _forcefield;
@@ -354,24 +441,13 @@ class Reducer
     void initialize_forcefield(const std::string & path);
     void initialize_rules(const std::string & path);
 
-    void reduce(void)
-    {
-        if (!_forcefield_initialized)
-            throw std::runtime_error("Reducer:: Forcefield not initialized!");
-
-        if (!_rules_initialized)
-            throw std::runtime_error("Reducer:: Rules not initialized!");
-
-        logging::status("Reducing model using group and forcefield");
-
-        ParticleGroups residues = _group_particles_by_residue(_source_topology.particles().data());
-
-        for (const ParticleContainer & residue : residues)
-        {
-            ParticleContainer grains = _reduce_residue(residue);
-            _target_topology.particles().push_back(grains);
-        }
-    }
+    // Reduces the source topology.
+    //
+    // The source particles are partitioned once into residues (runs of consecutive
+    // particles sharing chain and residue id). Residues are then reduced
+    // concurrently, and their grains are appended to the target topology in residue
+    // order, so that the result does not depend on the number of threads.
+    void reduce(void);
 
     void reduce(const ReductionParameters & parameters)
     {
@@ -394,53 +470,11 @@ class Reducer
     }
 
   protected:
-    std::vector<topology::Particle> _reduce_residue(const ParticleContainer & residue) const
-    {
-        const auto & rules = _rules.get_rules_for_residue(residue[0].properties().residue_name());
-
-        // Returns an empty vector if found no rule for this residue.
-        if (rules.empty())
-        {
-            std::string resname = residue[0].properties().residue_name();
-            logging::warning("Residue '%s' not found in reduce rules. Skipping it.", resname.c_str());
-            return {};
-        }
-
-        ResidueReducer residue_builder(residue, rules, _forcefield);
-        residue_builder.set_ignore_duplicate_particles(_ignore_duplicate_particles);
-        residue_builder.set_ignore_missing_particles(_ignore_missing_particles);
-
-        return residue_builder.build();
-    }
-
-    static bool __still_same_residue(const ParticleContainer & current_residue, const topology::Particle & p)
-    {
-        return p.properties().residue_id() == current_residue[0].properties().residue_id() and
-               p.properties().chain_name() == current_residue[0].properties().chain_name();
-    }
-
-    ParticleGroups _group_particles_by_residue(const ParticleContainer & particles) const
-    {
-        ParticleGroups residues;
-        ParticleContainer current_residue = {particles[0]};
+    // Compiles the rules against `names`, grouped by residue name.
+    std::unordered_map<std::string, std::vector<CompiledRule>> _compile_rules(AtomNameTable & names) const;
 
-        for (size_t i = 1; i < particles.size(); i++)
-        {
-            const topology::Particle & p = particles[i];
-
-            if (__still_same_residue(current_residue, p))
-                current_residue.push_back(p);
-
-            else
-            {
-                residues.push_back(current_residue);
-                current_residue.clear();
-                current_residue.push_back(p);
-            }
-        }
-        residues.push_back(current_residue);
-        return residues;
-    }
+    // Returns the ranges of consecutive particles that share chain and residue id.
+    static std::vector<ResidueRange> _partition_by_residue(const ParticleContainer & particles);
 };
 
 namespace legacy
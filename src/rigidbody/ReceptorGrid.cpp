@@ -0,0 +1,119 @@
+#include "ReceptorGrid.h"
+#include "nsearch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace biospring
+{
+namespace rigidbody
+{
+
+// Fills a grid around the receptor particles. `pair(p, distance)` returns the energy and the
+// force module (positive when attractive) between the receptor particle `p` and a particle
+// placed at a cell centre.
+template <typename PairFunction>
+static std::shared_ptr<grid::PotentialGrid> computeReceptorGrid(const std::vector<spn::Particle> & particles,
+                                                                const std::vector<size_t> & receptor, float cutoff,
+                                                                double spacing, PairFunction pair)
+{
+    if (receptor.empty())
+        throw std::invalid_argument("receptor grid: no receptor particle");
+    if (spacing <= 0.0)
+        throw std::invalid_argument("receptor grid: spacing must be > 0");
+
+    std::array<double, 3> lower;
+    std::array<double, 3> upper;
+    lower.fill(std::numeric_limits<double>::max());
+    upper.fill(std::numeric_limits<double>::lowest());
+    for (const size_t i : receptor)
+    {
+        const Vector3f & position = particles[i].getPosition();
+        const std::array<double, 3> coordinates = {position.getX(), position.getY(), position.getZ()};
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            lower[axis] = std::min(lower[axis], coordinates[axis]);
+            upper[axis] = std::max(upper[axis], coordinates[axis]);
+        }
+    }
+
+    std::array<double, 3> origin;
+    std::array<size_t, 3> shape;
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        origin[axis] = lower[axis] - cutoff;
+        shape[axis] = static_cast<size_t>(std::ceil((upper[axis] - lower[axis] + 2.0 * cutoff) / spacing)) + 1;
+    }
+
+    auto cells = std::make_shared<grid::PotentialGrid>(origin, shape, std::array<double, 3>{spacing, spacing, spacing});
+
+    const nsearch::NeighborSearch<std::vector<spn::Particle>> search(particles, cutoff, receptor);
+
+    const long nx = static_cast<long>(shape[0]);
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < nx; ++i)
+    {
+        spn::Particle node;
+        for (size_t j = 0; j < shape[1]; ++j)
+        {
+            for (size_t k = 0; k < shape[2]; ++k)
+            {
+                const Vector3f centre(static_cast<float>(origin[0] + (static_cast<double>(i) + 0.5) * spacing),
+                                      static_cast<float>(origin[1] + (static_cast<double>(j) + 0.5) * spacing),
+                                      static_cast<float>(origin[2] + (static_cast<double>(k) + 0.5) * spacing));
+                node.setPosition(centre);
+
+                grid::PotentialCell cell{0.0f, Vector3f()};
+                search.for_each_neighbor(node, [&](size_t index) {
+                    const spn::Particle & p = particles[index];
+                    Vector3f direction = p.getPosition() - centre;
+                    const float distance = direction.norm();
+                    if (distance == 0.0f)
+                        return;
+                    const auto [energy, module] = pair(p, distance);
+                    direction.normalize();
+                    cell.scalar += energy;
+                    cell.vector += direction * module;
+                });
+                cells->at(grid::discrete_coordinates(static_cast<int>(i), static_cast<int>(j), static_cast<int>(k))) =
+                    cell;
+            }
+        }
+    }
+
+    return cells;
+}
+
+std::shared_ptr<grid::PotentialGrid> computeStericReceptorGrid(const std::vector<spn::Particle> & particles,
+                                                               const std::vector<size_t> & receptor,
+                                                               const forcefield::ForceField & ff,
+                                                               const spn::Particle & probe, float cutoff,
+                                                               double spacing)
+{
+    const float radius = probe.getRadius();
+    const float epsilon = probe.getEpsilon();
+    return computeReceptorGrid(particles, receptor, cutoff, spacing, [&](const spn::Particle & p, float distance) {
+        return std::pair<float, float>(
+            ff.computeStericEnergy(p.getRadius(), radius, p.getEpsilon(), epsilon, distance),
+            ff.computeStericForceModule(p.getRadius(), radius, p.getEpsilon(), epsilon, distance));
+    });
+}
+
+std::shared_ptr<grid::PotentialGrid> computeElectrostaticReceptorGrid(const std::vector<spn::Particle> & particles,
+                                                                      const std::vector<size_t> & receptor,
+                                                                      const forcefield::ForceField & ff, float cutoff,
+                                                                      double spacing)
+{
+    return computeReceptorGrid(particles, receptor, cutoff, spacing, [&](const spn::Particle & p, float distance) {
+        return std::pair<float, float>(ff.computeElectrostaticEnergy(p.getCharge(), 1.0f, distance),
+                                       ff.computeElectrostaticForceModule(p.getCharge(), 1.0f, distance));
+    });
+}
+
+} // namespace rigidbody
+} // namespace biospring
@@ -0,0 +1,43 @@
+#ifndef __RECEPTORGRID_H__
+#define __RECEPTORGRID_H__
+
+#include "Particle.h"
+#include "forcefield/ForceField.h"
+#include "grid/PotentialGrid.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace biospring
+{
+namespace rigidbody
+{
+
+// Potential grids of a receptor, for rigid docking (rigidbody.receptor).
+//
+// The receptor is frozen and its interactions with the other particles are read from grids
+// computed once, so that a step costs O(ligand particles) instead of O(pairs). Each cell holds
+// the energy (scalar) and the force (vector) at its centre, summed over the receptor particles
+// within the cutoff. The grids extend the bounding box of the receptor by the cutoff, so that
+// the interaction is zero outside of them.
+//
+// The steric grid is computed for a single probe particle (radius and epsilon), the
+// electrostatic grid for a unit charge.
+//
+// Throws std::invalid_argument if there is no receptor particle or if the spacing is not
+// positive.
+std::shared_ptr<grid::PotentialGrid> computeStericReceptorGrid(const std::vector<spn::Particle> & particles,
+                                                               const std::vector<size_t> & receptor,
+                                                               const forcefield::ForceField & ff,
+                                                               const spn::Particle & probe, float cutoff,
+                                                               double spacing);
+
+std::shared_ptr<grid::PotentialGrid> computeElectrostaticReceptorGrid(const std::vector<spn::Particle> & particles,
+                                                                      const std::vector<size_t> & receptor,
+                                                                      const forcefield::ForceField & ff, float cutoff,
+                                                                      double spacing);
+
+} // namespace rigidbody
+} // namespace biospring
+
+#endif // __RECEPTORGRID_H__
@@ -1,5 +1,6 @@
 #include "RigidBodiesManager.h"
 #include "SpringNetwork.h"
+#include <algorithm>
 #include <vector>
 
 namespace biospring
@@ -59,6 +60,35 @@ namespace rigidbody
         }
     }
 
+    // Bodies are processed one after the other, each one in parallel over its members.
+    void RigidBodiesManager::AccumulateForcesAndTorques()
+    {
+        for (RigidBody * rb : collection)
+            rb->accumulateForceAndTorque();
+    }
+
+    void RigidBodiesManager::UpdateMemberPositions(double timestep)
+    {
+        for (RigidBody * rb : collection)
+            rb->updateMemberPositions(timestep);
+    }
+
+    void RigidBodiesManager::ApplyHydrophobicRestraints(spn::SpringNetwork & spn, double scale)
+    {
+        std::vector<size_t> candidates;
+        for (const RigidBody * rb : collection)
+            rb->addHydrophobicRestraintCandidates(candidates);
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        if (candidates.empty())
+            return;
+
+        const RigidBody::ParticleSearch search(spn.getParticles(), RigidBody::HYDROPHOBIC_RESTRAINT_CUTOFF,
+                                               std::move(candidates));
+        for (RigidBody * rb : collection)
+            rb->applyHydrophobicRestraint(search, scale);
+    }
+
     void RigidBodiesManager::CleanRigidBodies()
     {
         for (auto rb : collection)
@@ -15,7 +15,16 @@ class RigidBodiesManager
     static void SolveRigidBodiesDynamic();
     static void CleanRigidBodies();
 
-    static std::vector<RigidBody*> getCollection() { return collection; }
+    // Rigid-body dynamics fast path, see RigidBody::accumulateForceAndTorque and
+    // RigidBody::updateMemberPositions.
+    static void AccumulateForcesAndTorques();
+    static void UpdateMemberPositions(double timestep);
+
+    // Hydrophobic restraint between the bodies: the candidate particles of all the bodies are
+    // put in one cell list, then each body reduces the pair forces of its own members.
+    static void ApplyHydrophobicRestraints(spn::SpringNetwork & spn, double scale);
+
+    static const std::vector<RigidBody*> & getCollection() { return collection; }
     
   private:
       static std::vector<RigidBody*> collection;
@@ -40,16 +40,18 @@ RigidBody::RigidBody(spn::SpringNetwork * sp, unsigned newRbId, std::vector<unsi
 
 void RigidBody::UpdateSpringsState(bool isStatic)
 {
-    // Loop on all springs and update their status to "static" if the
-    // particle pair is rigid.
+    // Springs between two particles of this body are "static": they keep a
+    // constant length, so they are skipped by the force loop.
+    std::vector<unsigned> internalSprings;
     for (unsigned i = 0; i < this->_spn->getNumberOfSprings(); i++)
     {
         biospring::spn::Spring & s = _spn->getSpring(i);
         spn::Particle & p1 = s.getParticle1();
         spn::Particle & p2 = s.getParticle2();
-        if (p1.isRigid() && p2.isRigid())
-            _spn->updateSpringState(s.getId(), isStatic);
+        if (p1.isRigid() && p2.isRigid() && p1.getRigidBodyId() == rbid && p2.getRigidBodyId() == rbid)
+            internalSprings.push_back(s.getId());
     }
+    _spn->updateSpringStates(internalSprings, isStatic);
 }
 
 // Initialization ------------------------------------------------------------------------------------------------------
@@ -92,6 +94,7 @@ void RigidBody::init()
         _mass = computeTotalMass();
         _pos = computeBarycentre();
         _orientation= Quaternion(0, 0, 0, 1);
+        _updateRotation();
         _force = Vector3f();
         _torque = Vector3f();
         _omega_v = Vector3f();
@@ -169,8 +172,14 @@ void RigidBody::computeAllLocalPositions()
         spn::Particle & p = _spn->getParticle(_particulesIds[i]);
         Vector3f p0 = p.getPosition() - _pos;
         _p0.push_back(p0); // = "radius"
+        _localX.push_back(p0.getX());
+        _localY.push_back(p0.getY());
+        _localZ.push_back(p0.getZ());
         checkCom = checkCom + (p0) * p.getMass();
     }
+    _newX.resize(_p0.size());
+    _newY.resize(_p0.size());
+    _newZ.resize(_p0.size());
     //logging::info("Check center of mass, need to be equal to (0,0,0) and has value of (%f, %f, %f)", checkCom.getX(), checkCom.getY(), checkCom.getZ());
 }
 
@@ -234,9 +243,7 @@ void RigidBody::initImpalaSampling()
 
     // Initialize local insertion vector
     InsertionVector & iv = _spn->getInsertionVector();
-    iv.computeVector();
-    iv.computeAngle();
-    iv.computeRollAngle();
+    iv.update();
     // _p0 is indexed by position in _particulesIds. getExtid() is the PDB atom
     // id (or, for a coarse-grained model, the residue id), which lives in a
     // different numbering entirely: indexing _p0 with it read out of bounds and
@@ -436,8 +443,6 @@ void RigidBody::solve()
         applyDepthRestraint();
         if (_spn->isInsertionVectorEnabled())
             applyAngleRestraint();
-
-        //applyHydrophobicRestraint();
     }
     // Automatic sampling solving
     if (_spn->isImpalaSamplingEnabled() && !_spn->isMonteCarloEnabled())
@@ -478,11 +483,25 @@ void RigidBody::solve()
     delta_orientation.fromAxisAngle(_omega_v, _omega_v.norm() * _dt);
     _orientation = delta_orientation * _orientation;
     _orientation.normalize();
+    _updateRotation();
 
     _force = Vector3f();
     _torque = Vector3f();
 }
 
+// Rotation matrix of the unit quaternion _orientation: R v = q v q^-1.
+void RigidBody::_updateRotation()
+{
+    const double x = _orientation.getX();
+    const double y = _orientation.getY();
+    const double z = _orientation.getZ();
+    const double w = _orientation.getW();
+
+    _rotation = {1 - 2 * (y * y + z * z), 2 * (x * y - z * w),     2 * (x * z + y * w),
+                 2 * (x * y + z * w),     1 - 2 * (x * x + z * z), 2 * (y * z - x * w),
+                 2 * (x * z - y * w),     2 * (y * z + x * w),     1 - 2 * (x * x + y * y)};
+}
+
 void RigidBody::applyDepthRestraint()
 {
     if (applydepthrestraint)
@@ -497,7 +516,7 @@ void RigidBody::applyDepthRestraint()
 void RigidBody::applyAngleRestraint()
 {
     // Angle and insertion depth restraints
-    InsertionVector iv = _spn->getInsertionVector();
+    InsertionVector & iv = _spn->getInsertionVector();
     spn::Particle & p1 = iv.getParticle(0);
     spn::Particle & p2 = iv.getParticle(1);
 
@@ -515,59 +534,72 @@ void RigidBody::applyAngleRestraint()
     }
 }
 
-void RigidBody::applyHydrophobicRestraint()
+bool RigidBody::isHydrophobicRestraintCandidate(const spn::Particle & p)
 {
-    Vector3f force = Vector3f();
-    Vector3f torque = Vector3f();
-#ifdef OPENMP_SUPPORT
-#pragma omp parallel default(shared)
-#endif
+    return p.getTransferEnergyByAccessibleSurface() > 0.0 &&
+           p.getSolventAccessibilitySurface() >= HYDROPHOBIC_RESTRAINT_MIN_SASA &&
+           std::abs(p.getPosition().getZ()) <= HYDROPHOBIC_RESTRAINT_SLAB;
+}
+
+// Adds the members (and interaction particles) that take part in the restraint at this step.
+void RigidBody::addHydrophobicRestraintCandidates(std::vector<size_t> & candidates) const
+{
+    for (const auto * ids : {&_selfHydrophilicParticles, &_interactionHydrophilicParticles})
+        for (const unsigned id : *ids)
+            if (isHydrophobicRestraintCandidate(_spn->getParticle(id)))
+                candidates.push_back(id);
+}
+
+// Pairs each hydrophilic member with the candidates of `search` that do not belong to this body.
+void RigidBody::applyHydrophobicRestraint(const ParticleSearch & search, double scale)
 {
+    const std::vector<spn::Particle> & particles = _spn->getParticles();
+    const double cx = _pos.getX(), cy = _pos.getY(), cz = _pos.getZ();
+    double fx = 0, fy = 0, fz = 0, tx = 0, ty = 0, tz = 0;
+
+    const long n = static_cast<long>(_selfHydrophilicParticles.size());
 #ifdef OPENMP_SUPPORT
-#pragma omp for schedule(static)
-#endif 
-    for (unsigned i = 0; i < _selfHydrophilicParticles.size() ; i++)
+#pragma omp parallel for reduction(+ : fx, fy, fz, tx, ty, tz) schedule(dynamic, 16)
+#endif
+    for (long i = 0; i < n; i++)
     {
-        spn::Particle & pi = _spn->getParticle(_selfHydrophilicParticles[i]);
-        // Into membrane, consider only particle with positive transfert energy
-        double tri = pi.getTransferEnergyByAccessibleSurface();
-        double sasai = pi.getSolventAccessibilitySurface();
-        if (sasai < 10 || abs(pi.getPosition().getZ()) > 13.5) continue;
-
-        for (unsigned j = 0; j < _interactionHydrophilicParticles.size() ; j++)
-        {
-            spn::Particle & pj = _spn->getParticle(_interactionHydrophilicParticles[j]);
-            double trj = pj.getTransferEnergyByAccessibleSurface();
-            double sasaj = pj.getSolventAccessibilitySurface();
-            if (sasaj < 10 || abs(pj.getPosition().getZ()) > 13.5) continue;
-            Vector3f f = pi.getPosition() - pj.getPosition();
-            double distance = f.norm();
-            if (distance > 5) continue;
-            double hydrophobicitymodule = 0.0;
-            hydrophobicitymodule = (sasai * tri * sasaj * trj) * exp(-distance);
-            //hydrophobicitymodule *= ForceField::AVOGADRONUMBER * 1.0E-3;
-            //hydrophobicitymodule *= 1.0E-3;
-            hydrophobicitymodule *= 10;
-            f = f * hydrophobicitymodule;
-            //pi.addf(f);
-            //Vector3f visc = pi.getVelocity() * _spn->getViscosity();
-            force += f;
-            Vector3f t = (pi.getPosition() - _pos) ^ f;
-            torque += t;
-        }
+        const spn::Particle & pi = particles[_selfHydrophilicParticles[static_cast<size_t>(i)]];
+        if (!isHydrophobicRestraintCandidate(pi))
+            continue;
+        const double factor = pi.getSolventAccessibilitySurface() * pi.getTransferEnergyByAccessibleSurface() * scale;
+        const double rx = pi.getPosition().getX() - cx;
+        const double ry = pi.getPosition().getY() - cy;
+        const double rz = pi.getPosition().getZ() - cz;
+
+        search.for_each_neighbor(pi, [&](size_t j) {
+            const spn::Particle & pj = particles[j];
+            if (pj.isRigid() && pj.getRigidBodyId() == rbid)
+                return;
+
+            const Vector3f d = pi.getPosition() - pj.getPosition();
+            const double module = factor * pj.getSolventAccessibilitySurface() *
+                                  pj.getTransferEnergyByAccessibleSurface() * std::exp(-d.norm());
+            const double dx = d.getX() * module, dy = d.getY() * module, dz = d.getZ() * module;
+            fx += dx;
+            fy += dy;
+            fz += dz;
+            tx += ry * dz - rz * dy;
+            ty += rz * dx - rx * dz;
+            tz += rx * dy - ry * dx;
+        });
     }
-    //logging::info("force:%s ; torque:%s", _force.to_string().c_str(), _torque.to_string().c_str());
-    _force += force;
-    _torque += torque;
-}
+
+    _force += Vector3f(fx, fy, fz);
+    _torque += Vector3f(tx, ty, tz);
 }
 
 // Compute resultant force and torque that acts on the rigid system.
 // Update total force and torque applied to rigid body
 void RigidBody::computeParticleForceAndTorque(spn::Particle & p)
 {
-    if (RigidBodiesManager::getCollection().size() == 0) return;
-    RigidBody *rb = RigidBodiesManager::getCollection()[p.getRigidBodyId()];
+    const std::vector<RigidBody *> & collection = RigidBodiesManager::getCollection();
+    if (collection.size() == 0) return;
+    RigidBody *rb = collection[p.getRigidBodyId()];
     Vector3f torque = Vector3f();
     Vector3f force = p.getForce();
     if (!rb->withoutRotational)
@@ -579,6 +611,85 @@ void RigidBody::computeParticleForceAndTorque(spn::Particle & p)
     rb->_torque += torque;
 }
 
+// Same as computeParticleForceAndTorque for all the members at once.
+void RigidBody::accumulateForceAndTorque()
+{
+    const double cx = _pos.getX(), cy = _pos.getY(), cz = _pos.getZ();
+    const bool rotational = !withoutRotational;
+    double fx = 0, fy = 0, fz = 0, tx = 0, ty = 0, tz = 0;
+
+    const long n = static_cast<long>(_particulesIds.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for reduction(+ : fx, fy, fz, tx, ty, tz) schedule(static)
+#endif
+    for (long i = 0; i < n; i++)
+    {
+        const spn::Particle & p = _spn->getParticle(_particulesIds[static_cast<size_t>(i)]);
+        const Vector3f & f = p.getForce();
+        fx += f.getX();
+        fy += f.getY();
+        fz += f.getZ();
+        if (rotational)
+        {
+            const double rx = p.getPosition().getX() - cx;
+            const double ry = p.getPosition().getY() - cy;
+            const double rz = p.getPosition().getZ() - cz;
+            tx += ry * f.getZ() - rz * f.getY();
+            ty += rz * f.getX() - rx * f.getZ();
+            tz += rx * f.getY() - ry * f.getX();
+        }
+    }
+
+    _force += Vector3f(fx, fy, fz);
+    _torque += Vector3f(tx, ty, tz);
+}
+
+// Same as the dynamics branch of integrateParticleVelocity for all the members at once.
+void RigidBody::updateMemberPositions(double timestep)
+{
+    const std::array<double, 9> & r = _rotation;
+    const float r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4], r5 = r[5], r6 = r[6], r7 = r[7], r8 = r[8];
+    const float cx = _pos.getX(), cy = _pos.getY(), cz = _pos.getZ();
+    const float * lx = _localX.data();
+    const float * ly = _localY.data();
+    const float * lz = _localZ.data();
+    float * nx = _newX.data();
+    float * ny = _newY.data();
+    float * nz = _newZ.data();
+
+    const long n = static_cast<long>(_particulesIds.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel default(shared)
+#endif
+    {
+        // Plain loop over contiguous arrays: vectorized by the compiler.
+#ifdef OPENMP_SUPPORT
+#pragma omp for schedule(static)
+#endif
+        for (long i = 0; i < n; i++)
+        {
+            nx[i] = cx + r0 * lx[i] + r1 * ly[i] + r2 * lz[i];
+            ny[i] = cy + r3 * lx[i] + r4 * ly[i] + r5 * lz[i];
+            nz[i] = cz + r6 * lx[i] + r7 * ly[i] + r8 * lz[i];
+        }
+
+#ifdef OPENMP_SUPPORT
+#pragma omp for schedule(static)
+#endif
+        for (long i = 0; i < n; i++)
+        {
+            spn::Particle & p = _spn->getParticle(_particulesIds[static_cast<size_t>(i)]);
+            const Vector3f previousPosition = p.getPosition();
+            const Vector3f newPosition(nx[i], ny[i], nz[i]);
+            p.setPreviousPosition(previousPosition);
+            p.setPosition(newPosition);
+            // Set particle velocity (usefull when applying viscosity)
+            p.setVelocity((newPosition - previousPosition) / timestep);
+            p.resetForce();
+        }
+    }
+}
+
 void RigidBody::resetRigidBodiesForceAndTorque()
 {
 #ifdef OPENMP_SUPPORT
@@ -599,8 +710,9 @@ void RigidBody::resetRigidBodiesForceAndTorque()
 
 void RigidBody::integrateParticleVelocity(spn::Particle & p, int ind, double timestep)
 {
-    if (RigidBodiesManager::getCollection().size() == 0) return;
-    RigidBody *rb = RigidBodiesManager::getCollection()[p.getRigidBodyId()];
+    const std::vector<RigidBody *> & collection = RigidBodiesManager::getCollection();
+    if (collection.size() == 0) return;
+    RigidBody *rb = collection[p.getRigidBodyId()];
     Vector3f previousPosition = p.getPosition();
     p.setPreviousPosition(previousPosition);
 
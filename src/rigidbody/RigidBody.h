@@ -3,6 +3,7 @@
 
 #include <Vector3f.h>
 #include "Quaternion.h"
+#include <array>
 #include <cmath>
 #include <iostream>
 #include "InsertionVector.h"
@@ -10,6 +11,7 @@
 #include <string>
 #include "random.hpp"
 #include "SpringNetwork.h"
+#include "nsearch.hpp"
 
 using Random = effolkronium::random_static;
 
@@ -104,7 +106,17 @@ class RigidBody
     Vector3f external_force;
     Vector3f external_torque;
 
-    void applyHydrophobicRestraint();
+    // Hydrophobic restraint between rigid bodies (rigidbody.enablehydrophobicrestraint), see
+    // RigidBodiesManager::ApplyHydrophobicRestraints. Only particles with a positive transfer
+    // energy, a large enough accessible surface and inside the membrane slab take part.
+    using ParticleSearch = nsearch::NeighborSearch<std::vector<spn::Particle>>;
+    static constexpr double HYDROPHOBIC_RESTRAINT_CUTOFF = 5.0;    // Å
+    static constexpr double HYDROPHOBIC_RESTRAINT_SLAB = 13.5;     // membrane half-thickness, Å
+    static constexpr double HYDROPHOBIC_RESTRAINT_MIN_SASA = 10.0; // Å²
+
+    static bool isHydrophobicRestraintCandidate(const spn::Particle & p);
+    void addHydrophobicRestraintCandidates(std::vector<size_t> & candidates) const;
+    void applyHydrophobicRestraint(const ParticleSearch & search, double scale);
 
     void solve();
 
@@ -112,6 +124,17 @@ class RigidBody
     static void resetRigidBodiesForceAndTorque();
     static void integrateParticleVelocity(spn::Particle & p, int ind, double timestep); // Called in spn::SpringNetwork::integrateParticles
 
+    // Dynamics without IMPALA sampling nor Monte Carlo: the body is moved as a single 6-DOF
+    // object. Force and torque are reduced over the members in one pass, and the members are
+    // placed from the rotation matrix, computed once per step (see solve), with a batched
+    // transform of their local positions.
+    void accumulateForceAndTorque();
+    void updateMemberPositions(double timestep);
+
+    // Rotation from the body frame to the lab frame, row-major.
+    const std::array<double, 9> & getRotation() const { return _rotation; }
+    Quaternion getOrientation() const { return _orientation; }
+
     /* ---------------------------------------------------------------------------------------------------------------*/
 
     Matrix createVector3Matrix();
@@ -169,6 +192,7 @@ class RigidBody
     Vector3f   _pos;                       /* x(t) is _com at initial state*/
 
     Quaternion _orientation;
+    std::array<double, 9> _rotation;           /* R(t), from _orientation */
 
     /* Derived quantities (auxiliary variables) */            
     Vector3f   _v;                         /* v(t) */
@@ -181,6 +205,12 @@ class RigidBody
     /* Computed quantities */
     Vector3f   _force,                     /* F(t) */
                _torque;                    /* τ(t) */
+
+    /* Local positions (_p0) and new positions of the members, one array per coordinate */
+    std::vector<float> _localX, _localY, _localZ;
+    std::vector<float> _newX, _newY, _newZ;
+
+    void _updateRotation();
 };
 
 } // namespace rigidbody
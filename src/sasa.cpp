@@ -0,0 +1,209 @@
+#include "sasa.hpp"
+
+#include "logging.h"
+#include "nsearch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+#ifdef OPENMP_SUPPORT
+#include <omp.h>
+#endif
+
+namespace biospring
+{
+namespace sasa
+{
+
+using Searcher = nsearch::NeighborSearch<std::vector<Vector3f>>;
+
+std::vector<Vector3f> sphere_points(size_t n)
+{
+    std::vector<Vector3f> points;
+    points.reserve(n);
+
+    const double golden_angle = std::numbers::pi * (3.0 - std::sqrt(5.0));
+    for (size_t k = 0; k < n; ++k)
+    {
+        const double y = 1.0 - (2.0 * k + 1.0) / n;
+        const double r = std::sqrt(1.0 - y * y);
+        const double phi = golden_angle * k;
+        points.emplace_back(std::cos(phi) * r, y, std::sin(phi) * r);
+    }
+    return points;
+}
+
+ShrakeRupley::ShrakeRupley(const std::vector<double> & radii, double probe_radius, size_t npoints, float threshold,
+                           int nthreads)
+    : _threshold(threshold), _nthreads(nthreads)
+{
+    if (npoints == 0)
+        logging::die("ShrakeRupley: the number of test points must be positive");
+
+    _radii.reserve(radii.size());
+    for (double radius : radii)
+    {
+        const float extended = radius > 0.0 ? static_cast<float>(radius + probe_radius) : 0.0f;
+        _radii.push_back(extended);
+        _max_radius = std::max(_max_radius, extended);
+    }
+
+    for (const Vector3f & point : sphere_points(npoints))
+    {
+        _points_x.push_back(point.getX());
+        _points_y.push_back(point.getY());
+        _points_z.push_back(point.getZ());
+    }
+
+    _areas.assign(radii.size(), 0.0);
+}
+
+size_t ShrakeRupley::compute(const std::vector<float> & positions)
+{
+    const size_t n = _radii.size();
+    if (positions.size() != 3 * n)
+        logging::die("ShrakeRupley: expected %zu coordinates, got %zu", 3 * n, positions.size());
+
+    _last_recomputed = 0;
+    if (n == 0 || _max_radius <= 0.0f)
+    {
+        _total = 0.0;
+        _valid = true;
+        return 0;
+    }
+
+    _positions.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        _positions[i] = Vector3f(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]);
+
+    const std::vector<size_t> dirty = _select_dirty();
+
+    // Two spheres overlap when their centers are closer than the sum of their radii.
+    const Searcher searcher(_positions, 2.0f * _max_radius);
+    const size_t npoints = _points_x.size();
+    const float * px = _points_x.data();
+    const float * py = _points_y.data();
+    const float * pz = _points_z.data();
+
+#ifdef OPENMP_SUPPORT
+    const int nthreads = _nthreads > 0 ? _nthreads : omp_get_max_threads();
+#pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        std::vector<uint8_t> buried(npoints);
+
+#ifdef OPENMP_SUPPORT
+#pragma omp for schedule(dynamic, 64)
+#endif
+        for (size_t k = 0; k < dirty.size(); ++k)
+        {
+            const size_t i = dirty[k];
+            const float ri = _radii[i];
+            if (ri <= 0.0f)
+            {
+                _areas[i] = 0.0;
+                continue;
+            }
+
+            std::fill(buried.begin(), buried.end(), 0);
+            uint8_t * mask = buried.data();
+            const Vector3f & center = _positions[i];
+
+            searcher.for_each_neighbor(center, [&](size_t j) {
+                const float rj = _radii[j];
+                const float dx = center.getX() - _positions[j].getX();
+                const float dy = center.getY() - _positions[j].getY();
+                const float dz = center.getZ() - _positions[j].getZ();
+                const float d2 = dx * dx + dy * dy + dz * dz;
+                if (rj <= 0.0f || d2 >= (ri + rj) * (ri + rj))
+                    return;
+
+                // A test point c_i + ri * u is buried in sphere j when
+                // |d + ri * u|^2 < rj^2, with d = c_i - c_j.
+                const float offset = d2 + ri * ri - rj * rj;
+                const float scale = 2.0f * ri;
+#ifdef OPENMP_SUPPORT
+#pragma omp simd
+#endif
+                for (size_t p = 0; p < npoints; ++p)
+                    mask[p] |= static_cast<uint8_t>(offset + scale * (dx * px[p] + dy * py[p] + dz * pz[p]) < 0.0f);
+            });
+
+            size_t exposed = 0;
+            for (size_t p = 0; p < npoints; ++p)
+                exposed += mask[p] == 0;
+
+            _areas[i] = 4.0 * std::numbers::pi * ri * ri * static_cast<double>(exposed) / npoints;
+        }
+    }
+
+    // Summed in particle order so that the total does not depend on the number of threads.
+    _total = 0.0;
+    for (double area : _areas)
+        _total += area;
+
+    _valid = true;
+    _last_recomputed = dirty.size();
+    return _last_recomputed;
+}
+
+std::vector<size_t> ShrakeRupley::_select_dirty()
+{
+    const size_t n = _positions.size();
+    std::vector<size_t> dirty;
+
+    if (!_valid || _references.size() != n)
+    {
+        _references = _positions;
+        dirty.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            dirty[i] = i;
+        return dirty;
+    }
+
+    const float threshold2 = _threshold * _threshold;
+    std::vector<size_t> moved;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Vector3f d = _positions[i] - _references[i];
+        if (d.getX() * d.getX() + d.getY() * d.getY() + d.getZ() * d.getZ() > threshold2)
+            moved.push_back(i);
+    }
+
+    if (moved.empty())
+        return dirty;
+
+    // Most particles would be marked anyway: skip the neighbor lookups.
+    if (moved.size() > n / 4)
+    {
+        _valid = false;
+        return _select_dirty();
+    }
+
+    // A particle is affected by a moved particle if it is close to it now, or was
+    // close to it before it moved. Particles that did not move stay within
+    // `_threshold` of their reference, hence the margins.
+    std::vector<uint8_t> flags(n, 0);
+    const float cutoff = 2.0f * _max_radius + 2.0f * _threshold;
+    const Searcher current(_positions, cutoff);
+    const Searcher previous(_references, cutoff);
+    for (size_t j : moved)
+    {
+        flags[j] = 1;
+        current.for_each_neighbor(_positions[j], [&](size_t i) { flags[i] = 1; });
+        previous.for_each_neighbor(_references[j], [&](size_t i) { flags[i] = 1; });
+    }
+
+    for (size_t j : moved)
+        _references[j] = _positions[j];
+
+    for (size_t i = 0; i < n; ++i)
+        if (flags[i])
+            dirty.push_back(i);
+    return dirty;
+}
+
+} // namespace sasa
+} // namespace biospring
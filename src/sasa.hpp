@@ -0,0 +1,88 @@
+// Solvent accessible surface area.
+//
+// Native implementation of the Shrake-Rupley algorithm: each particle is
+// represented by a sphere of radius `radius + probe_radius` covered with test
+// points, and its area is the fraction of points that are not buried in any
+// neighboring sphere. Neighbors are found with the project cell lists.
+//
+// The computation is incremental: a particle is only recomputed when itself or
+// one of its neighbors has moved by more than a threshold since its area was
+// last computed. Between two calls where nothing moved much, the cost is the
+// one of building the cell lists.
+//
+// Example:
+//
+//     sasa::ShrakeRupley sr(radii, 1.4);
+//     sr.compute(positions);          // x, y, z for each particle
+//     double area = sr.areas()[0];
+//
+
+#ifndef __SASA_HPP__
+#define __SASA_HPP__
+
+#include <cstddef>
+#include <vector>
+
+#include "Vector3f.h"
+
+namespace biospring
+{
+namespace sasa
+{
+
+// Returns `n` points evenly distributed on the unit sphere (golden section spiral).
+std::vector<Vector3f> sphere_points(size_t n);
+
+class ShrakeRupley
+{
+  protected:
+    std::vector<float> _radii; // radius + probe radius for each particle
+    float _max_radius = 0.0f;
+    float _threshold;
+    int _nthreads;
+
+    // Test points on the unit sphere, stored as structure of arrays.
+    std::vector<float> _points_x;
+    std::vector<float> _points_y;
+    std::vector<float> _points_z;
+
+    std::vector<Vector3f> _positions;
+    std::vector<Vector3f> _references; // positions at which the neighborhood of each particle was last accounted for
+    std::vector<double> _areas;
+    double _total = 0.0;
+    bool _valid = false;
+    size_t _last_recomputed = 0;
+
+  public:
+    // Negative radii (unknown atom types) are handled as null radii.
+    // `threshold` is the displacement (in Å) above which a particle is considered as moved.
+    // `nthreads` is the number of OpenMP threads used (0 for the OpenMP default).
+    ShrakeRupley(const std::vector<double> & radii, double probe_radius = 1.4, size_t npoints = 100,
+                 float threshold = 0.1f, int nthreads = 0);
+
+    // Updates the areas for the given positions (x, y, z for each particle).
+    // Returns the number of particles whose area was recomputed.
+    size_t compute(const std::vector<float> & positions);
+
+    // Forces the next call to `compute` to recompute every particle.
+    void invalidate() { _valid = false; }
+
+    // Returns the area of each particle (in Å²).
+    const std::vector<double> & areas() const { return _areas; }
+
+    // Returns the total area (in Å²).
+    double total() const { return _total; }
+
+    size_t size() const { return _radii.size(); }
+    size_t number_of_points() const { return _points_x.size(); }
+    size_t last_recomputed() const { return _last_recomputed; }
+
+  protected:
+    // Returns the indices of the particles to recompute.
+    std::vector<size_t> _select_dirty();
+};
+
+} // namespace sasa
+} // namespace biospring
+
+#endif // __SASA_HPP__
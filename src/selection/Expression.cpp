@@ -0,0 +1,483 @@
+#include "Expression.h"
+#include "nsearch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace biospring
+{
+namespace selection
+{
+
+// ======================================================================================
+//
+// Expression tree.
+//
+// ======================================================================================
+
+struct Context
+{
+    const std::vector<spn::Particle> & particles;
+    const Labels & labels;
+};
+
+class Expression::Node
+{
+  public:
+    virtual ~Node() = default;
+
+    // Sets `mask` (one entry per particle) to the particles selected by the node.
+    virtual void evaluate(const Context & context, Mask & mask) const = 0;
+
+    // True if the node depends on the particle positions.
+    virtual bool dynamic() const { return false; }
+};
+
+using NodePtr = std::shared_ptr<const Expression::Node>;
+
+namespace
+{
+
+class Constant : public Expression::Node
+{
+  public:
+    explicit Constant(bool value) : _value(value) {}
+    void evaluate(const Context &, Mask & mask) const override { std::fill(mask.begin(), mask.end(), _value); }
+
+  protected:
+    bool _value;
+};
+
+// chain, resname, name, element: interned label in a set of values.
+class LabelMatch : public Expression::Node
+{
+  public:
+    using Field = std::vector<uint32_t> Labels::*;
+
+    LabelMatch(Field field, std::vector<std::string> values) : _field(field), _values(std::move(values)) {}
+
+    void evaluate(const Context & context, Mask & mask) const override
+    {
+        std::fill(mask.begin(), mask.end(), 0);
+        const std::vector<uint32_t> & column = context.labels.*_field;
+        const size_t n = column.size();
+        for (const std::string & value : _values)
+        {
+            const uint32_t id = context.labels.lookup(value);
+            if (id == Labels::npos)
+                continue;
+            for (size_t i = 0; i < n; ++i)
+                mask[i] |= static_cast<uint8_t>(column[i] == id);
+        }
+    }
+
+  protected:
+    Field _field;
+    std::vector<std::string> _values;
+};
+
+// resid, index: value in a set of inclusive ranges.
+class RangeMatch : public Expression::Node
+{
+  public:
+    RangeMatch(bool index, std::vector<std::pair<long, long>> ranges) : _index(index), _ranges(std::move(ranges)) {}
+
+    void evaluate(const Context & context, Mask & mask) const override
+    {
+        std::fill(mask.begin(), mask.end(), 0);
+        const size_t n = mask.size();
+        for (const auto & [first, last] : _ranges)
+        {
+            if (_index)
+            {
+                const long end = std::min(last, static_cast<long>(n) - 1);
+                for (long i = std::max(first, 0L); i <= end; ++i)
+                    mask[static_cast<size_t>(i)] = 1;
+            }
+            else
+            {
+                const std::vector<int> & resid = context.labels.resid;
+                for (size_t i = 0; i < n; ++i)
+                    mask[i] |= static_cast<uint8_t>(resid[i] >= first and resid[i] <= last);
+            }
+        }
+    }
+
+  protected:
+    bool _index;
+    std::vector<std::pair<long, long>> _ranges;
+};
+
+class CoordinateMatch : public Expression::Node
+{
+  public:
+    CoordinateMatch(int axis, const std::string & op, double value) : _axis(axis), _op(op), _value(value) {}
+
+    void evaluate(const Context & context, Mask & mask) const override
+    {
+        const size_t n = mask.size();
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double x = context.particles[i].getPosition()[_axis];
+            bool selected;
+            if (_op == "<")
+                selected = x < _value;
+            else if (_op == "<=")
+                selected = x <= _value;
+            else if (_op == ">")
+                selected = x > _value;
+            else
+                selected = x >= _value;
+            mask[i] = selected;
+        }
+    }
+
+    bool dynamic() const override { return true; }
+
+  protected:
+    int _axis;
+    std::string _op;
+    double _value;
+};
+
+class Not : public Expression::Node
+{
+  public:
+    explicit Not(NodePtr child) : _child(std::move(child)) {}
+
+    void evaluate(const Context & context, Mask & mask) const override
+    {
+        _child->evaluate(context, mask);
+        for (uint8_t & m : mask)
+            m = !m;
+    }
+
+    bool dynamic() const override { return _child->dynamic(); }
+
+  protected:
+    NodePtr _child;
+};
+
+class Binary : public Expression::Node
+{
+  public:
+    Binary(bool conjunction, NodePtr lhs, NodePtr rhs)
+        : _conjunction(conjunction), _lhs(std::move(lhs)), _rhs(std::move(rhs))
+    {
+    }
+
+    void evaluate(const Context & context, Mask & mask) const override
+    {
+        _lhs->evaluate(context, mask);
+        Mask other(mask.size());
+        _rhs->evaluate(context, other);
+        const size_t n = mask.size();
+        if (_conjunction)
+            for (size_t i = 0; i < n; ++i)
+                mask[i] &= other[i];
+        else
+            for (size_t i = 0; i < n; ++i)
+                mask[i] |= other[i];
+    }
+
+    bool dynamic() const override { return _lhs->dynamic() or _rhs->dynamic(); }
+
+  protected:
+    bool _conjunction;
+    NodePtr _lhs;
+    NodePtr _rhs;
+};
+
+// Particles closer than `radius` to a particle of the child selection, the child selection
+// included. Distances are looked up with a cell list built on the child selection.
+class Within : public Expression::Node
+{
+  public:
+    Within(double radius, NodePtr child) : _radius(radius), _child(std::move(child)) {}
+
+    void evaluate(const Context & context, Mask & mask) const override
+    {
+        _child->evaluate(context, mask);
+
+        std::vector<size_t> targets;
+        for (size_t i = 0; i < mask.size(); ++i)
+            if (mask[i])
+                targets.push_back(i);
+        if (targets.empty())
+            return;
+
+        const nsearch::NeighborSearch<std::vector<spn::Particle>> search(context.particles,
+                                                                        static_cast<float>(_radius), targets);
+
+        const long n = static_cast<long>(mask.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(dynamic, 256)
+#endif
+        for (long i = 0; i < n; ++i)
+        {
+            if (mask[i])
+                continue;
+            bool close = false;
+            search.for_each_neighbor(context.particles[i], [&close](size_t) { close = true; });
+            if (close)
+                mask[i] = 1;
+        }
+    }
+
+    bool dynamic() const override { return true; }
+
+  protected:
+    double _radius;
+    NodePtr _child;
+};
+
+// ======================================================================================
+//
+// Parser.
+//
+// ======================================================================================
+
+// Words that end a list of values.
+const std::set<std::string> RESERVED = {"and",   "or",      "not",  "(",       ")",     "all", "none", "within",
+                                        "of",    "chain",   "name", "resname", "element", "resid", "index",
+                                        "x",     "y",       "z",    "<",       "<=",    ">",   ">="};
+
+std::vector<std::string> tokenize(const std::string & text)
+{
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        const char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c)))
+            ++i;
+        else if (c == '(' or c == ')')
+            tokens.emplace_back(1, text[i++]);
+        else if (c == '<' or c == '>')
+        {
+            const bool equal = i + 1 < text.size() and text[i + 1] == '=';
+            tokens.push_back(text.substr(i, equal ? 2 : 1));
+            i += equal ? 2 : 1;
+        }
+        else
+        {
+            const size_t start = i;
+            while (i < text.size() and not std::isspace(static_cast<unsigned char>(text[i])) and
+                   std::string("()<>").find(text[i]) == std::string::npos)
+                ++i;
+            tokens.push_back(text.substr(start, i - start));
+        }
+    }
+    return tokens;
+}
+
+class Parser
+{
+  public:
+    using Lookup = std::function<NodePtr(const std::string &)>;
+
+    Parser(const std::string & text, const Lookup & lookup) : _text(text), _tokens(tokenize(text)), _lookup(lookup) {}
+
+    NodePtr parse()
+    {
+        if (_tokens.empty())
+            _error("empty selection");
+        NodePtr root = _expression();
+        if (_position < _tokens.size())
+            _error("unexpected '" + _tokens[_position] + "'");
+        return root;
+    }
+
+  protected:
+    const std::string & _text;
+    std::vector<std::string> _tokens;
+    size_t _position = 0;
+    const Lookup & _lookup;
+
+    [[noreturn]] void _error(const std::string & message) const
+    {
+        throw std::invalid_argument("selection '" + _text + "': " + message);
+    }
+
+    bool _done() const { return _position >= _tokens.size(); }
+    const std::string & _peek() const { return _tokens[_position]; }
+
+    bool _accept(const std::string & token)
+    {
+        if (_done() or _peek() != token)
+            return false;
+        ++_position;
+        return true;
+    }
+
+    const std::string & _next(const std::string & expected)
+    {
+        if (_done())
+            _error("expected " + expected + " at the end");
+        return _tokens[_position++];
+    }
+
+    double _number(const std::string & token)
+    {
+        std::istringstream iss(token);
+        double value;
+        if ((iss >> value).fail() or not iss.eof())
+            _error("invalid number '" + token + "'");
+        return value;
+    }
+
+    long _integer(const std::string & token)
+    {
+        std::istringstream iss(token);
+        long value;
+        if ((iss >> value).fail() or not iss.eof())
+            _error("invalid integer '" + token + "'");
+        return value;
+    }
+
+    // Values following a keyword, up to the next reserved word.
+    std::vector<std::string> _values(const std::string & keyword)
+    {
+        std::vector<std::string> values;
+        while (not _done() and not RESERVED.count(_peek()))
+            values.push_back(_tokens[_position++]);
+        if (values.empty())
+            _error("expected a value after '" + keyword + "'");
+        return values;
+    }
+
+    // "n", "n-m" (n >= 0) or "n:m".
+    std::pair<long, long> _range(const std::string & token)
+    {
+        size_t separator = token.find(':');
+        if (separator == std::string::npos)
+            separator = token.find('-', 1);
+        if (separator == std::string::npos)
+        {
+            const long value = _integer(token);
+            return {value, value};
+        }
+        const long first = _integer(token.substr(0, separator));
+        const long last = _integer(token.substr(separator + 1));
+        if (first > last)
+            _error("invalid range '" + token + "'");
+        return {first, last};
+    }
+
+    NodePtr _expression()
+    {
+        NodePtr node = _term();
+        while (_accept("or"))
+            node = std::make_shared<Binary>(false, node, _term());
+        return node;
+    }
+
+    NodePtr _term()
+    {
+        NodePtr node = _factor();
+        while (_accept("and"))
+            node = std::make_shared<Binary>(true, node, _factor());
+        return node;
+    }
+
+    NodePtr _factor()
+    {
+        const std::string token = _next("a selection");
+
+        if (token == "not")
+            return std::make_shared<Not>(_factor());
+        if (token == "(")
+        {
+            NodePtr node = _expression();
+            if (not _accept(")"))
+                _error("missing ')'");
+            return node;
+        }
+        if (token == "all" or token == "none")
+            return std::make_shared<Constant>(token == "all");
+        if (token.size() > 1 and token[0] == '@')
+        {
+            NodePtr node = _lookup ? _lookup(token.substr(1)) : nullptr;
+            if (not node)
+                _error("unknown selection '" + token.substr(1) + "'");
+            return node;
+        }
+        if (token == "chain")
+            return std::make_shared<LabelMatch>(&Labels::chain, _values(token));
+        if (token == "resname")
+            return std::make_shared<LabelMatch>(&Labels::resname, _values(token));
+        if (token == "name")
+            return std::make_shared<LabelMatch>(&Labels::name, _values(token));
+        if (token == "element")
+            return std::make_shared<LabelMatch>(&Labels::element, _values(token));
+        if (token == "resid" or token == "index")
+        {
+            std::vector<std::pair<long, long>> ranges;
+            for (const std::string & value : _values(token))
+                ranges.push_back(_range(value));
+            return std::make_shared<RangeMatch>(token == "index", ranges);
+        }
+        if (token == "x" or token == "y" or token == "z")
+        {
+            const std::string op = _next("a comparison operator");
+            if (op != "<" and op != "<=" and op != ">" and op != ">=")
+                _error("expected a comparison operator after '" + token + "'");
+            return std::make_shared<CoordinateMatch>(token[0] - 'x', op, _number(_next("a number")));
+        }
+        if (token == "within")
+        {
+            const double radius = _number(_next("a distance"));
+            if (radius <= 0.0)
+                _error("'within' distance must be > 0");
+            if (not _accept("of"))
+                _error("expected 'of' after 'within " + _tokens[_position - 1] + "'");
+            return std::make_shared<Within>(radius, _factor());
+        }
+        _error("unexpected '" + token + "'");
+    }
+};
+
+} // namespace
+
+// ======================================================================================
+//
+// Expression.
+//
+// ======================================================================================
+
+Expression::Expression(const std::string & text, const Lookup & lookup) : _text(text)
+{
+    const Parser::Lookup nodes = [&lookup](const std::string & name) -> NodePtr {
+        const Expression * expression = lookup ? lookup(name) : nullptr;
+        return expression ? expression->_root : nullptr;
+    };
+    _root = Parser(_text, nodes).parse();
+}
+
+bool Expression::isDynamic() const { return _root->dynamic(); }
+
+Mask Expression::mask(const std::vector<spn::Particle> & particles, const Labels & labels) const
+{
+    if (labels.size() != particles.size())
+        throw std::invalid_argument("selection '" + _text + "': labels do not match the particles");
+    Mask mask(particles.size());
+    _root->evaluate(Context{particles, labels}, mask);
+    return mask;
+}
+
+std::vector<size_t> Expression::evaluate(const std::vector<spn::Particle> & particles, const Labels & labels) const
+{
+    const Mask selected = mask(particles, labels);
+    std::vector<size_t> indexes;
+    for (size_t i = 0; i < selected.size(); ++i)
+        if (selected[i])
+            indexes.push_back(i);
+    return indexes;
+}
+
+} // namespace selection
+} // namespace biospring
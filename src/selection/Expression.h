@@ -0,0 +1,61 @@
+#ifndef __SELECTION_EXPRESSION_H__
+#define __SELECTION_EXPRESSION_H__
+
+#include "Labels.h"
+#include "Particle.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace selection
+{
+
+// One byte per particle: 1 if selected.
+using Mask = std::vector<uint8_t>;
+
+// A compiled selection expression, e.g. `chain A and resid 10-50 and name CA`.
+//
+//     expression := term { "or" term }
+//     term       := factor { "and" factor }
+//     factor     := "not" factor | "(" expression ")" | "all" | "none" | "@" name
+//                 | ("chain" | "resname" | "name" | "element") value { value }
+//                 | ("resid" | "index") range { range }           range := n | n-m | n:m
+//                 | ("x" | "y" | "z") ("<" | "<=" | ">" | ">=") number
+//                 | "within" number "of" factor
+//
+// `index` is the 0-based position of the particle in the system. `@name` refers to another
+// selection, expanded when the expression is compiled. Expressions that depend on positions
+// (coordinates, `within`) are dynamic: they must be evaluated again when particles move.
+class Expression
+{
+  public:
+    class Node;
+
+    // Returns the expression of a named selection, or nullptr if there is none.
+    using Lookup = std::function<const Expression *(const std::string &)>;
+
+    // Throws std::invalid_argument on a syntax error or an unknown reference.
+    explicit Expression(const std::string & text, const Lookup & lookup = nullptr);
+
+    const std::string & getText() const { return _text; }
+    bool isDynamic() const;
+
+    Mask mask(const std::vector<spn::Particle> & particles, const Labels & labels) const;
+
+    // Sorted indexes of the selected particles.
+    std::vector<size_t> evaluate(const std::vector<spn::Particle> & particles, const Labels & labels) const;
+
+  protected:
+    std::string _text;
+    std::shared_ptr<const Node> _root;
+};
+
+} // namespace selection
+} // namespace biospring
+
+#endif // __SELECTION_EXPRESSION_H__
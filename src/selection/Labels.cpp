@@ -0,0 +1,40 @@
+#include "Labels.h"
+
+namespace biospring
+{
+namespace selection
+{
+
+Labels::Labels(const std::vector<spn::Particle> & particles)
+{
+    const size_t n = particles.size();
+    chain.reserve(n);
+    resname.reserve(n);
+    name.reserve(n);
+    element.reserve(n);
+    resid.reserve(n);
+
+    for (const spn::Particle & p : particles)
+    {
+        chain.push_back(_intern(p.getChainName()));
+        resname.push_back(_intern(p.getResName()));
+        name.push_back(_intern(p.getName()));
+        element.push_back(_intern(p.getElementName()));
+        resid.push_back(static_cast<int>(p.getResId()));
+    }
+}
+
+uint32_t Labels::lookup(const std::string & s) const
+{
+    const auto it = _ids.find(s);
+    return it == _ids.end() ? npos : it->second;
+}
+
+uint32_t Labels::_intern(const std::string & s)
+{
+    const auto [it, inserted] = _ids.emplace(s, static_cast<uint32_t>(_ids.size()));
+    return it->second;
+}
+
+} // namespace selection
+} // namespace biospring
@@ -0,0 +1,48 @@
+#ifndef __SELECTION_LABELS_H__
+#define __SELECTION_LABELS_H__
+
+#include "Particle.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace biospring
+{
+namespace selection
+{
+
+// Particle labels laid out as one array per field, for the selection predicates.
+//
+// Strings are interned: each field holds the id of its value in a shared table, so that a
+// predicate such as `chain A` is an integer comparison over a contiguous array.
+class Labels
+{
+  public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    Labels() = default;
+    explicit Labels(const std::vector<spn::Particle> & particles);
+
+    size_t size() const { return resid.size(); }
+
+    // Returns the id of a string, or npos if no particle has it.
+    uint32_t lookup(const std::string & s) const;
+
+    std::vector<uint32_t> chain;
+    std::vector<uint32_t> resname;
+    std::vector<uint32_t> name;
+    std::vector<uint32_t> element;
+    std::vector<int> resid;
+
+  protected:
+    std::unordered_map<std::string, uint32_t> _ids;
+
+    uint32_t _intern(const std::string & s);
+};
+
+} // namespace selection
+} // namespace biospring
+
+#endif // __SELECTION_LABELS_H__
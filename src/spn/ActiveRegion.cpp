@@ -0,0 +1,144 @@
+#include "ActiveRegion.h"
+
+#include "concepts.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace biospring
+{
+namespace spn
+{
+
+static double squared_distance(const std::array<double, 3> & a, const std::array<double, 3> & b)
+{
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// ======================================================================================
+//
+// Hashed cells.
+//
+// ======================================================================================
+
+void ActiveRegion::Cells::remove(const std::array<double, 3> & position, unsigned index)
+{
+    const auto it = _cells.find(_keyAt(position));
+    if (it == _cells.end())
+        return;
+    std::vector<unsigned> & cell = it->second;
+    const auto element = std::find(cell.begin(), cell.end(), index);
+    if (element == cell.end())
+        return;
+    *element = cell.back();
+    cell.pop_back();
+    if (cell.empty())
+        _cells.erase(it);
+}
+
+std::array<int64_t, 3> ActiveRegion::Cells::_cell(const std::array<double, 3> & position) const
+{
+    const auto cell = [&](double x) { return static_cast<int64_t>(std::floor(x / _size)); };
+    return {cell(position[0]), cell(position[1]), cell(position[2])};
+}
+
+// 21 bits per coordinate: cells far apart may share a key, which only adds candidates
+// that are then rejected by distance.
+uint64_t ActiveRegion::Cells::_key(const std::array<int64_t, 3> & cell)
+{
+    const auto bits = [](int64_t c) { return static_cast<uint64_t>(c + (int64_t(1) << 20)) & 0x1FFFFF; };
+    return (bits(cell[0]) << 42) | (bits(cell[1]) << 21) | bits(cell[2]);
+}
+
+// ======================================================================================
+//
+// Active region.
+//
+// ======================================================================================
+
+ActiveRegion::ActiveRegion(double radius, double buffer)
+    : _radius(radius), _buffer(buffer), _frozen(radius), _centers(radius + buffer)
+{
+    if (!(radius > 0.0))
+        throw std::invalid_argument("active region: radius must be positive");
+    if (!(buffer >= 0.0))
+        throw std::invalid_argument("active region: buffer must not be negative");
+}
+
+ActiveRegion::Changes ActiveRegion::init(const std::vector<Particle> & particles, const std::vector<unsigned> & mobile,
+                                         const std::vector<std::array<double, 3>> & centers)
+{
+    _state.assign(particles.size(), FIXED);
+    for (const unsigned i : mobile)
+        _state[i] = ACTIVE;
+    _active = mobile;
+    _numberOfFrozen = 0;
+    _frozen.clear();
+    return update(particles, centers);
+}
+
+void ActiveRegion::_freeze(const std::vector<Particle> & particles, unsigned index)
+{
+    _state[index] = FROZEN;
+    _frozen.add(concepts::locatable::get_position(particles[index]), index);
+    ++_numberOfFrozen;
+}
+
+ActiveRegion::Changes ActiveRegion::update(const std::vector<Particle> & particles,
+                                           const std::vector<std::array<double, 3>> & centers)
+{
+    Changes changes;
+
+    _centers.clear();
+    for (size_t k = 0; k < centers.size(); ++k)
+        _centers.add(centers[k], static_cast<unsigned>(k));
+
+    // Freezes the active particles far from every center.
+    const double outer = (_radius + _buffer) * (_radius + _buffer);
+    size_t kept = 0;
+    for (const unsigned i : _active)
+    {
+        const std::array<double, 3> position = concepts::locatable::get_position(particles[i]);
+        bool near = false;
+        _centers.forEachNear(position,
+                             [&](unsigned k) { near = near || squared_distance(position, centers[k]) < outer; });
+        if (near)
+            _active[kept++] = i;
+        else
+        {
+            _freeze(particles, i);
+            changes.frozen.push_back(i);
+        }
+    }
+    _active.resize(kept);
+
+    // Activates the frozen particles close to a center.
+    const double inner = _radius * _radius;
+    for (const std::array<double, 3> & center : centers)
+    {
+        _frozen.forEachNear(center, [&](unsigned i) {
+            const std::array<double, 3> position = concepts::locatable::get_position(particles[i]);
+            if (_state[i] == FROZEN && squared_distance(position, center) < inner)
+            {
+                _state[i] = ACTIVE;
+                changes.activated.push_back(i);
+            }
+        });
+    }
+    std::sort(changes.activated.begin(), changes.activated.end());
+    for (const unsigned i : changes.activated)
+    {
+        _frozen.remove(concepts::locatable::get_position(particles[i]), i);
+        _active.push_back(i);
+    }
+    _numberOfFrozen -= changes.activated.size();
+
+    return changes;
+}
+
+} // namespace spn
+} // namespace biospring
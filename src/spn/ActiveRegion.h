@@ -0,0 +1,107 @@
+#ifndef __ACTIVEREGION_H__
+#define __ACTIVEREGION_H__
+
+#include "Particle.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace biospring
+{
+namespace spn
+{
+
+// Active region (activeregion.*): only the particles close to a set of centers move.
+//
+// A particle is activated when it comes closer than `radius` to a center, and frozen when it is
+// farther than `radius + buffer` from every center; the buffer keeps particles at the border
+// from switching state at each update. The region only decides which particles change state,
+// see SpringNetwork::_updateActiveRegion.
+//
+// Frozen particles are kept in a hashed cell list: they do not move, so it stays exact, and
+// an update only visits the active particles and the frozen particles near the centers.
+class ActiveRegion
+{
+  public:
+    struct Changes
+    {
+        std::vector<unsigned> activated;
+        std::vector<unsigned> frozen;
+
+        bool empty() const { return activated.empty() && frozen.empty(); }
+    };
+
+    // Throws std::invalid_argument if radius is not positive or buffer is negative.
+    ActiveRegion(double radius, double buffer);
+
+    // Starts with every mobile particle active, then updates the region. Particles that are not
+    // mobile (static in the input, the probe) are never activated.
+    Changes init(const std::vector<Particle> & particles, const std::vector<unsigned> & mobile,
+                 const std::vector<std::array<double, 3>> & centers);
+
+    Changes update(const std::vector<Particle> & particles, const std::vector<std::array<double, 3>> & centers);
+
+    bool isActive(size_t particle) const { return _state[particle] == ACTIVE; }
+    size_t getNumberOfActiveParticles() const { return _active.size(); }
+    size_t getNumberOfFrozenParticles() const { return _numberOfFrozen; }
+
+  protected:
+    enum State : uint8_t
+    {
+        FIXED,
+        ACTIVE,
+        FROZEN
+    };
+
+    // Cells of a given size, hashed: only non-empty cells are stored.
+    class Cells
+    {
+      public:
+        explicit Cells(double size) : _size(size) {}
+
+        void add(const std::array<double, 3> & position, unsigned index) { _cells[_keyAt(position)].push_back(index); }
+        void remove(const std::array<double, 3> & position, unsigned index);
+        void clear() { _cells.clear(); }
+
+        // Calls callback(index) for the elements of the cell of the position and of the 26 cells around.
+        template <typename Callback>
+        void forEachNear(const std::array<double, 3> & position, Callback && callback) const
+        {
+            const std::array<int64_t, 3> cell = _cell(position);
+            for (int64_t dx = -1; dx <= 1; ++dx)
+                for (int64_t dy = -1; dy <= 1; ++dy)
+                    for (int64_t dz = -1; dz <= 1; ++dz)
+                    {
+                        const auto it = _cells.find(_key({cell[0] + dx, cell[1] + dy, cell[2] + dz}));
+                        if (it != _cells.end())
+                            for (const unsigned index : it->second)
+                                callback(index);
+                    }
+        }
+
+      protected:
+        double _size;
+        std::unordered_map<uint64_t, std::vector<unsigned>> _cells;
+
+        std::array<int64_t, 3> _cell(const std::array<double, 3> & position) const;
+        static uint64_t _key(const std::array<int64_t, 3> & cell);
+        uint64_t _keyAt(const std::array<double, 3> & position) const { return _key(_cell(position)); }
+    };
+
+    double _radius;
+    double _buffer;
+    std::vector<State> _state; // per particle
+    std::vector<unsigned> _active;
+    size_t _numberOfFrozen = 0;
+    Cells _frozen;  // frozen particles, cells of size `radius`
+    Cells _centers; // centers of the current update, cells of size `radius + buffer`
+
+    void _freeze(const std::vector<Particle> & particles, unsigned index);
+};
+
+} // namespace spn
+} // namespace biospring
+
+#endif // __ACTIVEREGION_H__
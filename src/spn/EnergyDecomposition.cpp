@@ -0,0 +1,110 @@
+#include "EnergyDecomposition.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace biospring
+{
+namespace spn
+{
+
+const char * EnergyDecomposition::getTermName(Term term)
+{
+    static const char * const names[NUMBER_OF_TERMS] = {"spring", "electrostatic", "steric", "imp", "hydrophobic"};
+    return names[term];
+}
+
+EnergyDecomposition::EnergyDecomposition(size_t numberOfParticles) : _pending(numberOfParticles) {}
+
+size_t EnergyDecomposition::addGroup(const std::string & name, const std::vector<size_t> & particles)
+{
+    _groups.push_back({name, {}});
+    _sums.push_back({});
+    setGroupParticles(_groups.size() - 1, particles);
+    return _groups.size() - 1;
+}
+
+void EnergyDecomposition::setGroupParticles(size_t group, const std::vector<size_t> & particles)
+{
+    for (const size_t i : particles)
+        if (i >= _pending.size())
+            throw std::invalid_argument("energy decomposition: particle index " + std::to_string(i) +
+                                        " out of range in group '" + _groups[group].name + "'");
+    _groups[group].particles = particles;
+}
+
+void EnergyDecomposition::accumulate(const std::vector<Particle> & particles)
+{
+    // Each group sums its own particles: threads never write to the same sums, and the
+    // result does not depend on the number of threads.
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (long g = 0; g < static_cast<long>(_groups.size()); ++g)
+    {
+        Energies & sums = _sums[static_cast<size_t>(g)];
+        for (const size_t i : _groups[static_cast<size_t>(g)].particles)
+        {
+            const std::array<float, NUMBER_OF_TERMS> & pending = _pending[i];
+            for (size_t term = 0; term < NUMBER_OF_TERMS; ++term)
+                sums[term] += pending[term];
+
+            const Particle & p = particles[i];
+            if (p.isDynamic())
+            {
+                sums[ELECTROSTATIC] += p.getElectrostaticEnergy();
+                sums[STERIC] += p.getStericEnergy();
+                sums[IMP] += p.getIMPEnergy();
+                sums[HYDROPHOBIC] += p.getHydrophobicityEnergy();
+            }
+        }
+    }
+
+    std::fill(_pending.begin(), _pending.end(), std::array<float, NUMBER_OF_TERMS>{});
+    ++_samples;
+}
+
+double EnergyDecomposition::getMean(size_t group, Term term) const
+{
+    return _samples == 0 ? 0.0 : _sums[group][term] / static_cast<double>(_samples);
+}
+
+double EnergyDecomposition::getMeanTotal(size_t group) const
+{
+    const Energies & sums = _sums[group];
+    return _samples == 0 ? 0.0 : std::accumulate(sums.begin(), sums.end(), 0.0) / static_cast<double>(_samples);
+}
+
+void EnergyDecomposition::open(const std::string & path)
+{
+    _output.open(path, std::ios::trunc);
+    if (not _output)
+        throw std::runtime_error("cannot open energy decomposition output '" + path + "'");
+
+    _output << "step,group";
+    for (size_t term = 0; term < NUMBER_OF_TERMS; ++term)
+        _output << "," << getTermName(static_cast<Term>(term));
+    _output << ",total\n";
+}
+
+void EnergyDecomposition::write(size_t step)
+{
+    if (_output.is_open() and _samples > 0)
+    {
+        for (size_t g = 0; g < _groups.size(); ++g)
+        {
+            _output << step << "," << _groups[g].name;
+            for (size_t term = 0; term < NUMBER_OF_TERMS; ++term)
+                _output << "," << getMean(g, static_cast<Term>(term));
+            _output << "," << getMeanTotal(g) << "\n";
+        }
+        _output.flush();
+    }
+
+    std::fill(_sums.begin(), _sums.end(), Energies{});
+    _samples = 0;
+}
+
+} // namespace spn
+} // namespace biospring
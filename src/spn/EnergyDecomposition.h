@@ -0,0 +1,85 @@
+#ifndef __ENERGYDECOMPOSITION_H__
+#define __ENERGYDECOMPOSITION_H__
+
+#include "Particle.h"
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace spn
+{
+
+// Energy of groups of particles (residues or named selections), accumulated each step and
+// averaged over the sampling interval (decomposition.*).
+//
+// Pair energies are split in halves between the two particles, spring energies between the two
+// ends of the spring. The energies stored in the particles are read as is; contributions the
+// force loops keep apart (the deferred halves of nonbonded pairs, springs) are added with
+// addEnergy() from their serial passes. Groups may overlap.
+class EnergyDecomposition
+{
+  public:
+    enum Term
+    {
+        SPRING,
+        ELECTROSTATIC,
+        STERIC,
+        IMP,
+        HYDROPHOBIC,
+        NUMBER_OF_TERMS
+    };
+
+    static const char * getTermName(Term term);
+
+    explicit EnergyDecomposition(size_t numberOfParticles);
+
+    // Returns the index of the group.
+    size_t addGroup(const std::string & name, const std::vector<size_t> & particles);
+    void setGroupParticles(size_t group, const std::vector<size_t> & particles);
+
+    size_t getNumberOfGroups() const { return _groups.size(); }
+    const std::string & getGroupName(size_t group) const { return _groups[group].name; }
+
+    // Not thread-safe: called from the serial passes of the force loops.
+    void addEnergy(Term term, size_t particle, float energy) { _pending[particle][term] += energy; }
+
+    // Adds the energies of the current step to the sums, then clears the pending energies.
+    // Energies stored in static particles are not read: they are never computed.
+    void accumulate(const std::vector<Particle> & particles);
+
+    size_t getNumberOfSamples() const { return _samples; }
+
+    // Mean energy of a group since the last write (kJ/mol).
+    double getMean(size_t group, Term term) const;
+    double getMeanTotal(size_t group) const;
+
+    // Opens the table: one line per group at each write, "step,group,<terms>,total".
+    void open(const std::string & path);
+
+    // Writes the mean energies, then starts a new averaging interval.
+    void write(size_t step);
+
+  protected:
+    using Energies = std::array<double, NUMBER_OF_TERMS>;
+
+    struct Group
+    {
+        std::string name;
+        std::vector<size_t> particles;
+    };
+
+    std::vector<Group> _groups;
+    std::vector<std::array<float, NUMBER_OF_TERMS>> _pending; // per particle, current step
+    std::vector<Energies> _sums;                              // per group, current interval
+    size_t _samples = 0;
+    std::ofstream _output;
+};
+
+} // namespace spn
+} // namespace biospring
+
+#endif // __ENERGYDECOMPOSITION_H__
@@ -0,0 +1,84 @@
+#include "Ensemble.h"
+
+#include "utils/path.hpp"
+
+#include <stdexcept>
+
+#ifdef OPENMP_SUPPORT
+#include <omp.h>
+#endif
+
+namespace biospring
+{
+namespace spn
+{
+
+Ensemble::Ensemble(topology::Topology topology, const configuration::Configuration & config,
+                   size_t number_of_replicas)
+    : _topology(std::move(topology)), _configs(number_of_replicas, config), _replicas(), _grids()
+{
+    if (number_of_replicas == 0)
+        throw std::invalid_argument("an ensemble needs at least one replica");
+}
+
+void Ensemble::vary(const std::string & parameter, const std::vector<std::string> & values)
+{
+    if (!_configs[0].exists(parameter))
+        throw std::invalid_argument("invalid parameter '" + parameter + "'");
+    if (values.size() != 1 && values.size() != size())
+        throw std::invalid_argument("parameter '" + parameter + "': expected 1 or " + std::to_string(size()) +
+                                    " values, got " + std::to_string(values.size()));
+
+    for (size_t i = 0; i < size(); ++i)
+        _configs[i].setFromString(parameter, values.size() == 1 ? values[0] : values[i]);
+}
+
+void Ensemble::setup()
+{
+    // Rigid bodies are kept in a collection shared by the whole process (see
+    // rigidbody::RigidBodiesManager): each replica would move the bodies of the others.
+    for (size_t i = 0; i < size(); ++i)
+        if (_configs[i].rigidbody.enable)
+            throw std::runtime_error("replica " + std::to_string(i) +
+                                     ": rigid bodies (rigidbody.enable) are not available with replicas");
+
+    _replicas.clear();
+    for (size_t i = 0; i < size(); ++i)
+    {
+        configuration::Configuration config = _configs[i];
+        config.pdbtraj.path = utils::path::replicaPath(config.pdbtraj.path, i);
+        config.xtctraj.path = utils::path::replicaPath(config.xtctraj.path, i);
+        config.csvsample.path = utils::path::replicaPath(config.csvsample.path, i);
+        config.profiling.path = utils::path::replicaPath(config.profiling.path, i);
+        config.colvars.path = utils::path::replicaPath(config.colvars.path, i);
+        config.decomposition.path = utils::path::replicaPath(config.decomposition.path, i);
+
+        auto replica = std::make_unique<SpringNetwork>();
+        _topology.to_spring_network(*replica);
+        replica->setGridLoader([this](const std::string & path) { return _grids.get(path); });
+        replica->setColvarsOutputPath([i](const std::string & path) { return utils::path::replicaPath(path, i); });
+        replica->setup(config);
+        _replicas.push_back(std::move(replica));
+    }
+
+    // Replicas hold their own copy of the particles and springs.
+    _topology = topology::Topology();
+}
+
+void Ensemble::run()
+{
+    const long n = static_cast<long>(_replicas.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (long i = 0; i < n; ++i)
+    {
+#ifdef OPENMP_SUPPORT
+        omp_set_num_threads(1); // replicas are the unit of parallelism
+#endif
+        _replicas[i]->run();
+    }
+}
+
+} // namespace spn
+} // namespace biospring
@@ -0,0 +1,76 @@
+#ifndef __ENSEMBLE_H__
+#define __ENSEMBLE_H__
+
+#include "GridCache.h"
+#include "SpringNetwork.h"
+#include "configuration/Configuration.hpp"
+#include "topology.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace spn
+{
+
+//
+// Independent replicas of a system, run in a single process.
+//
+// The topology is read once and each DX grid is read once and shared, read-only, by all the
+// replicas: a replica only owns its dynamic state (particles, springs, neighbor lists,
+// trajectories). Replicas can differ by any configuration parameter (see vary), e.g. the
+// position of the probe or the membrane offsets, and write their outputs to their own files.
+//
+// Replicas are handed to the OpenMP threads one at a time (dynamic schedule), so that a thread
+// that finishes a replica takes the next one. Each replica runs on a single thread.
+//
+// Example:
+//
+//     spn::Ensemble ensemble(io::readTopology("model.nc"), config, 8);
+//     ensemble.vary("probe.x", {"0", "2", "4", "6", "8", "10", "12", "14"});
+//     ensemble.setup();
+//     ensemble.run();
+//
+class Ensemble
+{
+  public:
+    Ensemble(topology::Topology topology, const configuration::Configuration & config, size_t number_of_replicas);
+
+    size_t size() const { return _configs.size(); }
+
+    // Sets `parameter` (<group>.<name>) to values[i] for replica i, or to values[0] for all the
+    // replicas if there is only one value.
+    // Throws std::invalid_argument if the parameter does not exist or if the number of values is
+    // neither 1 nor the number of replicas.
+    void vary(const std::string & parameter, const std::vector<std::string> & values);
+
+    const configuration::Configuration & getConfiguration(size_t replica) const { return _configs.at(replica); }
+
+    // Builds the replicas, then releases the topology. Output paths get the replica number,
+    // e.g. traj.xtc becomes traj.2.xtc.
+    // Throws std::runtime_error if a replica enables rigid bodies, which are shared by the
+    // whole process, or if a replica cannot be set up.
+    void setup();
+
+    // Runs all the replicas to the end.
+    void run();
+
+    SpringNetwork & getReplica(size_t replica) { return *_replicas.at(replica); }
+    const SpringNetwork & getReplica(size_t replica) const { return *_replicas.at(replica); }
+
+    // Number of DX files read so far (each file is read once).
+    size_t getNumberOfGridsRead() const { return _grids.size(); }
+
+  protected:
+    topology::Topology _topology;
+    std::vector<configuration::Configuration> _configs;
+    std::vector<std::unique_ptr<SpringNetwork>> _replicas;
+    GridCache _grids;
+};
+
+} // namespace spn
+} // namespace biospring
+
+#endif // __ENSEMBLE_H__
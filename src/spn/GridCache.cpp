@@ -0,0 +1,30 @@
+#include "GridCache.h"
+
+#include "IO/OpenDXReader.h"
+#include "logging.h"
+
+namespace biospring
+{
+namespace spn
+{
+
+std::shared_ptr<grid::PotentialGrid> GridCache::get(const std::string & path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _grids.find(path);
+    if (it == _grids.end())
+    {
+        logging::info("Reading DX file '%s' (shared by all networks)", path.c_str());
+        it = _grids.emplace(path, std::make_shared<grid::PotentialGrid>(opendx::readGrid(path))).first;
+    }
+    return it->second;
+}
+
+size_t GridCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _grids.size();
+}
+
+} // namespace spn
+} // namespace biospring
@@ -0,0 +1,37 @@
+#ifndef __GRIDCACHE_H__
+#define __GRIDCACHE_H__
+
+#include "grid/PotentialGrid.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace biospring
+{
+namespace spn
+{
+
+//
+// DX grids read once and shared, read-only, by several spring networks (see
+// SpringNetwork::setGridLoader). Thread-safe.
+//
+class GridCache
+{
+  public:
+    // Returns the grid read from `path`, reading the file on first use.
+    std::shared_ptr<grid::PotentialGrid> get(const std::string & path);
+
+    // Number of DX files read so far.
+    size_t size() const;
+
+  protected:
+    std::map<std::string, std::shared_ptr<grid::PotentialGrid>> _grids; // by path
+    mutable std::mutex _mutex;
+};
+
+} // namespace spn
+} // namespace biospring
+
+#endif // __GRIDCACHE_H__
@@ -188,6 +188,33 @@ void Particle::addElectrostaticFieldForce()
     _electrostaticenergy += ff->computeElectrostaticFieldEnergy(cell.scalar, getCharge());
 }
 
+// No off-grid warning here: the receptor grids cover the receptor and its cutoff, a particle
+// outside of them does not interact with the receptor.
+// Unlike the pair interactions, grid forces do not skip the receptor particles bonded to this
+// one by a spring: the grid sums over the whole receptor.
+void Particle::addReceptorStericForce()
+{
+    const biospring::grid::PotentialGrid * potentialgrid = _springnetwork->getReceptorStericGrid();
+    if (!potentialgrid || potentialgrid->is_out_of_grid(biospring::grid::real_coordinates(getX(), getY(), getZ())))
+        return;
+
+    const auto & cell = potentialgrid->get(getX(), getY(), getZ());
+    addForce(cell.vector);
+    _stericenergy += cell.scalar;
+}
+
+void Particle::addReceptorElectrostaticForce()
+{
+    const biospring::grid::PotentialGrid * potentialgrid = _springnetwork->getReceptorElectrostaticGrid();
+    if (!potentialgrid || potentialgrid->is_out_of_grid(biospring::grid::real_coordinates(getX(), getY(), getZ())))
+        return;
+
+    // The grid is computed for a unit charge.
+    const auto & cell = potentialgrid->get(getX(), getY(), getZ());
+    addForce(cell.vector * getCharge());
+    _electrostaticenergy += cell.scalar * getCharge();
+}
+
 void Particle::addElectrostaticForce(std::vector<DeferredNonbondedContribution> & deferred)
 {
     Vector3f f = Vector3f();
@@ -431,7 +458,7 @@ void Particle::addStericForce(std::vector<DeferredNonbondedContribution> & defer
 // ======================================================================================
 // Add forces to probe
 
-float Particle::addStericProbeForce(Particle & probe)
+float Particle::addStericProbeForce(const Particle & probe, Vector3f & probeforce)
 {
     const biospring::forcefield::ForceField * ff = _springnetwork->getForceField();
     Vector3f f = probe.getPosition() - getPosition();
@@ -440,15 +467,14 @@ float Particle::addStericProbeForce(Particle & probe)
     const float pair_energy =
         ff->computeStericEnergy(probe.getRadius(), getRadius(), probe.getEpsilon(), getEpsilon(), distance);
     _stericenergy += pair_energy * 0.5f;
-    probe.setStericEnergy(probe.getStericEnergy() + pair_energy * 0.5f);
     f.normalize();
     f = f * ff->computeStericForceModule(probe.getRadius(), getRadius(), probe.getEpsilon(), getEpsilon(), distance);
     addForce(f);
-    probe.addForce(-f);
+    probeforce = -f;
     return pair_energy;
 }
 
-float Particle::addElectrostaticProbeForce(Particle & probe)
+float Particle::addElectrostaticProbeForce(const Particle & probe, Vector3f & probeforce)
 {
     const biospring::forcefield::ForceField * ff = _springnetwork->getForceField();
     Vector3f f = probe.getPosition() - getPosition();
@@ -456,11 +482,10 @@ float Particle::addElectrostaticProbeForce(Particle & probe)
 
     const float pair_energy = ff->computeElectrostaticEnergy(probe.getCharge(), getCharge(), distance);
     _electrostaticenergy += pair_energy * 0.5f;
-    probe.setElectrostaticEnergy(probe.getElectrostaticEnergy() + pair_energy * 0.5f);
     f.normalize();
     f = f * ff->computeElectrostaticForceModule(probe.getCharge(), getCharge(), distance);
     addForce(f);
-    probe.addForce(-f);
+    probeforce = -f;
     return pair_energy;
 }
 
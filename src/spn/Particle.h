@@ -117,7 +117,7 @@ class Particle : public ParticleProperty
     const std::string & getElementName() const { return _elementname; }
     void setElementName(const std::string & elementname) { _elementname = elementname; }
 
-    const std::unordered_map<unsigned, Spring *> getSpringNeighbors() const { return _springneighbors; }
+    const std::unordered_map<unsigned, Spring *> & getSpringNeighbors() const { return _springneighbors; }
     void removeSpringNeighbor(unsigned index) { _springneighbors.erase(index); }
     void addToSpringNeighbors(unsigned index, Spring * spring);
 
@@ -139,8 +139,17 @@ class Particle : public ParticleProperty
     void addStericForce(std::vector<DeferredNonbondedContribution> & deferred);
     void addIMPForce();
     void addHydrophobicityForce(std::vector<DeferredNonbondedContribution> & deferred);
-    float addElectrostaticProbeForce(Particle & probe);
-    float addStericProbeForce(Particle & probe);
+
+    // Interactions with the probe. Half of the pair energy goes to this particle; the probe is
+    // only read, and the force it gets is returned in `probeforce` for the caller to apply, so
+    // that particles can be processed in parallel. Returns the pair energy.
+    float addElectrostaticProbeForce(const Particle & probe, Vector3f & probeforce);
+    float addStericProbeForce(const Particle & probe, Vector3f & probeforce);
+
+    // Interactions with the receptor of rigid docking, read from its potential grids
+    // (see rigidbody/ReceptorGrid.h).
+    void addReceptorStericForce();
+    void addReceptorElectrostaticForce();
 
     void resetForce();
 
@@ -22,8 +22,10 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
 #include <math.h>
 #include <memory>
+#include <sstream>
 #include <stdlib.h>
 #include <string.h>
 #include <chrono>
@@ -34,13 +36,15 @@
 #endif
 
 #include "rigidbody/RigidBodiesManager.h"
+#include "rigidbody/ReceptorGrid.h"
+#include "utils/string.hpp"
 
 namespace biospring
 {
 namespace spn
 {
 
-unsigned SpringNetwork::_currentstructid = 0;
+std::atomic<unsigned> SpringNetwork::_currentstructid = 0;
 
 SpringNetwork::~SpringNetwork() {}
 
@@ -49,13 +53,45 @@ void SpringNetwork::_resetEnergies()
     _energies.reset();
 }
 
-void SpringNetwork::_updateInsertionVector()
+// The insertion vector is only computed when read, see InsertionVector.
+void SpringNetwork::_updateInsertionVector() { _insertionVector->invalidate(); }
+
+std::array<double, 3> SpringNetwork::getCentroid() const
+{
+    if (!_centroidValid)
+    {
+        _centroid = measure::centroid(_particles);
+        _centroidValid = true;
+    }
+    return _centroid;
+}
+
+// Sum of the positions of the particles that are not integrated: static particles, and the probe
+// (integrated apart, see computeParticleForces).
+std::array<double, 3> SpringNetwork::_nonIntegratedPositionSum() const
 {
+    if (!_staticPositionSumValid)
     {
-        _insertionVector->computeVector();
-        _insertionVector->computeAngle();
-        _insertionVector->computeRollAngle();
+        _staticPositionSum = {0.0, 0.0, 0.0};
+        for (const unsigned id : _staticparticules)
+        {
+            const Vector3f & position = _particles[id].getPosition();
+            _staticPositionSum[0] += position.getX();
+            _staticPositionSum[1] += position.getY();
+            _staticPositionSum[2] += position.getZ();
+        }
+        _staticPositionSumValid = true;
+    }
+
+    std::array<double, 3> sum = _staticPositionSum;
+    if (isProbeEnabled() && _probeparticule.getId() >= 0)
+    {
+        const Vector3f & position = _particles[static_cast<size_t>(_probeparticule.getId())].getPosition();
+        sum[0] += position.getX();
+        sum[1] += position.getY();
+        sum[2] += position.getZ();
     }
+    return sum;
 }
 
 // Calculates spring forces and applies them to the particles.
@@ -84,21 +120,23 @@ void SpringNetwork::computeSpringForces()
         spring.getParticle1().addForce(force);
         spring.getParticle2().addForce(-force);
         springenergy += spring.getEnergy();
+        if (_decomposition)
+        {
+            const float half = 0.5f * spring.getEnergy();
+            const auto id1 = static_cast<size_t>(spring.getParticle1().getId());
+            const auto id2 = static_cast<size_t>(spring.getParticle2().getId());
+            _decomposition->addEnergy(EnergyDecomposition::SPRING, id1, half);
+            _decomposition->addEnergy(EnergyDecomposition::SPRING, id2, half);
+        }
     }
 
     _energies.spring = springenergy;
 }
 
-// Calculate forces that apply on dynamic particles.
-void SpringNetwork::computeParticleForces()
+// Adds the given per-particle force terms (see `ParticleForceTerms`) to the
+// dynamic particles.
+void SpringNetwork::_addParticleForces(unsigned terms)
 {
-    float electrostatic_energy = 0.0f;
-    float steric_energy = 0.0f;
-    float imp_energy = 0.0f;
-    float hydrophobic_energy = 0.0f;
-
-    _resizeNonbondedPairScratch();
-
 #ifdef OPENMP_SUPPORT
 #pragma omp parallel for schedule(static)
 #endif
@@ -106,29 +144,67 @@ void SpringNetwork::computeParticleForces()
     {
         Particle & p = getParticle(_dynamicparticules[i]);
 
-        if (isElectrostaticEnabled())
+        if ((terms & ELECTROSTATIC_TERM) && isElectrostaticEnabled() && isElectrostaticCoulombEnabled() &&
+            p.isCharged())
         {
-            if (isElectrostaticCoulombEnabled() && p.isCharged() && _nsearch.electrostatic)
+            if (_nsearch.electrostatic)
                 p.addElectrostaticForce(_electrostaticPairScratch[i]);
-            if (isElectrostaticFieldEnabled())
-                p.addElectrostaticFieldForce();
+            if (_grids.receptorelectrostatic)
+                p.addReceptorElectrostaticForce();
         }
 
-        if (isDensityGridEnabled())
-            p.addDensityFieldForce();
+        if (terms & FIELD_TERMS)
+        {
+            if (isElectrostaticEnabled() && isElectrostaticFieldEnabled())
+                p.addElectrostaticFieldForce();
+            if (isDensityGridEnabled())
+                p.addDensityFieldForce();
+        }
 
-        if (isStericEnabled())
+        if ((terms & STERIC_TERM) && isStericEnabled())
+        {
             p.addStericForce(_stericPairScratch[i]);
+            if (_grids.receptorsteric)
+                p.addReceptorStericForce();
+        }
 
-        if (isViscosityEnabled())
+        if ((terms & VISCOSITY_TERM) && isViscosityEnabled())
             p.applyViscosity(getViscosity());
 
-        if (isIMPEnabled())
+        if ((terms & IMPALA_TERM) && isIMPEnabled())
             p.addIMPForce();
 
-        if (isHydrophobicityEnabled() && p.isHydrophobic() && _nsearch.hydrophobic)
+        if ((terms & HYDROPHOBICITY_TERM) && isHydrophobicityEnabled() && p.isHydrophobic() && _nsearch.hydrophobic)
             p.addHydrophobicityForce(_hydrophobicPairScratch[i]);
+    }
+}
+
+// Calculate forces that apply on dynamic particles.
+void SpringNetwork::computeParticleForces()
+{
+    float electrostatic_energy = 0.0f;
+    float steric_energy = 0.0f;
+    float imp_energy = 0.0f;
+    float hydrophobic_energy = 0.0f;
 
+    _resizeNonbondedPairScratch();
+
+    if (!_stageProfiler.enabled())
+        _addParticleForces(ALL_PARTICLE_FORCE_TERMS);
+    else
+    {
+        // One loop per term so that each one can be timed. Terms are still added
+        // in the same order to each particle, so forces are the same.
+        const std::pair<unsigned, size_t> terms[] = {
+            {ELECTROSTATIC_TERM, _stages.electrostatic}, {FIELD_TERMS, _stages.fields},
+            {STERIC_TERM, _stages.steric},               {VISCOSITY_TERM, _stages.viscosity},
+            {IMPALA_TERM, _stages.impala},               {HYDROPHOBICITY_TERM, _stages.hydrophobicity},
+        };
+        for (const auto & [term, stage] : terms)
+        {
+            timeit::ScopedStage scope(_stageProfiler, stage);
+            _addParticleForces(term);
+        }
     }
 
     // Applies the deferred "other side" of each unique nonbonded pair
@@ -136,9 +212,25 @@ void SpringNetwork::computeParticleForces()
     // contribution to the same target particle. Must run before the force
     // read by rigid-body torque aggregation and setPreviousForce() below, and
     // before summing per-particle energies, since it feeds both.
-    _applyNonbondedPairScratch(_stericPairScratch, steric_energy);
-    _applyNonbondedPairScratch(_electrostaticPairScratch, electrostatic_energy);
-    _applyNonbondedPairScratch(_hydrophobicPairScratch, hydrophobic_energy);
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.pairs);
+        _applyNonbondedPairScratch(_stericPairScratch, steric_energy, EnergyDecomposition::STERIC);
+        _applyNonbondedPairScratch(_electrostaticPairScratch, electrostatic_energy, EnergyDecomposition::ELECTROSTATIC);
+        _applyNonbondedPairScratch(_hydrophobicPairScratch, hydrophobic_energy, EnergyDecomposition::HYDROPHOBIC);
+    }
+
+    // External forces must be in place before rigid-body aggregation and
+    // setPreviousForce() below.
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.external);
+        _applyExternalForces();
+    }
+
+    if (isColvarsEnabled())
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.colvars);
+        _energies.bias = static_cast<float>(_colvars->apply(_particles, static_cast<size_t>(_nbiter)));
+    }
 
     // Sum per-particle energies in particle order to keep results reproducible
     // across OpenMP thread counts.
@@ -151,20 +243,16 @@ void SpringNetwork::computeParticleForces()
         hydrophobic_energy += p.getHydrophobicityEnergy();
     }
 
-    // The probe is shared by every particle, therefore probe interactions must
-    // not mutate it from an OpenMP loop. It is integrated exactly once per step.
+    // The probe is integrated exactly once per step, see _addProbeForces.
     if (isProbeEnabled())
     {
+        timeit::ScopedStage scope(_stageProfiler, _stages.probe);
         _probeparticule.resetForce();
 
-        for (const unsigned particle_id : _dynamicparticules)
-        {
-            Particle & p = getParticle(particle_id);
-            if (isProbeStericEnabled())
-                steric_energy += p.addStericProbeForce(_probeparticule);
-            if (isProbeElectrostaticEnabled())
-                electrostatic_energy += p.addElectrostaticProbeForce(_probeparticule);
-        }
+        if (isProbeStericEnabled())
+            steric_energy += _addProbeForces(STERIC_TERM);
+        if (isProbeElectrostaticEnabled())
+            electrostatic_energy += _addProbeForces(ELECTROSTATIC_TERM);
 
         if (isProbeElectrostaticFieldEnabled())
         {
@@ -181,14 +269,23 @@ void SpringNetwork::computeParticleForces()
         _syncProbeParticle();
     }
 
-    // Rigid-body accumulators are shared between their particles. Aggregate
-    // them serially after all per-particle forces are complete.
-    for (const unsigned particle_id : _dynamicparticules)
+    // Particle energies are complete, and are reset by the integration.
+    if (_decomposition)
     {
-        Particle & p = getParticle(particle_id);
-        if (isRigidBodyEnabled() && p.isRigid() && !isImpalaSamplingEnabled() && !isMonteCarloEnabled())
-            rigidbody::RigidBody::computeParticleForceAndTorque(p);
-        p.setPreviousForce();
+        timeit::ScopedStage scope(_stageProfiler, _stages.decomposition);
+        _decomposeEnergies();
+    }
+
+    // Rigid-body force and torque are reduced over the members of each body,
+    // after all per-particle forces are complete.
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.rigidbodyforces);
+        if (isRigidBodyDynamicsEnabled())
+            rigidbody::RigidBodiesManager::AccumulateForcesAndTorques();
+        if (isRigidBodyHydrophobicRestraintEnabled())
+            rigidbody::RigidBodiesManager::ApplyHydrophobicRestraints(*this, getRigidBodyHydrophobicRestraintScale());
+        for (const unsigned particle_id : _dynamicparticules)
+            getParticle(particle_id).setPreviousForce();
     }
 
     _energies.electrostatic = electrostatic_energy;
@@ -202,12 +299,23 @@ void SpringNetwork::computeParticleForces()
 void SpringNetwork::updateParticlePositions()
 {
     float kinetic_energy_particle = 0.0;
+    // The centroid is reduced in the same pass, see getCentroid.
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    double sum_z = 0.0;
+    timeit::ScopedStage integration(_stageProfiler, _stages.integration);
+
+    // Rigid bodies move their members as a whole.
+    const bool rigidBodyDynamics = isRigidBodyDynamicsEnabled();
+    if (rigidBodyDynamics)
+        rigidbody::RigidBodiesManager::UpdateMemberPositions(getTimeStep());
+
 #ifdef OPENMP_SUPPORT
 #pragma omp parallel default(shared)
 #endif
     {
 #ifdef OPENMP_SUPPORT
-#pragma omp for reduction(+ : kinetic_energy_particle) schedule(static)
+#pragma omp for reduction(+ : kinetic_energy_particle, sum_x, sum_y, sum_z) schedule(static)
 #endif
         // i stays a signed int: MSVC only supports OpenMP 2.0, which requires
         // a signed loop counter for #pragma omp parallel for.
@@ -215,7 +323,10 @@ void SpringNetwork::updateParticlePositions()
         {
             Particle & p = getParticle(_dynamicparticules[static_cast<size_t>(i)]);
             if (p.isRigid())
-                rigidbody::RigidBody::integrateParticleVelocity(p, i, getTimeStep());
+            {
+                if (!rigidBodyDynamics)
+                    rigidbody::RigidBody::integrateParticleVelocity(p, i, getTimeStep());
+            }
             else
                 p.IntegrateEuler(getTimeStep());
 
@@ -229,42 +340,92 @@ void SpringNetwork::updateParticlePositions()
             }
 
             kinetic_energy_particle += p.getKineticEnergy();
+            sum_x += x;
+            sum_y += y;
+            sum_z += z;
             p.resetForce();
         } // omp for loop
     }     // omp parallel
     _energies.kinetic += kinetic_energy_particle;
 
+    if (!_particles.empty())
+    {
+        const std::array<double, 3> others = _nonIntegratedPositionSum();
+        const double n = static_cast<double>(_particles.size());
+        _centroid = {(sum_x + others[0]) / n, (sum_y + others[1]) / n, (sum_z + others[2]) / n};
+        _centroidValid = true;
+    }
+    integration.stop();
+
     // The spatial grids must follow particle motion. Rebuild them once here,
     // after all particle positions have been integrated for the current step.
-    _markNeighborSearchesDirty();
-    _updateNeighborSearches();
+    // In an active region, only the active particles moved: they are moved to
+    // their new cells instead, so the cost does not grow with frozen particles.
+    timeit::ScopedStage nsearch(_stageProfiler, _stages.nsearch);
+    if (_activeRegion && !_neighborSearchesDirty)
+    {
+        for (const auto * searcher : {&_nsearch.steric, &_nsearch.electrostatic, &_nsearch.hydrophobic})
+            if (*searcher)
+                (*searcher)->relocate(_dynamicparticules);
+    }
+    else
+    {
+        _markNeighborSearchesDirty();
+        _updateNeighborSearches();
+    }
+
+    // Dynamic selections follow particle motion too.
+    if (_hasDynamicSelections)
+        updateSelections();
+    nsearch.stop();
+
+    if (_activeRegion && _config.activeregion.frequency > 0 &&
+        static_cast<size_t>(_nbiter) % _config.activeregion.frequency == 0)
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.activeregion);
+        _updateActiveRegion();
+    }
 }
 
 /// @brief Compute particles force and, if activated, springs forces.
 void SpringNetwork::computeForces()
 {
     if (isSpringEnabled())
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.springs);
         computeSpringForces();
+    }
     computeParticleForces();
 }
 
 void SpringNetwork::computeStep()
 {
+    timeit::ScopedStage step(_stageProfiler, _stages.step);
+
     idleRun();
     _meanConstraintsDistances = 0.0;
 
     computeForces();
 
     if (isConstraintEnabled())
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.constraints);
         applyConstraints();
+    }
 
     if (isRigidBodyEnabled())
-        rigidbody::RigidBodiesManager::SolveRigidBodiesDynamic(); 
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.rigidbodysolve);
+        rigidbody::RigidBodiesManager::SolveRigidBodiesDynamic();
+    }
 
     updateParticlePositions();
 
     if (isInsertionVectorEnabled())
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.ivector);
         _updateInsertionVector();
+    }
 }
 
 void SpringNetwork::run()
@@ -280,8 +441,9 @@ void SpringNetwork::run()
 
     if (isRigidBodyEnabled())
     {
-        // Set all structure to rigid.
-        rigidbody::RigidBodiesManager::InitRigidBodies(this, getDynamicParticles());
+        // Set all structure to rigid, one body per chain with rigidbody.splitchains.
+        for (const std::vector<unsigned> & particles : _rigidBodiesParticles())
+            rigidbody::RigidBodiesManager::InitRigidBodies(this, particles);
 
         // If write csv and automatic sampling enabled, do not write relative 
         // to the option csvsampling.frequency (set to a big number)
@@ -339,6 +501,21 @@ void SpringNetwork::endRun()
         if (interactor != nullptr)
             interactor->waitForInteractionThread();
     }
+
+    if (isColvarsEnabled())
+        _colvars->finish();
+
+    if (_stageProfiler.enabled())
+    {
+        _writeProfilingInterval();
+
+        std::stringstream summary;
+        _stageProfiler.print(summary);
+        logging::status("Step profile:");
+        std::string line;
+        while (std::getline(summary, line))
+            logging::info("%s", line.c_str());
+    }
 }
 
 void SpringNetwork::idleRun()
@@ -346,20 +523,30 @@ void SpringNetwork::idleRun()
     while (_pause)
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
-    for (Interactor* interactor : getInteractors()) 
     {
-        if (interactor != nullptr)
+        timeit::ScopedStage scope(_stageProfiler, _stages.interactors);
+        for (Interactor* interactor : getInteractors()) 
         {
-            interactor->syncSystemStateData();
+            if (interactor != nullptr)
+            {
+                interactor->syncSystemStateData();
+            }
         }
     }
 
-    _writeNextStep();
+    {
+        timeit::ScopedStage scope(_stageProfiler, _stages.trajectories);
+        _writeNextStep();
+    }
 
     _resetEnergies();
 
     _nbiter++;
 
+    if (_stageProfiler.enabled() && _config.profiling.frequency > 0 &&
+        static_cast<unsigned>(_nbiter) % _config.profiling.frequency == 0)
+        _writeProfilingInterval();
+
     if (_hasReachedEndOfRun())
         setEnd(true);
 }
@@ -385,6 +572,8 @@ void SpringNetwork::_displayFrameData()
         logging::info("IMP energy: %5.2f kJ.mol-1", _energies.imp);
     if (isHydrophobicityEnabled())
         logging::info("Hydrophobic energy: %5.2f kJ.mol-1", _energies.hydrophobic);
+    if (isColvarsEnabled())
+        logging::info("Bias energy: %5.2f kJ.mol-1", _energies.bias);
     if (isInsertionVectorEnabled())
     {
         logging::info("Insertion angle: %5.2lf °", _insertionVector->getAngle());
@@ -407,24 +596,50 @@ void SpringNetwork::_writeNextStep() { _trajectories.write_step(static_cast<size
 
 void SpringNetwork::writeNextStepNow() { _trajectories.write_step(); }
 
+unsigned SpringNetwork::_particleIndexFromId(unsigned id) const
+{
+    // Ids are indexes (see addParticle); the check covers ids changed by hand since.
+    if (id >= _particles.size() || _particles[id].getId() != static_cast<int>(id))
+        throw std::out_of_range("SpringNetwork::getParticleFromId: Particle id " + std::to_string(id) +
+                                " not found.");
+    return id;
+}
+
 std::vector<Particle>::const_reference SpringNetwork::getParticleFromId(unsigned id) const
 {
-    for (unsigned i = 0; i < _particles.size(); i++)
-    {
-        if (_particles[i].getId() == static_cast<int>(id))
-            return _particles[i];
-    }
-    throw std::out_of_range("SpringNetwork::getParticleFromId: Particle id not found.");
+    return _particles[_particleIndexFromId(id)];
 }
 
 std::vector<Particle>::reference SpringNetwork::getParticleFromId(unsigned id)
 {
-    for (unsigned i = 0; i < _particles.size(); i++)
-    {
-        if (_particles[i].getId() == static_cast<int>(id))
-            return _particles[i];
-    }
-    throw std::out_of_range("SpringNetwork::getParticleFromId: Particle id not found.");
+    return _particles[_particleIndexFromId(id)];
+}
+
+unsigned SpringNetwork::getParticleIndexFromExtid(unsigned extid) const
+{
+    const auto it = _extidToIndex.find(extid);
+    if (it == _extidToIndex.end())
+        throw std::out_of_range("SpringNetwork::getParticleIndexFromExtid: Particle external id " +
+                                std::to_string(extid) + " not found.");
+    return it->second;
+}
+
+std::vector<unsigned> SpringNetwork::getParticleIndexesFromIds(const std::vector<unsigned> & ids) const
+{
+    std::vector<unsigned> indexes;
+    indexes.reserve(ids.size());
+    for (const unsigned id : ids)
+        indexes.push_back(_particleIndexFromId(id));
+    return indexes;
+}
+
+std::vector<unsigned> SpringNetwork::getParticleIndexesFromExtids(const std::vector<unsigned> & extids) const
+{
+    std::vector<unsigned> indexes;
+    indexes.reserve(extids.size());
+    for (const unsigned extid : extids)
+        indexes.push_back(getParticleIndexFromExtid(extid));
+    return indexes;
 }
 
 void SpringNetwork::getParticlePosition(unsigned i, float position[3]) const
@@ -441,6 +656,72 @@ void SpringNetwork::setForce(unsigned i, float force[3])
     getParticle(i).addForce(f);
 }
 
+void SpringNetwork::setExternalForce(unsigned particle, const Vector3f & force, unsigned expiry,
+                                     const void * owner)
+{
+    if (particle >= getNumberOfParticles())
+        logging::die("setExternalForce: invalid particle index %u (system has %u particles)", particle,
+                     getNumberOfParticles());
+
+    auto [it, inserted] = _externalForceIndices.try_emplace(particle, _externalForces.size());
+    if (inserted)
+        _externalForces.push_back({particle, force, expiry, owner});
+    else
+        _externalForces[it->second] = {particle, force, expiry, owner};
+}
+
+void SpringNetwork::removeExternalForce(unsigned particle, const void * owner)
+{
+    auto it = _externalForceIndices.find(particle);
+    if (it != _externalForceIndices.end() and _externalForces[it->second].owner == owner)
+        removeExternalForce(particle);
+}
+
+void SpringNetwork::removeExternalForce(unsigned particle)
+{
+    auto it = _externalForceIndices.find(particle);
+    if (it == _externalForceIndices.end())
+        return;
+
+    // Swaps with the last force to keep the storage contiguous.
+    const size_t index = it->second;
+    _externalForceIndices.erase(it);
+    if (index != _externalForces.size() - 1)
+    {
+        _externalForces[index] = _externalForces.back();
+        _externalForceIndices[_externalForces[index].particle] = index;
+    }
+    _externalForces.pop_back();
+}
+
+void SpringNetwork::clearExternalForces()
+{
+    _externalForces.clear();
+    _externalForceIndices.clear();
+}
+
+void SpringNetwork::_applyExternalForces()
+{
+    const unsigned step = static_cast<unsigned>(_nbiter);
+
+    size_t i = 0;
+    while (i < _externalForces.size())
+    {
+        const ExternalForce & f = _externalForces[i];
+        if (f.expiry < step)
+        {
+            removeExternalForce(f.particle); // the last force now sits at `i`
+            continue;
+        }
+
+        // Static particles are never integrated nor reset: a force would pile up on them.
+        Particle & p = getParticle(f.particle);
+        if (p.isDynamic())
+            p.addForce(f.force);
+        ++i;
+    }
+}
+
 // =====================================================================================
 //
 // Modification Methods.
@@ -495,12 +776,28 @@ void SpringNetwork::updateSpringState(unsigned id, bool isStatic) {
     }
 }
 
-void SpringNetwork::addParticle(const Particle & source)
+void SpringNetwork::updateSpringStates(const std::vector<unsigned> & ids, bool isStatic)
+{
+    std::vector<bool> moved(_springs.size(), false);
+    for (const unsigned id : ids)
+        moved[id] = true;
+
+    std::vector<unsigned> & from = isStatic ? _dynamicsprings : _staticsprings;
+    std::vector<unsigned> & to = isStatic ? _staticsprings : _dynamicsprings;
+    std::vector<unsigned> kept;
+    kept.reserve(from.size());
+    for (const unsigned id : from)
+        (moved[id] ? to : kept).push_back(id);
+    from.swap(kept);
+}
+
+void SpringNetwork::addParticle(const Particle & source) { addParticle(Particle(source)); }
+
+void SpringNetwork::addParticle(Particle && p)
 {
     if (!_springs.empty())
         throw std::logic_error("SpringNetwork::addParticle: particles must be added before springs");
 
-    Particle p = Particle(source);
     p.setSpringNetwork(this);
     // Particle::getId()/setId() stay signed (used as an "unassigned" sentinel
     // for the probe particle, see isProbeParticle()), so cast explicitly at
@@ -521,9 +818,28 @@ void SpringNetwork::addParticle(const Particle & source)
     if (p.isHydrophobic())
         _hydrophobicparticules.push_back(static_cast<unsigned>(p.getId()));
 
-    _particles.push_back(p);
+    // Particles without an external id keep the default one (see Particle), which is not indexed.
+    if (p.getExtid() != static_cast<unsigned>(-1))
+        _extidToIndex.emplace(p.getExtid(), static_cast<unsigned>(p.getId()));
+
     _initparticles.push_back(p);
+    _particles.push_back(std::move(p));
     _markNeighborSearchesDirty();
+    invalidateCentroid();
+}
+
+void SpringNetwork::reserve(size_t nparticles, size_t nsprings)
+{
+    if (!_springs.empty())
+        throw std::logic_error("SpringNetwork::reserve: storage must be reserved before springs are added");
+
+    // One extra slot for the probe particle setup() may add after springs exist.
+    _particles.reserve(nparticles + 1);
+    _initparticles.reserve(nparticles);
+    _dynamicparticules.reserve(nparticles);
+    _extidToIndex.reserve(nparticles);
+    _springs.reserve(nsprings);
+    _dynamicsprings.reserve(nsprings);
 }
 
 void SpringNetwork::updateParticleState(unsigned id, bool isStatic) {
@@ -535,6 +851,35 @@ void SpringNetwork::updateParticleState(unsigned id, bool isStatic) {
         addDynamicParticle(id);
     }
     _particles[id].setStatic(isStatic);
+    invalidateCentroid();
+}
+
+void SpringNetwork::updateParticleStates(const std::vector<unsigned> & ids, bool isStatic)
+{
+    std::vector<unsigned> & from = isStatic ? _dynamicparticules : _staticparticules;
+    std::vector<unsigned> & to = isStatic ? _staticparticules : _dynamicparticules;
+
+    // The sum of static positions follows the changes instead of being computed again.
+    const double sign = isStatic ? 1.0 : -1.0;
+    const size_t previous = to.size();
+    for (const unsigned id : ids)
+    {
+        Particle & p = _particles[id];
+        if (p.isStatic() == isStatic)
+            continue;
+        p.setStatic(isStatic);
+        to.push_back(id);
+        _staticPositionSum[0] += sign * p.getPosition().getX();
+        _staticPositionSum[1] += sign * p.getPosition().getY();
+        _staticPositionSum[2] += sign * p.getPosition().getZ();
+    }
+    if (to.size() == previous)
+        return;
+
+    from.erase(std::remove_if(from.begin(), from.end(),
+                              [&](unsigned id) { return _particles[id].isStatic() == isStatic; }),
+               from.end());
+    _centroidValid = false;
 }
 
 void SpringNetwork::clear()
@@ -545,16 +890,31 @@ void SpringNetwork::clear()
     _dynamicparticules.clear();
     _chargedparticules.clear();
     _hydrophobicparticules.clear();
+    _receptorparticules.clear();
+    _extidToIndex.clear();
+    invalidateCentroid();
+    _grids.receptorsteric.reset();
+    _grids.receptorelectrostatic.reset();
     _springs.clear();
     _staticsprings.clear();
     _dynamicsprings.clear();
     _springForceScratch.clear();
+    clearExternalForces();
     _nsearch.steric.reset();
     _nsearch.electrostatic.reset();
     _nsearch.hydrophobic.reset();
     _neighborSearchesDirty = false;
     _insertionVector.reset();
     _probeparticule = Particle();
+    _constraints.clear();
+    _constraintenabled = false;
+    _selections.clear();
+    _selectionLabels = selection::Labels();
+    _hasDynamicSelections = false;
+    _decomposition.reset();
+    _dynamicDecompositionGroups.clear();
+    _activeRegion.reset();
+    _activeRegionCenter = nullptr;
 }
 
 // TODO: implement this function in `Topology`
@@ -635,6 +995,47 @@ void SpringNetwork::applyConstraints()
     _meanConstraintsDistances = sumDistances / _constraints.size();
 }
 
+const Selection & SpringNetwork::addSelection(const std::string & name, const std::string & expression)
+{
+    if (_findSelection(name) != nullptr)
+        throw std::invalid_argument("duplicate selection '" + name + "'");
+
+    // Labels do not change during a run: they are laid out once.
+    if (_selectionLabels.size() != _particles.size())
+        _selectionLabels = selection::Labels(_particles);
+
+    const selection::Expression compiled(expression, [this](const std::string & reference) {
+        const Selection * s = _findSelection(reference);
+        return s == nullptr ? nullptr : &s->getExpression();
+    });
+    _selections.push_back(std::make_unique<Selection>(name, compiled, _particles, _selectionLabels));
+    _hasDynamicSelections = _hasDynamicSelections || compiled.isDynamic();
+    return *_selections.back();
+}
+
+Selection * SpringNetwork::_findSelection(const std::string & name) const
+{
+    for (const auto & s : _selections)
+        if (s->getName() == name)
+            return s.get();
+    return nullptr;
+}
+
+const Selection & SpringNetwork::getSelection(const std::string & name) const
+{
+    const Selection * s = _findSelection(name);
+    if (s == nullptr)
+        throw std::invalid_argument("unknown selection '" + name + "'");
+    return *s;
+}
+
+void SpringNetwork::updateSelections()
+{
+    for (const auto & s : _selections)
+        if (s->isDynamic())
+            s->update(_selectionLabels);
+}
+
 void SpringNetwork::clearParticles(void) { clear(); }
 
 // =====================================================================================
@@ -649,15 +1050,21 @@ void SpringNetwork::setup(const configuration::Configuration & conf)
 
     _setupForceField();
     _setupProbe();
+    _setupRigidBodies();
     _setupSteric();
     _setupElectrostatic();
     _setupHydrophobic();
+    _setupReceptorGrids();
     _setupDensityGrid();
     _setupInsertionVector();
+    _setupSelections();
+    _setupConstraints();
+    _setupActiveRegion();
+    _setupColvars();
+    _setupEnergyDecomposition();
     _setupTrajectories();
+    _setupProfiling();
     _neighborSearchesDirty = false;
-    // _setupConstraints();
-    // _setupSelections();
 }
 
 void SpringNetwork::_setupSteric()
@@ -666,7 +1073,12 @@ void SpringNetwork::_setupSteric()
     {
         if (getStericCutoff() < 1e-6)
             throw std::runtime_error("Steric cutoff must be > 0");
-        _nsearch.steric = make_nsearch(_particles, getStericCutoff(), getNeighborSkin());
+        // The receptor of rigid docking is left out of the pair searches, see _setupReceptorGrids.
+        if (isReceptorGridEnabled())
+            _nsearch.steric =
+                make_nsearch(_particles, getStericCutoff(), _nonReceptorParticleIndexes(), getNeighborSkin());
+        else
+            _nsearch.steric = make_nsearch(_particles, getStericCutoff(), getNeighborSkin());
         _excludeProbeFromNeighborSearch(*_nsearch.steric);
     }
 }
@@ -716,9 +1128,7 @@ void SpringNetwork::_setupElectrostatic()
 
     if (isElectrostaticFieldEnabled())
     {
-        const std::string dxpath = _config.potentialgrid.path;
-        logging::info("Reading electrostatic map from DX file '%s'", dxpath.c_str());
-        _grids.potential = opendx::readGrid(dxpath);
+        _grids.potential = _loadGrid(_config.potentialgrid.path, "electrostatic map");
     }
 
     if (isElectrostaticCoulombEnabled())
@@ -736,16 +1146,106 @@ void SpringNetwork::_setupElectrostatic()
     }
 }
 
+void SpringNetwork::_setupRigidBodies()
+{
+    // Several bodies, and bodies next to a receptor, are only moved by the rigid-body dynamics.
+    if ((isRigidBodySplitChainsEnabled() || isReceptorGridEnabled()) && !isRigidBodyDynamicsEnabled())
+        throw std::runtime_error(
+            "rigidbody.splitchains and rigidbody.receptor are not available with IMPALA sampling nor Monte Carlo");
+
+    _receptorparticules.clear();
+    if (!isReceptorGridEnabled())
+        return;
+
+    const std::vector<std::string> chains = utils::string::split(_config.rigidbody.receptor, ",");
+    for (unsigned i = 0; i < _particles.size(); ++i)
+    {
+        if (!isProbeParticle(i) &&
+            std::find(chains.begin(), chains.end(), _particles[i].getChainName()) != chains.end())
+            _receptorparticules.push_back(i);
+    }
+    if (_receptorparticules.empty())
+        throw std::runtime_error("rigidbody.receptor: no particle in chain(s) '" + _config.rigidbody.receptor + "'");
+
+    // The receptor is frozen: it is not integrated and its internal springs are skipped.
+    updateParticleStates(_receptorparticules, true);
+
+    std::vector<unsigned> receptorsprings;
+    for (const unsigned id : _dynamicsprings)
+    {
+        const Spring & spring = _springs[id];
+        if (spring.getParticle1().isStatic() && spring.getParticle2().isStatic())
+            receptorsprings.push_back(id);
+    }
+    updateSpringStates(receptorsprings, true);
+
+    if (_dynamicparticules.empty())
+        throw std::runtime_error("rigidbody.receptor: no particle left to dock");
+}
+
+// Computes the receptor grids once the cutoffs are checked (_setupSteric, _setupElectrostatic).
+// The steric grid is computed for the mean particle of the bodies docked on the receptor.
+void SpringNetwork::_setupReceptorGrids()
+{
+    if (!isReceptorGridEnabled())
+        return;
+
+    const std::vector<size_t> receptor(_receptorparticules.begin(), _receptorparticules.end());
+    const double spacing = _config.rigidbody.receptorgrid_spacing;
+
+    if (isStericEnabled())
+    {
+        float radius = 0.0f;
+        float epsilon = 0.0f;
+        for (const unsigned id : _dynamicparticules)
+        {
+            radius += _particles[id].getRadius();
+            epsilon += _particles[id].getEpsilon();
+        }
+        Particle probe;
+        probe.setRadius(radius / static_cast<float>(_dynamicparticules.size()));
+        probe.setEpsilon(epsilon / static_cast<float>(_dynamicparticules.size()));
+        _grids.receptorsteric =
+            rigidbody::computeStericReceptorGrid(_particles, receptor, *_ff, probe, getStericCutoff(), spacing);
+    }
+
+    if (isElectrostaticEnabled() && isElectrostaticCoulombEnabled())
+    {
+        std::vector<size_t> charged;
+        for (const size_t i : receptor)
+            if (_particles[i].isCharged())
+                charged.push_back(i);
+        if (!charged.empty())
+            _grids.receptorelectrostatic = rigidbody::computeElectrostaticReceptorGrid(
+                _particles, charged, *_ff, getElectrostaticCutoff(), spacing);
+    }
+
+    logging::info("Receptor of %zu particles (chain %s) represented by potential grids.", receptor.size(),
+                  _config.rigidbody.receptor.c_str());
+
+    // The receptor is left out of the hydrophobic cell list too (see _hydrophobicParticleIndexes),
+    // and there is no hydrophobic receptor grid.
+    if (isHydrophobicityEnabled())
+        logging::warning("rigidbody.receptor: the hydrophobic interactions between the receptor and the other chains "
+                         "are not computed.");
+}
+
 void SpringNetwork::_setupDensityGrid()
 {
     if (isDensityGridEnabled())
     {
-        const std::string dxpath = _config.densitygrid.path;
-        logging::info("Reading density grid from DX file '%s'", dxpath.c_str());
-        _grids.density = opendx::readGrid(dxpath);
+        _grids.density = _loadGrid(_config.densitygrid.path, "density grid");
     }
 }
 
+std::shared_ptr<grid::PotentialGrid> SpringNetwork::_loadGrid(const std::string & path, const char * description) const
+{
+    if (_gridLoader)
+        return _gridLoader(path);
+    logging::info("Reading %s from DX file '%s'", description, path.c_str());
+    return std::make_shared<grid::PotentialGrid>(opendx::readGrid(path));
+}
+
 void SpringNetwork::_setupProbe()
 {
     if (isProbeEnabled())
@@ -762,6 +1262,7 @@ void SpringNetwork::_setupProbe()
         _probeparticule.setZ(_config.probe.z);
         _probeparticule.setId(static_cast<int>(_particles.size()));
         _particles.push_back(_probeparticule);
+        invalidateCentroid();
     }
 }
 
@@ -778,12 +1279,179 @@ void SpringNetwork::_setupTrajectories()
                                                                                    _config.csvsample.frequency));
 }
 
+void SpringNetwork::_setupProfiling()
+{
+    // BIOSPRING_PERF_COUNTERS turns on profiling with hardware counters without editing the configuration.
+    const bool hardware = _config.profiling.hardware || perf::requested_by_environment();
+    const bool enable = _config.profiling.enable || hardware;
+
+    _stageProfiler.reset();
+    _stageProfiler.set_enabled(enable);
+    _stageProfiler.set_hardware_counters(nullptr);
+    _hardwareCounters.close();
+
+    if (hardware)
+    {
+        if (_hardwareCounters.open())
+            _stageProfiler.set_hardware_counters(&_hardwareCounters);
+        else
+            logging::warning("Hardware counters are not available: %s. Only timings are profiled.",
+                             _hardwareCounters.error().c_str());
+    }
+
+    if (_profileOutput.is_open())
+        _profileOutput.close();
+
+    if (enable && !_config.profiling.path.empty())
+    {
+        _profileOutput.open(_config.profiling.path);
+        if (!_profileOutput)
+            logging::die("Cannot open profiling output file '%s'.", _config.profiling.path.c_str());
+        timeit::StageProfiler::write_header(_profileOutput, _stageProfiler.hardware_counters() != nullptr);
+    }
+}
+
+void SpringNetwork::_registerProfilerStages()
+{
+    _stages.step = _stageProfiler.add_stage("step");
+    _stages.interactors = _stageProfiler.add_stage("interactors");
+    _stages.trajectories = _stageProfiler.add_stage("trajectories");
+    _stages.springs = _stageProfiler.add_stage("springs");
+    _stages.electrostatic = _stageProfiler.add_stage("electrostatic");
+    _stages.fields = _stageProfiler.add_stage("fields");
+    _stages.steric = _stageProfiler.add_stage("steric");
+    _stages.viscosity = _stageProfiler.add_stage("viscosity");
+    _stages.impala = _stageProfiler.add_stage("impala");
+    _stages.hydrophobicity = _stageProfiler.add_stage("hydrophobicity");
+    _stages.pairs = _stageProfiler.add_stage("pairs");
+    _stages.external = _stageProfiler.add_stage("external");
+    _stages.colvars = _stageProfiler.add_stage("colvars");
+    _stages.probe = _stageProfiler.add_stage("probe");
+    _stages.decomposition = _stageProfiler.add_stage("decomposition");
+    _stages.rigidbodyforces = _stageProfiler.add_stage("rigidbodyforces");
+    _stages.constraints = _stageProfiler.add_stage("constraints");
+    _stages.rigidbodysolve = _stageProfiler.add_stage("rigidbodysolve");
+    _stages.integration = _stageProfiler.add_stage("integration");
+    _stages.nsearch = _stageProfiler.add_stage("nsearch");
+    _stages.activeregion = _stageProfiler.add_stage("activeregion");
+    _stages.ivector = _stageProfiler.add_stage("ivector");
+
+    _stages.nsearch_rebuilds = _stageProfiler.add_counter("nsearch_rebuilds");
+    _stages.nsearch_skips = _stageProfiler.add_counter("nsearch_skips");
+}
+
+void SpringNetwork::_writeProfilingInterval()
+{
+    if (_profileOutput.is_open())
+        _stageProfiler.write_interval(_profileOutput, static_cast<size_t>(_nbiter));
+}
+
 void SpringNetwork::_setupInsertionVector()
 {
     if (_config.ivector.enable)
         setInsertionVector(_config.ivector.vector[0], _config.ivector.vector[1]);
 }
 
+void SpringNetwork::_setupColvars()
+{
+    _colvars.reset();
+    if (!_config.colvars.enable)
+        return;
+
+    if (_config.colvars.input.empty())
+        throw std::runtime_error("colvars: no definitions file (colvars.input)");
+
+    // Indexes and RMSD reference positions refer to the particles as read.
+    _colvars = std::make_unique<cv::Colvars>();
+    _colvars->read(
+        _config.colvars.input, _initparticles,
+        [this](const std::string & name) -> const std::vector<size_t> * {
+            const Selection * s = _findSelection(name);
+            if (s == nullptr)
+                return nullptr;
+            // Groups are bound once: a dynamic selection would be frozen at its initial particles.
+            if (s->isDynamic())
+                throw std::invalid_argument("selection '" + name +
+                                            "' is dynamic (coordinates, within) and cannot be a group");
+            return &s->getIndexes();
+        },
+        _colvarsOutputPath);
+    if (!_config.colvars.path.empty())
+        _colvars->openTrace(_config.colvars.path, _config.colvars.frequency);
+    logging::info("Collective variables: %zu variables, %zu biases.", _colvars->getVariables().size(),
+                  _colvars->getBiases().size());
+}
+
+void SpringNetwork::_setupEnergyDecomposition()
+{
+    _decomposition.reset();
+    _dynamicDecompositionGroups.clear();
+    if (!_config.decomposition.enable)
+        return;
+
+    _decomposition = std::make_unique<EnergyDecomposition>(_particles.size());
+    const std::string & groups = _config.decomposition.groups;
+    if (groups == "residues")
+    {
+        // One group per residue (chain and residue id), in order of first appearance.
+        std::map<std::pair<std::string, int>, std::vector<size_t>> members;
+        std::vector<std::pair<std::string, int>> order;
+        for (size_t i = 0; i < _particles.size(); ++i)
+        {
+            if (isProbeParticle(i))
+                continue;
+            const Particle & p = _particles[i];
+            const std::pair<std::string, int> key(p.getChainName(), static_cast<int>(p.getResId()));
+            auto [it, inserted] = members.try_emplace(key);
+            if (inserted)
+                order.push_back(key);
+            it->second.push_back(i);
+        }
+        for (const auto & key : order)
+        {
+            const std::vector<size_t> & indexes = members[key];
+            const std::string name = key.first + ":" + _particles[indexes.front()].getResName() + ":" +
+                                     std::to_string(key.second);
+            _decomposition->addGroup(name, indexes);
+        }
+    }
+    else
+    {
+        std::vector<std::string> names;
+        if (groups == "selections")
+        {
+            for (const auto & selection : _selections)
+                names.push_back(selection->getName());
+        }
+        else
+        {
+            std::string name;
+            std::istringstream iss(groups);
+            while (std::getline(iss, name, ','))
+            {
+                name = utils::string::trim(name);
+                if (!name.empty())
+                    names.push_back(name);
+            }
+        }
+        for (const std::string & name : names)
+        {
+            const Selection * selection = _findSelection(name);
+            if (selection == nullptr)
+                throw std::runtime_error("decomposition.groups: unknown selection '" + name + "'");
+            const size_t group = _decomposition->addGroup(name, selection->getIndexes());
+            if (selection->isDynamic())
+                _dynamicDecompositionGroups.emplace_back(group, selection);
+        }
+    }
+
+    if (_decomposition->getNumberOfGroups() == 0)
+        throw std::runtime_error("decomposition: no groups ('" + groups + "')");
+    if (!_config.decomposition.path.empty())
+        _decomposition->open(_config.decomposition.path);
+    logging::info("Energy decomposition: %zu groups.", _decomposition->getNumberOfGroups());
+}
+
 
 std::vector<size_t> SpringNetwork::_chargedParticleIndexes() const
 {
@@ -792,7 +1460,7 @@ std::vector<size_t> SpringNetwork::_chargedParticleIndexes() const
 
     for (size_t i = 0; i < _particles.size(); ++i)
     {
-        if (_particles[i].isCharged())
+        if (_particles[i].isCharged() && !isReceptorParticle(i))
             indexes.push_back(i);
     }
 
@@ -806,13 +1474,50 @@ std::vector<size_t> SpringNetwork::_hydrophobicParticleIndexes() const
 
     for (size_t i = 0; i < _particles.size(); ++i)
     {
-        if (_particles[i].isHydrophobic())
+        if (_particles[i].isHydrophobic() && !isReceptorParticle(i))
+            indexes.push_back(i);
+    }
+
+    return indexes;
+}
+
+std::vector<size_t> SpringNetwork::_nonReceptorParticleIndexes() const
+{
+    std::vector<size_t> indexes;
+    indexes.reserve(_particles.size());
+
+    for (size_t i = 0; i < _particles.size(); ++i)
+    {
+        if (!isReceptorParticle(i))
             indexes.push_back(i);
     }
 
     return indexes;
 }
 
+// Particles of each rigid body: all the dynamic particles, or those of each chain (in order of
+// appearance) with rigidbody.splitchains.
+std::vector<std::vector<unsigned>> SpringNetwork::_rigidBodiesParticles() const
+{
+    if (!isRigidBodySplitChainsEnabled())
+        return {_dynamicparticules};
+
+    std::vector<std::string> chains;
+    std::vector<std::vector<unsigned>> bodies;
+    for (const unsigned id : _dynamicparticules)
+    {
+        const std::string & chain = _particles[id].getChainName();
+        const size_t body = std::find(chains.begin(), chains.end(), chain) - chains.begin();
+        if (body == chains.size())
+        {
+            chains.push_back(chain);
+            bodies.emplace_back();
+        }
+        bodies[body].push_back(id);
+    }
+    return bodies;
+}
+
 void SpringNetwork::_excludeProbeFromNeighborSearch(NeighborSearch::Searcher & searcher)
 {
     if (!isProbeEnabled())
@@ -834,16 +1539,67 @@ void SpringNetwork::_updateNeighborSearches()
     if (!_neighborSearchesDirty)
         return;
 
-    if (_nsearch.steric)
-        _nsearch.steric->update();
-    if (_nsearch.electrostatic)
-        _nsearch.electrostatic->update();
-    if (_nsearch.hydrophobic)
-        _nsearch.hydrophobic->update();
+    for (const auto * searcher : {&_nsearch.steric, &_nsearch.electrostatic, &_nsearch.hydrophobic})
+    {
+        if (!*searcher)
+            continue;
+        const bool rebuilt = (*searcher)->update();
+        _stageProfiler.increment(rebuilt ? _stages.nsearch_rebuilds : _stages.nsearch_skips);
+    }
 
     _neighborSearchesDirty = false;
 }
 
+float SpringNetwork::_addProbeForces(unsigned term)
+{
+    const bool steric = term == STERIC_TERM;
+    const NeighborSearch::SearcherPtr & searcher = steric ? _nsearch.steric : _nsearch.electrostatic;
+
+    // The probe is left out of the cell lists, but it can be queried like any position: only
+    // the dynamic particles within the cutoff interact with it. Without a cell list for the
+    // term, every dynamic particle does, without cutoff.
+    const std::vector<unsigned> * partners = &_dynamicparticules;
+    if (searcher)
+    {
+        _probeNeighbors.clear();
+        searcher->for_each_neighbor(_probeparticule, [&](size_t i) {
+            if (_particles[i].isDynamic())
+                _probeNeighbors.push_back(static_cast<unsigned>(i));
+        });
+        // Cells are visited in grid order: sorting keeps the sums below independent of it.
+        std::sort(_probeNeighbors.begin(), _probeNeighbors.end());
+        partners = &_probeNeighbors;
+    }
+
+    // Each pair writes to its particle and to its own slot: the probe, shared by every pair,
+    // is only read here, and its force and energy are reduced serially below, in order.
+    _probePairScratch.resize(partners->size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < static_cast<long>(partners->size()); ++i)
+    {
+        const unsigned particle_id = (*partners)[static_cast<size_t>(i)];
+        spn::DeferredNonbondedContribution & pair = _probePairScratch[static_cast<size_t>(i)];
+        Particle & p = getParticle(particle_id);
+        pair.target = particle_id;
+        pair.energy = steric ? p.addStericProbeForce(_probeparticule, pair.force)
+                             : p.addElectrostaticProbeForce(_probeparticule, pair.force);
+    }
+
+    float energy = 0.0f;
+    for (const spn::DeferredNonbondedContribution & pair : _probePairScratch)
+    {
+        _probeparticule.addForce(pair.force);
+        energy += pair.energy;
+    }
+    if (steric)
+        _probeparticule.setStericEnergy(_probeparticule.getStericEnergy() + energy * 0.5f);
+    else
+        _probeparticule.setElectrostaticEnergy(_probeparticule.getElectrostaticEnergy() + energy * 0.5f);
+    return energy;
+}
+
 void SpringNetwork::_resizeNonbondedPairScratch()
 {
     const size_t n = _dynamicparticules.size();
@@ -863,7 +1619,8 @@ void SpringNetwork::_resizeNonbondedPairScratch()
 }
 
 void SpringNetwork::_applyNonbondedPairScratch(
-    const std::vector<std::vector<spn::DeferredNonbondedContribution>> & scratch, float & energy)
+    const std::vector<std::vector<spn::DeferredNonbondedContribution>> & scratch, float & energy,
+    EnergyDecomposition::Term term)
 {
     for (const auto & bucket : scratch)
     {
@@ -871,10 +1628,22 @@ void SpringNetwork::_applyNonbondedPairScratch(
         {
             getParticle(contribution.target).addForce(contribution.force);
             energy += contribution.energy;
+            if (_decomposition)
+                _decomposition->addEnergy(term, contribution.target, contribution.energy);
         }
     }
 }
 
+void SpringNetwork::_decomposeEnergies()
+{
+    for (const auto & [group, selection] : _dynamicDecompositionGroups)
+        _decomposition->setGroupParticles(group, selection->getIndexes());
+
+    _decomposition->accumulate(_particles);
+    if (_config.decomposition.frequency > 0 && static_cast<size_t>(_nbiter) % _config.decomposition.frequency == 0)
+        _decomposition->write(static_cast<size_t>(_nbiter));
+}
+
 void SpringNetwork::_syncProbeParticle()
 {
     if (!isProbeEnabled())
@@ -902,8 +1671,143 @@ void SpringNetwork::_rebuildSpringNeighbors()
     }
 }
 
-void SpringNetwork::_setupSelections() { throw "Not Implemented Error"; }
-void SpringNetwork::_setupConstraints() { throw "Not Implemented Error"; }
+void SpringNetwork::_setupSelections()
+{
+    _constraints.clear();
+    _selections.clear();
+    _hasDynamicSelections = false;
+    _selectionLabels = selection::Labels();
+
+    for (const auto & [name, expression] : _config.selection.definitions)
+    {
+        try
+        {
+            const Selection & s = addSelection(name, expression);
+            logging::info("Selection '%s': %zu particles%s.", name.c_str(), s.size(),
+                          s.isDynamic() ? " (dynamic)" : "");
+        }
+        catch (const std::invalid_argument & e)
+        {
+            throw std::runtime_error(std::string("selection.") + name + ": " + e.what());
+        }
+    }
+}
+
+void SpringNetwork::_setupConstraints()
+{
+    _constraintenabled = _config.constraint.enable;
+    if (!_constraintenabled)
+        return;
+
+    Selection * selections[2];
+    const std::string names[2] = {_config.constraint.src, _config.constraint.dest};
+    for (size_t i = 0; i < 2; ++i)
+    {
+        selections[i] = _findSelection(names[i]);
+        if (selections[i] == nullptr)
+            throw std::runtime_error("constraint: unknown selection '" + names[i] + "'");
+        if (selections[i]->empty())
+            throw std::runtime_error("constraint: selection '" + names[i] + "' is empty");
+    }
+
+    addConstraint(
+        std::make_unique<Constraint>(selections[0], selections[1], static_cast<float>(_config.constraint.scale)));
+}
+
+void SpringNetwork::_setupActiveRegion()
+{
+    _activeRegion.reset();
+    _activeRegionCenter = nullptr;
+    if (!_config.activeregion.enable)
+        return;
+
+    if (isRigidBodyEnabled())
+        throw std::runtime_error("activeregion: not available with rigid bodies");
+    if (_config.activeregion.center == "probe")
+    {
+        if (!isProbeEnabled())
+            throw std::runtime_error("activeregion.center: the probe is not enabled");
+    }
+    else
+    {
+        _activeRegionCenter = _findSelection(_config.activeregion.center);
+        if (_activeRegionCenter == nullptr)
+            throw std::runtime_error("activeregion.center: unknown selection '" + _config.activeregion.center + "'");
+        if (_activeRegionCenter->empty())
+            throw std::runtime_error("activeregion.center: selection '" + _config.activeregion.center + "' is empty");
+    }
+
+    try
+    {
+        _activeRegion = std::make_unique<ActiveRegion>(_config.activeregion.radius, _config.activeregion.buffer);
+    }
+    catch (const std::invalid_argument & e)
+    {
+        throw std::runtime_error(e.what());
+    }
+    _applyActiveRegionChanges(_activeRegion->init(_particles, _dynamicparticules, _activeRegionCenters()));
+    logging::info("Active region: %zu active particles, %zu frozen.", _activeRegion->getNumberOfActiveParticles(),
+                  _activeRegion->getNumberOfFrozenParticles());
+}
+
+std::vector<std::array<double, 3>> SpringNetwork::_activeRegionCenters() const
+{
+    if (_activeRegionCenter == nullptr)
+    {
+        const Vector3f & position = _probeparticule.getPosition();
+        return {{position.getX(), position.getY(), position.getZ()}};
+    }
+
+    std::vector<std::array<double, 3>> centers;
+    centers.reserve(_activeRegionCenter->size());
+    for (const size_t i : _activeRegionCenter->getIndexes())
+    {
+        const Vector3f & position = _particles[i].getPosition();
+        centers.push_back({position.getX(), position.getY(), position.getZ()});
+    }
+    return centers;
+}
+
+void SpringNetwork::_updateActiveRegion()
+{
+    _applyActiveRegionChanges(_activeRegion->update(_particles, _activeRegionCenters()));
+}
+
+// Frozen particles stop, and springs between two frozen particles are skipped. Frozen particles
+// stay in the neighbor grids, at fixed positions, so active particles still interact with them.
+void SpringNetwork::_applyActiveRegionChanges(const ActiveRegion::Changes & changes)
+{
+    if (changes.empty())
+        return;
+
+    for (const unsigned id : changes.frozen)
+    {
+        _particles[id].setVelocity(Vector3f());
+        _particles[id].resetForce();
+    }
+    // Springs to active particles kept adding forces to the frozen ones.
+    for (const unsigned id : changes.activated)
+        _particles[id].resetForce();
+
+    updateParticleStates(changes.frozen, true);
+    updateParticleStates(changes.activated, false);
+
+    std::vector<unsigned> staticsprings;
+    std::vector<unsigned> dynamicsprings;
+    for (const std::vector<unsigned> * ids : {&changes.frozen, &changes.activated})
+    {
+        for (const unsigned id : *ids)
+        {
+            for (const auto & [neighbor, spring] : _particles[id].getSpringNeighbors())
+            {
+                const bool frozen = spring->getParticle1().isStatic() && spring->getParticle2().isStatic();
+                (frozen ? staticsprings : dynamicsprings).push_back(spring->getId());
+            }
+        }
+    }
+    updateSpringStates(staticsprings, true);
+    updateSpringStates(dynamicsprings, false);
+}
 
 } // namespace spn
 } // namespace biospring
@@ -12,22 +12,33 @@
 
 #include "measure.hpp"
 #include "nsearch.hpp"
+#include "perfcounters.hpp"
 #include "timeit.hpp"
 
+#include "ActiveRegion.h"
 #include "Constraint.h"
+#include "cv/Colvars.h"
+#include "EnergyDecomposition.h"
 #include "InsertionVector.h"
 #include "interactor/Interactor.h"
 #include "Particle.h"
 #include "Selection.h"
 #include "Spring.h"
 #include "Vector3f.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <functional>
 #include <stdio.h>
 #include <vector>
 
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 
 class Interactor;
@@ -42,10 +53,15 @@ class Spring;
 class SpringNetwork
 {
   private:
+    // Grids are held by shared pointers so that networks running side by side can share them
+    // (see setGridLoader).
     struct Grids
     {
-        grid::PotentialGrid potential;
-        grid::PotentialGrid density;
+        std::shared_ptr<grid::PotentialGrid> potential = std::make_shared<grid::PotentialGrid>();
+        std::shared_ptr<grid::PotentialGrid> density = std::make_shared<grid::PotentialGrid>();
+        // Receptor of rigid docking, computed by setup() (null when not used).
+        std::shared_ptr<grid::PotentialGrid> receptorsteric;
+        std::shared_ptr<grid::PotentialGrid> receptorelectrostatic;
     };
 
     struct Energies
@@ -56,6 +72,7 @@ class SpringNetwork
         float kinetic = 0.0f;
         float imp = 0.0f;
         float hydrophobic = 0.0f;
+        float bias = 0.0f; // collective variable biases
 
         void reset()
         {
@@ -65,6 +82,7 @@ class SpringNetwork
             kinetic = 0.0;
             imp = 0.0;
             hydrophobic = 0.0;
+            bias = 0.0;
         }
     };
 
@@ -104,13 +122,14 @@ class SpringNetwork
         : _viewer(nullptr), _interactors(), _initparticles(), _particles(), _staticparticules(), _dynamicparticules(),
           _chargedparticules(), _hydrophobicparticules(), _probeparticule(), _springs(), _staticsprings(),
           _dynamicsprings(), _springForceScratch(), _stericPairScratch(), _electrostaticPairScratch(),
-          _hydrophobicPairScratch(), _energies(), _nsearch(), _neighborSearchesDirty(false),
+          _hydrophobicPairScratch(), _externalForces(), _externalForceIndices(), _energies(), _nsearch(), _neighborSearchesDirty(false),
           _nbiter(0), _end(false), _pause(false), _grids(), _constraintenabled(false), _framerate(0.0),
           _freesasaState(), _ff(nullptr), _trajectories(), _insertionVector(nullptr), _constraints(),
-          _meanConstraintsDistances(0.0), _structid(_currentstructid++), _config(), _profiler()
+          _meanConstraintsDistances(0.0), _structid(_currentstructid.fetch_add(1)), _config(), _profiler()
     {
         _profiler.create_timer("main");
         _profiler.create_timer("samplerate");
+        _registerProfilerStages();
     }
 
     virtual ~SpringNetwork();
@@ -160,6 +179,7 @@ class SpringNetwork
     float getElectrostaticEnergy() const { return _energies.electrostatic; }
     float getIMPEnergy() const { return _energies.imp; }
     float getHydrophobicEnergy() const { return _energies.hydrophobic; }
+    float getBiasEnergy() const { return _energies.bias; }
 
     // ================================================================================
     // Used to define the minimum IMP energy of all possible conformations at a 
@@ -176,12 +196,28 @@ class SpringNetwork
     // ================================================================================
 
     // Gets/Sets potential grid.
-    biospring::grid::PotentialGrid & getPotentialGrid() { return _grids.potential; }
-    const biospring::grid::PotentialGrid & getPotentialGrid() const { return _grids.potential; }
+    biospring::grid::PotentialGrid & getPotentialGrid() { return *_grids.potential; }
+    const biospring::grid::PotentialGrid & getPotentialGrid() const { return *_grids.potential; }
 
     // Gets/Sets density grid.
-    biospring::grid::PotentialGrid & getDensityGrid() { return _grids.density; }
-    const biospring::grid::PotentialGrid & getDensityGrid() const { return _grids.density; }
+    biospring::grid::PotentialGrid & getDensityGrid() { return *_grids.density; }
+    const biospring::grid::PotentialGrid & getDensityGrid() const { return *_grids.density; }
+
+    // Gets receptor grids (rigidbody.receptor), or nullptr.
+    const biospring::grid::PotentialGrid * getReceptorStericGrid() const { return _grids.receptorsteric.get(); }
+    const biospring::grid::PotentialGrid * getReceptorElectrostaticGrid() const
+    {
+        return _grids.receptorelectrostatic.get();
+    }
+
+    // Returns the grid stored in a DX file. By default, setup() reads the files of the configuration;
+    // a loader that caches grids lets several networks share them, read-only (see Ensemble).
+    using GridLoader = std::function<std::shared_ptr<grid::PotentialGrid>(const std::string & path)>;
+    void setGridLoader(GridLoader loader) { _gridLoader = std::move(loader); }
+
+    // Renames the output files of the collective variable definitions (metadynamics profiles).
+    // By default, the paths are used as written; replicas and sweep runs add their number.
+    void setColvarsOutputPath(cv::Colvars::OutputPath outputPath) { _colvarsOutputPath = std::move(outputPath); }
 
     // ================================================================================
     // Modification Methods.
@@ -191,6 +227,8 @@ class SpringNetwork
     void addSpring(unsigned id1, unsigned id2, float equilibrium, float stiffness);
 
     void updateSpringState(unsigned id, bool isStatic);
+    // Same as updateSpringState for many springs, in a single pass over the spring lists.
+    void updateSpringStates(const std::vector<unsigned> & ids, bool isStatic);
     void addStaticSpring(unsigned id) { _staticsprings.push_back(id); }
     void addDynamicSpring(unsigned id) { _dynamicsprings.push_back(id); }
     void removeStaticSpring(unsigned id) { _staticsprings.erase(std::remove(_staticsprings.begin(), _staticsprings.end(), id), _staticsprings.end()); }
@@ -198,8 +236,16 @@ class SpringNetwork
 
     // Adds a particle to the network.
     void addParticle(const Particle & p);
+    void addParticle(Particle && p);
+
+    // Reserves storage for particles and springs ahead of a bulk load.
+    // Must be called before any spring is added: springs hold references to particles.
+    void reserve(size_t nparticles, size_t nsprings);
 
     void updateParticleState(unsigned id, bool isStatic);
+    // Same as updateParticleState for many particles, in a single pass over the particle lists.
+    // Particles already in the requested state are left as is.
+    void updateParticleStates(const std::vector<unsigned> & ids, bool isStatic);
     void addStaticParticle(unsigned id) { _staticparticules.push_back(id); }
     void addDynamicParticle(unsigned id) { _dynamicparticules.push_back(id); }
     void removeStaticParticle(unsigned id) { _staticparticules.erase(std::remove(_staticparticules.begin(), _staticparticules.end(), id), _staticparticules.end()); }
@@ -225,9 +271,20 @@ class SpringNetwork
     std::vector<Particle>::const_reference getParticle(unsigned index) const { return _particles[index]; }
     std::vector<Particle>::reference getParticle(unsigned index) { return _particles[index]; }
 
-    // Returns a particle using its id (see Particle::getId)
-    std::vector<Particle>::const_reference getParticleFromId(unsigned extid) const;
-    std::vector<Particle>::reference getParticleFromId(unsigned extid);
+    // Returns a particle using its id (see Particle::getId).
+    // Throws std::out_of_range if no particle has this id.
+    std::vector<Particle>::const_reference getParticleFromId(unsigned id) const;
+    std::vector<Particle>::reference getParticleFromId(unsigned id);
+
+    // Returns the index of the particle with the given external id (see Particle::getExtid, the
+    // atom serial of PDB input). When several particles share it, the first one added is returned.
+    // Throws std::out_of_range if no particle has this external id.
+    unsigned getParticleIndexFromExtid(unsigned extid) const;
+
+    // Same as above for many ids at once, for interactors and steering inputs that address
+    // particles by their source ids. Throw std::out_of_range on the first unknown id.
+    std::vector<unsigned> getParticleIndexesFromIds(const std::vector<unsigned> & ids) const;
+    std::vector<unsigned> getParticleIndexesFromExtids(const std::vector<unsigned> & extids) const;
 
     // ================================================================================
     // Shortcuts to configuration values.
@@ -285,16 +342,40 @@ class SpringNetwork
 
     // ================================================================================
     bool isInsertionVectorEnabled() const { return _insertionVector != nullptr; }
+    bool isColvarsEnabled() const { return _colvars != nullptr; }
+    const cv::Colvars & getColvars() const { return *_colvars; }
+    bool isEnergyDecompositionEnabled() const { return _decomposition != nullptr; }
+    bool isActiveRegionEnabled() const { return _activeRegion != nullptr; }
+    const ActiveRegion & getActiveRegion() const { return *_activeRegion; }
+    const EnergyDecomposition & getEnergyDecomposition() const { return *_decomposition; }
 
     bool isRigidBodyEnabled() const { return _config.rigidbody.enable; }
     bool isImpalaSamplingEnabled() const { return _config.rigidbody.enablesampling; }
     bool isMonteCarloEnabled() const { return _config.rigidbody.enablemontecarlo; }
+    // Rigid bodies follow their dynamics (neither IMPALA sampling nor Monte Carlo).
+    bool isRigidBodyDynamicsEnabled() const
+    {
+        return isRigidBodyEnabled() && !isImpalaSamplingEnabled() && !isMonteCarloEnabled();
+    }
     double getMonteCarloTemperature() const { return _config.rigidbody.montecarlo_temperature; }
     void setMonteCarloTemperature(float temp) { _config.rigidbody.montecarlo_temperature = temp; }
     double getMonteCarloTranslationNorm() const { return _config.rigidbody.montecarlo_translation_norm; }
     void setMonteCarloTranslationNorm(float norm) { _config.rigidbody.montecarlo_translation_norm = norm; }
     double getMonteCarloRotationNorm() const { return _config.rigidbody.montecarlo_rotation_norm; }
     void setMonteCarloRotationNorm(float norm) { _config.rigidbody.montecarlo_rotation_norm = norm; }
+    bool isRigidBodyHydrophobicRestraintEnabled() const
+    {
+        return isRigidBodyDynamicsEnabled() && _config.rigidbody.enablehydrophobicrestraint;
+    }
+    double getRigidBodyHydrophobicRestraintScale() const { return _config.rigidbody.hydrophobicrestraint_scale; }
+    bool isRigidBodySplitChainsEnabled() const { return isRigidBodyEnabled() && _config.rigidbody.splitchains; }
+    // Rigid docking: the receptor chains are frozen and represented by potential grids.
+    bool isReceptorGridEnabled() const { return isRigidBodyEnabled() && !_config.rigidbody.receptor.empty(); }
+    bool isReceptorParticle(size_t index) const
+    {
+        return std::binary_search(_receptorparticules.begin(), _receptorparticules.end(), index);
+    }
+    const std::vector<unsigned> & getReceptorParticles() const { return _receptorparticules; }
 
     // ================================================================================
 
@@ -322,8 +403,20 @@ class SpringNetwork
     vector<unsigned> getStaticParticles() const { return _staticparticules; }
     vector<unsigned> getHydrophobicParticles() const { return _hydrophobicparticules; }
 
+    // Returns subsets of spring ids. Static springs are skipped by the force loop.
+    const vector<unsigned> & getDynamicSprings() const { return _dynamicsprings; }
+    const vector<unsigned> & getStaticSprings() const { return _staticsprings; }
+
     // Returns the particle's centroid.
-    auto getCentroid() const { return biospring::measure::centroid(_particles); }
+    // It is reduced by the integration loop at each step; otherwise all the particles are scanned
+    // once and the result is kept. Particles moved by hand between two steps must be followed by
+    // invalidateCentroid().
+    std::array<double, 3> getCentroid() const;
+    void invalidateCentroid()
+    {
+        _centroidValid = false;
+        _staticPositionSumValid = false;
+    }
 
     // ================================================================================
     // Run-related methods.
@@ -360,8 +453,19 @@ class SpringNetwork
     void _setupInsertionVector();
     void _setupSelections();
     void _setupConstraints();
+    void _setupProfiling();
+    void _setupRigidBodies();
+    void _setupReceptorGrids();
+    void _setupColvars();
+    void _setupEnergyDecomposition();
+    void _setupActiveRegion();
+    Selection * _findSelection(const std::string & name) const;
+    std::shared_ptr<grid::PotentialGrid> _loadGrid(const std::string & path, const char * description) const;
     std::vector<size_t> _chargedParticleIndexes() const;
     std::vector<size_t> _hydrophobicParticleIndexes() const;
+    std::vector<size_t> _nonReceptorParticleIndexes() const;
+    std::array<double, 3> _nonIntegratedPositionSum() const;
+    std::vector<std::vector<unsigned>> _rigidBodiesParticles() const;
     void _excludeProbeFromNeighborSearch(NeighborSearch::Searcher & searcher);
     void _updateNeighborSearches();
     void _markNeighborSearchesDirty();
@@ -373,11 +477,21 @@ class SpringNetwork
     void _resizeNonbondedPairScratch();
 
     // Applies deferred nonbonded pair contributions to their target
-    // particles and adds their energy to `energy`. Must run serially, after
-    // the parallel region that filled `scratch`, since two buckets may defer
-    // a contribution to the same target particle.
+    // particles and adds their energy to `energy` (and to `term` of the
+    // energy decomposition). Must run serially, after the parallel region that
+    // filled `scratch`, since two buckets may defer a contribution to the same
+    // target particle.
     void _applyNonbondedPairScratch(const std::vector<std::vector<spn::DeferredNonbondedContribution>> & scratch,
-                                     float & energy);
+                                     float & energy, EnergyDecomposition::Term term);
+
+    // Active region: positions of the centers, and state changes of particles and springs.
+    std::vector<std::array<double, 3>> _activeRegionCenters() const;
+    void _updateActiveRegion();
+    void _applyActiveRegionChanges(const ActiveRegion::Changes & changes);
+
+    // Accumulates the energies of the step in the energy decomposition, and
+    // writes the means at the sampling frequency.
+    void _decomposeEnergies();
 
     // ================================================================================
     //
@@ -386,16 +500,75 @@ class SpringNetwork
     // ================================================================================
 
   public:
-    std::vector<Constraint *> getConstraints(void) { return _constraints; }
-    void addConstraint(Constraint * constraint) { _constraints.push_back(constraint); }
+    const std::vector<std::unique_ptr<Constraint>> & getConstraints() const { return _constraints; }
+    void addConstraint(std::unique_ptr<Constraint> constraint) { _constraints.push_back(std::move(constraint)); }
     void applyConstraints();
 
+    // ================================================================================
+    //
+    // Selection methods.
+    //
+    // ================================================================================
+
+    // Compiles a selection expression (see selection::Expression) and stores it by name.
+    // `@name` references in the expression refer to the previously added selections.
+    // Throws std::invalid_argument on a syntax error or a duplicate name.
+    const Selection & addSelection(const std::string & name, const std::string & expression);
+
+    // Throws std::invalid_argument if there is no such selection.
+    const Selection & getSelection(const std::string & name) const;
+    const std::vector<std::unique_ptr<Selection>> & getSelections() const { return _selections; }
+
+    // Evaluates the dynamic selections from the current positions.
+    void updateSelections();
+
     // ================================================================================
 
     virtual void getParticlePosition(unsigned i, float position[3]) const;
 
     virtual void setForce(unsigned i, float force[3]);
 
+    // ================================================================================
+    //
+    // External forces.
+    //
+    // Forces set by interactors (MDDriver, viewer) or steering scripts on a few
+    // particles. They are stored sparsely and added to the particle forces by
+    // computeParticleForces, so that their cost depends on the number of forced
+    // particles, not on the size of the system.
+    //
+    // ================================================================================
+
+    struct ExternalForce
+    {
+        unsigned particle; // particle index
+        Vector3f force;
+        unsigned expiry;   // last step at which the force is applied
+        const void * owner; // source that set the force (nullptr for anonymous sources)
+    };
+
+    static constexpr unsigned NO_EXPIRY = std::numeric_limits<unsigned>::max();
+
+    // Applies `force` to the particle at each step until step `expiry` (included).
+    // Replaces the external force previously set on this particle, if any, whoever set it.
+    // `owner` identifies the source of the force for `removeExternalForce(particle, owner)`.
+    void setExternalForce(unsigned particle, const Vector3f & force, unsigned expiry = NO_EXPIRY,
+                          const void * owner = nullptr);
+
+    // Removes the external force set on a particle, if any.
+    void removeExternalForce(unsigned particle);
+
+    // Removes the external force set on a particle only if it was last set by `owner`.
+    void removeExternalForce(unsigned particle, const void * owner);
+
+    void clearExternalForces();
+
+    const std::vector<ExternalForce> & getExternalForces() const { return _externalForces; }
+
+    // Per-stage timings of the simulation step. Only recorded when profiling is enabled.
+    timeit::StageProfiler & getStageProfiler() { return _stageProfiler; }
+    const timeit::StageProfiler & getStageProfiler() const { return _stageProfiler; }
+
     // The opaque viewer pointer is always present so enabling the optional
     // viewer never changes SpringNetwork's ABI or class layout.
     ::SpringNetworkViewer * _viewer;
@@ -411,6 +584,14 @@ class SpringNetwork
     std::vector<unsigned> _dynamicparticules;
     std::vector<unsigned> _chargedparticules;
     std::vector<unsigned> _hydrophobicparticules;
+    std::vector<unsigned> _receptorparticules; // sorted
+
+    // Index of each particle by external id, filled by addParticle. Particle ids need no table:
+    // addParticle assigns each particle its index as id.
+    std::unordered_map<unsigned, unsigned> _extidToIndex;
+
+    // Returns the index of the particle with the given id, or throws std::out_of_range.
+    unsigned _particleIndexFromId(unsigned id) const;
 
     Particle _probeparticule;
 
@@ -432,6 +613,37 @@ class SpringNetwork
     std::vector<std::vector<spn::DeferredNonbondedContribution>> _electrostaticPairScratch;
     std::vector<std::vector<spn::DeferredNonbondedContribution>> _hydrophobicPairScratch;
 
+    // External forces, and the position of each forced particle in `_externalForces`.
+    std::vector<ExternalForce> _externalForces;
+    std::unordered_map<unsigned, size_t> _externalForceIndices;
+
+    // Adds the external forces to the particles and drops the expired ones.
+    void _applyExternalForces();
+
+    // Per-particle force terms, as a bit mask for `_addParticleForces`.
+    enum ParticleForceTerms : unsigned
+    {
+        ELECTROSTATIC_TERM = 1 << 0,
+        FIELD_TERMS = 1 << 1, // electrostatic field and density grid
+        STERIC_TERM = 1 << 2,
+        VISCOSITY_TERM = 1 << 3,
+        IMPALA_TERM = 1 << 4,
+        HYDROPHOBICITY_TERM = 1 << 5,
+        ALL_PARTICLE_FORCE_TERMS = (1 << 6) - 1,
+    };
+
+    // Adds the given terms to the forces of the dynamic particles.
+    void _addParticleForces(unsigned terms);
+
+    // Adds the probe interactions of one term (STERIC_TERM or ELECTROSTATIC_TERM) to the probe
+    // and to the dynamic particles within the cutoff of the term. Returns their energy.
+    float _addProbeForces(unsigned term);
+
+    // Dynamic particles near the probe, and one contribution per probe pair, with the force
+    // owed to the probe. Reused between steps, see _addProbeForces.
+    std::vector<unsigned> _probeNeighbors;
+    std::vector<spn::DeferredNonbondedContribution> _probePairScratch;
+
     Energies _energies;
     NeighborSearch _nsearch;
     bool _neighborSearchesDirty;
@@ -449,21 +661,56 @@ class SpringNetwork
     FreeSASAState _freesasaState;
 
     std::unique_ptr<forcefield::ForceField> _ff;
+    GridLoader _gridLoader;
+    cv::Colvars::OutputPath _colvarsOutputPath;
 
     io::modern::TrajectoryManager _trajectories;
 
     std::unique_ptr<InsertionVector> _insertionVector;
-
-    vector<Constraint *> _constraints;
+    std::unique_ptr<cv::Colvars> _colvars; // set up with colvars.enable
+    std::unique_ptr<EnergyDecomposition> _decomposition; // set up with decomposition.enable
+    std::vector<std::pair<size_t, const Selection *>> _dynamicDecompositionGroups; // group, selection
+    std::unique_ptr<ActiveRegion> _activeRegion;  // set up with activeregion.enable
+    const Selection * _activeRegionCenter = nullptr; // nullptr: the probe
+
+    // Centroid cache, see getCentroid.
+    mutable std::array<double, 3> _centroid = {0.0, 0.0, 0.0};
+    mutable bool _centroidValid = false;
+    mutable std::array<double, 3> _staticPositionSum = {0.0, 0.0, 0.0};
+    mutable bool _staticPositionSumValid = false;
+
+    std::vector<std::unique_ptr<Constraint>> _constraints;
+    std::vector<std::unique_ptr<Selection>> _selections;
+    selection::Labels _selectionLabels; // built with the first selection
+    bool _hasDynamicSelections = false;
     float _meanConstraintsDistances;
 
-    static unsigned _currentstructid;
+    // Networks may be built concurrently (see Sweep), each taking the next id.
+    static std::atomic<unsigned> _currentstructid;
     unsigned _structid;
 
     configuration::Configuration _config;
 
     timeit::Profiler _profiler;
 
+    // Per-stage timings of the simulation step (see the `profiling` settings).
+    struct ProfilerStages
+    {
+        size_t step, interactors, trajectories, springs, electrostatic, fields, steric, viscosity, impala,
+            hydrophobicity, pairs, external, colvars, probe, decomposition, rigidbodyforces, constraints,
+            rigidbodysolve, integration, nsearch, activeregion, ivector;
+        size_t nsearch_rebuilds, nsearch_skips;
+    };
+    timeit::StageProfiler _stageProfiler;
+    ProfilerStages _stages;
+    perf::HardwareCounters _hardwareCounters; // opened when profiling.hardware is set
+    std::ofstream _profileOutput;
+
+    void _registerProfilerStages();
+
+    // Writes the timings accumulated since the last call to the profiling output.
+    void _writeProfilingInterval();
+
     // ================================================================================
 
     // Computes insertion vector's angle and updates barycentre.
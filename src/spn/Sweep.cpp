@@ -0,0 +1,298 @@
+#include "Sweep.h"
+
+#include "SpringNetwork.h"
+#include "logging.h"
+#include "utils/path.hpp"
+#include "utils/string.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef OPENMP_SUPPORT
+#include <omp.h>
+#endif
+
+namespace biospring
+{
+namespace spn
+{
+
+const std::array<const char *, 6> Sweep::ENERGY_NAMES = {"kinetic", "spring", "steric", "electrostatic", "imp",
+                                                         "hydrophobic"};
+
+Sweep::Sweep(topology::Topology topology, const configuration::Configuration & config, Mode mode)
+    : _topology(std::move(topology)), _config(config), _mode(mode), _parameters(), _values(), _grids()
+{
+}
+
+void Sweep::add(const std::string & parameter, const std::vector<std::string> & values)
+{
+    if (!_config.exists(parameter))
+        throw std::invalid_argument("invalid parameter '" + parameter + "'");
+    if (std::find(_parameters.begin(), _parameters.end(), parameter) != _parameters.end())
+        throw std::invalid_argument("parameter '" + parameter + "' is already swept");
+    if (values.empty())
+        throw std::invalid_argument("parameter '" + parameter + "' has no value");
+    if (_mode == Mode::List && !_values.empty() && values.size() != _values[0].size())
+        throw std::invalid_argument("parameter '" + parameter + "': expected " + std::to_string(_values[0].size()) +
+                                    " values, got " + std::to_string(values.size()));
+
+    _parameters.push_back(parameter);
+    _values.push_back(values);
+}
+
+size_t Sweep::size() const
+{
+    if (_values.empty())
+        return 1;
+    if (_mode == Mode::List)
+        return _values[0].size();
+
+    size_t n = 1;
+    for (const auto & values : _values)
+        n *= values.size();
+    return n;
+}
+
+std::vector<std::string> Sweep::getValues(size_t run) const
+{
+    if (run >= size())
+        throw std::out_of_range("run " + std::to_string(run) + " out of range");
+
+    std::vector<std::string> result(_parameters.size());
+    for (size_t i = _parameters.size(); i-- > 0;)
+    {
+        if (_mode == Mode::List)
+            result[i] = _values[i][run];
+        else
+        {
+            result[i] = _values[i][run % _values[i].size()];
+            run /= _values[i].size();
+        }
+    }
+    return result;
+}
+
+configuration::Configuration Sweep::getConfiguration(size_t run) const
+{
+    configuration::Configuration config = _config;
+    const std::vector<std::string> values = getValues(run);
+    for (size_t i = 0; i < _parameters.size(); ++i)
+        config.setFromString(_parameters[i], values[i]);
+
+    config.pdbtraj.path = utils::path::replicaPath(config.pdbtraj.path, run);
+    config.xtctraj.path = utils::path::replicaPath(config.xtctraj.path, run);
+    config.csvsample.path = utils::path::replicaPath(config.csvsample.path, run);
+    config.profiling.path = utils::path::replicaPath(config.profiling.path, run);
+    config.colvars.path = utils::path::replicaPath(config.colvars.path, run);
+    config.decomposition.path = utils::path::replicaPath(config.decomposition.path, run);
+    return config;
+}
+
+std::string Sweep::_tableHeader() const
+{
+    std::string header = "# run";
+    for (const std::string & parameter : _parameters)
+        header += "\t" + parameter;
+    for (const char * name : ENERGY_NAMES)
+        header += "\t" + std::string(name) + " (kJ.mol-1)";
+    return header;
+}
+
+// Reads the runs already in `table`, and rewrites it without the last line if this one was
+// left incomplete.
+std::set<size_t> Sweep::_readCompletedRuns(const std::string & table) const
+{
+    std::ifstream is(table);
+    if (!is)
+        throw std::runtime_error("cannot open '" + table + "'");
+
+    std::string line;
+    if (!std::getline(is, line) || line != _tableHeader())
+        throw std::runtime_error("'" + table + "' was written by another sweep (parameters differ)");
+
+    const size_t number_of_fields = 1 + _parameters.size() + ENERGY_NAMES.size();
+    std::vector<std::string> rows;
+    std::set<size_t> completed;
+    while (std::getline(is, line))
+    {
+        const std::vector<std::string> fields = utils::string::split(line, "\t");
+        if (fields.size() != number_of_fields)
+            continue;
+
+        size_t run = 0;
+        utils::string::from_string<size_t>(run, fields[0]);
+        if (run >= size())
+            throw std::runtime_error("'" + table + "' was written by another sweep (run " + fields[0] + " differs)");
+        const std::vector<std::string> values = getValues(run);
+        if (!std::equal(values.begin(), values.end(), fields.begin() + 1))
+            throw std::runtime_error("'" + table + "' was written by another sweep (run " + fields[0] + " differs)");
+
+        completed.insert(run);
+        rows.push_back(line);
+    }
+    is.close();
+
+    std::ofstream os(table, std::ios::trunc);
+    os << _tableHeader() << '\n';
+    for (const std::string & row : rows)
+        os << row << '\n';
+    return completed;
+}
+
+// Removes from `samples` the samples of the runs that are not in `runs`.
+void Sweep::_keepSamples(const std::string & samples, const std::set<size_t> & runs)
+{
+    std::vector<std::string> lines;
+    {
+        std::ifstream is(samples);
+        std::string line;
+        while (std::getline(is, line))
+        {
+            if (line.rfind("#", 0) == 0)
+            {
+                lines.push_back(line);
+                continue;
+            }
+            size_t run = 0;
+            utils::string::from_string<size_t>(run, line.substr(0, line.find('\t')));
+            if (runs.count(run))
+                lines.push_back(line);
+        }
+    }
+
+    std::ofstream os(samples, std::ios::trunc);
+    for (const std::string & line : lines)
+        os << line << '\n';
+}
+
+Sweep::Energies Sweep::_simulate(const configuration::Configuration & config, size_t run)
+{
+    // Trajectory files are flushed when the writers are destroyed with the network.
+    SpringNetwork spn;
+    _topology.to_spring_network(spn);
+    spn.setGridLoader([this](const std::string & path) { return _grids.get(path); });
+    spn.setColvarsOutputPath([run](const std::string & path) { return utils::path::replicaPath(path, run); });
+    spn.setup(config);
+    spn.run();
+
+    return {spn.getKineticEnergy(),       spn.getSpringEnergy(), spn.getStericEnergy(),
+            spn.getElectrostaticEnergy(), spn.getIMPEnergy(),    spn.getHydrophobicEnergy()};
+}
+
+size_t Sweep::run(const std::string & table, const std::string & samples, bool resume)
+{
+    for (size_t i = 0; i < size(); ++i)
+        if (getConfiguration(i).sim.nbsteps < 0)
+            throw std::invalid_argument("run " + std::to_string(i) +
+                                        ": the number of steps (simulation.nbsteps) must be set");
+
+    // Rigid bodies are kept in a collection shared by the whole process (see
+    // rigidbody::RigidBodiesManager): concurrent runs would move the bodies of each other, and
+    // a run would find the bodies of the previous one.
+    for (size_t i = 0; i < size(); ++i)
+        if (getConfiguration(i).rigidbody.enable)
+            throw std::runtime_error("run " + std::to_string(i) +
+                                     ": rigid bodies (rigidbody.enable) are not available in a sweep");
+
+    std::set<size_t> completed;
+    if (resume && std::filesystem::exists(table))
+    {
+        completed = _readCompletedRuns(table);
+        if (!samples.empty())
+            _keepSamples(samples, completed);
+    }
+    else
+    {
+        std::ofstream(table, std::ios::trunc) << _tableHeader() << '\n';
+        if (!samples.empty())
+            std::ofstream(samples, std::ios::trunc);
+    }
+
+    std::ofstream tableStream(table, std::ios::app);
+    if (!tableStream)
+        throw std::runtime_error("cannot open '" + table + "'");
+    std::ofstream samplesStream;
+    if (!samples.empty())
+    {
+        samplesStream.open(samples, std::ios::app);
+        if (!samplesStream)
+            throw std::runtime_error("cannot open '" + samples + "'");
+    }
+    bool samplesHeader = !samples.empty() && std::filesystem::file_size(samples) > 0;
+
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < size(); ++i)
+        if (!completed.count(i))
+            pending.push_back(i);
+    if (!completed.empty())
+        logging::status("Resuming sweep: %zu of %zu runs already done.", completed.size(), size());
+
+    std::mutex mutex;
+    std::exception_ptr error;
+    size_t done = completed.size();
+
+    const long n = static_cast<long>(pending.size());
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (long k = 0; k < n; ++k)
+    {
+#ifdef OPENMP_SUPPORT
+        omp_set_num_threads(1); // runs are the unit of parallelism
+#endif
+        const size_t run = pending[k];
+        try
+        {
+            const configuration::Configuration config = getConfiguration(run);
+            const Energies energies = _simulate(config, run);
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // Samples go first: a run is only done once its row is in the table.
+            if (samplesStream.is_open() && config.csvsample.enable)
+            {
+                std::ifstream is(config.csvsample.path);
+                std::string line;
+                while (std::getline(is, line))
+                {
+                    if (line.rfind("# ", 0) == 0)
+                    {
+                        if (!samplesHeader)
+                            samplesStream << "# run\t" << line.substr(2) << '\n';
+                        samplesHeader = true;
+                    }
+                    else if (!line.empty())
+                        samplesStream << run << '\t' << line << '\n';
+                }
+                samplesStream.flush();
+            }
+
+            tableStream << run;
+            for (const std::string & value : getValues(run))
+                tableStream << '\t' << value;
+            for (double energy : energies)
+                tableStream << '\t' << energy;
+            tableStream << std::endl;
+
+            logging::info("Sweep: run %zu done (%zu/%zu).", run, ++done, size());
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+    return pending.size();
+}
+
+} // namespace spn
+} // namespace biospring
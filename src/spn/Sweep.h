@@ -0,0 +1,101 @@
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+#include "GridCache.h"
+#include "configuration/Configuration.hpp"
+#include "topology.hpp"
+
+#include <array>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace biospring
+{
+namespace spn
+{
+
+//
+// Parameter sweep: runs a simulation for each combination of configuration values.
+//
+// Parameters (<group>.<name>) are added with their list of values. In Grid mode, the runs
+// are all the combinations of values (cartesian product, the last parameter varying fastest);
+// in List mode, run i takes the i-th value of every parameter.
+//
+// The topology is converted for each run, and each DX grid is read once and shared by all the
+// runs. Runs are handed to the OpenMP threads one at a time, each run using a single thread,
+// and only the running networks are held in memory.
+//
+// The final energies of each run are appended to a table as soon as the run ends, so that
+// an interrupted sweep resumes where it stopped. With CSV sampling enabled, the samples of
+// all the runs are gathered in a second table, with the run number as first column.
+// Output files of run i get the run number, e.g. traj.xtc becomes traj.i.xtc.
+//
+// Example:
+//
+//     spn::Sweep sweep(io::readTopology("model.nc"), config);
+//     sweep.add("impala.scale", {"0.5", "1", "2"});
+//     sweep.add("coulomb.dielectric", {"20", "40", "80"});
+//     sweep.run("sweep.tsv"); // 9 runs
+//
+class Sweep
+{
+  public:
+    enum class Mode
+    {
+        Grid,
+        List,
+    };
+
+    // Final energies of a run, in the order of the table columns.
+    using Energies = std::array<double, 6>;
+    static const std::array<const char *, 6> ENERGY_NAMES;
+
+    Sweep(topology::Topology topology, const configuration::Configuration & config, Mode mode = Mode::Grid);
+
+    // Adds a parameter and its values.
+    // Throws std::invalid_argument if the parameter does not exist or is already swept, if there
+    // is no value, or, in List mode, if the number of values differs from the other parameters.
+    void add(const std::string & parameter, const std::vector<std::string> & values);
+
+    // Number of runs.
+    size_t size() const;
+
+    const std::vector<std::string> & getParameters() const { return _parameters; }
+
+    // Values of the parameters for a run.
+    std::vector<std::string> getValues(size_t run) const;
+
+    // Configuration of a run, output paths included.
+    configuration::Configuration getConfiguration(size_t run) const;
+
+    // Runs the sweep and writes the final energies to `table`, and the CSV samples to `samples`
+    // if not empty. With `resume`, the runs already in `table` are skipped; otherwise the
+    // tables are overwritten.
+    // Returns the number of runs performed.
+    // Throws std::invalid_argument if a run has no end (simulation.nbsteps < 0), and
+    // std::runtime_error if a run enables rigid bodies, which are shared by the whole process,
+    // or if a table cannot be written or was written by another sweep.
+    size_t run(const std::string & table, const std::string & samples = "", bool resume = false);
+
+    // Number of DX files read so far (each file is read once).
+    size_t getNumberOfGridsRead() const { return _grids.size(); }
+
+  protected:
+    topology::Topology _topology;
+    configuration::Configuration _config;
+    Mode _mode;
+    std::vector<std::string> _parameters;
+    std::vector<std::vector<std::string>> _values; // per parameter
+    GridCache _grids;
+
+    std::string _tableHeader() const;
+    std::set<size_t> _readCompletedRuns(const std::string & table) const;
+    static void _keepSamples(const std::string & samples, const std::set<size_t> & runs);
+    Energies _simulate(const configuration::Configuration & config, size_t run);
+};
+
+} // namespace spn
+} // namespace biospring
+
+#endif // __SWEEP_H__
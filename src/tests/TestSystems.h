@@ -0,0 +1,53 @@
+#ifndef __TESTSYSTEMS_H__
+#define __TESTSYSTEMS_H__
+
+// Systems and configurations shared by the tests that run a spring network.
+
+#include <cstddef>
+
+#include "configuration/Configuration.hpp"
+#include "topology/Generator.hpp"
+
+namespace biospring
+{
+namespace tests
+{
+
+// Default configuration with springs and steric repulsion, and no profiling output.
+// Tests then enable the terms they exercise.
+inline configuration::Configuration simulation_configuration(int nbsteps, double steric_cutoff)
+{
+    configuration::Configuration config = configuration::defaultConfiguration();
+    config.sim.nbsteps = nbsteps;
+    config.spring.enable = true;
+    config.steric.enable = true;
+    config.steric.cutoff = steric_cutoff;
+    config.profiling.enable = false;
+    return config;
+}
+
+// A globule of `n` particles (see topology::generator::lattice_protein).
+inline topology::Topology lattice_protein(size_t n, unsigned seed)
+{
+    topology::generator::Parameters parameters;
+    parameters.number_of_particles = n;
+    parameters.seed = seed;
+    return topology::generator::lattice_protein(parameters);
+}
+
+// `n` particles in chains of `chain_size` (see topology::generator::assembly).
+inline topology::Topology assembly(size_t n, size_t chain_size, unsigned seed,
+                                   double chain_gap = topology::generator::Parameters().chain_gap)
+{
+    topology::generator::Parameters parameters;
+    parameters.number_of_particles = n;
+    parameters.chain_size = chain_size;
+    parameters.chain_gap = chain_gap;
+    parameters.seed = seed;
+    return topology::generator::assembly(parameters);
+}
+
+} // namespace tests
+} // namespace biospring
+
+#endif // __TESTSYSTEMS_H__
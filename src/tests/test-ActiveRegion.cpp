@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "ActiveRegion.h"
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+
+using namespace biospring;
+
+// Particles along x, 1 Å apart.
+static std::vector<spn::Particle> make_line(size_t n)
+{
+    std::vector<spn::Particle> particles(n);
+    for (size_t i = 0; i < n; ++i)
+        particles[i].setPosition(Vector3f(static_cast<float>(i), 0.0f, 0.0f));
+    return particles;
+}
+
+TEST(ActiveRegion, init_and_update)
+{
+    const std::vector<spn::Particle> particles = make_line(100);
+    std::vector<unsigned> mobile;
+    for (unsigned i = 0; i < 100; ++i)
+        if (i != 1)
+            mobile.push_back(i);
+
+    spn::ActiveRegion region(5.0, 2.0);
+    const spn::ActiveRegion::Changes init = region.init(particles, mobile, {{0.0, 0.0, 0.0}});
+    EXPECT_TRUE(init.activated.empty());
+    EXPECT_EQ(init.frozen.size(), 93u); // 7 to 99, 1 is not mobile
+    EXPECT_EQ(region.getNumberOfActiveParticles(), 6u);
+    EXPECT_EQ(region.getNumberOfFrozenParticles(), 93u);
+    EXPECT_TRUE(region.isActive(6));
+    EXPECT_FALSE(region.isActive(1));
+    EXPECT_FALSE(region.isActive(7));
+
+    // Particles 46 to 54 come within 5 Å; 0 to 6 are farther than 7 Å.
+    const spn::ActiveRegion::Changes changes = region.update(particles, {{50.0, 0.0, 0.0}});
+    EXPECT_EQ(changes.activated, (std::vector<unsigned>{46, 47, 48, 49, 50, 51, 52, 53, 54}));
+    EXPECT_EQ(changes.frozen, (std::vector<unsigned>{0, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(region.getNumberOfActiveParticles(), 9u);
+
+    // 46 is 6.5 Å away, within the buffer: it stays active.
+    const spn::ActiveRegion::Changes shifted = region.update(particles, {{52.5, 0.0, 0.0}});
+    EXPECT_EQ(shifted.activated, (std::vector<unsigned>{55, 56, 57}));
+    EXPECT_TRUE(shifted.frozen.empty());
+    EXPECT_TRUE(region.isActive(46));
+
+    EXPECT_THROW(spn::ActiveRegion(0.0, 1.0), std::invalid_argument);
+    EXPECT_THROW(spn::ActiveRegion(1.0, -1.0), std::invalid_argument);
+}
+
+TEST(ActiveRegion, spring_network)
+{
+    spn::SpringNetwork spn;
+    tests::lattice_protein(500, 4).to_spring_network(spn);
+
+    configuration::Configuration config = tests::simulation_configuration(20, 8.0);
+    config.setFromString("selection.site", "index 0");
+    config.activeregion.enable = true;
+    config.activeregion.center = "site";
+    config.activeregion.radius = 8.0;
+    config.activeregion.frequency = 5;
+    spn.setup(config);
+    ASSERT_TRUE(spn.isActiveRegionEnabled());
+
+    const size_t active = spn.getActiveRegion().getNumberOfActiveParticles();
+    EXPECT_GT(active, 1u);
+    EXPECT_LT(active, 500u);
+    EXPECT_EQ(spn.getDynamicParticles().size(), active);
+    EXPECT_EQ(spn.getStaticParticles().size(), 500u - active);
+    for (const unsigned id : spn.getStaticSprings())
+    {
+        const spn::Spring & spring = spn.getSpring(id);
+        EXPECT_TRUE(spring.getParticle1().isStatic() && spring.getParticle2().isStatic());
+    }
+    for (const unsigned id : spn.getDynamicSprings())
+    {
+        const spn::Spring & spring = spn.getSpring(id);
+        EXPECT_FALSE(spring.getParticle1().isStatic() && spring.getParticle2().isStatic());
+    }
+
+    std::vector<Vector3f> positions;
+    for (size_t i = 0; i < spn.getNumberOfParticles(); ++i)
+        positions.push_back(spn.getParticle(i).getPosition());
+    const std::vector<unsigned> frozen = spn.getStaticParticles();
+    spn.run();
+
+    for (const unsigned id : frozen)
+        if (!spn.getActiveRegion().isActive(id))
+        {
+            EXPECT_EQ(spn.getParticle(id).getPosition(), positions[id]);
+        }
+
+    config.activeregion.center = "missing";
+    spn::SpringNetwork other;
+    tests::lattice_protein(500, 4).to_spring_network(other);
+    EXPECT_THROW(other.setup(config), std::runtime_error);
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
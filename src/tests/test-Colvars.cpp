@@ -0,0 +1,329 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+#include "cv/Colvars.h"
+#include "forcefield/constants.hpp"
+
+using namespace biospring;
+
+static std::vector<spn::Particle> make_particles()
+{
+    const float positions[][3] = {{0.0f, 0.0f, 0.0f},  {3.0f, 0.5f, -1.0f}, {2.0f, 4.0f, 1.0f},
+                                  {-1.0f, 2.0f, 3.0f}, {5.0f, -2.0f, 2.5f}, {1.0f, 1.0f, -3.0f}};
+    std::vector<spn::Particle> particles(6);
+    for (size_t i = 0; i < particles.size(); ++i)
+        particles[i].setPosition(Vector3f(positions[i][0], positions[i][1], positions[i][2]));
+    return particles;
+}
+
+// Compares the gradient of a variable with central finite differences.
+static void expect_gradient(cv::CollectiveVariable & variable, std::vector<spn::Particle> particles)
+{
+    const float h = 1e-2f;
+    variable.compute(particles);
+    const std::vector<std::array<double, 3>> gradient = variable.getGradient();
+
+    for (size_t n = 0; n < variable.getParticles().size(); ++n)
+    {
+        spn::Particle & p = particles[variable.getParticles()[n]];
+        const Vector3f position = p.getPosition();
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            Vector3f shifted = position;
+            shifted[axis] += h;
+            p.setPosition(shifted);
+            variable.compute(particles);
+            const double forward = variable.getValue();
+            shifted[axis] -= 2 * h;
+            p.setPosition(shifted);
+            variable.compute(particles);
+            const double backward = variable.getValue();
+            p.setPosition(position);
+
+            const double expected = (forward - backward) / (2 * h);
+            EXPECT_NEAR(gradient[n][axis], expected, 1e-2 * std::max(1.0, std::fabs(expected)))
+                << variable.getType() << ", particle " << variable.getParticles()[n] << ", axis " << axis;
+        }
+    }
+}
+
+TEST(Colvars, values)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+
+    cv::Distance distance("d", 0, 1);
+    distance.compute(particles);
+    EXPECT_NEAR(distance.getValue(), std::sqrt(9.0 + 0.25 + 1.0), 1e-6);
+
+    cv::Angle angle("a", 1, 0, 5);
+    angle.compute(particles);
+    EXPECT_NEAR(angle.getValue(), std::acos((3.0 + 0.5 + 3.0) / (std::sqrt(10.25) * std::sqrt(11.0))) * 180.0 / M_PI,
+                1e-4);
+
+    cv::CentroidDistance centroids("c", {0, 1}, {2, 3});
+    centroids.compute(particles);
+    EXPECT_NEAR(centroids.getValue(), std::sqrt(1.0 * 1.0 + 2.75 * 2.75 + 2.5 * 2.5), 1e-6);
+
+    cv::Depth depth("z", {0, 1, 2, 3});
+    depth.compute(particles);
+    EXPECT_NEAR(depth.getValue(), 0.75, 1e-6);
+
+    std::vector<spn::Particle> moved = particles;
+    moved[2].setPosition(moved[2].getPosition() + Vector3f(2.0f, 0.0f, 0.0f));
+    cv::RMSD rmsd("r", {0, 1, 2, 3}, particles);
+    rmsd.compute(particles);
+    EXPECT_NEAR(rmsd.getValue(), 0.0, 1e-12);
+    rmsd.compute(moved);
+    EXPECT_NEAR(rmsd.getValue(), 1.0, 1e-6);
+}
+
+TEST(Colvars, gradients_match_finite_differences)
+{
+    std::vector<spn::Particle> particles = make_particles();
+    std::vector<spn::Particle> reference = particles;
+    for (spn::Particle & p : reference)
+        p.setPosition(p.getPosition() * 0.9f + Vector3f(0.3f, -0.2f, 0.1f));
+
+    cv::Distance distance("d", 0, 4);
+    cv::Angle angle("a", 1, 2, 3);
+    cv::CentroidDistance centroids("c", {0, 1, 2}, {2, 3, 4, 5}); // overlapping groups
+    cv::Depth depth("z", {1, 3, 5});
+    cv::RMSD rmsd("r", {0, 1, 2, 3, 4, 5}, reference);
+
+    expect_gradient(distance, particles);
+    expect_gradient(angle, particles);
+    expect_gradient(centroids, particles);
+    expect_gradient(depth, particles);
+    expect_gradient(rmsd, particles);
+}
+
+TEST(Colvars, invalid_variables)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    EXPECT_THROW(cv::Distance("d", 1, 1), std::invalid_argument);
+    EXPECT_THROW(cv::Angle("a", 0, 1, 0), std::invalid_argument);
+    EXPECT_THROW(cv::Depth("z", {}), std::invalid_argument);
+    EXPECT_THROW(cv::RMSD("r", {0, 10}, particles), std::invalid_argument);
+}
+
+// The umbrella force pulls the particles towards the window centre, and walls only act
+// beyond their bounds.
+TEST(Colvars, harmonic_biases)
+{
+    std::vector<spn::Particle> particles = make_particles();
+    cv::Colvars colvars;
+    const cv::CollectiveVariable & distance = colvars.addVariable(std::make_unique<cv::Distance>("d", 0, 1));
+    colvars.addBias(std::make_unique<cv::Umbrella>(distance, 2.0, 10.0));
+
+    const double energy = colvars.apply(particles, 0);
+    const double d = std::sqrt(10.25);
+    EXPECT_NEAR(energy, 0.5 * 10.0 * (d - 2.0) * (d - 2.0), 1e-6);
+
+    // The particles are too far apart: the forces bring them closer, and cancel out.
+    const Vector3f r01 = particles[1].getPosition() - particles[0].getPosition();
+    EXPECT_GT(particles[0].getForce().dot(r01), 0.0f);
+    EXPECT_LT(particles[1].getForce().dot(r01), 0.0f);
+    EXPECT_NEAR((particles[0].getForce() + particles[1].getForce()).norm(), 0.0f, 1e-9f);
+    EXPECT_NEAR(particles[0].getForce().norm(), 10.0 * (d - 2.0) * forcefield::GLOBAL_SPRING_FORCE_CONVERT,
+                1e-4 * particles[0].getForce().norm());
+    EXPECT_EQ(particles[2].getForce(), Vector3f());
+
+    double derivative;
+    const cv::HarmonicWall wall(distance, 1.0, 5.0, 4.0);
+    EXPECT_EQ(wall.evaluate(3.0, derivative), 0.0);
+    EXPECT_EQ(derivative, 0.0);
+    EXPECT_DOUBLE_EQ(wall.evaluate(6.0, derivative), 2.0);
+    EXPECT_DOUBLE_EQ(derivative, 4.0);
+    EXPECT_DOUBLE_EQ(wall.evaluate(0.5, derivative), 0.5);
+    EXPECT_DOUBLE_EQ(derivative, -2.0);
+}
+
+// No force on static particles: they are never integrated nor reset.
+TEST(Colvars, static_particles_are_not_pushed)
+{
+    std::vector<spn::Particle> particles = make_particles();
+    particles[0].setStatic(true);
+    cv::Colvars colvars;
+    const cv::CollectiveVariable & distance = colvars.addVariable(std::make_unique<cv::Distance>("d", 0, 1));
+    colvars.addBias(std::make_unique<cv::Umbrella>(distance, 2.0, 10.0));
+    colvars.apply(particles, 0);
+    EXPECT_EQ(particles[0].getForce(), Vector3f());
+    EXPECT_NE(particles[1].getForce(), Vector3f());
+}
+
+TEST(Colvars, metadynamics)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    cv::Distance distance("d", 0, 1);
+
+    cv::Metadynamics::Parameters parameters;
+    parameters.height = 2.0;
+    parameters.sigma = 0.5;
+    parameters.pace = 10;
+    parameters.biasfactor = 5.0;
+    parameters.temperature = 300.0;
+    parameters.min = 0.0;
+    parameters.max = 10.0;
+    parameters.bins = 1000;
+    cv::Metadynamics metad(distance, parameters);
+
+    double derivative;
+    metad.update(3.0, 5); // not a deposition step
+    EXPECT_EQ(metad.getNumberOfHills(), 0u);
+    metad.update(3.0, 10);
+    ASSERT_EQ(metad.getNumberOfHills(), 1u);
+    EXPECT_NEAR(metad.evaluate(3.0, derivative), 2.0, 1e-6);
+    EXPECT_NEAR(derivative, 0.0, 1e-2);
+    // The bias pushes away from the hill.
+    metad.evaluate(3.5, derivative);
+    EXPECT_LT(derivative, 0.0);
+    EXPECT_NEAR(derivative, -2.0 * std::exp(-0.5) / 0.5, 1e-2);
+    EXPECT_EQ(metad.evaluate(11.0, derivative), 0.0);
+    EXPECT_EQ(derivative, 0.0);
+
+    // Well-tempered: the second hill is lower.
+    const double kT = forcefield::BOLTZMANJPERK * forcefield::AVOGADRO_NUMBER / forcefield::KJOULE_TO_JOULE * 300.0;
+    metad.deposit(3.0);
+    EXPECT_NEAR(metad.evaluate(3.0, derivative), 2.0 + 2.0 * std::exp(-2.0 / (kT * 4.0)), 1e-5);
+
+    // The free energy is the opposite of the bias, scaled by γ / (γ - 1), with a zero minimum.
+    const std::vector<double> free_energy = metad.getFreeEnergy();
+    EXPECT_NEAR(free_energy[300], 0.0, 1e-9);
+    EXPECT_NEAR(free_energy[0], 1.25 * metad.getBias()[300], 1e-6);
+
+    parameters.biasfactor = 1.0;
+    EXPECT_THROW(cv::Metadynamics(distance, parameters), std::invalid_argument);
+}
+
+TEST(Colvars, read_definitions)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    std::istringstream is("# distances\n"
+                          "cv d distance 0 1\n"
+                          "cv c centroiddistance 0-2 3,5  # two groups\n"
+                          "\n"
+                          "cv z depth 0-5\n"
+                          "cv r rmsd 1-4\n"
+                          "cv a angle 0 1 2\n"
+                          "bias umbrella d center=2.5 k=10\n"
+                          "bias wall z lower=-5 k=1\n"
+                          "bias metadynamics c sigma=0.2 min=0 max=20 bins=200 pace=50\n");
+    cv::Colvars colvars;
+    colvars.read(is, particles);
+
+    ASSERT_EQ(colvars.getVariables().size(), 5u);
+    ASSERT_EQ(colvars.getBiases().size(), 3u);
+    EXPECT_EQ(colvars.getVariable("c").getType(), "centroiddistance");
+    EXPECT_EQ(colvars.getVariable("c").getParticles(), (std::vector<size_t>{0, 1, 2, 3, 5}));
+    EXPECT_EQ(colvars.getVariable("r").getParticles(), (std::vector<size_t>{1, 2, 3, 4}));
+    EXPECT_EQ(colvars.getBiases()[2]->getType(), "metadynamics");
+    EXPECT_EQ(&colvars.getBiases()[2]->getVariable(), &colvars.getVariable("c"));
+    EXPECT_THROW(colvars.getVariable("x"), std::invalid_argument);
+}
+
+TEST(Colvars, groups_from_selections)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    const std::vector<size_t> tail = {3, 4, 5};
+    const cv::Colvars::Selections selections = [&](const std::string & name) {
+        return name == "tail" ? &tail : nullptr;
+    };
+
+    std::istringstream is("cv z depth @tail\n");
+    cv::Colvars colvars;
+    colvars.read(is, particles, selections);
+    EXPECT_EQ(colvars.getVariable("z").getParticles(), tail);
+
+    std::istringstream unknown("cv z depth @head\n");
+    EXPECT_THROW(cv::Colvars().read(unknown, particles, selections), std::runtime_error);
+}
+
+TEST(Colvars, read_errors_report_the_line)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    const std::vector<std::string> invalid = {
+        "cv d distance 0 1\ncv d distance 0 2\n", // duplicate name
+        "cv d distance 0 6\n",                    // out of range
+        "cv d distance 0\n",                      // missing argument
+        "cv d torsion 0 1 2 3\n",                 // unknown type
+        "cv d distance 0 1\nbias umbrella d k=1\n",
+        "cv d distance 0 1\nbias umbrella d center=1 k=1 x=2\n",
+        "bias umbrella d center=1 k=1\n",         // unknown variable
+        "cv c depth 3-1\n",
+        "colvar d distance 0 1\n",
+    };
+    for (const std::string & text : invalid)
+    {
+        std::istringstream is("# header\n" + text);
+        cv::Colvars colvars;
+        try
+        {
+            colvars.read(is, particles);
+            ADD_FAILURE() << "no error for: " << text;
+        }
+        catch (const std::runtime_error & e)
+        {
+            EXPECT_NE(std::string(e.what()).find("line "), std::string::npos) << e.what();
+        }
+    }
+}
+
+// colvars.enable drives the biases from the simulation loop.
+TEST(Colvars, spring_network)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "colvars-spring-network";
+    std::filesystem::create_directories(directory);
+    const std::string input = (directory / "colvars.in").string();
+    const std::string trace = (directory / "colvars.dat").string();
+    const std::string profile = (directory / "fes.dat").string();
+    std::ofstream(input) << "cv d centroiddistance 0-9 90-99\n"
+                         << "bias umbrella d center=0 k=5\n"
+                         << "bias metadynamics d sigma=0.5 min=0 max=50 bins=100 pace=2 path=" << profile << "\n";
+
+    spn::SpringNetwork spn;
+    tests::lattice_protein(100, 3).to_spring_network(spn);
+
+    configuration::Configuration config = tests::simulation_configuration(10, 5.0);
+    config.colvars.enable = true;
+    config.colvars.input = input;
+    config.colvars.path = trace;
+    config.colvars.frequency = 5;
+    spn.setup(config);
+    ASSERT_TRUE(spn.isColvarsEnabled());
+    spn.run();
+
+    EXPECT_GT(spn.getBiasEnergy(), 0.0f);
+    EXPECT_GT(spn.getColvars().getVariable("d").getValue(), 0.0);
+
+    std::vector<std::string> lines;
+    std::ifstream is(trace);
+    for (std::string line; std::getline(is, line);)
+        lines.push_back(line);
+    ASSERT_GE(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "# step d bias");
+    EXPECT_TRUE(std::filesystem::exists(profile));
+
+    config.colvars.input = (directory / "missing.in").string();
+    spn::SpringNetwork other;
+    tests::lattice_protein(100, 3).to_spring_network(other);
+    EXPECT_THROW(other.setup(config), std::runtime_error);
+
+    std::filesystem::remove_all(directory);
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "EnergyDecomposition.h"
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+
+using namespace biospring;
+
+static configuration::Configuration make_configuration()
+{
+    configuration::Configuration config = tests::simulation_configuration(1, 8.0);
+    config.setFromString("steric.mode", "lennard-jones-12-6Amber");
+    config.electrostatic.enable = true;
+    config.electrostatic.cutoff = 12.0;
+    config.hydrophobicity.enable = true;
+    config.hydrophobicity.cutoff = 8.0;
+    config.decomposition.enable = true;
+    config.decomposition.path = "";
+    config.decomposition.frequency = 0;
+    return config;
+}
+
+static void make_system(spn::SpringNetwork & spn) { tests::assembly(120, 60, 5, 4.0).to_spring_network(spn); }
+
+TEST(EnergyDecomposition, means)
+{
+    spn::EnergyDecomposition decomposition(4);
+    EXPECT_EQ(decomposition.addGroup("a", {0, 1}), 0u);
+    EXPECT_EQ(decomposition.addGroup("b", {1, 2, 3}), 1u);
+    EXPECT_THROW(decomposition.addGroup("c", {4}), std::invalid_argument);
+
+    // Static particles: only the energies added explicitly are read.
+    std::vector<spn::Particle> particles(4);
+    for (spn::Particle & p : particles)
+        p.setStatic(true);
+
+    decomposition.addEnergy(spn::EnergyDecomposition::SPRING, 1, 2.0f);
+    decomposition.addEnergy(spn::EnergyDecomposition::STERIC, 3, -1.0f);
+    decomposition.accumulate(particles);
+    decomposition.addEnergy(spn::EnergyDecomposition::SPRING, 1, 4.0f);
+    decomposition.accumulate(particles);
+
+    EXPECT_EQ(decomposition.getNumberOfSamples(), 2u);
+    EXPECT_DOUBLE_EQ(decomposition.getMean(0, spn::EnergyDecomposition::SPRING), 3.0);
+    EXPECT_DOUBLE_EQ(decomposition.getMean(1, spn::EnergyDecomposition::STERIC), -0.5);
+    EXPECT_DOUBLE_EQ(decomposition.getMeanTotal(1), 2.5);
+
+    decomposition.write(10);
+    EXPECT_EQ(decomposition.getNumberOfSamples(), 0u);
+    EXPECT_DOUBLE_EQ(decomposition.getMeanTotal(0), 0.0);
+}
+
+// Residues partition the system: their energies add up to the totals of the step.
+TEST(EnergyDecomposition, residues_sum_to_totals)
+{
+    spn::SpringNetwork spn;
+    make_system(spn);
+    spn.setup(make_configuration());
+    ASSERT_TRUE(spn.isEnergyDecompositionEnabled());
+    spn.run();
+
+    const spn::EnergyDecomposition & decomposition = spn.getEnergyDecomposition();
+    ASSERT_EQ(decomposition.getNumberOfGroups(), 120u);
+    EXPECT_EQ(decomposition.getGroupName(60).substr(0, 2), "B:");
+    ASSERT_EQ(decomposition.getNumberOfSamples(), 1u);
+    EXPECT_NE(spn.getStericEnergy(), 0.0f);
+    EXPECT_NE(spn.getElectrostaticEnergy(), 0.0f);
+    EXPECT_NE(spn.getHydrophobicEnergy(), 0.0f);
+
+    const std::pair<spn::EnergyDecomposition::Term, float> totals[] = {
+        {spn::EnergyDecomposition::SPRING, spn.getSpringEnergy()},
+        {spn::EnergyDecomposition::ELECTROSTATIC, spn.getElectrostaticEnergy()},
+        {spn::EnergyDecomposition::STERIC, spn.getStericEnergy()},
+        {spn::EnergyDecomposition::HYDROPHOBIC, spn.getHydrophobicEnergy()},
+    };
+    for (const auto & [term, total] : totals)
+    {
+        double sum = 0.0;
+        for (size_t g = 0; g < decomposition.getNumberOfGroups(); ++g)
+            sum += decomposition.getMean(g, term);
+        EXPECT_NEAR(sum, total, 1e-3 * (1.0 + std::fabs(total))) << spn::EnergyDecomposition::getTermName(term);
+    }
+}
+
+TEST(EnergyDecomposition, selections_table)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "energy-decomposition.csv";
+
+    configuration::Configuration config = make_configuration();
+    config.sim.nbsteps = 10;
+    config.setFromString("selection.first", "chain A");
+    config.setFromString("selection.interface", "chain B and within 8 of @first");
+    config.decomposition.groups = "first, interface";
+    config.decomposition.path = path.string();
+    config.decomposition.frequency = 5;
+
+    spn::SpringNetwork spn;
+    make_system(spn);
+    spn.setup(config);
+    ASSERT_EQ(spn.getEnergyDecomposition().getNumberOfGroups(), 2u);
+    spn.run();
+
+    std::vector<std::string> lines;
+    std::ifstream is(path);
+    for (std::string line; std::getline(is, line);)
+        lines.push_back(line);
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[0], "step,group,spring,electrostatic,steric,imp,hydrophobic,total");
+    EXPECT_EQ(lines[1].substr(0, 8), "5,first,");
+    EXPECT_EQ(lines[4].substr(0, 13), "10,interface,");
+    std::filesystem::remove(path);
+
+    config.decomposition.groups = "first,missing";
+    spn::SpringNetwork other;
+    make_system(other);
+    EXPECT_THROW(other.setup(config), std::runtime_error);
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+#include "cv/Bias.h"
+#include "spn/Ensemble.h"
+
+using namespace biospring;
+
+static configuration::Configuration make_configuration()
+{
+    configuration::Configuration config = tests::simulation_configuration(5, 5.0);
+    config.densitygrid.enable = true;
+    config.densitygrid.path = "data/sample.dx";
+    return config;
+}
+
+TEST(Ensemble, needs_a_replica)
+{
+    EXPECT_THROW(spn::Ensemble(tests::lattice_protein(200, 3), make_configuration(), 0), std::invalid_argument);
+}
+
+TEST(Ensemble, vary)
+{
+    spn::Ensemble ensemble(tests::lattice_protein(200, 3), make_configuration(), 3);
+    ensemble.vary("probe.x", {"0", "5", "10"});
+    ensemble.vary("steric.cutoff", {"4"});
+
+    EXPECT_FLOAT_EQ(ensemble.getConfiguration(0).probe.x, 0.0);
+    EXPECT_FLOAT_EQ(ensemble.getConfiguration(1).probe.x, 5.0);
+    EXPECT_FLOAT_EQ(ensemble.getConfiguration(2).probe.x, 10.0);
+    for (size_t i = 0; i < ensemble.size(); ++i)
+        EXPECT_FLOAT_EQ(ensemble.getConfiguration(i).steric.cutoff, 4.0);
+
+    EXPECT_THROW(ensemble.vary("probe.w", {"0"}), std::invalid_argument);
+    EXPECT_THROW(ensemble.vary("probe.x", {"0", "5"}), std::invalid_argument);
+}
+
+// Rigid bodies are shared by the whole process: replicas would move each other's bodies.
+TEST(Ensemble, rejects_rigid_bodies)
+{
+    spn::Ensemble ensemble(tests::lattice_protein(200, 3), make_configuration(), 2);
+    ensemble.vary("rigidbody.enable", {"0", "1"});
+    EXPECT_THROW(ensemble.setup(), std::runtime_error);
+}
+
+// Each replica writes its own metadynamics profile.
+TEST(Ensemble, replicas_rename_metadynamics_profiles)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "ensemble-colvars";
+    std::filesystem::create_directories(directory);
+    const std::string input = (directory / "colvars.in").string();
+    std::ofstream(input) << "cv d distance 0 199\n"
+                         << "bias metadynamics d min=0 max=50 path=" << (directory / "fes.dat").string() << "\n";
+
+    configuration::Configuration config = make_configuration();
+    config.colvars.enable = true;
+    config.colvars.input = input;
+    config.colvars.path = (directory / "colvars.dat").string();
+    spn::Ensemble ensemble(tests::lattice_protein(200, 3), config, 2);
+    ensemble.setup();
+
+    for (size_t i = 0; i < ensemble.size(); ++i)
+    {
+        const auto & bias = dynamic_cast<const cv::Metadynamics &>(*ensemble.getReplica(i).getColvars().getBiases()[0]);
+        EXPECT_EQ(bias.getParameters().path, (directory / ("fes." + std::to_string(i) + ".dat")).string());
+    }
+}
+
+TEST(Ensemble, replicas_share_grids)
+{
+    spn::Ensemble ensemble(tests::lattice_protein(200, 3), make_configuration(), 4);
+    ensemble.setup();
+
+    EXPECT_EQ(ensemble.getNumberOfGridsRead(), 1u);
+    for (size_t i = 1; i < ensemble.size(); ++i)
+        EXPECT_EQ(&ensemble.getReplica(i).getDensityGrid(), &ensemble.getReplica(0).getDensityGrid());
+}
+
+TEST(Ensemble, replicas_run_like_a_single_network)
+{
+    spn::SpringNetwork reference;
+    tests::lattice_protein(200, 3).to_spring_network(reference);
+    reference.setup(make_configuration());
+    reference.run();
+
+    spn::Ensemble ensemble(tests::lattice_protein(200, 3), make_configuration(), 3);
+    ensemble.setup();
+    ensemble.run();
+
+    for (size_t i = 0; i < ensemble.size(); ++i)
+    {
+        const spn::SpringNetwork & replica = ensemble.getReplica(i);
+        ASSERT_EQ(replica.getNumberOfParticles(), reference.getNumberOfParticles());
+        for (unsigned p = 0; p < replica.getNumberOfParticles(); ++p)
+            EXPECT_EQ(replica.getParticle(p).getPosition(), reference.getParticle(p).getPosition());
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+
+#include "InsertionVector.h"
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+#include "measure.hpp"
+
+using namespace biospring;
+
+static configuration::Configuration make_configuration()
+{
+    configuration::Configuration config = tests::simulation_configuration(20, 5.0);
+    config.probe.enable = true;
+    config.probe.enablesteric = true;
+    config.probe.x = 3.0;
+    config.ivector.enable = true;
+    config.ivector.vector = {3, 40};
+    return config;
+}
+
+static void make_network(spn::SpringNetwork & spn)
+{
+    tests::lattice_protein(100, 11).to_spring_network(spn);
+
+    // Push the system so that the centroid moves.
+    for (unsigned i = 0; i < spn.getNumberOfParticles(); ++i)
+        spn.getParticle(i).setVelocity(Vector3f(0.01f, -0.02f, 0.03f));
+}
+
+// The centroid reduced by the integration loop is the centroid of all the particles: static
+// particles and the probe included.
+TEST(InsertionVector, centroid_is_reduced_during_integration)
+{
+    spn::SpringNetwork spn;
+    make_network(spn);
+    spn.setup(make_configuration());
+    spn.updateParticleState(0, true);
+    spn.updateParticleState(1, true);
+    spn.run();
+
+    const std::array<double, 3> centroid = spn.getCentroid();
+    const std::array<double, 3> expected = measure::centroid(spn.getParticles());
+    for (size_t axis = 0; axis < 3; ++axis)
+        EXPECT_NEAR(centroid[axis], expected[axis], 1e-4);
+}
+
+// Particles moved by hand are seen once the cache is invalidated.
+TEST(InsertionVector, centroid_after_moving_particles_by_hand)
+{
+    spn::SpringNetwork spn;
+    make_network(spn);
+    spn.setup(make_configuration());
+    const double x = spn.getCentroid()[0];
+
+    for (unsigned i = 0; i < spn.getNumberOfParticles(); ++i)
+        spn.getParticle(i).setPosition(spn.getParticle(i).getPosition() + Vector3f(1.0, 0.0, 0.0));
+    spn.invalidateCentroid();
+    EXPECT_NEAR(spn.getCentroid()[0], x + 1.0, 1e-4);
+}
+
+// The insertion vector is computed when read, from the current positions.
+TEST(InsertionVector, computed_on_demand)
+{
+    spn::SpringNetwork spn;
+    make_network(spn);
+    spn.setup(make_configuration());
+    spn.run();
+
+    const InsertionVector & iv = spn.getInsertionVector();
+    InsertionVector reference(spn, spn.getParticle(3), spn.getParticle(40));
+
+    EXPECT_EQ(iv.getVector(), spn.getParticle(40).getPosition() - spn.getParticle(3).getPosition());
+    EXPECT_FLOAT_EQ(iv.getAngle(), reference.getAngle());
+    EXPECT_FLOAT_EQ(iv.getRollAngle(), reference.getRollAngle());
+    EXPECT_FLOAT_EQ(iv.getInsertionDepth(), static_cast<float>(measure::centroid(spn.getParticles())[2]));
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
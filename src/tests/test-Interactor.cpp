@@ -0,0 +1,276 @@
+
+#include <gtest/gtest.h>
+
+#include "Particle.h"
+#include "SpringNetwork.h"
+#include "configuration/Configuration.hpp"
+#include "interactor/Interactor.h"
+
+using namespace biospring;
+
+namespace
+{
+
+// Interactor without a thread: the tests play both sides.
+class DummyInteractor : public Interactor
+{
+  public:
+    using Interactor::initializeSystemState;
+
+    bool continueInteractionThread() override { return false; }
+    void stopInteractionThread() override {}
+
+  protected:
+    void setupInteraction() override {}
+    void processInteractions() override {}
+};
+
+struct TestInteractor : public ::testing::Test
+{
+    configuration::Configuration config;
+    spn::SpringNetwork spn;
+    DummyInteractor interactor;
+
+    void SetUp() override
+    {
+        ::testing::Test::SetUp();
+        config.sim.nbsteps = 1;
+        config.sim.timestep = 0.01;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            spn::Particle p;
+            p.setPosition(Vector3f(i, 2.0 * i, 3.0 * i));
+            spn.addParticle(p);
+        }
+        spn.setup(config);
+
+        interactor.setSpringNetwork(&spn);
+        interactor.initializeSystemState();
+    }
+};
+
+} // namespace
+
+TEST_F(TestInteractor, InitialStateIsPublished)
+{
+    const SystemState & state = interactor.getSystemState();
+    ASSERT_EQ(state.positions.size(), 9u);
+    EXPECT_FLOAT_EQ(state.positions[3], 1.0);
+    EXPECT_FLOAT_EQ(state.positions[4], 2.0);
+    EXPECT_FLOAT_EQ(state.positions[5], 3.0);
+
+    // Particle properties are not requested by default.
+    EXPECT_TRUE(state.forces.empty());
+    EXPECT_TRUE(state.solventAccessibilities.empty());
+}
+
+TEST_F(TestInteractor, SyncPublishesPositions)
+{
+    spn.getParticle(2).setPosition(Vector3f(7.0, 8.0, 9.0));
+    interactor.syncSystemStateData();
+
+    const SystemState & state = interactor.acquireSystemState();
+    EXPECT_FLOAT_EQ(state.positions[6], 7.0);
+    EXPECT_FLOAT_EQ(state.positions[7], 8.0);
+    EXPECT_FLOAT_EQ(state.positions[8], 9.0);
+}
+
+// Cached values are computed on the main thread and published with the positions, once requested.
+TEST_F(TestInteractor, SyncPublishesCentroidAndInsertionVector)
+{
+    spn.setInsertionVector(0, 2);
+    interactor.syncSystemStateData();
+    const SystemState & before = interactor.acquireSystemState();
+    EXPECT_FALSE(before.fields & (Interactor::STATE_CENTROID | Interactor::STATE_INSERTION_VECTOR));
+    EXPECT_EQ(before.insertionParticles[0], -1);
+
+    interactor.requestStateFields(Interactor::STATE_CENTROID | Interactor::STATE_INSERTION_VECTOR);
+    spn.getParticle(2).setPosition(Vector3f(7.0, 8.0, 9.0));
+    spn.invalidateCentroid();
+    interactor.syncSystemStateData();
+
+    const SystemState & state = interactor.acquireSystemState();
+    EXPECT_FLOAT_EQ(state.centroidZ, (0.0f + 3.0f + 9.0f) / 3.0f);
+    EXPECT_FLOAT_EQ(state.insertionDepth, state.centroidZ);
+    EXPECT_FLOAT_EQ(state.insertionAngle, spn.getInsertionVector().getAngle());
+    EXPECT_FLOAT_EQ(state.insertionRollAngle, spn.getInsertionVector().getRollAngle());
+    EXPECT_EQ(state.insertionParticles[0], 0);
+    EXPECT_EQ(state.insertionParticles[1], 2);
+}
+
+TEST_F(TestInteractor, ExternalForcesAreAppliedAtEachStep)
+{
+    const float force[3] = {1.0f, 2.0f, 3.0f};
+    ASSERT_TRUE(interactor.pushClearExternalForces());
+    ASSERT_TRUE(interactor.pushExternalForce(1, force));
+    ASSERT_TRUE(interactor.pushEndExternalForces());
+    interactor.syncSystemStateData();
+
+    ASSERT_EQ(spn.getExternalForces().size(), 1u);
+    for (int step = 0; step < 2; ++step)
+    {
+        for (unsigned i = 0; i < spn.getNumberOfParticles(); ++i)
+            spn.getParticle(i).setForce(Vector3f());
+
+        spn.computeParticleForces();
+
+        EXPECT_EQ(spn.getParticle(1).getForce(), Vector3f(1.0, 2.0, 3.0));
+        EXPECT_EQ(spn.getParticle(0).getForce(), Vector3f());
+    }
+}
+
+TEST_F(TestInteractor, ClearRemovesExternalForces)
+{
+    const float force[3] = {1.0f, 0.0f, 0.0f};
+    interactor.pushClearExternalForces();
+    interactor.pushExternalForce(0, force);
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+    ASSERT_EQ(spn.getExternalForces().size(), 1u);
+
+    interactor.pushClearExternalForces();
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+    EXPECT_TRUE(spn.getExternalForces().empty());
+}
+
+TEST_F(TestInteractor, ClearKeepsOtherExternalForces)
+{
+    // Forces set by someone else (e.g. the viewer) are not part of the interactor's frames.
+    spn.setExternalForce(2, Vector3f(0.0, 0.0, 1.0));
+
+    const float force[3] = {1.0f, 0.0f, 0.0f};
+    interactor.pushClearExternalForces();
+    interactor.pushExternalForce(0, force);
+    interactor.pushClearExternalForces();
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+
+    ASSERT_EQ(spn.getExternalForces().size(), 1u);
+    EXPECT_EQ(spn.getExternalForces()[0].particle, 2u);
+}
+
+TEST_F(TestInteractor, ClearKeepsForcesOverwrittenByOtherSources)
+{
+    const float force[3] = {1.0f, 0.0f, 0.0f};
+    interactor.pushClearExternalForces();
+    interactor.pushExternalForce(0, force);
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+
+    // The viewer takes over the particle forced by the interactor.
+    spn.setExternalForce(0, Vector3f(0.0, 0.0, 1.0));
+
+    interactor.pushClearExternalForces();
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+
+    ASSERT_EQ(spn.getExternalForces().size(), 1u);
+    EXPECT_EQ(spn.getExternalForces()[0].force, Vector3f(0.0, 0.0, 1.0));
+}
+
+TEST_F(TestInteractor, IncompleteFrameIsNotApplied)
+{
+    const float first[3] = {1.0f, 0.0f, 0.0f};
+    const float second[3] = {0.0f, 1.0f, 0.0f};
+    interactor.pushClearExternalForces();
+    interactor.pushExternalForce(0, first);
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+
+    // The interactor thread is halfway through the next frame.
+    interactor.pushClearExternalForces();
+    interactor.pushExternalForce(1, second);
+    interactor.syncSystemStateData();
+
+    ASSERT_EQ(spn.getExternalForces().size(), 1u);
+    EXPECT_EQ(spn.getExternalForces()[0].particle, 0u);
+
+    interactor.pushExternalForce(2, second);
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+
+    ASSERT_EQ(spn.getExternalForces().size(), 2u);
+    EXPECT_EQ(spn.getExternalForces()[0].particle, 1u);
+    EXPECT_EQ(spn.getExternalForces()[1].particle, 2u);
+}
+
+TEST_F(TestInteractor, LastForceOfAFrameWins)
+{
+    const float first[3] = {1.0f, 0.0f, 0.0f};
+    const float second[3] = {0.0f, 1.0f, 0.0f};
+    interactor.pushClearExternalForces();
+    interactor.pushExternalForce(0, first);
+    interactor.pushExternalForce(0, second);
+    interactor.pushEndExternalForces();
+    interactor.syncSystemStateData();
+
+    ASSERT_EQ(spn.getExternalForces().size(), 1u);
+    EXPECT_EQ(spn.getExternalForces()[0].force, Vector3f(0.0, 1.0, 0.0));
+}
+
+TEST_F(TestInteractor, ForceOnUnknownParticleIsIgnored)
+{
+    const float force[3] = {1.0f, 0.0f, 0.0f};
+    interactor.pushClearExternalForces();
+    interactor.pushExternalForce(42, force);
+    interactor.pushEndExternalForces();
+    EXPECT_NO_THROW(interactor.syncSystemStateData());
+    EXPECT_TRUE(spn.getExternalForces().empty());
+}
+
+// -- SpringNetwork external forces ---------------------------------------------
+
+TEST_F(TestInteractor, ExternalForceExpires)
+{
+    // getNbIterations() is 0: the force is applied at steps 0 and 1 only.
+    spn.setExternalForce(0, Vector3f(1.0, 0.0, 0.0), 1);
+
+    spn.computeParticleForces();
+    EXPECT_EQ(spn.getParticle(0).getForce(), Vector3f(1.0, 0.0, 0.0));
+
+    spn.idleRun(); // step 1
+    spn.getParticle(0).setForce(Vector3f());
+    spn.computeParticleForces();
+    EXPECT_EQ(spn.getParticle(0).getForce(), Vector3f(1.0, 0.0, 0.0));
+
+    spn.idleRun(); // step 2
+    spn.getParticle(0).setForce(Vector3f());
+    spn.computeParticleForces();
+    EXPECT_EQ(spn.getParticle(0).getForce(), Vector3f());
+    EXPECT_TRUE(spn.getExternalForces().empty());
+}
+
+TEST_F(TestInteractor, SetExternalForceReplacesPreviousOne)
+{
+    spn.setExternalForce(1, Vector3f(1.0, 0.0, 0.0));
+    spn.setExternalForce(1, Vector3f(0.0, 2.0, 0.0));
+
+    ASSERT_EQ(spn.getExternalForces().size(), 1u);
+    spn.computeParticleForces();
+    EXPECT_EQ(spn.getParticle(1).getForce(), Vector3f(0.0, 2.0, 0.0));
+}
+
+TEST_F(TestInteractor, RemoveExternalForce)
+{
+    spn.setExternalForce(0, Vector3f(1.0, 0.0, 0.0));
+    spn.setExternalForce(1, Vector3f(0.0, 1.0, 0.0));
+    spn.setExternalForce(2, Vector3f(0.0, 0.0, 1.0));
+
+    spn.removeExternalForce(0);
+    spn.removeExternalForce(0); // no-op
+
+    spn.computeParticleForces();
+    EXPECT_EQ(spn.getParticle(0).getForce(), Vector3f());
+    EXPECT_EQ(spn.getParticle(1).getForce(), Vector3f(0.0, 1.0, 0.0));
+    EXPECT_EQ(spn.getParticle(2).getForce(), Vector3f(0.0, 0.0, 1.0));
+
+    spn.clearExternalForces();
+    EXPECT_TRUE(spn.getExternalForces().empty());
+}
+
+TEST_F(TestInteractor, SetExternalForceOnInvalidParticleDies)
+{
+    EXPECT_DEATH(spn.setExternalForce(3, Vector3f()), "!! ERROR: setExternalForce: invalid particle index 3");
+}
@@ -48,8 +48,13 @@ struct TestNetCDFRoundTrip : public ::testing::Test
             p.setHydrophobicity(HYDROPHOBICITY);
             p.setTransferEnergyByAccessibleSurface(TRANSFER_ENERGY);
             p.setSolventAccessibilitySurface(ACCESSIBLE_SURFACE);
+            p.setName("CA");
+            p.setResName("ALA");
+            p.setChainName("B");
+            p.setExtid(static_cast<unsigned>(10 + i));
             spn.addParticle(p);
         }
+        spn.addSpring(0, 1, 1.25f, 2.0f);
         spn.setup(config);
 
         NetCDFWriter writer(path, &spn);
@@ -88,3 +93,40 @@ TEST_F(TestNetCDFRoundTrip, ThePerParticleFloatsAreNotSwapped)
     EXPECT_FLOAT_EQ(properties.imp().transfert_energy_by_accessible_surface(), TRANSFER_ENERGY);
     EXPECT_FLOAT_EQ(properties.imp().solvent_accessible_surface(), ACCESSIBLE_SURFACE);
 }
+
+// The simulation engine loads the .nc straight into a SpringNetwork. It must end
+// up with the same network as the Topology path used by the other tools.
+TEST_F(TestNetCDFRoundTrip, DirectLoadMatchesTopologyPath)
+{
+    NetCDFReader topologyreader(path);
+    topologyreader.read();
+    spn::SpringNetwork expected;
+    topologyreader.getTopology().to_spring_network(expected);
+
+    NetCDFReader directreader(path);
+    spn::SpringNetwork actual;
+    directreader.readSpringNetwork(actual);
+
+    ASSERT_EQ(actual.getNumberOfParticles(), expected.getNumberOfParticles());
+    ASSERT_EQ(actual.getNumberOfSprings(), expected.getNumberOfSprings());
+    for (unsigned i = 0; i < actual.getNumberOfParticles(); ++i)
+    {
+        const spn::Particle & a = actual.getParticle(i);
+        const spn::Particle & e = expected.getParticle(i);
+        EXPECT_EQ(a.getName(), e.getName());
+        EXPECT_EQ(a.getResName(), e.getResName());
+        EXPECT_EQ(a.getChainName(), e.getChainName());
+        EXPECT_EQ(a.getExtid(), e.getExtid());
+        EXPECT_EQ(a.getPosition(), e.getPosition());
+        EXPECT_FLOAT_EQ(a.getMass(), e.getMass());
+        EXPECT_FLOAT_EQ(a.getRadius(), e.getRadius());
+        EXPECT_FLOAT_EQ(a.getHydrophobicity(), e.getHydrophobicity());
+        EXPECT_FLOAT_EQ(a.getTransferEnergyByAccessibleSurface(), e.getTransferEnergyByAccessibleSurface());
+        EXPECT_FLOAT_EQ(a.getSolventAccessibilitySurface(), e.getSolventAccessibilitySurface());
+        EXPECT_EQ(a.isDynamic(), e.isDynamic());
+        EXPECT_EQ(a.getNumberOfSprings(), e.getNumberOfSprings());
+    }
+    EXPECT_EQ(actual.getParticle(0).getName(), "CA");
+    EXPECT_FLOAT_EQ(actual.getSpring(0).getEquilibrium(), 1.25f);
+    EXPECT_FLOAT_EQ(actual.getSpring(0).getStiffness(), 2.0f);
+}
@@ -1,11 +1,13 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <string>
 
 #include "IO/PDBReader.h"
+#include "utils/string.hpp"
 #include "topology/Topology.hpp"
 
 using namespace biospring;
@@ -94,3 +96,74 @@ TEST(TestPDBReader, ValidConectRecordsStillCreateSprings)
     EXPECT_EQ(reader.getTopology().number_of_particles(), 3u);
     EXPECT_EQ(reader.getTopology().number_of_springs(), 2u);
 }
+
+// Fixed columns are parsed from views on the line: trimmed text fields, optional
+// trailing columns defaulted when absent, numbers with a leading sign.
+TEST(TestPDBReader, ParseAtomRecordReadsFixedColumns)
+{
+    PDBReader::AtomRecord record;
+    const std::string line = "HETATM  123 CA   ALA B  -7      -1.500  +2.250 100.125  0.50 12.34           C1+";
+    ASSERT_TRUE(PDBReader::parseAtomRecord(line, record));
+
+    EXPECT_EQ(record.atom_id, 123);
+    EXPECT_EQ(record.name, "CA");
+    EXPECT_EQ(record.residue_name, "ALA");
+    EXPECT_EQ(record.chain_name, "B");
+    EXPECT_EQ(record.residue_id, -7);
+    EXPECT_FLOAT_EQ(record.x, -1.5f);
+    EXPECT_FLOAT_EQ(record.y, 2.25f);
+    EXPECT_FLOAT_EQ(record.z, 100.125f);
+    EXPECT_FLOAT_EQ(record.occupancy, 0.5f);
+    EXPECT_FLOAT_EQ(record.temperature_factor, 12.34f);
+    EXPECT_EQ(record.element_name, "C");
+    EXPECT_FLOAT_EQ(record.charge, 1.0f);
+
+    // xyz-only record: trailing columns take their default values.
+    const std::string shortline = "ATOM      1  P    DA A   1       1.000   2.000   3.0";
+    ASSERT_TRUE(PDBReader::parseAtomRecord(shortline, record));
+    EXPECT_FLOAT_EQ(record.z, 3.0f);
+    EXPECT_FLOAT_EQ(record.occupancy, 1.0f);
+    EXPECT_FLOAT_EQ(record.temperature_factor, 0.0f);
+    EXPECT_TRUE(record.element_name.empty());
+
+    EXPECT_FALSE(PDBReader::parseAtomRecord("ATOM      1  N   ALA A   1", record));
+    EXPECT_FALSE(PDBReader::parseAtomRecord("ATOM      1  N   ALA A   1         abc   0.000   0.000", record));
+}
+
+// The whole-file reader must yield the same particles, in file order, as the
+// line parser, whatever the line endings.
+TEST(TestPDBReader, ReadMatchesParseAtomLine)
+{
+    std::string content;
+    for (int i = 1; i <= 1000; ++i)
+    {
+        char line[82];
+        std::snprintf(line, sizeof(line), "ATOM  %5d  CA  GLY A%4d    %8.3f%8.3f%8.3f  1.00  0.00           C\r\n", i, i,
+                      0.1 * i, -0.2 * i, 0.3 * i);
+        content += line;
+    }
+    content += "CONECT    1    2    1\r\nCONECT    2    1\r\nEND\r\n";
+    const std::string path = write_temp_pdb("read-crlf.pdb", content);
+
+    PDBReader reader(path);
+    reader.read();
+
+    const auto & topology = reader.getTopology();
+    ASSERT_EQ(topology.number_of_particles(), 1000u);
+    // 1-2 is listed twice and 1-1 is no bond.
+    EXPECT_EQ(topology.number_of_springs(), 1u);
+
+    size_t i = 0;
+    for (const std::string & line : utils::string::split(content, "\r\n"))
+    {
+        if (!PDBReader::isAtomLine(line))
+            continue;
+        const topology::Particle expected = PDBReader::parseAtomLine(line);
+        const topology::Particle & actual = topology.get_particle(i++);
+        EXPECT_EQ(actual.properties().atom_id(), expected.properties().atom_id());
+        EXPECT_EQ(actual.properties().name(), "CA");
+        EXPECT_EQ(actual.properties().element_name(), "C");
+        EXPECT_EQ(actual.position(), expected.position());
+    }
+    EXPECT_EQ(reader.getIdFromExtid(500), 499);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+#include "measure.hpp"
+
+using namespace biospring;
+
+static configuration::Configuration make_configuration()
+{
+    configuration::Configuration config = tests::simulation_configuration(1, 6.0);
+    config.setFromString("steric.mode", "lennard-jones-12-6Amber");
+    config.probe.enable = true;
+    config.probe.enablesteric = true;
+    config.probe.radius = 3.0;
+    config.probe.epsilon = 1.0;
+    return config;
+}
+
+static void make_network(spn::SpringNetwork & spn) { tests::lattice_protein(300, 8).to_spring_network(spn); }
+
+// Steric energy between the probe and the dynamic particles closer than `cutoff`.
+static double probe_steric_energy(const spn::SpringNetwork & spn, double cutoff)
+{
+    const spn::Particle & probe = spn.getProbeParticle();
+    const forcefield::ForceField * ff = spn.getForceField();
+    double energy = 0.0;
+    for (const unsigned id : spn.getDynamicParticles())
+    {
+        const spn::Particle & p = spn.getParticle(id);
+        const float distance = static_cast<float>(measure::distance(probe, p));
+        if (distance < cutoff)
+            energy += ff->computeStericEnergy(probe.getRadius(), p.getRadius(), probe.getEpsilon(), p.getEpsilon(),
+                                              distance);
+    }
+    return energy;
+}
+
+// The probe, placed next to a particle, interacts with the particles found by the steric cell list.
+TEST(Probe, steric_through_cell_list)
+{
+    spn::SpringNetwork reference;
+    make_network(reference);
+    configuration::Configuration config = make_configuration();
+    const Vector3f & site = reference.getParticle(150).getPosition();
+    config.probe.x = site.getX() + 1.0f;
+    config.probe.y = site.getY();
+    config.probe.z = site.getZ();
+
+    spn::SpringNetwork spn;
+    make_network(spn);
+    spn.setup(config);
+    const double expected = probe_steric_energy(spn, config.steric.cutoff);
+    const double all = probe_steric_energy(spn, 1e9);
+    spn.computeParticleForces();
+
+    ASSERT_NE(expected, 0.0);
+    EXPECT_NEAR(spn.getProbeParticle().getStericEnergy(), 0.5 * expected, 1e-4 * (1.0 + std::fabs(expected)));
+    EXPECT_NE(spn.getProbeParticle().getForce().norm(), 0.0f);
+    EXPECT_NE(expected, all); // the cutoff leaves particles out
+
+    // Without a steric cell list, every dynamic particle interacts with the probe.
+    config.steric.enable = false;
+    spn::SpringNetwork sweep;
+    make_network(sweep);
+    sweep.setup(config);
+    sweep.computeParticleForces();
+
+    EXPECT_NEAR(sweep.getProbeParticle().getStericEnergy(), 0.5 * all, 1e-4 * (1.0 + std::fabs(all)));
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Particle.h"
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+#include "forcefield/ForceFieldElectrostaticCoulombAndStericLinear.h"
+#include "rigidbody/ReceptorGrid.h"
+#include "rigidbody/RigidBodiesManager.h"
+
+using namespace biospring;
+
+static std::vector<spn::Particle> make_receptor()
+{
+    std::vector<spn::Particle> particles(3);
+    particles[0].setPosition(Vector3f(0.0, 0.0, 0.0));
+    particles[1].setPosition(Vector3f(3.0, 0.0, 0.0));
+    particles[2].setPosition(Vector3f(0.0, 4.0, 1.0));
+    for (size_t i = 0; i < particles.size(); ++i)
+    {
+        particles[i].setRadius(1.5);
+        particles[i].setEpsilon(0.5);
+        particles[i].setCharge(i == 1 ? -1.0f : 1.0f);
+    }
+    return particles;
+}
+
+static configuration::Configuration make_docking_configuration()
+{
+    configuration::Configuration config = tests::simulation_configuration(5, 12.0);
+    config.electrostatic.enable = true;
+    config.electrostatic.cutoff = 12.0;
+    config.rigidbody.enable = true;
+    config.rigidbody.splitchains = true;
+    config.rigidbody.receptor = "A";
+    return config;
+}
+
+// RigidBodiesManager keeps its bodies in a static member: the network is held by the fixture,
+// so that the bodies are cleaned before it is destroyed.
+struct TestReceptorGrid : public ::testing::Test
+{
+    spn::SpringNetwork spn;
+
+    void SetUp() override { rigidbody::RigidBodiesManager::CleanRigidBodies(); }
+    void TearDown() override { rigidbody::RigidBodiesManager::CleanRigidBodies(); }
+};
+
+// Each cell holds the sum of the pair interactions at its centre.
+TEST(ReceptorGrid, cells_hold_the_interactions_at_their_centre)
+{
+    const std::vector<spn::Particle> particles = make_receptor();
+    const forcefield::ForceFieldElectrostaticCoulombAndStericLinear ff;
+    spn::Particle probe;
+    probe.setRadius(2.0);
+    probe.setEpsilon(1.0);
+
+    const auto steric = rigidbody::computeStericReceptorGrid(particles, {0, 1, 2}, ff, probe, 5.0, 0.5);
+    const auto electrostatic = rigidbody::computeElectrostaticReceptorGrid(particles, {0, 1, 2}, ff, 8.0, 0.5);
+
+    const grid::discrete_coordinates cell = steric->cell_coordinates(grid::real_coordinates(1.2, 1.7, 0.3));
+    const Vector3f centre(static_cast<float>(steric->origin()[0] + (cell.x + 0.5) * 0.5),
+                          static_cast<float>(steric->origin()[1] + (cell.y + 0.5) * 0.5),
+                          static_cast<float>(steric->origin()[2] + (cell.z + 0.5) * 0.5));
+
+    float energy = 0.0f;
+    Vector3f force;
+    for (const spn::Particle & p : particles)
+    {
+        Vector3f direction = p.getPosition() - centre;
+        const float distance = direction.norm();
+        direction.normalize();
+        energy += ff.computeStericEnergy(p.getRadius(), 2.0, p.getEpsilon(), 1.0, distance);
+        force += direction * ff.computeStericForceModule(p.getRadius(), 2.0, p.getEpsilon(), 1.0, distance);
+    }
+    EXPECT_NEAR(steric->at(cell).scalar, energy, 1e-4);
+    EXPECT_NEAR(steric->at(cell).vector.getX(), force.getX(), 1e-4);
+    EXPECT_NEAR(steric->at(cell).vector.getY(), force.getY(), 1e-4);
+    EXPECT_NEAR(steric->at(cell).vector.getZ(), force.getZ(), 1e-4);
+    EXPECT_NE(steric->at(cell).scalar, 0.0f);
+
+    // The grids cover the receptor and its cutoff.
+    EXPECT_FALSE(steric->is_out_of_grid(grid::real_coordinates(-4.9, 0.0, 0.0)));
+    EXPECT_TRUE(steric->is_out_of_grid(grid::real_coordinates(-5.6, 0.0, 0.0)));
+    EXPECT_FALSE(electrostatic->is_out_of_grid(grid::real_coordinates(-7.9, 0.0, 0.0)));
+}
+
+TEST(ReceptorGrid, invalid_arguments)
+{
+    const std::vector<spn::Particle> particles = make_receptor();
+    const forcefield::ForceFieldElectrostaticCoulombAndStericLinear ff;
+    EXPECT_THROW(rigidbody::computeElectrostaticReceptorGrid(particles, {}, ff, 8.0, 1.0), std::invalid_argument);
+    EXPECT_THROW(rigidbody::computeElectrostaticReceptorGrid(particles, {0}, ff, 8.0, 0.0), std::invalid_argument);
+}
+
+// The receptor chain is frozen and left out of the pair searches, and the other chains
+// become one rigid body each.
+TEST_F(TestReceptorGrid, docking)
+{
+    tests::assembly(150, 50, 7).to_spring_network(spn);
+    spn.setup(make_docking_configuration());
+
+    ASSERT_EQ(spn.getReceptorParticles().size(), 50u);
+    ASSERT_NE(spn.getReceptorStericGrid(), nullptr);
+    ASSERT_NE(spn.getReceptorElectrostaticGrid(), nullptr);
+    EXPECT_EQ(spn.getDynamicParticles().size(), 100u);
+    for (const unsigned id : spn.getReceptorParticles())
+    {
+        EXPECT_EQ(spn.getParticle(id).getChainName(), "A");
+        EXPECT_TRUE(spn.getParticle(id).isStatic());
+    }
+    for (const unsigned id : spn.getDynamicParticles())
+        for (const size_t neighbor : spn.getNeighborSearch().steric->get_neighbors(id))
+            EXPECT_FALSE(spn.isReceptorParticle(neighbor));
+
+    std::vector<Vector3f> receptor;
+    for (const unsigned id : spn.getReceptorParticles())
+        receptor.push_back(spn.getParticle(id).getPosition());
+
+    spn.run();
+
+    EXPECT_EQ(rigidbody::RigidBodiesManager::getCollection().size(), 2u);
+    for (size_t i = 0; i < receptor.size(); ++i)
+        EXPECT_EQ(spn.getParticle(spn.getReceptorParticles()[i]).getPosition(), receptor[i]);
+}
+
+// A ligand alone in its chain has no pair neighbor: its nonbonded force is the receptor grid force.
+TEST_F(TestReceptorGrid, ligand_receives_grid_forces)
+{
+    for (spn::Particle & p : make_receptor())
+    {
+        p.setChainName("A");
+        spn.addParticle(p);
+    }
+    spn::Particle ligand;
+    ligand.setChainName("B");
+    ligand.setPosition(Vector3f(1.0, 1.5, 3.5));
+    ligand.setRadius(1.5);
+    ligand.setEpsilon(0.5);
+    ligand.setCharge(1.0);
+    spn.addParticle(ligand);
+
+    configuration::Configuration config = make_docking_configuration();
+    config.spring.enable = false;
+    spn.setup(config);
+    ASSERT_EQ(spn.getDynamicParticles(), (std::vector<unsigned>{3}));
+
+    spn.computeParticleForces();
+
+    const Vector3f position = spn.getParticle(3).getPosition();
+    const auto & steric = spn.getReceptorStericGrid()->get(position.getX(), position.getY(), position.getZ());
+    const auto & electrostatic =
+        spn.getReceptorElectrostaticGrid()->get(position.getX(), position.getY(), position.getZ());
+    const Vector3f expected = steric.vector + electrostatic.vector * 1.0f;
+    const Vector3f force = spn.getParticle(3).getForce();
+    ASSERT_GT(expected.norm(), 0.0f);
+    EXPECT_FLOAT_EQ(force.getX(), expected.getX());
+    EXPECT_FLOAT_EQ(force.getY(), expected.getY());
+    EXPECT_FLOAT_EQ(force.getZ(), expected.getZ());
+    EXPECT_FLOAT_EQ(spn.getStericEnergy(), steric.scalar);
+}
+
+TEST_F(TestReceptorGrid, docking_needs_rigid_body_dynamics)
+{
+    configuration::Configuration config = make_docking_configuration();
+    config.rigidbody.enablemontecarlo = true;
+    tests::assembly(150, 50, 7).to_spring_network(spn);
+    EXPECT_THROW(spn.setup(config), std::runtime_error);
+
+    config = make_docking_configuration();
+    config.rigidbody.receptor = "Z";
+    spn::SpringNetwork other;
+    tests::assembly(150, 50, 7).to_spring_network(other);
+    EXPECT_THROW(other.setup(config), std::runtime_error);
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
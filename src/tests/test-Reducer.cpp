@@ -4,6 +4,7 @@
 #include <string>
 
 #include "IO/io.h"
+#include "measure.hpp"
 #include "reduce/Reducer.h"
 #include "topology.hpp"
 
@@ -62,6 +63,38 @@ TEST_F(TestReducer, reduce_ignore_missing)
     EXPECT_EQ(reducer.target_topology().number_of_particles(), 183);
 }
 
+// Grains come out in input residue order, and each is placed at the centroid of
+// the atoms its rule names.
+TEST_F(TestReducer, reduce_grains_in_residue_order)
+{
+    biospring::reduce::Reducer reducer(topology);
+    reducer.initialize_forcefield(path_forcefield);
+    reducer.initialize_rules(path_reduce_rules);
+    reducer.reduce();
+
+    const auto & grains = reducer.target_topology().particles();
+    ASSERT_EQ(grains.size(), 183);
+    for (size_t i = 1; i < grains.size(); ++i)
+    {
+        if (grains[i].properties().chain_name() == grains[i - 1].properties().chain_name())
+        {
+            EXPECT_GE(grains[i].properties().residue_id(), grains[i - 1].properties().residue_id());
+        }
+    }
+
+    // Recomputes the first grain from the source topology.
+    const auto & first = grains[0].properties();
+    const auto rules = reducer.rules().get_rules_for_residue(first.residue_name());
+    const auto & rule = rules[first.name()];
+    std::vector<biospring::topology::Particle> members;
+    for (const auto & p : topology.particles())
+        if (p.properties().residue_id() == first.residue_id() && p.properties().chain_name() == first.chain_name() &&
+            rule.hasAtomNamed(p.properties().name()))
+            members.push_back(p);
+    ASSERT_EQ(members.size(), rule.number_of_atoms());
+    EXPECT_EQ(first.position(), Vector3f(biospring::measure::centroid(members)));
+}
+
 // ===========================================================================
 // Basic tests
 // ===========================================================================
@@ -13,8 +13,8 @@ namespace
 
 // RigidBodiesManager keeps its collection in a static member, so it outlives any
 // single test; clear it on both ends to keep cases independent. Note
-// getCollection() hands back a copy of the pointer vector, so it can only be
-// used to observe, never to mutate.
+// getCollection() hands back a const reference to the pointer vector, so it can
+// only be used to observe, never to mutate.
 struct TestRigidBodiesManager : public ::testing::Test
 {
     configuration::Configuration config;
@@ -81,3 +81,50 @@ TEST_F(TestRigidBodiesManager, EmptyRequestClearsTheCollection)
     rigidbody::RigidBodiesManager::InitRigidBodies(&spn, {});
     EXPECT_EQ(rigidbody::RigidBodiesManager::getCollection().size(), 0u);
 }
+
+// The cell-list restraint must find the same pairs as the all-pairs loop it
+// replaces: every hydrophilic member of one body against those of the others,
+// never against its own body, with opposite forces on the two bodies.
+TEST_F(TestRigidBodiesManager, HydrophobicRestraintPairsOtherBodies)
+{
+    const Vector3f positions[] = {{0.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {2.0, 0.0, 0.0}, {2.0, 1.0, 1.0}};
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        spn::Particle & p = spn.getParticle(i);
+        p.setPosition(positions[i]);
+        p.setTransferEnergyByAccessibleSurface(0.01f * static_cast<float>(i + 1));
+        p.setSolventAccessibilitySurface(20.0f + static_cast<float>(i));
+    }
+    rigidbody::RigidBodiesManager::InitRigidBodies(&spn, {0, 1});
+    rigidbody::RigidBodiesManager::InitRigidBodies(&spn, {2, 3});
+    const auto & bodies = rigidbody::RigidBodiesManager::getCollection();
+    ASSERT_EQ(bodies.size(), 2u);
+
+    const double scale = 10.0;
+    rigidbody::RigidBodiesManager::ApplyHydrophobicRestraints(spn, scale);
+
+    // All-pairs reference for the first body.
+    Vector3f force, torque;
+    for (unsigned i : {0u, 1u})
+    {
+        for (unsigned j : {2u, 3u})
+        {
+            const spn::Particle & pi = spn.getParticle(i);
+            const spn::Particle & pj = spn.getParticle(j);
+            Vector3f f = pi.getPosition() - pj.getPosition();
+            f = f * (pi.getSolventAccessibilitySurface() * pi.getTransferEnergyByAccessibleSurface() *
+                     pj.getSolventAccessibilitySurface() * pj.getTransferEnergyByAccessibleSurface() *
+                     std::exp(-f.norm()) * scale);
+            force += f;
+            torque += (pi.getPosition() - bodies[0]->getPos()) ^ f;
+        }
+    }
+
+    for (int k = 0; k < 3; ++k)
+    {
+        EXPECT_NEAR(bodies[0]->getForce()[k], force[k], 1e-4);
+        EXPECT_NEAR(bodies[1]->getForce()[k], -force[k], 1e-4);
+        EXPECT_NEAR(bodies[0]->getTorque()[k], torque[k], 1e-4);
+    }
+    EXPECT_GT(force.norm(), 0.0);
+}
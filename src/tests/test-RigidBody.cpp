@@ -73,3 +73,81 @@ TEST_F(TestRigidBody, LocalIndexIsRelativeToTheBodyNotTheNetwork)
     EXPECT_EQ(body.localIndexOf(spn.getParticle(1)), 0u);
     EXPECT_EQ(body.localIndexOf(spn.getParticle(2)), 1u);
 }
+
+// Force and torque of a body are the sums over its members, torques taken
+// about the center of mass.
+TEST_F(TestRigidBody, ForceAndTorqueAreReducedOverTheMembers)
+{
+    rigidbody::RigidBody body(&spn, 0, {0, 1, 2});
+    spn.getParticle(0).setForce(Vector3f(0.0, 1.0, 0.0));
+    spn.getParticle(2).setForce(Vector3f(0.0, 2.0, 3.0));
+
+    body.accumulateForceAndTorque();
+
+    // Center of mass at x = 1: arms of -1 and +1 along x.
+    EXPECT_FLOAT_EQ(body.getForce().getX(), 0.0);
+    EXPECT_FLOAT_EQ(body.getForce().getY(), 3.0);
+    EXPECT_FLOAT_EQ(body.getForce().getZ(), 3.0);
+    EXPECT_FLOAT_EQ(body.getTorque().getX(), 0.0);
+    EXPECT_FLOAT_EQ(body.getTorque().getY(), -3.0);
+    EXPECT_FLOAT_EQ(body.getTorque().getZ(), 1.0);
+}
+
+// The batched transform must place the members where the quaternion rotation
+// of their local positions puts them.
+TEST_F(TestRigidBody, MembersFollowTheOrientation)
+{
+    rigidbody::RigidBody body(&spn, 0, {0, 1, 2});
+    body.external_force = Vector3f(0.5, 0.0, 0.0);
+    body.external_torque = Vector3f(0.0, 0.0, 4000.0);
+    body.solve();
+    body.updateMemberPositions(config.sim.timestep);
+
+    const rigidbody::Quaternion q = body.getOrientation();
+    ASSERT_GT(std::abs(q.getZ()), 1e-3) << "the body must have rotated";
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const Vector3f local = Vector3f(static_cast<float>(i), 0.0, 0.0) - Vector3f(1.0, 0.0, 0.0);
+        const Vector3f expected = body.getPos() + (q * rigidbody::Quaternion(local, 0.0) * q.inverse()).getV();
+        const spn::Particle & p = spn.getParticle(i);
+        EXPECT_NEAR(p.getPosition().getX(), expected.getX(), 1e-5);
+        EXPECT_NEAR(p.getPosition().getY(), expected.getY(), 1e-5);
+        EXPECT_NEAR(p.getPosition().getZ(), expected.getZ(), 1e-5);
+
+        const Vector3f velocity = (p.getPosition() - p.getPreviousPosition()) / config.sim.timestep;
+        EXPECT_NEAR(p.getVelocity().getX(), velocity.getX(), 1e-3);
+        EXPECT_NEAR(p.getVelocity().getY(), velocity.getY(), 1e-3);
+    }
+}
+
+// Springs between two members of a body keep their length: they leave the
+// force loop. A spring to a particle outside the body stays.
+TEST(RigidBodySprings, InternalSpringsAreStatic)
+{
+    configuration::Configuration config;
+    config.sim.nbsteps = 1;
+    config.sim.timestep = 0.01;
+
+    spn::SpringNetwork spn;
+    for (int i = 0; i < 4; ++i)
+    {
+        spn::Particle p;
+        p.setPosition(Vector3f(static_cast<float>(i), 0.0, 0.0));
+        p.setMass(12.0);
+        spn.addParticle(p);
+    }
+    spn.addSpring(0, 1, 1.0, 1.0);
+    spn.addSpring(1, 2, 1.0, 1.0);
+    spn.addSpring(2, 3, 1.0, 1.0);
+    spn.setup(config);
+
+    {
+        rigidbody::RigidBody body(&spn, 0, {0, 1, 2});
+        EXPECT_EQ(spn.getDynamicSprings(), std::vector<unsigned>({2}));
+        EXPECT_EQ(spn.getStaticSprings(), std::vector<unsigned>({0, 1}));
+
+        body.UpdateSpringsState(false);
+    }
+    EXPECT_EQ(spn.getDynamicSprings(), std::vector<unsigned>({2, 0, 1}));
+    EXPECT_TRUE(spn.getStaticSprings().empty());
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Selection.h"
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+#include "selection/Expression.h"
+#include "selection/Labels.h"
+
+using namespace biospring;
+
+// Two chains of 5 residues, one particle per residue, along x (1 Å apart).
+// Chain B is shifted by 10 Å along y.
+static std::vector<spn::Particle> make_particles()
+{
+    std::vector<spn::Particle> particles(10);
+    for (size_t i = 0; i < particles.size(); ++i)
+    {
+        spn::Particle & p = particles[i];
+        const bool b = i >= 5;
+        p.setChainName(b ? "B" : "A");
+        p.setResId(static_cast<unsigned>(i % 5 + 1));
+        p.setResName(i % 2 ? "ALA" : "LEU");
+        p.setName(i % 5 == 0 ? "N" : "CA");
+        p.setElementName(i % 5 == 0 ? "N" : "C");
+        p.setPosition(Vector3f(static_cast<float>(i % 5), b ? 10.0f : 0.0f, static_cast<float>(i) * 0.1f));
+    }
+    return particles;
+}
+
+static std::vector<size_t> select(const std::string & text, const std::vector<spn::Particle> & particles)
+{
+    return selection::Expression(text).evaluate(particles, selection::Labels(particles));
+}
+
+TEST(Selection, labels)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    const selection::Labels labels(particles);
+    ASSERT_EQ(labels.size(), 10u);
+    EXPECT_EQ(labels.chain[0], labels.lookup("A"));
+    EXPECT_EQ(labels.chain[7], labels.lookup("B"));
+    EXPECT_EQ(labels.resid[7], 3);
+    EXPECT_EQ(labels.lookup("Z"), selection::Labels::npos);
+}
+
+TEST(Selection, keywords)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    using indexes = std::vector<size_t>;
+
+    EXPECT_EQ(select("all", particles).size(), 10u);
+    EXPECT_TRUE(select("none", particles).empty());
+    EXPECT_EQ(select("chain B", particles), (indexes{5, 6, 7, 8, 9}));
+    EXPECT_EQ(select("chain A B", particles).size(), 10u);
+    EXPECT_TRUE(select("chain Z", particles).empty());
+    EXPECT_EQ(select("name N", particles), (indexes{0, 5}));
+    EXPECT_EQ(select("resname ALA", particles), (indexes{1, 3, 5, 7, 9}));
+    EXPECT_EQ(select("element N", particles), (indexes{0, 5}));
+    EXPECT_EQ(select("resid 2-3 5", particles), (indexes{1, 2, 4, 6, 7, 9}));
+    EXPECT_EQ(select("resid 2:3", particles), (indexes{1, 2, 6, 7}));
+    EXPECT_EQ(select("index 0 8-20", particles), (indexes{0, 8, 9}));
+    EXPECT_EQ(select("x >= 3", particles), (indexes{3, 4, 8, 9}));
+    EXPECT_EQ(select("z<0.2", particles), (indexes{0, 1}));
+}
+
+TEST(Selection, operators)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    using indexes = std::vector<size_t>;
+
+    EXPECT_EQ(select("chain A and resid 2-4 and name CA", particles), (indexes{1, 2, 3}));
+    EXPECT_EQ(select("chain A and not name CA", particles), (indexes{0}));
+    EXPECT_EQ(select("name N or resid 5", particles), (indexes{0, 4, 5, 9}));
+    // "and" binds tighter than "or".
+    EXPECT_EQ(select("name N or chain B and resid 5", particles), (indexes{0, 5, 9}));
+    EXPECT_EQ(select("(name N or chain B) and resid 5", particles), (indexes{9}));
+    EXPECT_EQ(select("not not chain A", particles), select("chain A", particles));
+}
+
+TEST(Selection, within)
+{
+    std::vector<spn::Particle> particles = make_particles();
+    using indexes = std::vector<size_t>;
+
+    EXPECT_EQ(select("within 1.5 of index 2", particles), (indexes{1, 2, 3}));
+    EXPECT_EQ(select("chain B and within 10.1 of index 0", particles), (indexes{5, 6}));
+    EXPECT_TRUE(select("within 3 of none", particles).empty());
+
+    const selection::Expression expression("within 1.5 of index 2");
+    EXPECT_TRUE(expression.isDynamic());
+    EXPECT_FALSE(selection::Expression("chain A or resid 1").isDynamic());
+    EXPECT_TRUE(selection::Expression("chain A or x < 1").isDynamic());
+
+    particles[4].setPosition(Vector3f(2.0f, 1.0f, 0.2f));
+    EXPECT_EQ(expression.evaluate(particles, selection::Labels(particles)), (indexes{1, 2, 3, 4}));
+}
+
+TEST(Selection, references)
+{
+    const std::vector<spn::Particle> particles = make_particles();
+    const selection::Expression backbone("name N");
+    const selection::Expression expression("chain B and not @backbone", [&](const std::string & name) {
+        return name == "backbone" ? &backbone : nullptr;
+    });
+    EXPECT_EQ(expression.evaluate(particles, selection::Labels(particles)), (std::vector<size_t>{6, 7, 8, 9}));
+    EXPECT_THROW(selection::Expression("@backbone"), std::invalid_argument);
+}
+
+TEST(Selection, syntax_errors)
+{
+    for (const std::string text : {"", "chain", "chain A and", "chain A resid 1", "(chain A", "chain A)",
+                                   "resid 5-2", "resid a", "x = 2", "within of chain A", "within -1 of all",
+                                   "within 2 chain A", "foo"})
+        EXPECT_THROW(selection::Expression{text}, std::invalid_argument) << "'" << text << "'";
+}
+
+// Named selections from the configuration, and a constraint between two of them.
+TEST(Selection, spring_network)
+{
+    spn::SpringNetwork spn;
+    tests::assembly(100, 50, 2).to_spring_network(spn);
+
+    configuration::Configuration config = tests::simulation_configuration(20, 5.0);
+    config.setFromString("selection.first", "chain A");
+    config.setFromString("selection.second", "chain B and not resid 51-60");
+    config.setFromString("selection.contact", "@first and within 15 of @second");
+    config.setFromString("constraint.enable", "1");
+    config.setFromString("constraint.src", "first");
+    config.setFromString("constraint.dest", "second");
+    config.setFromString("constraint.scale", "100");
+    EXPECT_FALSE(config.exists("selection.1abc"));
+    spn.setup(config);
+
+    ASSERT_EQ(spn.getSelections().size(), 3u);
+    EXPECT_EQ(spn.getSelection("first").size(), 50u);
+    EXPECT_EQ(spn.getSelection("second").size(), 40u);
+    EXPECT_TRUE(spn.getSelection("contact").isDynamic());
+    EXPECT_FALSE(spn.getSelection("contact").empty());
+    EXPECT_LT(spn.getSelection("contact").size(), 50u);
+    EXPECT_THROW(spn.getSelection("third"), std::invalid_argument);
+    EXPECT_THROW(spn.addSelection("first", "all"), std::invalid_argument);
+    ASSERT_TRUE(spn.isConstraintEnabled());
+    ASSERT_EQ(spn.getConstraints().size(), 1u);
+
+    const float distance = spn.getConstraints()[0]->getDistance();
+    spn.run();
+    EXPECT_LT(spn.getConstraints()[0]->getDistance(), distance);
+
+    config.setFromString("constraint.dest", "missing");
+    spn::SpringNetwork other;
+    tests::assembly(100, 50, 2).to_spring_network(other);
+    EXPECT_THROW(other.setup(config), std::runtime_error);
+}
+
+// Collective variable groups are bound once: dynamic selections are rejected.
+TEST(Selection, dynamic_selections_are_not_colvar_groups)
+{
+    const std::filesystem::path input = std::filesystem::temp_directory_path() / "selection-colvars.in";
+    std::ofstream(input) << "cv z depth @contact\n";
+
+    configuration::Configuration config = tests::simulation_configuration(1, 5.0);
+    config.setFromString("selection.first", "chain A");
+    config.setFromString("selection.contact", "chain B and within 15 of @first");
+    config.colvars.enable = true;
+    config.colvars.input = input.string();
+    config.colvars.path = (std::filesystem::temp_directory_path() / "selection-colvars.dat").string();
+
+    spn::SpringNetwork spn;
+    tests::assembly(100, 50, 2).to_spring_network(spn);
+    EXPECT_THROW(spn.setup(config), std::runtime_error);
+
+    std::ofstream(input) << "cv z depth @first\n";
+    spn::SpringNetwork other;
+    tests::assembly(100, 50, 2).to_spring_network(other);
+    other.setup(config);
+    EXPECT_EQ(other.getColvars().getVariable("z").getParticles().size(), 50u);
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
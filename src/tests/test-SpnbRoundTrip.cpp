@@ -0,0 +1,228 @@
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "IO/SpnbFormat.h"
+#include "IO/SpnbReader.h"
+#include "IO/SpnbWriter.h"
+#include "Particle.h"
+#include "SpringNetwork.h"
+
+using namespace biospring;
+
+namespace
+{
+
+struct TestSpnbRoundTrip : public ::testing::Test
+{
+    spn::SpringNetwork spn;
+    std::string path;
+
+    void SetUp() override
+    {
+        ::testing::Test::SetUp();
+        // One file per test, as ctest may run them concurrently.
+        const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path = (std::filesystem::temp_directory_path() / ("roundtrip-" + name + ".spnb")).string();
+
+        for (int i = 0; i < 3; ++i)
+        {
+            spn::Particle p;
+            p.setPosition(Vector3f(static_cast<float>(i), 2.0f * i, -1.0f));
+            p.setMass(12.0f + i);
+            p.setCharge(-0.5f * i);
+            p.setRadius(1.5);
+            p.setEpsilon(0.2f);
+            p.setHydrophobicity(0.25f);
+            p.setTransferEnergyByAccessibleSurface(7.5f);
+            p.setSolventAccessibilitySurface(123.0f);
+            p.setName(i == 2 ? "LONGNAME" : "CA");
+            p.setResName("ALA");
+            p.setChainName(i == 0 ? "A" : "CHAIN_B");
+            p.setResId(static_cast<unsigned>(5 + i));
+            p.setExtid(static_cast<unsigned>(10 + i));
+            p.setDynamic(i != 1);
+            spn.addParticle(p);
+        }
+        spn.addSpring(0, 1, 1.25f, 2.0f);
+        spn.addSpring(1, 2, 3.5f, 4.0f);
+
+        SpnbWriter(path, &spn).write();
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    // Overwrites the first values of a section of the file.
+    void patchSection(io::spnb::SectionId id, const std::vector<int32_t> & values) const
+    {
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+        io::spnb::Header header;
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        stream.seekg(header.header_size);
+        for (uint32_t i = 0; i < header.number_of_sections; ++i)
+        {
+            io::spnb::SectionEntry entry;
+            stream.read(reinterpret_cast<char *>(&entry), sizeof(entry));
+            if (entry.id != static_cast<uint32_t>(id))
+                continue;
+            stream.seekp(static_cast<std::streamoff>(entry.offset));
+            stream.write(reinterpret_cast<const char *>(values.data()),
+                         static_cast<std::streamsize>(values.size() * sizeof(int32_t)));
+            return;
+        }
+        FAIL() << "section not found";
+    }
+
+    // Overwrites the header of the file.
+    template <typename Patch> void patchHeader(Patch && patch) const
+    {
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+        io::spnb::Header header;
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        patch(header);
+        stream.seekp(0);
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+};
+
+} // namespace
+
+TEST_F(TestSpnbRoundTrip, SpringNetworkRoundTrip)
+{
+    spn::SpringNetwork other;
+    SpnbReader(path).readSpringNetwork(other);
+
+    ASSERT_EQ(other.getNumberOfParticles(), spn.getNumberOfParticles());
+    ASSERT_EQ(other.getNumberOfSprings(), spn.getNumberOfSprings());
+
+    for (size_t i = 0; i < spn.getNumberOfParticles(); ++i)
+    {
+        const spn::Particle & expected = spn.getParticle(i);
+        const spn::Particle & actual = other.getParticle(i);
+        EXPECT_EQ(actual.getPosition(), expected.getPosition());
+        EXPECT_FLOAT_EQ(actual.getMass(), expected.getMass());
+        EXPECT_FLOAT_EQ(actual.getCharge(), expected.getCharge());
+        EXPECT_FLOAT_EQ(actual.getRadius(), expected.getRadius());
+        EXPECT_FLOAT_EQ(actual.getEpsilon(), expected.getEpsilon());
+        EXPECT_FLOAT_EQ(actual.getHydrophobicity(), expected.getHydrophobicity());
+        EXPECT_FLOAT_EQ(actual.getTransferEnergyByAccessibleSurface(), expected.getTransferEnergyByAccessibleSurface());
+        EXPECT_FLOAT_EQ(actual.getSolventAccessibilitySurface(), expected.getSolventAccessibilitySurface());
+        EXPECT_EQ(actual.getName(), expected.getName());
+        EXPECT_EQ(actual.getResName(), expected.getResName());
+        EXPECT_EQ(actual.getChainName(), expected.getChainName());
+        EXPECT_EQ(actual.getResId(), expected.getResId());
+        EXPECT_EQ(actual.getExtid(), expected.getExtid());
+        EXPECT_EQ(actual.isDynamic(), expected.isDynamic());
+    }
+
+    for (size_t i = 0; i < spn.getNumberOfSprings(); ++i)
+    {
+        EXPECT_EQ(other.getSpring(i).getParticle1().getId(), spn.getSpring(i).getParticle1().getId());
+        EXPECT_EQ(other.getSpring(i).getParticle2().getId(), spn.getSpring(i).getParticle2().getId());
+        EXPECT_FLOAT_EQ(other.getSpring(i).getEquilibrium(), spn.getSpring(i).getEquilibrium());
+        EXPECT_FLOAT_EQ(other.getSpring(i).getStiffness(), spn.getSpring(i).getStiffness());
+    }
+}
+
+TEST_F(TestSpnbRoundTrip, TopologyRoundTrip)
+{
+    SpnbReader reader(path);
+    reader.read();
+
+    const topology::Topology & top = reader.getTopology();
+    ASSERT_EQ(top.number_of_particles(), 3u);
+    ASSERT_EQ(top.number_of_springs(), 2u);
+
+    // Names are not truncated to the fixed widths of the NetCDF format.
+    EXPECT_EQ(top.get_particle(2).properties().name(), "LONGNAME");
+    EXPECT_EQ(top.get_particle(1).properties().chain_name(), "CHAIN_B");
+    EXPECT_EQ(top.get_particle(2).properties().atom_id(), 12);
+    EXPECT_EQ(top.get_particle(2).properties().residue_id(), 7);
+    EXPECT_TRUE(top.get_particle(1).properties().is_static());
+    EXPECT_FLOAT_EQ(top.get_particle(0).properties().imp().transfert_energy_by_accessible_surface(), 7.5f);
+}
+
+// Null masses are replaced by 1.0 whatever the target, as in the NetCDF reader.
+TEST_F(TestSpnbRoundTrip, NullMassIsReplaced)
+{
+    spn.getParticle(1).setMass(0.0f);
+    SpnbWriter(path, &spn).write();
+
+    SpnbReader reader(path);
+    reader.read();
+    EXPECT_FLOAT_EQ(reader.getTopology().get_particle(1).properties().mass(), 1.0f);
+    EXPECT_FLOAT_EQ(reader.getTopology().get_particle(0).properties().mass(), 12.0f);
+
+    spn::SpringNetwork other;
+    SpnbReader(path).readSpringNetwork(other);
+    EXPECT_FLOAT_EQ(other.getParticle(1).getMass(), 1.0f);
+}
+
+TEST_F(TestSpnbRoundTrip, SectionsAreAligned)
+{
+    SpnbReader reader(path);
+    reader.open();
+    EXPECT_EQ(reader.getNumberOfParticles(), 3u);
+    EXPECT_EQ(reader.getNumberOfSprings(), 2u);
+
+    std::ifstream stream(path, std::ios::binary);
+    io::spnb::Header header;
+    stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+    ASSERT_EQ(header.version, io::spnb::VERSION);
+    for (uint32_t i = 0; i < header.number_of_sections; ++i)
+    {
+        io::spnb::SectionEntry entry;
+        stream.read(reinterpret_cast<char *>(&entry), sizeof(entry));
+        EXPECT_EQ(entry.offset % io::spnb::ALIGNMENT, 0u);
+    }
+}
+
+TEST_F(TestSpnbRoundTrip, DiesOnBadMagic)
+{
+    {
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+        stream.write("NOTSPNB", 7);
+    }
+    SpnbReader reader(path);
+    EXPECT_DEATH(reader.read(), "!! ERROR: " + path + ": not a .spnb file");
+}
+
+TEST_F(TestSpnbRoundTrip, DiesOnInvalidSpring)
+{
+    patchSection(io::spnb::SectionId::Springs, {0, 3});
+    SpnbReader reader(path);
+    EXPECT_DEATH(reader.read(), "!! ERROR: " + path + ": .spnb spring 0 refers to an unknown particle \\(0, 3\\)");
+
+    patchSection(io::spnb::SectionId::Springs, {-1, 1});
+    EXPECT_DEATH(reader.read(), "spring 0 refers to an unknown particle \\(-1, 1\\)");
+
+    patchSection(io::spnb::SectionId::Springs, {1, 1});
+    EXPECT_DEATH(reader.read(), "spring 0 links particle 1 to itself");
+}
+
+TEST_F(TestSpnbRoundTrip, DiesOnUnknownString)
+{
+    SpnbReader reader(path);
+    reader.open();
+    EXPECT_EQ(reader.getString(0), "CA");
+    EXPECT_DEATH(reader.getString(1000), "!! ERROR: " + path + ": .spnb string 1000 not found or corrupted");
+}
+
+// Header counts are multiplied by element sizes: huge ones must not wrap around.
+TEST_F(TestSpnbRoundTrip, DiesOnOversizedCounts)
+{
+    patchHeader([](io::spnb::Header & header) { header.number_of_particles = uint64_t(1) << 62; });
+    SpnbReader reader(path);
+    EXPECT_DEATH(reader.read(), "!! ERROR: " + path + ": .spnb header counts exceed the file size");
+
+    patchHeader([](io::spnb::Header & header) {
+        header.number_of_particles = 3;
+        header.number_of_strings = std::numeric_limits<uint32_t>::max();
+    });
+    EXPECT_DEATH(reader.read(), "invalid .spnb number of strings");
+}
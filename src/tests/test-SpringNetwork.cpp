@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "SpringNetwork.h"
+#include "TestSystems.h"
+
+using namespace biospring;
+
+static void make_network(spn::SpringNetwork & spn) { tests::lattice_protein(50, 3).to_spring_network(spn); }
+
+TEST(SpringNetwork, particle_from_id)
+{
+    spn::SpringNetwork spn;
+    make_network(spn);
+
+    EXPECT_EQ(&spn.getParticleFromId(17), &spn.getParticle(17));
+    EXPECT_EQ(spn.getParticleIndexesFromIds({3, 0, 49}), (std::vector<unsigned>{3, 0, 49}));
+    EXPECT_THROW(spn.getParticleFromId(50), std::out_of_range);
+    EXPECT_THROW(spn.getParticleIndexesFromIds({1, 50}), std::out_of_range);
+}
+
+// The generator numbers atoms from 1, as PDB files do.
+TEST(SpringNetwork, particle_index_from_extid)
+{
+    spn::SpringNetwork spn;
+    make_network(spn);
+
+    for (unsigned i = 0; i < spn.getNumberOfParticles(); ++i)
+        EXPECT_EQ(spn.getParticleIndexFromExtid(spn.getParticle(i).getExtid()), i);
+    EXPECT_EQ(spn.getParticleIndexesFromExtids({1, 50, 10}), (std::vector<unsigned>{0, 49, 9}));
+    EXPECT_THROW(spn.getParticleIndexFromExtid(0), std::out_of_range);
+    EXPECT_THROW(spn.getParticleIndexesFromExtids({1, 51}), std::out_of_range);
+
+    // The first particle added keeps a shared external id.
+    spn::Particle duplicate;
+    duplicate.setExtid(10);
+    spn.clear();
+    spn.addParticle(duplicate);
+    spn.addParticle(duplicate);
+    EXPECT_EQ(spn.getParticleIndexFromExtid(10), 0u);
+    EXPECT_THROW(spn.getParticleIndexFromExtid(1), std::out_of_range);
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TestSystems.h"
+#include "configuration/Configuration.hpp"
+#include "spn/Sweep.h"
+
+using namespace biospring;
+
+static configuration::Configuration make_configuration() { return tests::simulation_configuration(3, 5.0); }
+
+static std::vector<std::string> read_lines(const std::string & path)
+{
+    std::vector<std::string> lines;
+    std::ifstream is(path);
+    for (std::string line; std::getline(is, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+class TestSweep : public ::testing::Test
+{
+  protected:
+    std::filesystem::path directory;
+
+    void SetUp() override
+    {
+        const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        directory = std::filesystem::temp_directory_path() / ("sweep-" + name);
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    std::string path(const std::string & name) const { return (directory / name).string(); }
+};
+
+TEST(Sweep, grid_combinations)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration());
+    sweep.add("steric.cutoff", {"4", "5", "6"});
+    sweep.add("spring.scale", {"1", "2"});
+
+    ASSERT_EQ(sweep.size(), 6u);
+    EXPECT_EQ(sweep.getValues(0), (std::vector<std::string>{"4", "1"}));
+    EXPECT_EQ(sweep.getValues(1), (std::vector<std::string>{"4", "2"}));
+    EXPECT_EQ(sweep.getValues(5), (std::vector<std::string>{"6", "2"}));
+    EXPECT_THROW(sweep.getValues(6), std::out_of_range);
+
+    const configuration::Configuration config = sweep.getConfiguration(3);
+    EXPECT_FLOAT_EQ(config.steric.cutoff, 5.0);
+    EXPECT_FLOAT_EQ(config.spring.scale, 2.0);
+}
+
+TEST(Sweep, list)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration(), spn::Sweep::Mode::List);
+    sweep.add("steric.cutoff", {"4", "5", "6"});
+    sweep.add("spring.scale", {"1", "2", "3"});
+
+    ASSERT_EQ(sweep.size(), 3u);
+    EXPECT_EQ(sweep.getValues(2), (std::vector<std::string>{"6", "3"}));
+    EXPECT_THROW(sweep.add("probe.x", {"1", "2"}), std::invalid_argument);
+}
+
+TEST(Sweep, invalid_parameters)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration());
+    EXPECT_EQ(sweep.size(), 1u);
+    EXPECT_THROW(sweep.add("steric.radius", {"1"}), std::invalid_argument);
+    EXPECT_THROW(sweep.add("steric.cutoff", {}), std::invalid_argument);
+    sweep.add("steric.cutoff", {"4"});
+    EXPECT_THROW(sweep.add("steric.cutoff", {"5"}), std::invalid_argument);
+}
+
+TEST(Sweep, output_paths_get_the_run_number)
+{
+    configuration::Configuration config = make_configuration();
+    config.xtctraj.path = "traj.xtc";
+    spn::Sweep sweep(tests::lattice_protein(100, 5), config);
+    sweep.add("spring.scale", {"1", "2"});
+    EXPECT_EQ(sweep.getConfiguration(1).xtctraj.path, "traj.1.xtc");
+}
+
+TEST(Sweep, runs_must_end)
+{
+    configuration::Configuration config = make_configuration();
+    config.sim.nbsteps = -1;
+    spn::Sweep sweep(tests::lattice_protein(100, 5), config);
+    EXPECT_THROW(sweep.run("unused.tsv"), std::invalid_argument);
+}
+
+// Rigid bodies are shared by the whole process: runs would move each other's bodies.
+TEST_F(TestSweep, rejects_rigid_bodies)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration());
+    sweep.add("rigidbody.enable", {"0", "1"});
+    EXPECT_THROW(sweep.run(path("sweep.tsv")), std::runtime_error);
+}
+
+TEST_F(TestSweep, table_of_final_energies)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration());
+    sweep.add("steric.cutoff", {"4", "6"});
+    sweep.add("spring.scale", {"1", "2"});
+
+    EXPECT_EQ(sweep.run(path("sweep.tsv")), 4u);
+
+    const std::vector<std::string> lines = read_lines(path("sweep.tsv"));
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[0].rfind("# run\tsteric.cutoff\tspring.scale\tkinetic", 0), 0u);
+    std::vector<bool> seen(4, false);
+    for (size_t i = 1; i < lines.size(); ++i)
+        seen.at(std::stoul(lines[i])) = true;
+    EXPECT_EQ(seen, std::vector<bool>(4, true));
+}
+
+TEST_F(TestSweep, resume)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration());
+    sweep.add("spring.scale", {"1", "2", "3"});
+    ASSERT_EQ(sweep.run(path("sweep.tsv")), 3u);
+
+    // Nothing left to run.
+    EXPECT_EQ(sweep.run(path("sweep.tsv"), "", true), 0u);
+
+    // Drops the last run and leaves an incomplete line.
+    std::vector<std::string> lines = read_lines(path("sweep.tsv"));
+    {
+        std::ofstream os(path("sweep.tsv"));
+        os << lines[0] << '\n' << lines[1] << '\n' << lines[2] << '\n' << lines[3].substr(0, 3);
+    }
+    EXPECT_EQ(sweep.run(path("sweep.tsv"), "", true), 1u);
+    EXPECT_EQ(read_lines(path("sweep.tsv")).size(), 4u);
+
+    // Without resume, everything is run again.
+    EXPECT_EQ(sweep.run(path("sweep.tsv")), 3u);
+}
+
+TEST_F(TestSweep, resume_another_sweep)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration());
+    sweep.add("spring.scale", {"1", "2"});
+    sweep.run(path("sweep.tsv"));
+
+    spn::Sweep other(tests::lattice_protein(100, 5), make_configuration());
+    other.add("steric.cutoff", {"1", "2"});
+    EXPECT_THROW(other.run(path("sweep.tsv"), "", true), std::runtime_error);
+}
+
+// Without swept parameters, a row only holds the run number and the energies.
+TEST_F(TestSweep, resume_unknown_run)
+{
+    spn::Sweep sweep(tests::lattice_protein(100, 5), make_configuration());
+    ASSERT_EQ(sweep.run(path("sweep.tsv")), 1u);
+
+    const std::vector<std::string> lines = read_lines(path("sweep.tsv"));
+    {
+        std::ofstream os(path("sweep.tsv"), std::ios::app);
+        os << "5" << lines[1].substr(lines[1].find('\t')) << '\n';
+    }
+    EXPECT_THROW(sweep.run(path("sweep.tsv"), "", true), std::runtime_error);
+}
+
+TEST_F(TestSweep, samples)
+{
+    configuration::Configuration config = make_configuration();
+    config.csvsample.enable = true;
+    config.csvsample.frequency = 1;
+    config.csvsample.path = path("sample.csv");
+
+    spn::Sweep sweep(tests::lattice_protein(100, 5), config);
+    sweep.add("spring.scale", {"1", "2"});
+    sweep.run(path("sweep.tsv"), path("samples.tsv"));
+
+    const std::vector<std::string> lines = read_lines(path("samples.tsv"));
+    ASSERT_GT(lines.size(), 2u);
+    EXPECT_EQ(lines[0].rfind("# run\tStep", 0), 0u);
+
+    size_t samples[2] = {0, 0};
+    for (size_t i = 1; i < lines.size(); ++i)
+        ++samples[std::stoul(lines[i])];
+    EXPECT_GT(samples[0], 0u);
+    EXPECT_EQ(samples[0], samples[1]);
+}
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "IO/modern/XTCTrajectoryWriter.hpp"
+#include "Particle.h"
+#include "SpringNetwork.h"
+#include "xdrfile_xtc.h"
+
+using namespace biospring;
+
+// A frame written by the XTC trajectory writer is read back by xdrfile, in nm.
+TEST(XTCRoundTrip, FrameIsReadBack)
+{
+    spn::SpringNetwork spn;
+    for (int i = 0; i < 3; ++i)
+    {
+        spn::Particle p;
+        p.setPosition(Vector3f(10.0f * i, 2.0f, -5.0f));
+        spn.addParticle(p);
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "roundtrip.xtc").string();
+    {
+        io::modern::XTCTrajectoryWriter writer(path, spn);
+        writer.write_step();
+    }
+
+    int natoms = 0;
+    ASSERT_EQ(read_xtc_natoms(const_cast<char *>(path.c_str()), &natoms), exdrOK);
+    ASSERT_EQ(natoms, 3);
+
+    XDRFILE * xdr = xdrfile_open(path.c_str(), "r");
+    ASSERT_NE(xdr, nullptr);
+    int step = -1;
+    float time = -1.0f;
+    float precision = 0.0f;
+    matrix box;
+    std::vector<float> x(3 * natoms);
+    const int status = read_xtc(xdr, natoms, &step, &time, box, reinterpret_cast<rvec *>(x.data()), &precision);
+    xdrfile_close(xdr);
+
+    ASSERT_EQ(status, exdrOK);
+    EXPECT_EQ(step, 0);
+    for (int i = 0; i < natoms; ++i)
+    {
+        EXPECT_NEAR(x[3 * i + 0], 1.0f * i, 1e-3);
+        EXPECT_NEAR(x[3 * i + 1], 0.2f, 1e-3);
+        EXPECT_NEAR(x[3 * i + 2], -0.5f, 1e-3);
+    }
+}
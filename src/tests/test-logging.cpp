@@ -2,6 +2,10 @@
 #include "../logging.h"
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -92,3 +96,155 @@ TEST(WarnOnce, UsesTheWarningChannel)
     EXPECT_NE(capture.str().find(biospring::logging::WARNING_PREFIX), std::string::npos);
     EXPECT_NE(capture.str().find("formatted string and 42"), std::string::npos);
 }
+
+// Messages below the level are dropped; errors always go through.
+TEST(Logging, LevelFiltering)
+{
+    using biospring::logging::Level;
+    CerrCapture capture;
+
+    biospring::logging::set_level(Level::Warning);
+    biospring::logging::info("filtered info");
+    biospring::logging::status("filtered status");
+    biospring::logging::warning("kept warning");
+    biospring::logging::error("kept error");
+    biospring::logging::set_level(Level::Debug);
+
+    EXPECT_EQ(capture.count("filtered"), 0u);
+    EXPECT_EQ(capture.count("kept warning"), 1u);
+    EXPECT_EQ(capture.count("kept error"), 1u);
+
+    Level level;
+    EXPECT_TRUE(biospring::logging::level_from_string("status", level));
+    EXPECT_EQ(level, Level::Status);
+    EXPECT_FALSE(biospring::logging::level_from_string("verbose", level));
+}
+
+TEST(Logging, RateLimiterAllowsBurstPerPeriod)
+{
+    biospring::logging::RateLimiter limiter(3, std::chrono::milliseconds(50));
+
+    unsigned allowed = 0;
+    for (int i = 0; i < 10; ++i)
+        allowed += limiter.allow();
+    EXPECT_EQ(allowed, 3u);
+    EXPECT_EQ(limiter.take_suppressed(), 7u);
+    EXPECT_EQ(limiter.take_suppressed(), 0u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_TRUE(limiter.allow());
+}
+
+// The number of suppressed messages is reported with the next message that gets through.
+TEST(Logging, RateLimitedCallSiteReportsSuppressedMessages)
+{
+    CerrCapture capture;
+
+    const auto poll = [](int i) { BIOSPRING_LOG_RATE_LIMITED(info, 2, 50, "polled value %d", i); };
+    for (int i = 0; i < 5; ++i)
+        poll(i);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    poll(5);
+
+    EXPECT_EQ(capture.count("polled value"), 3u);
+    EXPECT_EQ(capture.count("polled value 5"), 1u);
+    EXPECT_EQ(capture.count("(3 similar messages suppressed)"), 1u);
+}
+
+TEST(Logging, JsonSink)
+{
+    const std::string path = "test-logging.jsonl";
+    biospring::logging::set_json_sink(path);
+    {
+        CerrCapture capture;
+        biospring::logging::warning("quote \" and\tTab");
+    }
+    biospring::logging::set_json_sink("");
+
+    std::ifstream file(path);
+    std::string line;
+    ASSERT_TRUE(std::getline(file, line));
+    EXPECT_EQ(line.find("{\"time\":"), 0u) << line;
+    EXPECT_NE(line.find("\"level\":\"warning\""), std::string::npos) << line;
+    EXPECT_NE(line.find("\"message\":\"quote \\\" and\\tTab\"}"), std::string::npos) << line;
+    EXPECT_FALSE(std::getline(file, line));
+    std::remove(path.c_str());
+}
+
+// In asynchronous mode, messages from several threads are all written, whole, and in the
+// order each thread logged them.
+TEST(Logging, AsyncWritesWholeLinesInOrder)
+{
+    CerrCapture capture;
+    biospring::logging::start_async();
+    EXPECT_TRUE(biospring::logging::is_async());
+
+    constexpr int THREADS = 4;
+    constexpr int MESSAGES = 50;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.emplace_back([t]() {
+            for (int i = 0; i < MESSAGES; ++i)
+            {
+                biospring::logging::info("thread %d message %d", t, i);
+                if (i % 10 == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    for (std::thread & thread : threads)
+        thread.join();
+
+    biospring::logging::flush();
+    biospring::logging::stop_async();
+    EXPECT_FALSE(biospring::logging::is_async());
+
+    const uint64_t dropped = biospring::logging::dropped_messages();
+    std::vector<int> last(THREADS, -1);
+    std::istringstream lines(capture.str());
+    std::string line;
+    size_t count = 0;
+    while (std::getline(lines, line))
+    {
+        int t = -1, i = -1;
+        if (sscanf(line.c_str(), "%*[^t]thread %d message %d", &t, &i) != 2)
+            continue;
+        ASSERT_TRUE(t >= 0 && t < THREADS) << line;
+        EXPECT_GT(i, last[t]) << line;
+        last[t] = i;
+        ++count;
+    }
+    EXPECT_EQ(count + dropped, static_cast<size_t>(THREADS * MESSAGES));
+}
+
+// Messages logged while asynchronous mode stops are written, either by the last drain or
+// synchronously.
+TEST(Logging, AsyncKeepsMessagesLoggedWhileStopping)
+{
+    CerrCapture capture;
+    const uint64_t dropped = biospring::logging::dropped_messages();
+    biospring::logging::start_async();
+
+    constexpr int THREADS = 4;
+    constexpr int MESSAGES = 200;
+    std::atomic<int> started{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+        threads.emplace_back([&started, t]() {
+            ++started;
+            for (int i = 0; i < MESSAGES; ++i)
+                biospring::logging::info("stopping %d %d", t, i);
+        });
+    while (started < THREADS)
+        std::this_thread::yield();
+    biospring::logging::stop_async();
+    for (std::thread & thread : threads)
+        thread.join();
+
+    std::istringstream lines(capture.str());
+    std::string line;
+    size_t count = 0;
+    while (std::getline(lines, line))
+        if (line.find("stopping ") != std::string::npos)
+            ++count;
+    EXPECT_EQ(count + (biospring::logging::dropped_messages() - dropped), static_cast<size_t>(THREADS * MESSAGES));
+}
@@ -206,6 +206,35 @@ TEST(TestNeighborSearchSkin, UpdateRebuildsAfterExceedingSkinMargin)
     EXPECT_NE(std::find(neighbors.begin(), neighbors.end(), 10u), neighbors.end());
 }
 
+// Only the particles given to relocate() move, some of them far outside the grid box:
+// queries must match a grid rebuilt from scratch.
+TEST(TestNeighborSearch, RelocateMatchesRebuild)
+{
+    auto particles = generate_random_particles(300);
+    double cutoff = 8.0;
+    biospring::nsearch::NeighborSearch ns(particles, cutoff);
+
+    std::vector<size_t> moved;
+    for (size_t i = 0; i < particles.size(); i += 7)
+    {
+        const auto & pos = particles[i].getPosition();
+        const float shift = i % 2 ? 30.0f : -30.0f;
+        particles[i].setPosition(Vector3f(pos.getX() + shift, pos.getY() - 0.5f * shift, pos.getZ()));
+        moved.push_back(i);
+    }
+    ns.relocate(moved);
+
+    const biospring::nsearch::NeighborSearch rebuilt(particles, cutoff);
+    for (const auto & p : particles)
+    {
+        auto neighbors = ns.get_neighbors(p);
+        auto expected = rebuilt.get_neighbors(p);
+        std::sort(neighbors.begin(), neighbors.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(neighbors, expected);
+    }
+}
+
 // =====================================================================================
 //
 // Test for `NeighborSearchBase` class.
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include "perfcounters.hpp"
+
+#include <cstdlib>
+#include <string>
+
+using namespace biospring;
+
+namespace
+{
+
+// A loop the compiler cannot remove.
+double busy_loop(size_t n)
+{
+    volatile double x = 0.0;
+    for (size_t i = 0; i < n; ++i)
+        x = x + static_cast<double>(i) * 0.5;
+    return x;
+}
+
+} // namespace
+
+TEST(perfcounters, event_names)
+{
+    EXPECT_STREQ(perf::event_name(perf::CYCLES), "cycles");
+    EXPECT_STREQ(perf::event_name(perf::INSTRUCTIONS), "instructions");
+    EXPECT_STREQ(perf::event_name(perf::LLC_MISSES), "llc_misses");
+    EXPECT_STREQ(perf::event_name(perf::BRANCH_MISSES), "branch_misses");
+}
+
+TEST(perfcounters, difference_saturates)
+{
+    const perf::Counts a{10, 20, 30, 40};
+    const perf::Counts b{5, 25, 30, 0};
+    EXPECT_EQ(perf::difference(a, b), (perf::Counts{5, 0, 0, 40}));
+}
+
+TEST(perfcounters, requested_by_environment)
+{
+    unsetenv("BIOSPRING_PERF_COUNTERS");
+    EXPECT_FALSE(perf::requested_by_environment());
+    setenv("BIOSPRING_PERF_COUNTERS", "0", 1);
+    EXPECT_FALSE(perf::requested_by_environment());
+    setenv("BIOSPRING_PERF_COUNTERS", "1", 1);
+    EXPECT_TRUE(perf::requested_by_environment());
+    unsetenv("BIOSPRING_PERF_COUNTERS");
+}
+
+TEST(perfcounters, closed_counters_read_zero)
+{
+    perf::HardwareCounters counters;
+    EXPECT_FALSE(counters.is_open());
+    EXPECT_EQ(counters.read(), perf::Counts{});
+}
+
+TEST(perfcounters, counts_instructions)
+{
+    perf::HardwareCounters counters;
+    if (!counters.open())
+    {
+        EXPECT_FALSE(counters.error().empty());
+        GTEST_SKIP() << "hardware counters not available: " << counters.error();
+    }
+    ASSERT_TRUE(counters.is_open());
+    if (!counters.available(perf::INSTRUCTIONS))
+        GTEST_SKIP() << "instructions are not counted by this CPU";
+
+    const perf::Counts start = counters.read();
+    busy_loop(1000000);
+    const perf::Counts counts = perf::difference(counters.read(), start);
+    EXPECT_GT(counts[perf::INSTRUCTIONS], 1000000u);
+
+    counters.close();
+    EXPECT_FALSE(counters.is_open());
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include "sasa.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+using namespace biospring;
+
+namespace
+{
+
+// Exposed area of a sphere of radius `ri` partially buried in a sphere of radius
+// `rj` whose center is at distance `d`.
+double two_sphere_area(double ri, double rj, double d)
+{
+    const double h = ri - (d * d + ri * ri - rj * rj) / (2.0 * d);
+    return 4.0 * std::numbers::pi * ri * ri - 2.0 * std::numbers::pi * ri * h;
+}
+
+std::vector<float> random_positions(size_t n, float size, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(0.0f, size);
+    std::vector<float> positions(3 * n);
+    for (float & x : positions)
+        x = distribution(generator);
+    return positions;
+}
+
+} // namespace
+
+// =====================================================================================
+// sasa::sphere_points
+TEST(TestSASA, sphere_points)
+{
+    const auto points = sasa::sphere_points(100);
+    ASSERT_EQ(points.size(), 100u);
+
+    double x = 0.0, y = 0.0, z = 0.0;
+    for (const Vector3f & p : points)
+    {
+        EXPECT_NEAR(std::sqrt(p.getX() * p.getX() + p.getY() * p.getY() + p.getZ() * p.getZ()), 1.0, 1e-5);
+        x += p.getX();
+        y += p.getY();
+        z += p.getZ();
+    }
+
+    // Evenly distributed: the centroid is close to the center of the sphere.
+    EXPECT_NEAR(x / 100, 0.0, 1e-2);
+    EXPECT_NEAR(y / 100, 0.0, 1e-2);
+    EXPECT_NEAR(z / 100, 0.0, 1e-2);
+}
+
+// =====================================================================================
+// sasa::ShrakeRupley
+TEST(TestSASA, isolated_sphere)
+{
+    sasa::ShrakeRupley sr({1.5}, 1.4);
+    sr.compute({1.0f, 2.0f, 3.0f});
+    EXPECT_NEAR(sr.areas()[0], 4.0 * std::numbers::pi * 2.9 * 2.9, 1e-3);
+    EXPECT_DOUBLE_EQ(sr.total(), sr.areas()[0]);
+}
+
+TEST(TestSASA, two_overlapping_spheres)
+{
+    sasa::ShrakeRupley sr({1.5, 2.0}, 1.4, 2000);
+    sr.compute({0.0f, 0.0f, 0.0f, 5.0f, 0.0f, 0.0f});
+
+    const double expected0 = two_sphere_area(2.9, 3.4, 5.0);
+    const double expected1 = two_sphere_area(3.4, 2.9, 5.0);
+    EXPECT_NEAR(sr.areas()[0], expected0, 0.01 * expected0);
+    EXPECT_NEAR(sr.areas()[1], expected1, 0.01 * expected1);
+}
+
+TEST(TestSASA, buried_sphere)
+{
+    sasa::ShrakeRupley sr({0.5, 5.0}, 1.4);
+    sr.compute({0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f});
+    EXPECT_DOUBLE_EQ(sr.areas()[0], 0.0);
+    EXPECT_GT(sr.areas()[1], 0.0);
+}
+
+TEST(TestSASA, unknown_radius)
+{
+    // Unknown radii are handled as null radii: no area, and no burying.
+    sasa::ShrakeRupley sr({-1.0, 1.5}, 1.4);
+    sr.compute({0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f});
+    EXPECT_DOUBLE_EQ(sr.areas()[0], 0.0);
+    EXPECT_NEAR(sr.areas()[1], 4.0 * std::numbers::pi * 2.9 * 2.9, 1e-3);
+}
+
+TEST(TestSASA, nothing_moved)
+{
+    const std::vector<float> positions = random_positions(200, 20.0f, 1);
+    sasa::ShrakeRupley sr(std::vector<double>(200, 1.5), 1.4);
+
+    EXPECT_EQ(sr.compute(positions), 200u);
+    const double total = sr.total();
+
+    EXPECT_EQ(sr.compute(positions), 0u);
+    EXPECT_DOUBLE_EQ(sr.total(), total);
+}
+
+TEST(TestSASA, incremental_matches_full_computation)
+{
+    const size_t n = 400;
+    std::vector<float> positions = random_positions(n, 30.0f, 2);
+    sasa::ShrakeRupley incremental(std::vector<double>(n, 1.7), 1.4);
+    incremental.compute(positions);
+
+    // Moves a few particles well beyond the threshold, including one far away
+    // from its previous neighbors.
+    positions[3 * 10] += 1.0f;
+    positions[3 * 50 + 1] -= 0.5f;
+    positions[3 * 90 + 2] += 15.0f;
+    const size_t recomputed = incremental.compute(positions);
+    EXPECT_GT(recomputed, 3u);
+    EXPECT_LT(recomputed, n);
+
+    sasa::ShrakeRupley full(std::vector<double>(n, 1.7), 1.4);
+    full.compute(positions);
+    for (size_t i = 0; i < n; ++i)
+        EXPECT_DOUBLE_EQ(incremental.areas()[i], full.areas()[i]) << "particle " << i;
+    EXPECT_NEAR(incremental.total(), full.total(), 1e-6 * full.total());
+}
+
+TEST(TestSASA, small_moves_are_ignored)
+{
+    std::vector<float> positions = random_positions(100, 20.0f, 3);
+    sasa::ShrakeRupley sr(std::vector<double>(100, 1.5), 1.4, 100, 0.1f);
+    sr.compute(positions);
+
+    positions[0] += 0.05f;
+    EXPECT_EQ(sr.compute(positions), 0u);
+
+    // Displacements add up until they exceed the threshold.
+    positions[0] += 0.06f;
+    EXPECT_GT(sr.compute(positions), 0u);
+}
+
+TEST(TestSASA, invalidate)
+{
+    const std::vector<float> positions = random_positions(50, 10.0f, 4);
+    sasa::ShrakeRupley sr(std::vector<double>(50, 1.5), 1.4);
+    sr.compute(positions);
+    sr.invalidate();
+    EXPECT_EQ(sr.compute(positions), 50u);
+}
+
+TEST(TestSASA, wrong_number_of_coordinates)
+{
+    sasa::ShrakeRupley sr({1.5, 1.5}, 1.4);
+    EXPECT_DEATH(sr.compute({0.0f, 0.0f, 0.0f}), "!! ERROR: ShrakeRupley: expected 6 coordinates, got 3");
+}
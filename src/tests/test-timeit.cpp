@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include "timeit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace biospring;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+std::vector<std::string> lines(const std::string & text)
+{
+    std::vector<std::string> result;
+    std::stringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line))
+        result.push_back(line);
+    return result;
+}
+
+} // namespace
+
+TEST(StageProfiler, statistics)
+{
+    timeit::StageProfiler::Statistics s;
+    for (uint64_t ns : {100, 200, 300, 400, 10000})
+        s.record(ns);
+
+    EXPECT_EQ(s.count, 5u);
+    EXPECT_EQ(s.total, 11000u);
+    EXPECT_EQ(s.min, 100u);
+    EXPECT_EQ(s.max, 10000u);
+    EXPECT_DOUBLE_EQ(s.mean(), 2200.0);
+
+    // Quantiles are upper bounds from log2 bins.
+    EXPECT_GE(s.quantile(0.5), 300u);
+    EXPECT_LT(s.quantile(0.5), 512u);
+    EXPECT_EQ(s.quantile(1.0), 10000u);
+
+    s.reset();
+    EXPECT_EQ(s.count, 0u);
+    EXPECT_EQ(s.quantile(0.5), 0u);
+}
+
+TEST(StageProfiler, scoped_stage_only_records_when_enabled)
+{
+    timeit::StageProfiler profiler;
+    const size_t stage = profiler.add_stage("stage");
+    const size_t counter = profiler.add_counter("counter");
+
+    {
+        timeit::ScopedStage scope(profiler, stage);
+    }
+    profiler.increment(counter);
+    EXPECT_EQ(profiler.stages()[stage].run.count, 0u);
+    EXPECT_EQ(profiler.counters()[counter].run, 0u);
+
+    profiler.set_enabled();
+    {
+        timeit::ScopedStage scope(profiler, stage);
+    }
+    {
+        timeit::ScopedStage scope(profiler, stage);
+        scope.stop();
+    }
+    profiler.increment(counter, 3);
+    EXPECT_EQ(profiler.stages()[stage].run.count, 2u);
+    EXPECT_EQ(profiler.counters()[counter].run, 3u);
+}
+
+TEST(StageProfiler, write_interval)
+{
+    timeit::StageProfiler profiler;
+    profiler.set_enabled();
+    const size_t forces = profiler.add_stage("forces");
+    profiler.add_stage("unused");
+    const size_t rebuilds = profiler.add_counter("rebuilds");
+
+    profiler.record(forces, 2us);
+    profiler.record(forces, 4us);
+    profiler.increment(rebuilds);
+
+    std::ostringstream os;
+    timeit::StageProfiler::write_header(os);
+    profiler.write_interval(os, 10);
+
+    // Stages that did not run in the interval are skipped.
+    std::vector<std::string> rows = lines(os.str());
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_EQ(rows[0], "step,stage,count,total_us,mean_us,min_us,max_us,p50_us,p90_us,p99_us");
+    EXPECT_TRUE(rows[1].starts_with("10,forces,2,6.000,3.000,2.000,4.000,")) << rows[1];
+    EXPECT_EQ(rows[2], "10,rebuilds,1,,,,,,,");
+
+    // A new interval starts after each write, the run statistics are kept.
+    std::ostringstream next;
+    profiler.write_interval(next, 20);
+    EXPECT_EQ(lines(next.str()), std::vector<std::string>{"20,rebuilds,0,,,,,,,"});
+    EXPECT_EQ(profiler.stages()[forces].run.count, 2u);
+    EXPECT_EQ(profiler.counters()[rebuilds].run, 1u);
+
+    std::ostringstream summary;
+    profiler.print(summary);
+    EXPECT_NE(summary.str().find("forces"), std::string::npos);
+    EXPECT_EQ(summary.str().find("unused"), std::string::npos);
+}
+
+TEST(StageProfiler, write_interval_with_hardware_counters)
+{
+    // Counters are not opened: only the reporting of the recorded events is tested.
+    perf::HardwareCounters counters;
+    timeit::StageProfiler profiler;
+    profiler.set_enabled();
+    profiler.set_hardware_counters(&counters);
+    const size_t forces = profiler.add_stage("forces");
+    const size_t rebuilds = profiler.add_counter("rebuilds");
+
+    profiler.record(forces, 2us, perf::Counts{1000, 2000, 3, 4});
+    profiler.record(forces, 2us, perf::Counts{1000, 1000, 1, 0});
+    profiler.increment(rebuilds);
+
+    std::ostringstream os;
+    timeit::StageProfiler::write_header(os, true);
+    profiler.write_interval(os, 10);
+
+    std::vector<std::string> rows = lines(os.str());
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_TRUE(rows[0].ends_with(",p99_us,cycles,instructions,llc_misses,branch_misses,ipc")) << rows[0];
+    EXPECT_TRUE(rows[1].ends_with(",2000,3000,4,4,1.500")) << rows[1];
+    EXPECT_EQ(rows[2], "10,rebuilds,1,,,,,,,,,,,,");
+    EXPECT_EQ(profiler.stages()[forces].run.events, (perf::Counts{2000, 3000, 4, 4}));
+
+    // Events the CPU does not count are reported as n/a.
+    std::ostringstream summary;
+    profiler.print(summary);
+    EXPECT_NE(summary.str().find("IPC"), std::string::npos);
+    EXPECT_NE(summary.str().find("n/a"), std::string::npos);
+}
+
+// Counters of a CPU that counts cycles and cache misses, but not instructions.
+class CountersWithoutInstructions : public perf::HardwareCounters
+{
+  public:
+    CountersWithoutInstructions() { _slots = {0, -1, 1, -1}; }
+};
+
+TEST(StageProfiler, print_ratios_need_instructions)
+{
+    CountersWithoutInstructions counters;
+    timeit::StageProfiler profiler;
+    profiler.set_enabled();
+    profiler.set_hardware_counters(&counters);
+    const size_t forces = profiler.add_stage("forces");
+    profiler.record(forces, 2us, perf::Counts{1000, 0, 3, 0});
+
+    std::ostringstream summary;
+    profiler.print(summary);
+    const std::vector<std::string> rows = lines(summary.str());
+    const auto row =
+        std::find_if(rows.begin(), rows.end(), [](const std::string & r) { return r.starts_with("forces"); });
+    ASSERT_NE(row, rows.end());
+    std::istringstream fields(*row);
+    std::vector<std::string> columns{std::istream_iterator<std::string>(fields), std::istream_iterator<std::string>()};
+    ASSERT_GE(columns.size(), 3u);
+    EXPECT_EQ(std::vector<std::string>(columns.end() - 3, columns.end()),
+              (std::vector<std::string>{"n/a", "n/a", "n/a"}))
+        << *row;
+}
+
+// -- Main function  ----------------------------------------------------------
+int main(int argc, char * argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,10 +1,13 @@
 
 #include "../utils.hpp"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 
 class StringCompareTestFixture : public ::testing::TestWithParam<std::tuple<std::string, std::string>> {};
@@ -84,6 +87,15 @@ INSTANTIATE_TEST_SUITE_P(
         std::make_tuple("bar", "foo.bar"),
         std::make_tuple("baz", "foo.bar.baz")));
 
+// -- replicaPath function -----------------------------------------------------
+TEST(replicaPath, InsertsNumberBeforeExtension)
+{
+    EXPECT_EQ("traj.2.xtc", path::replicaPath("traj.xtc", 2));
+    EXPECT_EQ("out/profile.0.csv", path::replicaPath("out/profile.csv", 0));
+    EXPECT_EQ("trajectory.1", path::replicaPath("trajectory", 1));
+    EXPECT_EQ("", path::replicaPath("", 1));
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -364,6 +376,119 @@ TEST(File, OpenreadEmptyPath)
     EXPECT_DEATH(file::openread(fname, infile), "!! ERROR: openread: empty file name");
 }
 
+// -- Concurrency  -------------------------------------------------------------
+TEST(Concurrency, TripleBufferAcquireWithoutPublish)
+{
+    concurrency::TripleBuffer<int> buffer;
+    buffer.for_each([](int & value) { value = 0; });
+    EXPECT_FALSE(buffer.acquire());
+    EXPECT_EQ(buffer.front(), 0);
+}
+
+TEST(Concurrency, TripleBufferPublishAcquire)
+{
+    concurrency::TripleBuffer<int> buffer;
+    buffer.back() = 1;
+    buffer.publish();
+    EXPECT_TRUE(buffer.acquire());
+    EXPECT_EQ(buffer.front(), 1);
+
+    // Nothing new: front does not change.
+    EXPECT_FALSE(buffer.acquire());
+    EXPECT_EQ(buffer.front(), 1);
+}
+
+TEST(Concurrency, TripleBufferKeepsLatestValue)
+{
+    concurrency::TripleBuffer<int> buffer;
+    for (int i = 1; i <= 5; ++i)
+    {
+        buffer.back() = i;
+        buffer.publish();
+    }
+    EXPECT_TRUE(buffer.acquire());
+    EXPECT_EQ(buffer.front(), 5);
+}
+
+TEST(Concurrency, TripleBufferConcurrentValuesAreComplete)
+{
+    // The consumer must never see a value that is being written.
+    concurrency::TripleBuffer<std::vector<int>> buffer;
+    buffer.for_each([](std::vector<int> & v) { v.assign(64, 0); });
+
+    const int n = 20000;
+    std::thread producer([&] {
+        for (int i = 1; i <= n; ++i)
+        {
+            std::fill(buffer.back().begin(), buffer.back().end(), i);
+            buffer.publish();
+        }
+    });
+
+    int last = 0;
+    while (last < n)
+    {
+        if (!buffer.acquire())
+            continue;
+        const std::vector<int> & v = buffer.front();
+        ASSERT_TRUE(std::all_of(v.begin(), v.end(), [&](int x) { return x == v.front(); }));
+        ASSERT_GE(v.front(), last);
+        last = v.front();
+    }
+    producer.join();
+}
+
+TEST(Concurrency, SpscQueueCapacity)
+{
+    EXPECT_EQ(concurrency::SpscQueue<int>(1).capacity(), 2u);
+    EXPECT_EQ(concurrency::SpscQueue<int>(5).capacity(), 8u);
+    EXPECT_EQ(concurrency::SpscQueue<int>(8).capacity(), 8u);
+}
+
+TEST(Concurrency, SpscQueuePushPop)
+{
+    concurrency::SpscQueue<int> queue(4);
+    int value = 0;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop(value));
+
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.push(i));
+    EXPECT_FALSE(queue.push(4)); // full
+    EXPECT_EQ(queue.size(), 4u);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(Concurrency, SpscQueueConcurrentOrder)
+{
+    concurrency::SpscQueue<int> queue(16);
+    const int n = 100000;
+
+    std::thread producer([&] {
+        for (int i = 0; i < n; ++i)
+            while (!queue.push(i))
+                ;
+    });
+
+    int expected = 0;
+    int value;
+    while (expected < n)
+    {
+        if (queue.pop(value))
+        {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        }
+    }
+    producer.join();
+}
+
 // -- Main function  ----------------------------------------------------------
 int main(int argc, char * argv[])
 {
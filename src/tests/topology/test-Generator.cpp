@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "topology/Generator.hpp"
+
+using namespace biospring;
+using namespace biospring::topology;
+
+static generator::Parameters make_parameters(size_t n, unsigned seed = 1)
+{
+    generator::Parameters parameters;
+    parameters.number_of_particles = n;
+    parameters.chain_size = 100;
+    parameters.seed = seed;
+    return parameters;
+}
+
+TEST(Generator, system_kind)
+{
+    for (const std::string name : {"lattice", "membrane", "assembly"})
+        EXPECT_EQ(generator::system_kind_name(generator::system_kind(name)), name);
+    EXPECT_THROW(generator::system_kind("vesicle"), std::invalid_argument);
+}
+
+TEST(Generator, number_of_particles)
+{
+    for (auto kind : {generator::SystemKind::Lattice, generator::SystemKind::Membrane, generator::SystemKind::Assembly})
+    {
+        for (size_t n : {1, 250, 1001})
+        {
+            const Topology top = generator::make_system(kind, make_parameters(n));
+            EXPECT_EQ(top.number_of_particles(), n) << generator::system_kind_name(kind);
+        }
+        EXPECT_GT(generator::make_system(kind, make_parameters(500)).number_of_springs(), 0u);
+    }
+}
+
+TEST(Generator, same_seed_gives_same_system)
+{
+    const Topology a = generator::lattice_protein(make_parameters(300, 7));
+    const Topology b = generator::lattice_protein(make_parameters(300, 7));
+    const Topology c = generator::lattice_protein(make_parameters(300, 8));
+
+    ASSERT_EQ(a.number_of_particles(), b.number_of_particles());
+    EXPECT_EQ(a.number_of_springs(), b.number_of_springs());
+    bool same_as_other_seed = true;
+    for (size_t i = 0; i < a.number_of_particles(); ++i)
+    {
+        EXPECT_EQ(a.get_particle(i).position(), b.get_particle(i).position());
+        if (!(a.get_particle(i).position() == c.get_particle(i).position()))
+            same_as_other_seed = false;
+    }
+    EXPECT_FALSE(same_as_other_seed);
+}
+
+TEST(Generator, assembly_chains_are_not_linked)
+{
+    const Topology top = generator::assembly(make_parameters(450));
+
+    std::set<std::string> chains;
+    for (const Particle & p : top.particles())
+        chains.insert(p.properties().chain_name());
+    EXPECT_EQ(chains, (std::set<std::string>{"A", "B", "C", "D", "E"}));
+
+    for (const Spring & spring : top.springs())
+        EXPECT_EQ(spring.first().properties().chain_name(), spring.second().properties().chain_name());
+}
+
+TEST(Generator, membrane_heads_are_charged_and_tails_hydrophobic)
+{
+    const Topology top = generator::membrane_slab(make_parameters(400));
+    for (const Particle & p : top.particles())
+    {
+        if (p.properties().name() == "PO4")
+            EXPECT_TRUE(p.properties().is_charged());
+        else
+            EXPECT_GT(p.properties().hydrophobicity(), 0.0f);
+    }
+}
@@ -170,6 +170,72 @@ TEST(Topology, add_springs_from_cutoff)
     }
 }
 
+// Checks that each pair within the cutoff gets exactly one spring, even when some
+// springs already exist.
+TEST(Topology, add_springs_from_cutoff_exact_pairs)
+{
+    topology::Topology top;
+    top.add_particles(generate_random_particles(500));
+
+    // Brute-force count of the pairs within the cutoff.
+    size_t expected = 0;
+    for (size_t i = 0; i < top.number_of_particles(); ++i)
+        for (size_t j = i + 1; j < top.number_of_particles(); ++j)
+            if (measure::distance(top.get_particle(i), top.get_particle(j)) < 10.0)
+                ++expected;
+    ASSERT_GE(expected, 1);
+
+    // A pre-existing spring within the cutoff must not be duplicated.
+    std::pair<size_t, size_t> first_pair{0, 0};
+    for (size_t j = 1; j < top.number_of_particles() && first_pair.second == 0; ++j)
+        if (measure::distance(top.get_particle(0), top.get_particle(j)) < 10.0)
+            first_pair = {0, j};
+    if (first_pair.second != 0)
+        top.add_spring(first_pair.first, first_pair.second, 1.0, 5.0);
+
+    top.add_springs_from_cutoff(10.0, 2.0);
+    EXPECT_EQ(top.number_of_springs(), expected);
+
+    // Springs are created in ascending (i, j) order, first particle first.
+    for (size_t k = 1; k < top.number_of_springs(); ++k)
+    {
+        const auto & spring = top.get_spring(k);
+        EXPECT_LT(top.particles().by_uid().at(spring.first().unique_id()),
+                  top.particles().by_uid().at(spring.second().unique_id()));
+        EXPECT_FLOAT_EQ(spring.stiffness(), 2.0);
+    }
+}
+
+// Checks that springs are only added between particles from different topologies.
+TEST(Topology, add_springs_between_topologies_from_cutoff)
+{
+    topology::Topology top1, top2;
+    top1.add_particles(generate_random_particles(200));
+    top2.add_particles(generate_random_particles(200));
+    for (auto & p : top2.particles())
+        p.properties().set_topology_id(1);
+
+    topology::Topology merged = top1.merge(top2);
+    merged.add_springs_between_topologies_from_cutoff(10.0);
+    ASSERT_GE(merged.number_of_springs(), 1);
+
+    size_t expected = 0;
+    for (size_t i = 0; i < merged.number_of_particles(); ++i)
+        for (size_t j = i + 1; j < merged.number_of_particles(); ++j)
+        {
+            const topology::Particle & p1 = merged.get_particle(i);
+            const topology::Particle & p2 = merged.get_particle(j);
+            const bool across = p1.properties().topology_id() != p2.properties().topology_id();
+            if (across && measure::distance(p1, p2) < 10.0)
+                ++expected;
+            if (!across)
+            {
+                EXPECT_FALSE(merged.has_spring_between(p1, p2));
+            }
+        }
+    EXPECT_EQ(merged.number_of_springs(), expected);
+}
+
 TEST(Topology, to_spring_network)
 {
     topology::Topology top;
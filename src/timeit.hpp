@@ -1,12 +1,19 @@
 #ifndef __TIMEIT_HPP__
 #define __TIMEIT_HPP__
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <iomanip> // std::setprecision
 #include <iostream>
+#include <limits>
 #include <map>
 #include <ostream>
 #include <string>
+#include <vector>
+
+#include "perfcounters.hpp"
 
 namespace biospring
 {
@@ -155,6 +162,340 @@ void Profiler::_assert_timer_does_not_exists(const std::string & name) const
 
 bool Profiler::_timer_exists(const std::string & name) const { return _counters.count(name); }
 
+// A StageProfiler accumulates the time spent in the stages of a loop, e.g. the stages
+// of a simulation step.
+//
+// Stages are registered once and then referred to by their index, so that recording a
+// duration only costs a few additions. Each duration is also binned in a histogram with
+// power-of-two bins (in nanoseconds). Statistics are kept over the whole run and over
+// the current interval, which is reset each time it is written.
+//
+// Recording is not thread-safe: stages are meant to be timed from the thread that runs
+// the loop, around parallel regions rather than inside them.
+//
+// When hardware counters are attached (set_hardware_counters), each stage also
+// accumulates the cycles, instructions, cache misses and branch misses counted while it
+// ran, which are reported next to the timings.
+//
+// Example:
+//
+//     StageProfiler profiler;
+//     const size_t forces = profiler.add_stage("forces");
+//     profiler.set_enabled(true);
+//     {
+//         ScopedStage scope(profiler, forces);
+//         computeForces();
+//     }
+//     profiler.print();
+//
+class StageProfiler
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    // Bin i holds durations in [2^(i-1), 2^i) ns (bin 0 holds durations < 1 ns).
+    static constexpr size_t NUMBER_OF_BINS = 40;
+
+    struct Statistics
+    {
+        uint64_t count = 0;
+        uint64_t total = 0; // in ns
+        uint64_t min = std::numeric_limits<uint64_t>::max();
+        uint64_t max = 0;
+        std::array<uint64_t, NUMBER_OF_BINS> histogram{};
+        perf::Counts events{}; // hardware events, summed over all records
+
+        inline void record(uint64_t ns);
+        inline void reset() { *this = Statistics(); }
+        double mean() const { return count ? static_cast<double>(total) / count : 0.0; }
+
+        // Returns an upper bound of the `q` quantile (0 < q <= 1), in ns.
+        inline uint64_t quantile(double q) const;
+    };
+
+    struct Stage
+    {
+        std::string name;
+        Statistics run;
+        Statistics interval;
+    };
+
+    struct Counter
+    {
+        std::string name;
+        uint64_t run = 0;
+        uint64_t interval = 0;
+    };
+
+  protected:
+    std::vector<Stage> _stages;
+    std::vector<Counter> _counters;
+    bool _enabled = false;
+    const perf::HardwareCounters * _hardware = nullptr;
+
+  public:
+    // Registers a stage and returns its index.
+    size_t add_stage(const std::string & name)
+    {
+        _stages.push_back({name, {}, {}});
+        return _stages.size() - 1;
+    }
+
+    // Registers a counter and returns its index.
+    size_t add_counter(const std::string & name)
+    {
+        _counters.push_back({name, 0, 0});
+        return _counters.size() - 1;
+    }
+
+    bool enabled() const { return _enabled; }
+    void set_enabled(bool enabled = true) { _enabled = enabled; }
+
+    // Counters read around each stage, or nullptr to only record timings.
+    const perf::HardwareCounters * hardware_counters() const { return _hardware; }
+    void set_hardware_counters(const perf::HardwareCounters * counters) { _hardware = counters; }
+
+    void record(size_t stage, clock::duration duration)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        const uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+        _stages[stage].run.record(value);
+        _stages[stage].interval.record(value);
+    }
+
+    void record(size_t stage, clock::duration duration, const perf::Counts & events)
+    {
+        record(stage, duration);
+        for (size_t i = 0; i < perf::NUMBER_OF_EVENTS; ++i)
+        {
+            _stages[stage].run.events[i] += events[i];
+            _stages[stage].interval.events[i] += events[i];
+        }
+    }
+
+    void increment(size_t counter, uint64_t n = 1)
+    {
+        if (!_enabled)
+            return;
+        _counters[counter].run += n;
+        _counters[counter].interval += n;
+    }
+
+    const std::vector<Stage> & stages() const { return _stages; }
+    const std::vector<Counter> & counters() const { return _counters; }
+
+    // Resets all statistics.
+    inline void reset();
+
+    // Writes the CSV header matching `write_interval`.
+    // With hardware counters, one column per event and the instructions per cycle are added.
+    inline static void write_header(std::ostream & os, bool hardware = false);
+
+    // Writes the statistics of the current interval, one line per stage and counter,
+    // then starts a new interval. Durations are in microseconds. Hardware event columns
+    // are written when counters are attached.
+    inline void write_interval(std::ostream & os, size_t step);
+
+    // Prints the statistics of the whole run, stages sorted by decreasing total time.
+    // With hardware counters, also prints the instructions per cycle and the cache and
+    // branch misses per thousand instructions: memory-bound stages have a low IPC and
+    // many cache misses.
+    inline void print(std::ostream & os = std::cout) const;
+
+  protected:
+    static double _instructions_per_cycle(const Statistics & s)
+    {
+        return s.events[perf::CYCLES] ? static_cast<double>(s.events[perf::INSTRUCTIONS]) / s.events[perf::CYCLES]
+                                      : 0.0;
+    }
+
+    static double _per_kilo_instructions(const Statistics & s, size_t event)
+    {
+        return s.events[perf::INSTRUCTIONS] ? 1e3 * s.events[event] / s.events[perf::INSTRUCTIONS] : 0.0;
+    }
+};
+
+// Times the enclosing scope as a stage of a StageProfiler.
+// Does not read the clock when the profiler is disabled.
+class ScopedStage
+{
+  protected:
+    StageProfiler & _profiler;
+    size_t _stage;
+    bool _active;
+    StageProfiler::clock::time_point _start;
+    perf::Counts _events;
+
+  public:
+    ScopedStage(StageProfiler & profiler, size_t stage)
+        : _profiler(profiler), _stage(stage), _active(profiler.enabled())
+    {
+        if (!_active)
+            return;
+        if (_profiler.hardware_counters())
+            _events = _profiler.hardware_counters()->read();
+        _start = StageProfiler::clock::now();
+    }
+
+    ~ScopedStage() { stop(); }
+
+    // Records the stage now rather than at the end of the scope.
+    void stop()
+    {
+        if (!_active)
+            return;
+        const auto duration = StageProfiler::clock::now() - _start;
+        if (_profiler.hardware_counters())
+            _profiler.record(_stage, duration, perf::difference(_profiler.hardware_counters()->read(), _events));
+        else
+            _profiler.record(_stage, duration);
+        _active = false;
+    }
+
+    ScopedStage(const ScopedStage &) = delete;
+    ScopedStage & operator=(const ScopedStage &) = delete;
+};
+
+// ======================================================================================
+//
+// StageProfiler
+//
+// ======================================================================================
+
+void StageProfiler::Statistics::record(uint64_t ns)
+{
+    ++count;
+    total += ns;
+    min = std::min(min, ns);
+    max = std::max(max, ns);
+
+    size_t bin = 0;
+    while (bin + 1 < NUMBER_OF_BINS && (ns >> bin) != 0)
+        ++bin;
+    ++histogram[bin];
+}
+
+uint64_t StageProfiler::Statistics::quantile(double q) const
+{
+    if (count == 0)
+        return 0;
+
+    const double target = q * static_cast<double>(count);
+    uint64_t cumulated = 0;
+    for (size_t bin = 0; bin < NUMBER_OF_BINS; ++bin)
+    {
+        cumulated += histogram[bin];
+        if (static_cast<double>(cumulated) >= target)
+            return std::min(max, (uint64_t(1) << bin) - 1);
+    }
+    return max;
+}
+
+void StageProfiler::reset()
+{
+    for (Stage & stage : _stages)
+    {
+        stage.run.reset();
+        stage.interval.reset();
+    }
+    for (Counter & counter : _counters)
+        counter.run = counter.interval = 0;
+}
+
+void StageProfiler::write_header(std::ostream & os, bool hardware)
+{
+    os << "step,stage,count,total_us,mean_us,min_us,max_us,p50_us,p90_us,p99_us";
+    if (hardware)
+    {
+        for (size_t event = 0; event < perf::NUMBER_OF_EVENTS; ++event)
+            os << ',' << perf::event_name(event);
+        os << ",ipc";
+    }
+    os << '\n';
+}
+
+void StageProfiler::write_interval(std::ostream & os, size_t step)
+{
+    const auto us = [](double ns) { return ns * 1e-3; };
+
+    os << std::fixed << std::setprecision(3);
+    for (Stage & stage : _stages)
+    {
+        const Statistics & s = stage.interval;
+        if (s.count == 0)
+            continue;
+        os << step << ',' << stage.name << ',' << s.count << ',' << us(s.total) << ',' << us(s.mean()) << ','
+           << us(s.min) << ',' << us(s.max) << ',' << us(s.quantile(0.5)) << ',' << us(s.quantile(0.9)) << ','
+           << us(s.quantile(0.99));
+        if (_hardware)
+        {
+            for (uint64_t count : s.events)
+                os << ',' << count;
+            os << ',' << _instructions_per_cycle(s);
+        }
+        os << '\n';
+        stage.interval.reset();
+    }
+    for (Counter & counter : _counters)
+    {
+        os << step << ',' << counter.name << ',' << counter.interval << ",,,,,,," << (_hardware ? ",,,,," : "")
+           << '\n';
+        counter.interval = 0;
+    }
+    os.flush();
+}
+
+void StageProfiler::print(std::ostream & os) const
+{
+    std::vector<const Stage *> sorted;
+    uint64_t total = 0;
+    for (const Stage & stage : _stages)
+    {
+        if (stage.run.count == 0)
+            continue;
+        sorted.push_back(&stage);
+        total = std::max(total, stage.run.total);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Stage * a, const Stage * b) { return a->run.total > b->run.total; });
+
+    const auto ms = [](double ns) { return ns * 1e-6; };
+
+    os << std::fixed << std::setprecision(3);
+    os << std::left << std::setw(24) << "stage" << std::right << std::setw(10) << "count" << std::setw(14)
+       << "total (ms)" << std::setw(8) << "%" << std::setw(12) << "mean (ms)" << std::setw(12) << "p99 (ms)"
+       << std::setw(12) << "max (ms)";
+    if (_hardware)
+        os << std::setw(8) << "IPC" << std::setw(12) << "LLC MPKI" << std::setw(12) << "branch MPKI";
+    os << '\n';
+
+    // Prints an event ratio, or n/a if the CPU does not count the event or the instructions
+    // the ratio is taken against.
+    const auto ratio = [&](double value, size_t event, int width) {
+        if (_hardware->available(event) && _hardware->available(perf::INSTRUCTIONS))
+            os << std::setw(width) << value;
+        else
+            os << std::setw(width) << "n/a";
+    };
+
+    for (const Stage * stage : sorted)
+    {
+        const Statistics & s = stage->run;
+        os << std::left << std::setw(24) << stage->name << std::right << std::setw(10) << s.count << std::setw(14)
+           << ms(s.total) << std::setw(8) << std::setprecision(1) << 100.0 * s.total / total << std::setprecision(3)
+           << std::setw(12) << ms(s.mean()) << std::setw(12) << ms(s.quantile(0.99)) << std::setw(12) << ms(s.max);
+        if (_hardware)
+        {
+            ratio(_instructions_per_cycle(s), perf::CYCLES, 8);
+            ratio(_per_kilo_instructions(s, perf::LLC_MISSES), perf::LLC_MISSES, 12);
+            ratio(_per_kilo_instructions(s, perf::BRANCH_MISSES), perf::BRANCH_MISSES, 12);
+        }
+        os << '\n';
+    }
+    for (const Counter & counter : _counters)
+        os << std::left << std::setw(24) << counter.name << std::right << std::setw(10) << counter.run << '\n';
+}
+
 void timeit(const auto fn, size_t N = 10000)
 {
     Timer timer;
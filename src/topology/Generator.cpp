@@ -0,0 +1,223 @@
+#include "Generator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace biospring
+{
+namespace topology
+{
+namespace generator
+{
+
+namespace
+{
+
+using LatticePoint = std::array<int, 3>;
+
+// Returns the `n` points of a cubic lattice closest to its center, sorted by
+// distance to the center (ties broken by lattice order, for reproducibility).
+std::vector<LatticePoint> globule_points(size_t n)
+{
+    const int side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(n))));
+    const double center = 0.5 * (side - 1);
+
+    std::vector<LatticePoint> points;
+    points.reserve(static_cast<size_t>(side) * side * side);
+    for (int i = 0; i < side; ++i)
+        for (int j = 0; j < side; ++j)
+            for (int k = 0; k < side; ++k)
+                points.push_back({i, j, k});
+
+    const auto distance2 = [center](const LatticePoint & p) {
+        return (p[0] - center) * (p[0] - center) + (p[1] - center) * (p[1] - center) +
+               (p[2] - center) * (p[2] - center);
+    };
+    std::stable_sort(points.begin(), points.end(),
+                     [&](const LatticePoint & a, const LatticePoint & b) { return distance2(a) < distance2(b); });
+    points.resize(n);
+    return points;
+}
+
+class Builder
+{
+  protected:
+    const Parameters & _parameters;
+    std::mt19937 _generator;
+    std::uniform_real_distribution<float> _jitter;
+    Topology & _topology;
+
+  public:
+    Builder(const Parameters & parameters, Topology & topology)
+        : _parameters(parameters), _generator(parameters.seed),
+          _jitter(-static_cast<float>(parameters.jitter), static_cast<float>(parameters.jitter)), _topology(topology)
+    {
+        _topology.reserve(parameters.number_of_particles);
+    }
+
+    ParticleProperties bead(const Vector3f & position)
+    {
+        ParticleProperties properties;
+        const int id = static_cast<int>(_topology.number_of_particles());
+        properties.set_atom_id(id + 1);
+        properties.set_residue_id(id + 1);
+        properties.set_position(position + Vector3f(_jitter(_generator), _jitter(_generator), _jitter(_generator)));
+        properties.set_mass(110.0f);
+        properties.set_radius(1.8f);
+        properties.set_epsilon(0.1f);
+        properties.set_dynamic();
+        return properties;
+    }
+
+    void add(const ParticleProperties & properties) { _topology.add_particle(properties); }
+
+    void add_springs() { _topology.add_springs_from_cutoff(_parameters.spring_cutoff); }
+};
+
+// Adds a globule of `n` particles whose lattice starts at `origin`.
+void add_globule(Builder & builder, size_t n, const Vector3f & origin, double spacing, const std::string & chain)
+{
+    size_t index = 0;
+    for (const LatticePoint & point : globule_points(n))
+    {
+        const Vector3f position = origin + Vector3f(point[0], point[1], point[2]) * static_cast<float>(spacing);
+        ParticleProperties properties = builder.bead(position);
+        properties.set_name("CA");
+        properties.set_residue_name(index % 3 == 0 ? "LEU" : "ALA");
+        properties.set_chain_name(chain);
+        if (index % 5 == 0)
+            properties.set_charge(index % 10 == 0 ? 1.0f : -1.0f);
+        if (index % 3 == 0)
+            properties.set_hydrophobicity(1.0f);
+        builder.add(properties);
+        ++index;
+    }
+}
+
+// Returns the name of the chain at `index`: A..Z, then AA, AB...
+std::string chain_name(size_t index)
+{
+    std::string name;
+    do
+    {
+        name.insert(name.begin(), static_cast<char>('A' + index % 26));
+        index = index / 26;
+    } while (index-- > 0);
+    return name;
+}
+
+} // namespace
+
+SystemKind system_kind(const std::string & name)
+{
+    if (name == "lattice")
+        return SystemKind::Lattice;
+    if (name == "membrane")
+        return SystemKind::Membrane;
+    if (name == "assembly")
+        return SystemKind::Assembly;
+    throw std::invalid_argument("unknown system kind '" + name + "' (expected lattice, membrane or assembly)");
+}
+
+std::string system_kind_name(SystemKind kind)
+{
+    switch (kind)
+    {
+    case SystemKind::Lattice:
+        return "lattice";
+    case SystemKind::Membrane:
+        return "membrane";
+    case SystemKind::Assembly:
+        return "assembly";
+    }
+    return "";
+}
+
+Topology lattice_protein(const Parameters & parameters)
+{
+    Topology top;
+    Builder builder(parameters, top);
+    add_globule(builder, parameters.number_of_particles, Vector3f(), parameters.spacing, "A");
+    builder.add_springs();
+    return top;
+}
+
+Topology membrane_slab(const Parameters & parameters)
+{
+    constexpr size_t NUMBER_OF_LAYERS = 4;
+    const size_t per_layer = (parameters.number_of_particles + NUMBER_OF_LAYERS - 1) / NUMBER_OF_LAYERS;
+    const size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(per_layer))));
+    const float spacing = static_cast<float>(parameters.spacing);
+
+    Topology top;
+    Builder builder(parameters, top);
+    size_t count = 0;
+    for (size_t layer = 0; layer < NUMBER_OF_LAYERS; ++layer)
+    {
+        const bool head = layer == 0 || layer == NUMBER_OF_LAYERS - 1;
+        const float z = (static_cast<float>(layer) - 0.5f * (NUMBER_OF_LAYERS - 1)) * spacing;
+        for (size_t i = 0; i < per_layer && count < parameters.number_of_particles; ++i, ++count)
+        {
+            const Vector3f position(static_cast<float>(i % side) * spacing, static_cast<float>(i / side) * spacing, z);
+            ParticleProperties properties = builder.bead(position);
+            properties.set_name(head ? "PO4" : "C1");
+            properties.set_residue_name("POPC");
+            properties.set_chain_name(layer < NUMBER_OF_LAYERS / 2 ? "L" : "U");
+            if (head)
+                properties.set_charge(i % 2 == 0 ? 1.0f : -1.0f);
+            else
+                properties.set_hydrophobicity(1.0f);
+            builder.add(properties);
+        }
+    }
+    builder.add_springs();
+    return top;
+}
+
+Topology assembly(const Parameters & parameters)
+{
+    const size_t chain_size = std::max<size_t>(1, std::min(parameters.chain_size, parameters.number_of_particles));
+    const size_t number_of_chains = (parameters.number_of_particles + chain_size - 1) / chain_size;
+    const size_t chains_per_side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(number_of_chains))));
+
+    // Lattice extent of one globule, plus the gap.
+    const double extent = std::ceil(std::cbrt(static_cast<double>(chain_size))) * parameters.spacing;
+    const float stride = static_cast<float>(extent + std::max(parameters.chain_gap, parameters.spring_cutoff));
+
+    Topology top;
+    Builder builder(parameters, top);
+    size_t remaining = parameters.number_of_particles;
+    for (size_t chain = 0; chain < number_of_chains; ++chain)
+    {
+        const Vector3f origin(static_cast<float>(chain % chains_per_side) * stride,
+                              static_cast<float>(chain / chains_per_side % chains_per_side) * stride,
+                              static_cast<float>(chain / (chains_per_side * chains_per_side)) * stride);
+        const size_t n = std::min(chain_size, remaining);
+        add_globule(builder, n, origin, parameters.spacing, chain_name(chain));
+        remaining -= n;
+    }
+    builder.add_springs();
+    return top;
+}
+
+Topology make_system(SystemKind kind, const Parameters & parameters)
+{
+    switch (kind)
+    {
+    case SystemKind::Lattice:
+        return lattice_protein(parameters);
+    case SystemKind::Membrane:
+        return membrane_slab(parameters);
+    case SystemKind::Assembly:
+        return assembly(parameters);
+    }
+    return Topology();
+}
+
+} // namespace generator
+} // namespace topology
+} // namespace biospring
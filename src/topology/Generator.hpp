@@ -0,0 +1,71 @@
+#ifndef __TOPOLOGY_GENERATOR_HPP__
+#define __TOPOLOGY_GENERATOR_HPP__
+
+#include "Topology.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace biospring
+{
+namespace topology
+{
+namespace generator
+{
+
+// =============================================================================
+//
+// Canonical synthetic systems.
+//
+// Elastic-network systems of any size, used to measure the simulation engine
+// on inputs that scale smoothly with the number of particles. Beads sit on a
+// cubic lattice, slightly shifted at random so that springs do not all have
+// the same equilibrium length. The same parameters and seed always give the
+// same system.
+//
+// =============================================================================
+
+enum class SystemKind
+{
+    Lattice,  // one compact globular protein
+    Membrane, // a bilayer slab: two leaflets of head and tail beads
+    Assembly, // a multi-chain assembly of globular proteins
+};
+
+// Returns the kind named `name` ("lattice", "membrane" or "assembly").
+// Throws std::invalid_argument if the name is unknown.
+SystemKind system_kind(const std::string & name);
+std::string system_kind_name(SystemKind kind);
+
+struct Parameters
+{
+    size_t number_of_particles = 10000;
+    double spacing = 3.8;        // lattice spacing (Å)
+    double jitter = 0.2;         // maximal random shift of each coordinate (Å)
+    double spring_cutoff = 7.0;  // springs link beads closer than this distance (Å)
+    size_t chain_size = 1000;    // number of particles per chain in assemblies
+    double chain_gap = 10.0;     // minimal distance between chains in assemblies (Å)
+    unsigned seed = 1;
+};
+
+// A compact globule: the `number_of_particles` lattice points closest to the center
+// of a cube. One particle out of five is charged (alternating signs), one out of
+// three is hydrophobic.
+Topology lattice_protein(const Parameters & parameters);
+
+// A bilayer slab spanning the xy plane: four layers of beads (head, tail, tail,
+// head) on a square lattice. Heads are charged, tails are hydrophobic.
+Topology membrane_slab(const Parameters & parameters);
+
+// Globular chains of `chain_size` particles on a cubic grid, each chain with its own
+// chain name. Chains are further apart than the spring cutoff, so springs never
+// link two chains.
+Topology assembly(const Parameters & parameters);
+
+Topology make_system(SystemKind kind, const Parameters & parameters);
+
+} // namespace generator
+} // namespace topology
+} // namespace biospring
+
+#endif // __TOPOLOGY_GENERATOR_HPP__
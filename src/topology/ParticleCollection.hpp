@@ -84,6 +84,14 @@ class ParticleCollection
         _by_uid[_data.back().unique_id()] = _data.size() - 1;
     }
 
+    // Constructs a new particle from its properties at the end of the collection.
+    // Avoids the temporary `Particle` and the copy made by `push_back` when bulk loading.
+    void emplace_back(const ParticleProperties & properties)
+    {
+        _data.emplace_back(properties);
+        _by_uid[_data.back().unique_id()] = _data.size() - 1;
+    }
+
     // Adds a severak (copies of) particle to the end of the collection.
     template <typename container> void push_back(const container & particles)
     {
@@ -209,6 +217,13 @@ class ParticleCollection
     // Returns whether the collection is empty.
     bool empty() const { return _data.empty(); }
 
+    // Reserves storage for at least `n` particles.
+    void reserve(size_type n)
+    {
+        _data.reserve(n);
+        _by_uid.reserve(n);
+    }
+
     // =============================================================================
     // Lookup.
     // =============================================================================
@@ -158,6 +158,7 @@ class ParticleProperties
     void set_name(const std::string & name) { _name = name; }
     void set_residue_name(const std::string & residue_name) { _residue_name = residue_name; }
     void set_chain_name(const std::string & chain_name) { _chain_name = chain_name; }
+    void set_element_name(const std::string & element_name) { _element_name = element_name; }
 
     void set_residue_id(int residue_id) { _residue_id = residue_id; }
     void set_atom_id(int atom_id) { _atom_id = atom_id; }
@@ -159,6 +159,31 @@ class SpringCollection
         return _data.back();
     }
 
+    // Adds springs between the particles at the given positions in the particle collection.
+    // Unlike `add_spring`, pairs that are already linked are silently skipped, so that
+    // springs can be inserted in bulk without using exceptions as control flow.
+    // Equilibrium distances are set to the distance between each pair.
+    // Returns the number of springs actually added.
+    size_t add_springs(const std::vector<std::pair<size_t, size_t>> & pairs, double stiffness = 1.0)
+    {
+        const size_t size_before = _data.size();
+        reserve(size_before + pairs.size());
+
+        for (const auto & [i, j] : pairs)
+        {
+            Particle & p1 = _particles[i];
+            Particle & p2 = _particles[j];
+
+            if (p1.unique_id() == p2.unique_id() || exists(p1, p2))
+                continue;
+
+            _data.push_back(Spring(p1, p2, -1.0, stiffness));
+            _by_uid[_data.back().uid()] = _data.size() - 1;
+        }
+
+        return _data.size() - size_before;
+    }
+
     // + operator.
     // Returns a new SpringCollection that contains the springs of both collections.
     SpringCollection operator+(const SpringCollection & other)
@@ -218,6 +243,13 @@ class SpringCollection
     // Returns true if the collection is empty.
     bool empty() const { return _data.empty(); }
 
+    // Reserves storage for at least `n` springs.
+    void reserve(size_t n)
+    {
+        _data.reserve(n);
+        _by_uid.reserve(n);
+    }
+
     // =============================================================================
     // Lookup.
     // =============================================================================
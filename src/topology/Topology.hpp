@@ -8,6 +8,10 @@
 #include "nsearch.hpp"
 
 #include "SpringNetwork.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
 namespace biospring
 {
 namespace topology
@@ -73,6 +77,15 @@ class Topology
     size_t number_of_particles() const { return _particles.size(); }
     size_t number_of_springs() const { return _springs.size(); }
 
+    // Reserves storage for particles and springs ahead of a bulk load.
+    // Particles must be reserved before any spring is added: springs hold
+    // references to particles that a reallocation would invalidate.
+    void reserve(size_t nparticles, size_t nsprings = 0)
+    {
+        _particles.reserve(nparticles);
+        _springs.reserve(nsprings);
+    }
+
     // =============================================================================
     // Particle manipulation.
     // =============================================================================
@@ -80,6 +93,9 @@ class Topology
     // Adds a particle to the topology.
     void add_particle(const Particle & particle) { _particles.push_back(particle); }
 
+    // Adds a particle constructed from its properties to the topology.
+    void add_particle(const ParticleProperties & properties) { _particles.emplace_back(properties); }
+
     // Adds a collection of particles to the topology.
     template <typename container> void add_particles(const container & particles) { _particles.push_back(particles); }
     void add_particles(const std::initializer_list<Particle> & particles) { _particles.push_back(particles); }
@@ -104,37 +120,11 @@ class Topology
     // Equilibrium distance is set to the distance bewteen each pair.
     void add_springs_from_cutoff(double cutoff, double stiffness = 1.0)
     {
-        // Initializes the neighbor search object.
-        nsearch::NeighborSearch nsearch(_particles, cutoff);
-
-        // Iterates over all particles.
-        for (Particle & p : _particles)
-        {
-            // Gets the neighbors of the current particle.
-            auto neighbor_indexes = nsearch.get_neighbors(p);
-
-            // Iterates over the neighbors.
-            for (auto & neighbor_index : neighbor_indexes)
-            {
-                Particle & neighbor = _particles[neighbor_index];
-
-                // If both particles are static, skip them.
-                if (p.properties().is_static() && neighbor.properties().is_static())
-                    continue;
-
-                // Adds a spring between the current particle and the neighbor.
-                // In this context, it's possible that we're trying to add a spring that
-                // already exists.
-                try
-                {
-                    auto & spring = add_spring(p, neighbor);
-                    spring.set_stiffness(stiffness);
-                }
-                catch (const SpringAlreadyExistsException & e)
-                {
-                }
-            }
-        }
+        auto pairs = _pairs_within_cutoff(cutoff, [](const Particle & p1, const Particle & p2) {
+            // If both particles are static, skip them.
+            return !(p1.properties().is_static() && p2.properties().is_static());
+        });
+        _springs.add_springs(pairs, stiffness);
     }
 
     // Adds springs betweens particles that originate from different topologies.
@@ -142,41 +132,12 @@ class Topology
     // topology merging.
     void add_springs_between_topologies_from_cutoff(double cutoff, double stiffness = 1.0)
     {
-        // Initializes the neighbor search object.
-        nsearch::NeighborSearch nsearch(_particles, cutoff);
-
-        // Iterates over all particles.
-        for (Particle & p : _particles)
-        {
-            // Gets the neighbors of the current particle.
-            auto neighbor_indexes = nsearch.get_neighbors(p);
-
-            // Iterates over the neighbors.
-            for (auto & neighbor_index : neighbor_indexes)
-            {
-                Particle & neighbor = _particles[neighbor_index];
-
-                // If the neighbor is in the same topology, skip it.
-                if (p.properties().topology_id() == neighbor.properties().topology_id())
-                    continue;
-
-                // If both particles are static, skip them.
-                if (p.properties().is_static() && neighbor.properties().is_static())
-                    continue;
-
-                // Adds a spring between the current particle and the neighbor.
-                // In this context, it's possible that we're trying to add a spring that
-                // already exists.
-                try
-                {
-                    auto & spring = add_spring(p, neighbor);
-                    spring.set_stiffness(stiffness);
-                }
-                catch (const SpringAlreadyExistsException & e)
-                {
-                }
-            }
-        }
+        auto pairs = _pairs_within_cutoff(cutoff, [](const Particle & p1, const Particle & p2) {
+            // If both particles are in the same topology, or if both are static, skip them.
+            return p1.properties().topology_id() != p2.properties().topology_id() &&
+                   !(p1.properties().is_static() && p2.properties().is_static());
+        });
+        _springs.add_springs(pairs, stiffness);
     }
 
     // =============================================================================
@@ -246,6 +207,7 @@ class Topology
     {
         // Removes all springs and particles from the SpringNetwork.
         spn.clear();
+        spn.reserve(_particles.size(), _springs.size());
 
         // Copies particles.
         for (const topology::Particle & source : _particles)
@@ -281,7 +243,7 @@ class Topology
             target.setSolventAccessibilitySurface(source.properties().imp().solvent_accessible_surface());
             target.setTransferEnergyByAccessibleSurface(source.properties().imp().transfert_energy_by_accessible_surface());
 
-            spn.addParticle(target);
+            spn.addParticle(std::move(target));
         }
 
         // Copies springs.
@@ -296,6 +258,52 @@ class Topology
     }
 
   protected:
+    // Returns the pairs of particle positions (i, j), with i < j, that are closer than
+    // `cutoff` and for which `accept(particle_i, particle_j)` is true.
+    //
+    // Each pair is enumerated once (half shell): particle i only keeps the neighbors
+    // that come after it. Particles are distributed over threads, each thread
+    // collecting its pairs in its own buffer; buffers are then concatenated and
+    // sorted, so that the result does not depend on the number of threads.
+    template <typename Predicate>
+    std::vector<std::pair<size_t, size_t>> _pairs_within_cutoff(double cutoff, Predicate && accept) const
+    {
+        std::vector<std::pair<size_t, size_t>> pairs;
+        if (_particles.empty())
+            return pairs;
+
+        // Initializes the neighbor search object.
+        nsearch::NeighborSearch nsearch(_particles, cutoff);
+        const size_t nparticles = _particles.size();
+
+#ifdef OPENMP_SUPPORT
+#pragma omp parallel
+#endif
+        {
+            std::vector<std::pair<size_t, size_t>> local;
+
+#ifdef OPENMP_SUPPORT
+#pragma omp for schedule(dynamic, 64) nowait
+#endif
+            for (size_t i = 0; i < nparticles; ++i)
+            {
+                const Particle & p = _particles[i];
+                nsearch.for_each_neighbor(p, [&](size_t j) {
+                    if (j > i && accept(p, _particles[j]))
+                        local.emplace_back(i, j);
+                });
+            }
+
+#ifdef OPENMP_SUPPORT
+#pragma omp critical(topology_pairs_within_cutoff)
+#endif
+            pairs.insert(pairs.end(), local.begin(), local.end());
+        }
+
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
     // Copies `other`'s particles to this topology.
     void _copy_particles(const Topology & other)
     {
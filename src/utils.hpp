@@ -1,8 +1,10 @@
 #ifndef __UTILS_HPP__
 #define __UTILS_HPP__
 
+#include "utils/concurrency.hpp"
 #include "utils/path.hpp"
 #include "utils/file.hpp"
+#include "utils/memory.hpp"
 #include "utils/string.hpp"
 
 #endif // __UTILS_HPP__
\ No newline at end of file
@@ -0,0 +1,138 @@
+// Lock-free exchange of data between two threads.
+//
+// Both classes here are meant for a single producer and a single consumer, which
+// is how the simulation loop talks to an interactor thread: the main thread
+// publishes the system state, the interactor publishes what it wants applied to
+// the system. Neither side ever blocks the other.
+
+#ifndef __UTILS_CONCURRENCY_HPP__
+#define __UTILS_CONCURRENCY_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace biospring
+{
+namespace utils
+{
+namespace concurrency
+{
+
+// Triple buffer.
+//
+// The producer fills `back()` then calls `publish()`; the consumer calls `acquire()`
+// and reads `front()`. The two sides always work on different buffers, and the
+// third one holds the latest published value, so that the producer never waits for
+// the consumer and the consumer always gets a complete value (possibly the same as
+// last time when nothing new was published).
+template <typename T> class TripleBuffer
+{
+  protected:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> _buffers;
+    uint8_t _back = 0;               // owned by the producer
+    std::atomic<uint8_t> _middle{1}; // latest published buffer, plus the FRESH flag
+    uint8_t _front = 2;              // owned by the consumer
+
+  public:
+    // Producer side.
+    T & back() { return _buffers[_back]; }
+
+    // Makes `back()` the latest value and hands the producer another buffer.
+    void publish()
+    {
+        const uint8_t previous = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+        _back = previous & INDEX_MASK;
+    }
+
+    // Consumer side.
+    // Fetches the latest published value, if any. Returns true if `front()` changed.
+    bool acquire()
+    {
+        if ((_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        const uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & INDEX_MASK;
+        return true;
+    }
+
+    T & front() { return _buffers[_front]; }
+    const T & front() const { return _buffers[_front]; }
+
+    // Applies `function` to each of the three buffers.
+    // Not thread-safe: only meant to size the buffers before both threads start.
+    template <typename Function> void for_each(Function && function)
+    {
+        for (T & buffer : _buffers)
+            function(buffer);
+    }
+};
+
+// Bounded single-producer, single-consumer queue.
+//
+// `push` is only called by one thread and `pop` by another one. The capacity is
+// rounded up to a power of two.
+template <typename T> class SpscQueue
+{
+  protected:
+    std::unique_ptr<T[]> _data;
+    size_t _mask;
+    alignas(64) std::atomic<size_t> _head{0}; // next slot to read, written by the consumer
+    alignas(64) std::atomic<size_t> _tail{0}; // next slot to write, written by the producer
+
+    static size_t _round_capacity(size_t capacity)
+    {
+        size_t n = 2;
+        while (n < capacity)
+            n <<= 1;
+        return n;
+    }
+
+  public:
+    explicit SpscQueue(size_t capacity = 1024)
+        : _data(std::make_unique<T[]>(_round_capacity(capacity))), _mask(_round_capacity(capacity) - 1)
+    {
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+    // Producer side.
+    // Returns false if the queue is full.
+    bool push(const T & value)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) > _mask)
+            return false;
+        _data[tail & _mask] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side.
+    // Returns false if the queue is empty.
+    bool pop(T & value)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+        value = _data[head & _mask];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Number of elements in the queue. Only exact when called from one of the two
+    // threads while the other is idle.
+    size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+};
+
+} // namespace concurrency
+} // namespace utils
+} // namespace biospring
+
+#endif // __UTILS_CONCURRENCY_HPP__
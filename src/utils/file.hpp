@@ -6,8 +6,18 @@
 #include "logging.h"
 
 #include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
 #include <sys/stat.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define BIOSPRING_HAS_MMAP
+#endif
+
 namespace biospring
 {
 namespace utils
@@ -56,6 +66,89 @@ inline bool exists(const std::string & path)
     return (stat(path.c_str(), &buffer) == 0);
 }
 
+// Read-only view on the whole content of a file.
+//
+// On POSIX systems the file is mapped in memory with mmap(2), so that large
+// inputs (e.g. multi-million atom PDB files) are paged in by the kernel rather
+// than copied line by line through an std::ifstream. Elsewhere, or when the file
+// cannot be mapped (pipes, special files), its content is read in a buffer.
+//
+// Dies if the file cannot be opened or, optionally, if it is empty.
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    MappedFile(const std::string & path, bool diesIfEmpty = false) { open(path, diesIfEmpty); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    void open(const std::string & path, bool diesIfEmpty = false)
+    {
+        close();
+        if (path.empty())
+        {
+            logging::die("openread: empty file name");
+        }
+#ifdef BIOSPRING_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            logging::die("can't open file: '%s'", path.c_str());
+        }
+        struct stat sb;
+        if (::fstat(fd, &sb) == 0 and S_ISREG(sb.st_mode) and sb.st_size > 0)
+        {
+            void * addr = ::mmap(nullptr, static_cast<size_t>(sb.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                _data = static_cast<const char *>(addr);
+                _size = static_cast<size_t>(sb.st_size);
+                _mapped = true;
+            }
+        }
+        ::close(fd);
+#endif
+        if (not _mapped)
+        {
+            std::ifstream infile(path, std::ios::binary);
+            if (not infile)
+            {
+                logging::die("can't open file: '%s'", path.c_str());
+            }
+            _buffer.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+            _data = _buffer.data();
+            _size = _buffer.size();
+        }
+        if (diesIfEmpty and _size == 0)
+        {
+            logging::die("%s: empty file", path.c_str());
+        }
+    }
+
+    void close()
+    {
+#ifdef BIOSPRING_HAS_MMAP
+        if (_mapped)
+            ::munmap(const_cast<char *>(_data), _size);
+#endif
+        _mapped = false;
+        _data = nullptr;
+        _size = 0;
+        _buffer.clear();
+    }
+
+    std::string_view view() const { return std::string_view(_data, _size); }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+  protected:
+    const char * _data = nullptr;
+    size_t _size = 0;
+    bool _mapped = false;
+    std::string _buffer;
+};
 
 } // namespace file
 } // namespace utils
@@ -0,0 +1,43 @@
+// Memory usage utilities.
+
+#ifndef __UTILS_MEMORY_HPP__
+#define __UTILS_MEMORY_HPP__
+
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace biospring
+{
+namespace utils
+{
+namespace memory
+{
+
+// Returns the peak resident set size of the process in bytes.
+// Returns 0 on platforms where it is not available.
+inline size_t peakResidentSetSize()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    // macOS reports ru_maxrss in bytes.
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    // Linux reports ru_maxrss in kilobytes.
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+} // namespace memory
+} // namespace utils
+} // namespace biospring
+
+#endif // __UTILS_MEMORY_HPP__
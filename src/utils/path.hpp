@@ -3,7 +3,9 @@
 #ifndef __UTILS_PATH_HPP__
 #define __UTILS_PATH_HPP__
 
+#include <cstddef>
 #include <string>
+#include <utility>
 
 namespace biospring
 {
@@ -54,6 +56,15 @@ inline std::string getExtension(std::string path)
     return path.substr(path.find_last_of('.') + 1, path.size());
 }
 
+// Returns a path with a replica (or run) number inserted before the extension.
+inline std::string replicaPath(const std::string & path, size_t replica)
+{
+    if (path.empty())
+        return path;
+    const auto [root, extension] = splitExtension(path);
+    return root + "." + std::to_string(replica) + (extension.empty() ? "" : "." + extension);
+}
+
 } // namespace path
 } // namespace utils
 } // namespace biospring
@@ -2,11 +2,16 @@
 #define __UTILS_STRING_HPP__
 
 #include <algorithm>
+#include <cerrno>
+#include <charconv>
 #include <cstdarg>
+#include <cstdlib>
 #include <iterator>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 
@@ -139,6 +144,80 @@ inline std::string rtrim(const std::string & s) { return std::regex_replace(s, s
 // Trim from both sides.
 inline std::string trim(const std::string & s) { return ltrim(rtrim(s)); }
 
+// Trims whitespace from both sides of a view, without allocating.
+// Unlike `trim`, the result refers to the same characters as the input.
+inline std::string_view trim_view(std::string_view s)
+{
+    constexpr std::string_view whitespace = " \t\n\r\f\v";
+    const size_t first = s.find_first_not_of(whitespace);
+    if (first == std::string_view::npos)
+        return std::string_view();
+    const size_t last = s.find_last_not_of(whitespace);
+    return s.substr(first, last - first + 1);
+}
+
+// Parses the leading number of a fixed-width field with `std::from_chars`.
+//
+// Mimics `std::stoi`/`std::stof` on the field: leading whitespace and a '+' sign
+// are skipped and trailing characters are ignored, but nothing throws. Returns
+// false if no number could be read.
+//
+// Standard libraries without floating-point `std::from_chars` (older libc++, as
+// shipped with AppleClang) do not define `__cpp_lib_to_chars`: floating-point
+// fields are then parsed with `strtof`/`strtod`.
+template <typename T> inline bool parse_field(std::string_view s, T & value)
+{
+    const size_t first = s.find_first_not_of(" \t\n\r\f\v");
+    if (first == std::string_view::npos)
+        return false;
+    s.remove_prefix(first);
+    if (s.front() == '+')
+        s.remove_prefix(1);
+#ifndef __cpp_lib_to_chars
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        // The view is not null-terminated.
+        const std::string field(s);
+        char * end = nullptr;
+        errno = 0;
+        if constexpr (std::is_same_v<T, float>)
+            value = std::strtof(field.c_str(), &end);
+        else if constexpr (std::is_same_v<T, double>)
+            value = std::strtod(field.c_str(), &end);
+        else
+            value = std::strtold(field.c_str(), &end);
+        return end != field.c_str() && errno != ERANGE;
+    }
+    else
+#endif
+    {
+        const auto result = std::from_chars(s.data(), s.data() + s.size(), value);
+        return result.ec == std::errc();
+    }
+}
+
+// Returns a view on each line of a text buffer (line offsets index).
+// Line terminators ("\n" or "\r\n") are not part of the views.
+inline std::vector<std::string_view> split_lines(std::string_view text)
+{
+    std::vector<std::string_view> lines;
+    lines.reserve(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos)
+            end = text.size();
+        std::string_view line = text.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        lines.push_back(line);
+        start = end + 1;
+    }
+    return lines;
+}
+
 // Converts a string to any type.
 // Adapted from http://forums.codeguru.com/showthread.php?231054-C-String-How-to-convert-a-string-into-a-numeric-type
 template <class T> inline bool from_string(T & t, const std::string & s)
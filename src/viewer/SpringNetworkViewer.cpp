@@ -314,6 +314,13 @@ void SpringNetworkViewer::updateColor()
 	}
 void SpringNetworkViewer::updateForce()
 	{
+	// The force follows the mouse: it is set again at each frame and expires at
+	// the next step if the user releases the selection.
+	const unsigned expiry=static_cast<unsigned>(_springnetwork->getNbIterations())+1;
+	set <unsigned >::iterator sit;
+	for(sit=selection.begin();sit!=selection.end();++sit)
+		_springnetwork->setExternalForce(*sit,force,expiry);
+
 	particlesforce = (GLfloat*)glMapBufferARB(GL_ARRAY_BUFFER_ARB, GL_READ_WRITE_ARB);
 	if(particlesforce)
 		{